@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -22,7 +22,7 @@
 // \__/\__(_|_)_____/_/ /_/\__, /_/_/ /_/\___/ 
 //                        /____/               
 //
-// AbstractGame.cpp : Copyright  2013 Tom Tondeur
+// AbstractGame.cpp : Copyright © 2013 Tom Tondeur
 //
 
 //------------
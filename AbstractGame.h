@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -23,7 +23,7 @@
 //                        /____/               
 //
 // AbstractGame.h : Abstract class, game classes inherit from this
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 //
 
 #pragma once
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -18,6 +18,7 @@
 #include "CameraComponent.h"
 #include "../Scenegraph/GameScene.h"
 #include "TransformComponent.h"
+#include "../Graphics/Model3D.h"
 
 using namespace tt;
 
@@ -94,6 +95,21 @@ const Matrix4x4& CameraComponent::GetViewInverse() const
 	return m_MatViewInv;
 }
 
+Ray CameraComponent::GetPickRay(const POINT& screenPosition, const tt::ViewportInfo& viewport) const
+{
+	Vector2 halfDimensions(viewport.width * .5f, viewport.height * .5f);
+	
+	//Calculate NDC
+	Vector2 ndcCoords( (screenPosition.x - halfDimensions.x) / halfDimensions.x, (halfDimensions.y - screenPosition.y) / halfDimensions.y);
+
+	//Transform near and far point
+	Matrix4x4 matViewProjInv = (m_MatView * m_MatProj).Inverse();
+	Vector3 start	= Vector3(ndcCoords.x, ndcCoords.y, 0).TransformPoint(matViewProjInv);
+	Vector3 end		= Vector3(ndcCoords.x, ndcCoords.y, 1).TransformPoint(matViewProjInv);
+
+	return Ray(start, Vector3::Normalize(end - start) );
+}
+
 CameraAttributes& CameraComponent::GetAttributes(void)
 {
 	return m_Attributes;
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -30,6 +30,7 @@ struct CameraAttributes
 };
 
 class TransformComponent;
+struct Ray;
 
 class CameraComponent : public ObjectComponent
 {
@@ -45,6 +46,8 @@ public:
 	const tt::Matrix4x4& GetView(void) const;
 	const tt::Matrix4x4& GetProjection(void) const;
 	const tt::Matrix4x4& GetViewInverse(void) const;
+	//World space ray from the near plane through a pixel of the viewport, with a normalized direction
+	Ray GetPickRay(const POINT& screenPosition, const tt::ViewportInfo& viewport) const;
 	CameraAttributes& GetAttributes(void);
 
 private:
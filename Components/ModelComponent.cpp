@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -21,13 +21,18 @@
 #include "../Graphics/GraphicsDevice.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Materials/SkinnedMaterial.h"
+#include "../Graphics/AnimationSystem.h"
 #include "../Graphics/SpriteFont.h"
 #include "../Components/TransformComponent.h"
 #include "../AbstractGame.h"
 #include "../Scenegraph/GameScene.h"
 #include "CameraComponent.h"
 
-ModelComponent::ModelComponent(std::tstring modelFilename, const TransformComponent* pTransform):m_ModelFile(modelFilename),m_pTransform(pTransform),m_pMeshAnimator(nullptr)
+std::vector<AnimationLOD> ModelComponent::s_AnimationLODs;
+float ModelComponent::s_MaxLODScreenError = 0.002f;
+float ModelComponent::s_LODHysteresis = 0.2f;
+
+ModelComponent::ModelComponent(std::tstring modelFilename, const TransformComponent* pTransform):m_ModelFile(modelFilename),m_pTransform(pTransform),m_pMeshAnimator(nullptr),m_AnimationTimeOffset(0),m_MeshLOD(0),m_bBackfaceClusterCulling(false),m_RenderableIndex(UINT_MAX)
 {
 
 }
@@ -45,15 +50,37 @@ void ModelComponent::Initialize(void)
 	
 	if(m_pModel->HasAnimData()){
 		m_pMeshAnimator = new MeshAnimator();
-		m_pMeshAnimator->SetModel(m_pModel.get() );
+		m_pMeshAnimator->SetAnimationData(&m_pModel->GetAnimationData() );
 		m_pMeshAnimator->SetAnimationClip(_T("WalkCycle"));
+		m_pMeshAnimator->SetTimeOffset(m_AnimationTimeOffset);
 	}
 }
 
 void ModelComponent::Update(const tt::GameContext& context)
 {
-	if(m_pModel->HasAnimData())
-		m_pMeshAnimator->Update(context);
+	//Culled against the camera together with every other model once the scene is drawn
+	m_RenderableIndex = context.pGame->GetActiveScene()->SubmitRenderable(this);
+
+	bool bMeshLODs = m_pModel->GetNrOfLODs() > 1;
+	bool bAnimationLODs = m_pMeshAnimator && !s_AnimationLODs.empty();
+	float projectedSize = bMeshLODs || bAnimationLODs ? GetProjectedSize(context) : 0.0f;
+
+	if(bMeshLODs)
+		SelectMeshLOD(projectedSize);
+
+	if(!m_pMeshAnimator)
+		return;
+
+	if(bAnimationLODs){
+		unsigned int level = 0;
+		while(level + 1 < s_AnimationLODs.size() && projectedSize < s_AnimationLODs[level].MinScreenSize)
+			++level;
+
+		m_pMeshAnimator->SetLOD(s_AnimationLODs[level].UpdateInterval, s_AnimationLODs[level].ReducedSkeleton);
+	}
+
+	//Evaluated in parallel with all other animators once the scene is updated
+	AnimationSystem::Submit(m_pMeshAnimator);
 }
 
 void ModelComponent::Draw(const tt::GameContext& context)
@@ -61,9 +88,15 @@ void ModelComponent::Draw(const tt::GameContext& context)
 	if(m_pMaterial == nullptr)
 		throw exception();
 	
-	if( Cull(context) )
+	if(!context.pGame->GetActiveScene()->IsRenderableVisible(m_RenderableIndex, this) )
 		return;	
 	
+	const MeshLOD& lod = m_pModel->GetLOD(m_MeshLOD);
+	unsigned int nrOfCulledIndices = UpdateDrawRanges(context, lod);
+	context.pGame->GetActiveScene()->AddToMeshLODStats(m_pModel->GetLOD(0), lod, nrOfCulledIndices);
+	if(m_DrawRanges.empty() )
+		return;
+
 	auto pMat = dynamic_cast<SkinnedMaterial*>(m_pMaterial.get() );
 	if(pMat){
 		if(!m_pModel->HasAnimData())
@@ -71,11 +104,21 @@ void ModelComponent::Draw(const tt::GameContext& context)
 		
 		m_pMeshAnimator->Draw(context);
 		pMat->SetBoneTransforms(m_pMeshAnimator->GetBoneTransforms() );
-		pMat->SetDualQuats(m_pMeshAnimator->GetDualQuats() );
 		pMat->SetLightDirection(tt::Vector3(0,-1,0) );
+		
+		//Skeletons too large for the shader are drawn per submesh, each with its part of the palette
+		if(!lod.Submeshes.empty() ){
+			for(auto& submesh : lod.Submeshes){
+				SetSubmeshPalette(pMat, submesh);
+				MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->Draw(m_pModel, m_pTransform->GetWorldMatrix(), m_pMaterial, context, submesh.StartIndex, submesh.NrOfIndices);
+			}
+			return;
+		}
+
+		pMat->SetDualQuats(m_pMeshAnimator->GetDualQuats() );
 	}
 
-	MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->Draw(m_pModel, m_pTransform->GetWorldMatrix(), m_pMaterial, context);
+	MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->Draw(m_pModel, m_pTransform->GetWorldMatrix(), m_pMaterial, context, m_DrawRanges);
 }
 
 void ModelComponent::DrawDeferred(const tt::GameContext& context)
@@ -83,9 +126,15 @@ void ModelComponent::DrawDeferred(const tt::GameContext& context)
 	if(m_pMaterial == nullptr)
 		throw exception();
 	
-	if( Cull(context) )
+	if(!context.pGame->GetActiveScene()->IsRenderableVisible(m_RenderableIndex, this) )
 		return;	
 	
+	const MeshLOD& lod = m_pModel->GetLOD(m_MeshLOD);
+	unsigned int nrOfCulledIndices = UpdateDrawRanges(context, lod);
+	context.pGame->GetActiveScene()->AddToMeshLODStats(m_pModel->GetLOD(0), lod, nrOfCulledIndices);
+	if(m_DrawRanges.empty() )
+		return;
+
 	auto pMat = dynamic_cast<SkinnedMaterial*>(m_pMaterial.get() );
 	if(pMat){
 		if(!m_pModel->HasAnimData())
@@ -93,11 +142,22 @@ void ModelComponent::DrawDeferred(const tt::GameContext& context)
 		
 		m_pMeshAnimator->Draw(context);
 		pMat->SetBoneTransforms(m_pMeshAnimator->GetBoneTransforms() );
-		pMat->SetDualQuats(m_pMeshAnimator->GetDualQuats() );
 		pMat->SetLightDirection(tt::Vector3(0,-1,0) );
+		
+		//Only the first submesh clears the G-buffers, simplified levels start further in the index buffer
+		if(!lod.Submeshes.empty() ){
+			for(unsigned int i = 0; i < lod.Submeshes.size(); ++i){
+				auto& submesh = lod.Submeshes[i];
+				SetSubmeshPalette(pMat, submesh);
+				MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->DrawDeferred(m_pModel, m_pTransform->GetWorldMatrix(), m_pMaterial, context, submesh.StartIndex, submesh.NrOfIndices, i == 0);
+			}
+			return;
+		}
+
+		pMat->SetDualQuats(m_pMeshAnimator->GetDualQuats() );
 	}
 
-	MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->DrawDeferred(m_pModel, m_pTransform->GetWorldMatrix(), m_pMaterial, context);
+	MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->DrawDeferred(m_pModel, m_pTransform->GetWorldMatrix(), m_pMaterial, context, m_DrawRanges);
 }
 
 void ModelComponent::SetMaterial(resource_ptr<Material> pMat)
@@ -105,51 +165,150 @@ void ModelComponent::SetMaterial(resource_ptr<Material> pMat)
 	m_pMaterial = pMat;
 }
 
-const TransformComponent* ModelComponent::GetTransform(void) const
+void ModelComponent::SetAnimationTimeOffset(float seconds)
 {
-	return m_pTransform;
+	m_AnimationTimeOffset = seconds;
+
+	if(m_pMeshAnimator)
+		m_pMeshAnimator->SetTimeOffset(seconds);
 }
 
-bool ModelComponent::Cull(const tt::GameContext& context)
+bool ModelComponent::CrossFadeAnimation(const std::tstring& clipName, float seconds)
 {
-	tt::Vector3 vertices[8];
-	tt::Matrix4x4 wvpMat = m_pTransform->GetWorldMatrix() * context.pGame->GetActiveScene()->GetActiveCamera()->GetView() * context.pGame->GetActiveScene()->GetActiveCamera()->GetProjection();
-	
-	AABBox aabBox = m_pModel->GetAABB();
-	aabBox.GetVertices(vertices);
-	
-	//If one point is inside the view frustum, the bounding volume is visible
-	for(unsigned int i=0; i<8; ++i){
-		vertices[i] = vertices[i].TransformPoint(wvpMat);
-
-		if( vertices[i].x >= -1 && vertices[i].x <= 1 && 
-			vertices[i].y >= -1 && vertices[i].y <= 1 &&
-			vertices[i].z >= 0  && vertices[i].z <= 1 )
-			return false;
+	return m_pMeshAnimator && m_pMeshAnimator->CrossFade(clipName, seconds);
+}
+
+bool ModelComponent::SetAnimationLayerWeight(const std::tstring& clipName, float weight, float fadeSeconds)
+{
+	return m_pMeshAnimator && m_pMeshAnimator->SetLayerWeight(clipName, weight, fadeSeconds);
+}
+
+void ModelComponent::SetAnimationLODs(const std::vector<AnimationLOD>& lods)
+{
+	s_AnimationLODs = lods;
+}
+
+void ModelComponent::SetMeshLODSelection(float maxScreenError, float hysteresis)
+{
+	s_MaxLODScreenError = maxScreenError;
+	s_LODHysteresis = hysteresis;
+}
+
+void ModelComponent::SelectMeshLOD(float projectedSize)
+{
+	//Coarsest level whose error stays below the threshold on screen
+	unsigned int level = 0;
+	while(level + 1 < m_pModel->GetNrOfLODs() && m_pModel->GetLOD(level + 1).Error * projectedSize <= s_MaxLODScreenError)
+		++level;
+
+	//Finer levels are picked right away, coarser ones only once they are clearly below the threshold
+	while(level > m_MeshLOD && m_pModel->GetLOD(level).Error * projectedSize > s_MaxLODScreenError * (1 - s_LODHysteresis) )
+		--level;
+
+	m_MeshLOD = level;
+}
+
+unsigned int ModelComponent::UpdateDrawRanges(const tt::GameContext& context, const MeshLOD& lod)
+{
+	m_DrawRanges.clear();
+
+	//Clusters only cover the full model
+	const ClusterStreams& clusters = m_pModel->GetClusters();
+	if(m_MeshLOD > 0 || clusters.Size() == 0){
+		IndexRange range = {lod.StartIndex, lod.NrOfIndices};
+		m_DrawRanges.push_back(range);
+		return 0;
 	}
+
+	auto pCamera = context.pGame->GetActiveScene()->GetActiveCamera();
+	ClusterCamera camera(m_pTransform->GetWorldMatrix(), pCamera->GetView(), pCamera->GetProjection(), m_bBackfaceClusterCulling);
+	CullClusters(clusters, camera, m_DrawRanges);
+
+	unsigned int nrOfDrawnIndices = 0;
+	for(auto& range : m_DrawRanges)
+		nrOfDrawnIndices += range.NrOfIndices;
+
+	return lod.NrOfIndices - nrOfDrawnIndices;
+}
+
+void ModelComponent::SetSubmeshPalette(SkinnedMaterial* pMat, const SkinnedSubmesh& submesh)
+{
+	const auto& palette = m_pMeshAnimator->GetDualQuats();
 	
-	//Additional checks to make sure we don't cull edge cases	
-	tt::Matrix4x4 invWvpMat = wvpMat.Inverse();
-	tt::Vector3 origin[] = {tt::Vector3(-1, -1, 0),
-							tt::Vector3(-1,  1, 0),
-							tt::Vector3( 1, -1, 0),
-							tt::Vector3( 1,  1, 0),
-							};
-	tt::Vector3 destination[] = {tt::Vector3(-1, -1, 1),
-								 tt::Vector3(-1,  1, 1),
-								 tt::Vector3( 1, -1, 1),
-								 tt::Vector3( 1,  1, 1),
-								 };
-	tt::Vector3 direction = tt::Vector3(0,0,1).TransformVector(invWvpMat);
-	
-	if(aabBox.Intersect(Ray(origin[0].TransformPoint(invWvpMat), destination[0].TransformPoint(invWvpMat)), 0, 1) )
-		return false;
-	if(aabBox.Intersect(Ray(origin[1].TransformPoint(invWvpMat), destination[1].TransformPoint(invWvpMat)), 0, 1) )
-		return false;
-	if(aabBox.Intersect(Ray(origin[2].TransformPoint(invWvpMat), destination[2].TransformPoint(invWvpMat)), 0, 1) )
-		return false;
-	if(aabBox.Intersect(Ray(origin[3].TransformPoint(invWvpMat), destination[3].TransformPoint(invWvpMat)), 0, 1) )
+	m_SubmeshPalette.resize(submesh.Bones.size() );
+	for(unsigned int i = 0; i < submesh.Bones.size(); ++i)
+		m_SubmeshPalette[i] = submesh.Bones[i] < palette.size() ? palette[submesh.Bones[i]] : tt::DualQuaternion::Identity;
+
+	pMat->SetDualQuats(m_SubmeshPalette);
+}
+
+bool ModelComponent::GetSkinnedVertices(std::vector<tt::Vector3>& positions, std::vector<tt::Vector3>* pNormals) const
+{
+	if(!m_pMeshAnimator)
 		return false;
 
-	return true;
+	return SkinVertices(m_pModel->GetSkinningStreams(), m_pMeshAnimator->GetDualQuats(), positions, pNormals);
+}
+
+float ModelComponent::GetProjectedSize(const tt::GameContext& context) const
+{
+	auto pCamera = context.pGame->GetActiveScene()->GetActiveCamera();
+	const tt::Matrix4x4& world = m_pTransform->GetWorldMatrix();
+	const tt::Matrix4x4& proj = pCamera->GetProjection();
+	
+	const AABBox& aabBox = m_pModel->GetAABB();
+	tt::Vector3 center = ((aabBox.Bounds[0] + aabBox.Bounds[1]) * .5f).TransformPoint(world);
+	float radius = ((aabBox.Bounds[1] - aabBox.Bounds[0]) * .5f).TransformVector(world).Length();
+
+	//Clip space w is the view depth for perspective projections and 1 for orthographic ones
+	float viewDepth = center.TransformPoint(pCamera->GetView() ).z;
+	float w = viewDepth * proj._34 + proj._44;
+	if(w <= 0)
+		return FLT_MAX;
+
+	return radius * proj._22 / w;
+}
+
+void ModelComponent::SetBackfaceClusterCulling(bool bEnabled)
+{
+	m_bBackfaceClusterCulling = bEnabled;
+}
+
+const TransformComponent* ModelComponent::GetTransform(void) const
+{
+	return m_pTransform;
+}
+
+resource_ptr<Model3D> ModelComponent::GetModel(void) const
+{
+	return m_pModel;
+}
+
+const MeshAnimator* ModelComponent::GetMeshAnimator(void) const
+{
+	return m_pMeshAnimator;
+}
+
+AABBox ModelComponent::GetBounds(void) const
+{
+	return m_pMeshAnimator ? m_pMeshAnimator->GetAABB(m_pModel->GetAABB() ) : m_pModel->GetAABB();
+}
+
+AABBox ModelComponent::GetWorldBounds(void) const
+{
+	AABBox bounds = GetBounds();
+	if(bounds.Bounds[0].x > bounds.Bounds[1].x)
+		return bounds;
+
+	//The center is transformed as a point, the extents by the absolute value of the matrix (Arvo)
+	const tt::Matrix4x4& world = m_pTransform->GetWorldMatrix();
+	tt::Vector3 center = ((bounds.Bounds[0] + bounds.Bounds[1]) * .5f).TransformPoint(world);
+	tt::Vector3 extents = (bounds.Bounds[1] - bounds.Bounds[0]) * .5f;
+	tt::Vector3 worldExtents(	fabsf(world._11) * extents.x + fabsf(world._21) * extents.y + fabsf(world._31) * extents.z,
+								fabsf(world._12) * extents.x + fabsf(world._22) * extents.y + fabsf(world._32) * extents.z,
+								fabsf(world._13) * extents.x + fabsf(world._23) * extents.y + fabsf(world._33) * extents.z);
+
+	bounds.Bounds[0] = center - worldExtents;
+	bounds.Bounds[1] = center + worldExtents;
+	return bounds;
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -25,6 +25,12 @@ class Material;
 class Model3D;
 class MeshAnimator;
 class TransformComponent;
+struct AnimationLOD;
+struct SkinnedSubmesh;
+struct MeshLOD;
+struct IndexRange;
+struct AABBox;
+class SkinnedMaterial;
 
 class ModelComponent : public ObjectComponent
 {
@@ -40,17 +46,58 @@ public:
 	virtual void DrawDeferred(const tt::GameContext& context);
 
 	void SetMaterial(resource_ptr<Material> pMat);
-	const TransformComponent* GetTransform(void) const;
+	//Offset (in seconds) on the animation playback, lets crowds of the same model move out of lockstep
+	void SetAnimationTimeOffset(float seconds);
+	//Animation layers, see MeshAnimator. Return false for models without animation data or clips they don't have.
+	bool CrossFadeAnimation(const std::tstring& clipName, float seconds);
+	bool SetAnimationLayerWeight(const std::tstring& clipName, float weight, float fadeSeconds = 0);
 	
-	bool Cull(const tt::GameContext& context);
+	//Animation LODs of all animated models, from highest to lowest MinScreenSize. The first level the model is
+	//large enough for on screen is used, the last one below that. Empty (the default) always animates at full detail.
+	static void SetAnimationLODs(const std::vector<AnimationLOD>& lods);
+	//Mesh LODs (see Model3D::GetLOD) are picked so the surface moves at most maxScreenError on screen, as a fraction of half the
+	//screen height (0.002 is about a pixel at 1080p). 0 always draws the full model. A coarser level is only picked once its error
+	//is below (1 - hysteresis) * maxScreenError, so models near a boundary don't switch levels back and forth.
+	static void SetMeshLODSelection(float maxScreenError, float hysteresis = 0.2f);
+	//Lets CullClusters skip clusters that face away from the camera, only for materials that cull back faces
+	void SetBackfaceClusterCulling(bool bEnabled);
+	const TransformComponent* GetTransform(void) const;
+	resource_ptr<Model3D> GetModel(void) const;
+	//nullptr for models without animation data
+	const MeshAnimator* GetMeshAnimator(void) const;
+	//Model space bounds, of the playing clip for animated models since the bind pose doesn't cover the animation
+	AABBox GetBounds(void) const;
+	//GetBounds through the world matrix, the box around the transformed box
+	AABBox GetWorldBounds(void) const;
+
+	//Model space vertices of the current animation pose, skinned on the CPU. Returns false for models without animation data.
+	bool GetSkinnedVertices(std::vector<tt::Vector3>& positions, std::vector<tt::Vector3>* pNormals = nullptr) const;
 
 private:
+	//Radius of the bounding box projected by the active camera, as a fraction of half the screen height
+	float GetProjectedSize(const tt::GameContext& context) const;
+	//Picks m_MeshLOD for the projected size, see SetMeshLODSelection
+	void SelectMeshLOD(float projectedSize);
+	//Fills m_DrawRanges with the visible clusters of the full model, or the whole level without clusters. Returns the number of culled indices.
+	unsigned int UpdateDrawRanges(const tt::GameContext& context, const MeshLOD& lod);
+	//Uploads the palette entries of the submesh's bones, in local bone order
+	void SetSubmeshPalette(SkinnedMaterial* pMat, const SkinnedSubmesh& submesh);
+
 	//Datamembers
 	std::tstring m_ModelFile;
 	resource_ptr<Model3D> m_pModel;
 	resource_ptr<Material> m_pMaterial;
 	const TransformComponent* m_pTransform;
 	MeshAnimator* m_pMeshAnimator;
+	float m_AnimationTimeOffset;
+	std::vector<tt::DualQuaternion> m_SubmeshPalette;
+	unsigned int m_MeshLOD;
+	std::vector<IndexRange> m_DrawRanges;
+	bool m_bBackfaceClusterCulling;
+	unsigned int m_RenderableIndex; //In the frustum culling of the active scene, see GameScene::SubmitRenderable
+
+	static std::vector<AnimationLOD> s_AnimationLODs;
+	static float s_MaxLODScreenError, s_LODHysteresis;
 
 	//Disabling default copy constructor & assignment operator
 	ModelComponent(const ModelComponent& src);
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -16,8 +16,11 @@
 // along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "PickComponent.h"
+#include "ModelComponent.h"
+#include "TransformComponent.h"
+#include "../Graphics/Model3D.h"
 
-PickComponent::PickComponent(void)
+PickComponent::PickComponent(SceneObject* pParent, const ModelComponent* pModel):m_pParentObject(pParent),m_pModel(pModel)
 {
 
 }
@@ -29,3 +32,34 @@ PickComponent::~PickComponent(void)
 
 //Methods
 
+bool PickComponent::Raycast(const Ray& ray, float maxDistance, RayHit& hit)
+{
+	auto pModel = m_pModel->GetModel();
+	if(pModel == nullptr)
+		return false;
+
+	//The ray is taken to model space as is, distances along it stay the same
+	tt::Matrix4x4 worldInv = m_pModel->GetTransform()->GetWorldMatrix().Inverse();
+	Ray modelRay(ray.Origin.TransformPoint(worldInv), ray.Direction.TransformVector(worldInv) );
+
+	auto pAnimator = m_pModel->GetMeshAnimator();
+	if(pAnimator == nullptr)
+		return pModel->GetBVH().Intersect(modelRay, maxDistance, hit);
+
+	return m_SkinnedBVH.Intersect(pModel->GetBVH(), pModel->GetSkinningStreams(), pAnimator->GetDualQuats(), pAnimator->GetPoseSerial()
+								 ,modelRay, maxDistance, hit);
+}
+
+bool PickComponent::GetRaycastBounds(AABBox& worldBounds) const
+{
+	if(m_pModel->GetModel() == nullptr)
+		return true;
+
+	worldBounds.Include(m_pModel->GetWorldBounds() );
+	return true;
+}
+
+SceneObject* PickComponent::GetParent(void) const
+{
+	return m_pParentObject;
+}
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -17,18 +17,31 @@
 
 #pragma once
 
-class PickComponent
+#include "../Scenegraph/ObjectComponent.h"
+#include "../Graphics/SkinnedBVH.h"
+
+class SceneObject;
+class ModelComponent;
+
+//Makes a model pickable with exact ray tests against its triangles (see GameScene::Pick), through the BVH of its Model3D.
+//Animated models are picked in their current pose, through a SkinnedBVH.
+class PickComponent : public ObjectComponent
 {
 public:
 	//Default constructor & destructor
-	PickComponent(void);
+	PickComponent(SceneObject* pParent, const ModelComponent* pModel);
 	virtual ~PickComponent(void);
 
 	//Methods
+	virtual bool Raycast(const Ray& ray, float maxDistance, RayHit& hit) override;
+	virtual bool GetRaycastBounds(AABBox& worldBounds) const override;
+	SceneObject* GetParent(void) const;
 
 private:
 	//Datamembers
-
+	SceneObject* m_pParentObject;
+	const ModelComponent* m_pModel;
+	SkinnedBVH m_SkinnedBVH;
 
 	//Disabling default copy constructor & assignment operator
 	PickComponent(const PickComponent& src);
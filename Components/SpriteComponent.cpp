@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -28,6 +28,7 @@ Sprite::Sprite(const tt::Matrix4x4& transform) : pTexture(nullptr)
 }
 
 SpriteComponent::SpriteComponent(std::tstring textureFilename, const TransformComponent* pTransform):m_TextureFilename(textureFilename)
+																									,m_pTransform(pTransform)
 																									,m_Sprite(pTransform->GetWorldMatrix())
 { }
 
@@ -45,5 +46,8 @@ void SpriteComponent::Initialize(void)
 
 void SpriteComponent::Draw(const tt::GameContext& context)
 {
+	//m_Sprite references the world matrix, which the transform only expands when requested
+	m_pTransform->GetWorldMatrix();
+	
 	MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->GetSpriteBatch()->Draw(m_Sprite);
 }
\ No newline at end of file
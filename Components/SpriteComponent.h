@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -46,6 +46,7 @@ public:
 private:
 	//Datamembers
 	std::tstring m_TextureFilename;
+	const TransformComponent* m_pTransform;
 	Sprite m_Sprite;
 		
 	//Disabling default copy constructor & assignment operator
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -19,7 +19,8 @@
 
 using namespace tt;
 
-TransformComponent::TransformComponent(void):m_WorldPosition(0),m_WorldRotation(Quaternion::Identity),m_WorldScale(1),m_World(Matrix4x4::Identity)
+TransformComponent::TransformComponent(void):m_WorldPosition(0),m_WorldRotation(Quaternion::Identity),m_WorldScale(1),m_World(Transform3x4::Identity)
+											,m_WorldMatrix(Matrix4x4::Identity),m_bWorldMatrixDirty(false)
 											,m_NewPosition(0),m_NewRotation(Quaternion::Identity),m_NewScale(0)
 											,m_DeltaPosition(0),m_DeltaRotation(Quaternion::Identity),m_DeltaScale(0)
 											,m_Forward(0,0,1),m_Right(1,0,0),m_Up(0,1,0)
@@ -81,14 +82,11 @@ void TransformComponent::CheckForUpdate(bool bForce)
 	if(!bTransformed && !bForce)
 		return;	
 	
-	auto matTrans = Matrix4x4::Translation(m_WorldPosition);
-	auto matRot = Matrix4x4::Rotation(m_WorldRotation);
-	auto matScale = Matrix4x4::Scale(m_WorldScale);
-
-	m_World = matScale * matRot * matTrans;
+	m_World = Transform3x4::FromTRS(m_WorldPosition, m_WorldRotation, m_WorldScale);
+	m_bWorldMatrixDirty = true;
 	
-	m_Forward = Vector3(0,0,1).TransformPoint(matRot);
-	m_Right = Vector3(1,0,0).TransformPoint(matRot);
+	m_Forward = Vector3(0,0,1).TransformPoint(m_WorldRotation);
+	m_Right = Vector3(1,0,0).TransformPoint(m_WorldRotation);
 	m_Up = m_Forward.Cross(m_Right).Normalize();
 }
 
@@ -149,12 +147,24 @@ const Vector3& TransformComponent::GetWorldScale() const
 	return m_WorldScale; 
 }
 
-const Matrix4x4& TransformComponent::GetWorldMatrix() const
+const Transform3x4& TransformComponent::GetWorldTransform() const
 { 
 	const_cast<TransformComponent*>(this)->CheckForUpdate(); 
 	return m_World; 
 }
 
+const Matrix4x4& TransformComponent::GetWorldMatrix() const
+{ 
+	auto pThis = const_cast<TransformComponent*>(this);
+	pThis->CheckForUpdate();
+	
+	if(m_bWorldMatrixDirty){
+		pThis->m_WorldMatrix = m_World.ToMatrix4x4();
+		pThis->m_bWorldMatrixDirty = false;
+	}
+	return m_WorldMatrix; 
+}
+
 Vector3 TransformComponent::GetForward() const
 { 
 	return m_Forward;
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -45,6 +45,7 @@ public:
 	const tt::Vector3&		GetWorldPosition(void) const;
 	const tt::Quaternion&	GetWorldRotation(void) const;
 	const tt::Vector3&		GetWorldScale(void) const;
+	const tt::Transform3x4&	GetWorldTransform(void) const;
 	const tt::Matrix4x4&	GetWorldMatrix(void) const;
 
 	tt::Vector3 GetForward(void) const;
@@ -59,7 +60,9 @@ private:
 	tt::Vector3		m_WorldPosition, m_NewPosition, m_DeltaPosition;
 	tt::Quaternion	m_WorldRotation, m_NewRotation, m_DeltaRotation;
 	tt::Vector3		m_WorldScale,	 m_NewScale,	m_DeltaScale;
-	tt::Matrix4x4 m_World;
+	tt::Transform3x4 m_World;
+	tt::Matrix4x4 m_WorldMatrix; //Expanded from m_World on request, only needed for GPU upload
+	bool m_bWorldMatrixDirty;
 
 	tt::Vector3 m_Forward, m_Right, m_Up;
 
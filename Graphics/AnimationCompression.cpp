@@ -0,0 +1,305 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "AnimationCompression.h"
+#include "MeshAnimator.h"
+
+namespace
+{
+	const float SQRT2 = 1.41421356f;
+	const unsigned short MAX_QUANTIZED_COMPONENT = 0x7FFF;
+	const unsigned short MAX_QUANTIZED_TRANSLATION = 0xFFFF;
+
+	//Bounds the cost of keyframe reduction on long constant tracks
+	const unsigned int MAX_SEGMENT_LENGTH = 256;
+	//Number of retained keys a track cursor may step over before falling back to a binary search
+	const unsigned int MAX_CURSOR_STEPS = 4;
+
+	float Dot(const tt::Quaternion& a, const tt::Quaternion& b)
+	{
+		return a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w;
+	}
+
+	//Normalized lerp along the shortest arc
+	tt::Quaternion Nlerp(const tt::Quaternion& a, const tt::Quaternion& b, float t)
+	{
+		float weightB = Dot(a, b) < 0 ? -t : t;
+		tt::Quaternion out = a * (1-t) + b * weightB;
+		return out.Normalize();
+	}
+
+	tt::Vector3 Lerp(const tt::Vector3& a, const tt::Vector3& b, float t)
+	{
+		return a + (b - a) * t;
+	}
+
+	//Angle between two unit quaternions, in radians
+	float AngleBetween(const tt::Quaternion& a, const tt::Quaternion& b)
+	{
+		float cosHalfAngle = fabs(Dot(a, b));
+		return 2 * acosf(cosHalfAngle < 1 ? cosHalfAngle : 1);
+	}
+
+	//Inverse of the DualQuaternion(rotation, translation) constructor: t = 2 * vec(d * conj(r)), for a unit r
+	tt::Vector3 ExtractTranslation(const tt::DualQuaternion& dq)
+	{
+		const tt::Quaternion& r = dq.Data[0];
+		const tt::Quaternion& d = dq.Data[1];
+		return tt::Vector3(2 * (-d.w*r.x + d.x*r.w - d.y*r.z + d.z*r.y),
+						   2 * (-d.w*r.y + d.x*r.z + d.y*r.w - d.z*r.x),
+						   2 * (-d.w*r.z - d.x*r.y + d.y*r.x + d.z*r.w));
+	}
+
+	unsigned short QuantizeUnit(float f, unsigned short maxValue)
+	{
+		if(f <= 0)
+			return 0;
+		if(f >= 1)
+			return maxValue;
+		return static_cast<unsigned short>(f * maxValue + .5f);
+	}
+}
+
+//-----------------
+//QuantizedRotation
+//-----------------
+QuantizedRotation QuantizedRotation::Encode(const tt::Quaternion& rotation)
+{
+	const float* pComponents = &rotation.x;
+	
+	unsigned int largest = 0;
+	for(unsigned int i=1; i < 4; ++i)
+		if(fabs(pComponents[i]) > fabs(pComponents[largest]))
+			largest = i;
+
+	//q and -q are the same rotation, flip so the dropped component is positive
+	float sign = pComponents[largest] < 0 ? -1.0f : 1.0f;
+
+	QuantizedRotation out;
+	for(unsigned int i=0, iOut=0; i < 4; ++i)
+		if(i != largest)
+			out.Data[iOut++] = QuantizeUnit(sign * pComponents[i] * SQRT2 * .5f + .5f, MAX_QUANTIZED_COMPONENT);
+
+	out.Data[0] |= (largest & 1) << 15;
+	out.Data[1] |= (largest >> 1) << 15;
+	return out;
+}
+
+tt::Quaternion QuantizedRotation::Decode(void) const
+{
+	unsigned int largest = (Data[0] >> 15) | ((Data[1] >> 15) << 1);
+	
+	float smallest[3];
+	float sumSq = 0;
+	for(unsigned int i=0; i < 3; ++i){
+		smallest[i] = ((Data[i] & MAX_QUANTIZED_COMPONENT) / static_cast<float>(MAX_QUANTIZED_COMPONENT) - .5f) * SQRT2;
+		sumSq += smallest[i] * smallest[i];
+	}
+
+	tt::Quaternion out;
+	float* pComponents = &out.x;
+	for(unsigned int i=0, iIn=0; i < 4; ++i)
+		pComponents[i] = (i == largest) ? sqrtf(sumSq < 1 ? 1 - sumSq : 0) : smallest[iIn++];
+
+	return out;
+}
+
+//--------------
+//CompressedClip
+//--------------
+CompressedClip::CompressedClip(void)
+{
+
+}
+
+CompressedClip::~CompressedClip(void)
+{
+
+}
+
+//Methods
+
+bool CompressedClip::Compress(const AnimationClip& clip, float rotationTolerance, float translationTolerance)
+{
+	unsigned int nrOfKeys = clip.Keys.size();
+	if(nrOfKeys == 0 || nrOfKeys > 0xFFFF)
+		return false;
+	
+	unsigned int nrOfTracks = clip.Keys[0].BoneTransforms.size();
+	for(auto& key : clip.Keys)
+		if(key.BoneTransforms.size() != nrOfTracks)
+			return false;
+
+	m_KeyTimes.clear();
+	m_TrackOffsets.clear();
+	m_KeyIndices.clear();
+	m_Rotations.clear();
+	m_Translations.clear();
+	m_TranslationMin.clear();
+	m_TranslationScale.clear();
+
+	m_KeyTimes.reserve(nrOfKeys);
+	for(auto& key : clip.Keys)
+		m_KeyTimes.push_back(key.KeyTime);
+
+	std::vector<tt::Quaternion> rotations(nrOfKeys);
+	std::vector<tt::Vector3> translations(nrOfKeys);
+	std::vector<unsigned short> retained;
+	retained.reserve(nrOfKeys);
+
+	for(unsigned int track=0; track < nrOfTracks; ++track){
+		m_TrackOffsets.push_back(m_KeyIndices.size());
+
+		//Decompose the track, and find its translation bounds
+		tt::Vector3 minPos(FLT_MAX), maxPos(-FLT_MAX);
+		for(unsigned int i=0; i < nrOfKeys; ++i){
+			tt::DualQuaternion dq = clip.Keys[i].BoneTransforms[track];
+			dq *= 1 / sqrtf(Dot(dq.Data[0], dq.Data[0]));
+			
+			rotations[i] = dq.Data[0];
+			translations[i] = ExtractTranslation(dq);
+
+			minPos = tt::Vector3(min(minPos.x, translations[i].x), min(minPos.y, translations[i].y), min(minPos.z, translations[i].z));
+			maxPos = tt::Vector3(max(maxPos.x, translations[i].x), max(maxPos.y, translations[i].y), max(maxPos.z, translations[i].z));
+		}
+
+		//Greedy keyframe reduction: grow each segment until one of the keys it skips is off by more than the tolerance
+		retained.clear();
+		retained.push_back(0);
+		unsigned int segmentStart = 0;
+		for(unsigned int segmentEnd = 2; segmentEnd < nrOfKeys; ++segmentEnd){
+			bool bWithinTolerance = segmentEnd - segmentStart <= MAX_SEGMENT_LENGTH;
+			
+			float startTime = m_KeyTimes[segmentStart];
+			float duration = m_KeyTimes[segmentEnd] - startTime;
+			for(unsigned int i = segmentStart+1; bWithinTolerance && i < segmentEnd; ++i){
+				float t = duration > 0 ? (m_KeyTimes[i] - startTime) / duration : 0;
+				
+				if(AngleBetween(Nlerp(rotations[segmentStart], rotations[segmentEnd], t), rotations[i]) > rotationTolerance
+				|| (Lerp(translations[segmentStart], translations[segmentEnd], t) - translations[i]).Length() > translationTolerance)
+					bWithinTolerance = false;
+			}
+
+			if(!bWithinTolerance){
+				segmentStart = segmentEnd - 1;
+				retained.push_back(static_cast<unsigned short>(segmentStart));
+			}
+		}
+		if(nrOfKeys > 1)
+			retained.push_back(static_cast<unsigned short>(nrOfKeys - 1));
+
+		//Quantize the retained keys
+		tt::Vector3 extent = maxPos - minPos;
+		tt::Vector3 invExtent(extent.x > 0 ? 1/extent.x : 0, extent.y > 0 ? 1/extent.y : 0, extent.z > 0 ? 1/extent.z : 0);
+		m_TranslationMin.push_back(minPos);
+		m_TranslationScale.push_back(extent / MAX_QUANTIZED_TRANSLATION);
+
+		for(auto keyIndex : retained){
+			const tt::Vector3& pos = translations[keyIndex];
+			m_KeyIndices.push_back(keyIndex);
+			m_Rotations.push_back(QuantizedRotation::Encode(rotations[keyIndex]));
+			m_Translations.push_back(QuantizeUnit((pos.x - minPos.x) * invExtent.x, MAX_QUANTIZED_TRANSLATION));
+			m_Translations.push_back(QuantizeUnit((pos.y - minPos.y) * invExtent.y, MAX_QUANTIZED_TRANSLATION));
+			m_Translations.push_back(QuantizeUnit((pos.z - minPos.z) * invExtent.z, MAX_QUANTIZED_TRANSLATION));
+		}
+	}
+	m_TrackOffsets.push_back(m_KeyIndices.size());
+
+	return true;
+}
+
+//Returns the retained key (relative to the track) starting the segment that contains prevKey
+unsigned int CompressedClip::FindSegment(unsigned int track, unsigned int prevKey, unsigned int cursor) const
+{
+	unsigned int trackStart = m_TrackOffsets[track];
+	unsigned int nrOfTrackKeys = m_TrackOffsets[track+1] - trackStart;
+	const unsigned short* pKeys = &m_KeyIndices[trackStart];
+
+	if(nrOfTrackKeys < 2)
+		return 0;
+	
+	//Playback mostly stays in, or moves to the next, segment
+	if(cursor < nrOfTrackKeys-1 && pKeys[cursor] <= prevKey){
+		for(unsigned int step=0; step < MAX_CURSOR_STEPS; ++step, ++cursor)
+			if(cursor == nrOfTrackKeys-2 || pKeys[cursor+1] > prevKey)
+				return cursor;
+	}
+	
+	//Seek
+	unsigned int segment = upper_bound(pKeys, pKeys + nrOfTrackKeys, prevKey) - pKeys;
+	segment = segment > 0 ? segment-1 : 0;
+	return segment < nrOfTrackKeys-1 ? segment : nrOfTrackKeys-2;
+}
+
+void CompressedClip::Sample(float keyTime, unsigned int prevKey, unsigned int* pTrackCursors, tt::DualQuaternion* pPose) const
+{
+	unsigned int nrOfTracks = GetNrOfTracks();
+
+	for(unsigned int track=0; track < nrOfTracks; ++track)
+		pPose[track] = SampleTrack(track, keyTime, prevKey, pTrackCursors[track]);
+}
+
+void CompressedClip::Sample(float keyTime, unsigned int prevKey, const unsigned int* pTracks, unsigned int nrOfTracks
+						   ,unsigned int* pTrackCursors, tt::DualQuaternion* pPose) const
+{
+	for(unsigned int i=0; i < nrOfTracks; ++i)
+		pPose[i] = SampleTrack(pTracks[i], keyTime, prevKey, pTrackCursors[pTracks[i]]);
+}
+
+tt::DualQuaternion CompressedClip::SampleTrack(unsigned int track, float keyTime, unsigned int prevKey, unsigned int& cursor) const
+{
+	unsigned int segment = cursor = FindSegment(track, prevKey, cursor);
+	
+	unsigned int iKey = m_TrackOffsets[track] + segment;
+	unsigned int iNextKey = (iKey+1 < m_TrackOffsets[track+1]) ? iKey+1 : iKey;
+
+	float startTime = m_KeyTimes[m_KeyIndices[iKey]];
+	float duration = m_KeyTimes[m_KeyIndices[iNextKey]] - startTime;
+	float t = duration > 0 ? (keyTime - startTime) / duration : 0;
+	t = t < 0 ? 0 : (t > 1 ? 1 : t);
+
+	const tt::Vector3& minPos = m_TranslationMin[track];
+	const tt::Vector3& scale = m_TranslationScale[track];
+	const unsigned short* pPos = &m_Translations[iKey*3];
+	const unsigned short* pNextPos = &m_Translations[iNextKey*3];
+	
+	tt::Vector3 pos = Lerp(tt::Vector3(pPos[0], pPos[1], pPos[2]), tt::Vector3(pNextPos[0], pNextPos[1], pNextPos[2]), t);
+	pos = minPos + pos * scale;
+
+	return tt::DualQuaternion(Nlerp(m_Rotations[iKey].Decode(), m_Rotations[iNextKey].Decode(), t), pos);
+}
+
+bool CompressedClip::IsEmpty(void) const
+{
+	return m_TrackOffsets.empty();
+}
+
+unsigned int CompressedClip::GetNrOfTracks(void) const
+{
+	return m_TrackOffsets.empty() ? 0 : m_TrackOffsets.size() - 1;
+}
+
+unsigned int CompressedClip::GetMemorySize(void) const
+{
+	return sizeof(CompressedClip)
+		 + m_KeyTimes.size() * sizeof(float)
+		 + m_TrackOffsets.size() * sizeof(unsigned int)
+		 + m_KeyIndices.size() * sizeof(unsigned short)
+		 + m_Rotations.size() * sizeof(QuantizedRotation)
+		 + m_Translations.size() * sizeof(unsigned short)
+		 + (m_TranslationMin.size() + m_TranslationScale.size()) * sizeof(tt::Vector3);
+}
@@ -0,0 +1,76 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "../Helpers/Namespace.h"
+
+struct AnimationClip;
+
+//Rotation stored as its three smallest components (15 bits each), the index of the largest one is
+//spread over the top bits of Data[0] and Data[1]. The largest component is rebuilt as sqrt(1 - a²-b²-c²).
+struct QuantizedRotation
+{
+	unsigned short Data[3];
+
+	static QuantizedRotation Encode(const tt::Quaternion& rotation);
+	tt::Quaternion Decode(void) const;
+};
+
+//Keyframe reduced and quantized version of an AnimationClip.
+//Every bone is a track: keys that can be interpolated from their neighbours within the error tolerance are dropped,
+//the remaining ones store a QuantizedRotation and a 16 bit per component translation relative to the track bounds.
+class CompressedClip
+{
+public:
+	//Default constructor & destructor
+	CompressedClip(void);
+	~CompressedClip(void);
+
+	//Methods
+	//rotationTolerance in radians, translationTolerance in model units. Returns false if the clip can't be compressed.
+	bool Compress(const AnimationClip& clip, float rotationTolerance, float translationTolerance);
+	
+	//Samples all tracks at keyTime, prevKey being the index of the last original key at or before keyTime.
+	//pTrackCursors holds one entry per track and caches the current segment between calls, start with zeroes.
+	void Sample(float keyTime, unsigned int prevKey, unsigned int* pTrackCursors, tt::DualQuaternion* pPose) const;
+	//Samples only the listed tracks, pPose[i] receives track pTracks[i]. pTrackCursors is still indexed by track.
+	void Sample(float keyTime, unsigned int prevKey, const unsigned int* pTracks, unsigned int nrOfTracks
+			   ,unsigned int* pTrackCursors, tt::DualQuaternion* pPose) const;
+
+	bool IsEmpty(void) const;
+	unsigned int GetNrOfTracks(void) const;
+	unsigned int GetMemorySize(void) const;
+
+private:
+	//Datamembers
+	std::vector<float> m_KeyTimes;
+
+	//Track i owns the keys in [m_TrackOffsets[i], m_TrackOffsets[i+1])
+	std::vector<unsigned int> m_TrackOffsets;
+	std::vector<unsigned short> m_KeyIndices;
+	std::vector<QuantizedRotation> m_Rotations;
+	std::vector<unsigned short> m_Translations;
+
+	//Per track dequantization, translation = min + quantized * scale
+	std::vector<tt::Vector3> m_TranslationMin;
+	std::vector<tt::Vector3> m_TranslationScale;
+
+	//Internal methods
+	unsigned int FindSegment(unsigned int track, unsigned int prevKey, unsigned int cursor) const;
+	tt::DualQuaternion SampleTrack(unsigned int track, float keyTime, unsigned int prevKey, unsigned int& cursor) const;
+};
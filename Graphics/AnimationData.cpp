@@ -0,0 +1,120 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "AnimationData.h"
+
+bool AnimationData::HasBoneHierarchy(void) const
+{
+	return !BoneParents.empty();
+}
+
+const AnimationClip* AnimationData::FindClip(const tstring& name) const
+{
+	auto it = find_if(Clips.begin(), Clips.end(), [&](const AnimationClip& clip){
+		return clip.Name == name;
+	});
+
+	return it == Clips.end() ? nullptr : &(*it);
+}
+
+unsigned int AnimationData::FindBone(const tstring& name) const
+{
+	auto it = find_if(Skeleton.begin(), Skeleton.end(), [&](const Bone& bone){
+		return bone.Name == name;
+	});
+
+	return it == Skeleton.end() ? Bone::NO_PARENT : static_cast<unsigned int>(it - Skeleton.begin() );
+}
+
+void AnimationData::SetReducedSkeleton(vector<unsigned int> bones)
+{
+	if(bones.empty()){
+		ReducedBones.clear();
+		ReducedBoneMap.clear();
+		ReducedParents.clear();
+		return;
+	}
+
+	//Keys are relative to the parent bone, a bone can't be evaluated without its ancestors
+	if(HasBoneHierarchy() )
+		for(unsigned int i = 0; i < bones.size(); ++i){
+			unsigned int parent = BoneParents[bones[i]];
+			if(parent != Bone::NO_PARENT && find(bones.begin(), bones.end(), parent) == bones.end() )
+				bones.push_back(parent);
+		}
+
+	sort(bones.begin(), bones.end() );
+	bones.erase(unique(bones.begin(), bones.end() ), bones.end() );
+
+	//Bind pose position of every bone, 2 * dual (x) conj(real)
+	vector<tt::Vector3> bindPositions;
+	for(auto& bone : Skeleton){
+		tt::Quaternion pos = tt::Quaternion::Conjugate(bone.BindPose.Data[0]) * bone.BindPose.Data[1] * 2.0f;
+		bindPositions.push_back(tt::Vector3(pos.x, pos.y, pos.z) );
+	}
+
+	ReducedBoneMap.resize(Skeleton.size() );
+	for(unsigned int bone = 0; bone < Skeleton.size(); ++bone){
+		float closestDistSq = FLT_MAX;
+		for(unsigned int i = 0; i < bones.size(); ++i){
+			float distSq = (bindPositions[bones[i]] - bindPositions[bone]).LengthSq();
+			if(distSq < closestDistSq){
+				closestDistSq = distSq;
+				ReducedBoneMap[bone] = i;
+			}
+		}
+	}
+
+	vector<Bone> reducedSkeleton;
+	for(auto bone : bones)
+		reducedSkeleton.push_back(Skeleton[bone]);
+
+	//Parents precede their children in the skeleton, so they still do in the reduced one
+	ReducedParents.clear();
+	if(HasBoneHierarchy() )
+		for(auto bone : bones){
+			unsigned int parent = BoneParents[bone];
+			ReducedParents.push_back(parent == Bone::NO_PARENT ? Bone::NO_PARENT
+									 : static_cast<unsigned int>(lower_bound(bones.begin(), bones.end(), parent) - bones.begin() ) );
+		}
+
+	ReducedBindPoses.Initialize(reducedSkeleton);
+	ReducedBones = move(bones);
+}
+
+bool AnimationData::HasReducedSkeleton(void) const
+{
+	return !ReducedBones.empty();
+}
+
+const AABBox* AnimationData::GetBounds(const AnimationClip* pClip) const
+{
+	if(!pClip || pClip < Clips.data() || pClip >= Clips.data() + Bounds.size() )
+		return nullptr;
+
+	const ClipBounds& clipBounds = Bounds[pClip - Clips.data()];
+	return clipBounds.IsEmpty() ? nullptr : &clipBounds.Bounds;
+}
+
+const AABBox* AnimationData::GetBounds(const AnimationClip* pClip, float tick) const
+{
+	if(!pClip || pClip < Clips.data() || pClip >= Clips.data() + Bounds.size() )
+		return nullptr;
+
+	const ClipBounds& clipBounds = Bounds[pClip - Clips.data()];
+	return clipBounds.IsEmpty() ? nullptr : &clipBounds.GetBounds(*pClip, tick);
+}
@@ -0,0 +1,53 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "MeshAnimator.h"
+#include "ClipBounds.h"
+
+//Skeleton and animation clips of a skinned Model3D, with what every MeshAnimator of the model shares. Model3DLoader fills it
+//in and it doesn't change afterwards, apart from the reduced skeleton. Holds no graphics resources, animators can play it
+//without a device.
+struct AnimationData
+{
+	vector<Bone> Skeleton;					//Sorted by depth in the hierarchy, parents precede their children
+	vector<unsigned int> BoneParents;		//Bone::Parent of every bone as one stream for LocalToModel, empty without hierarchy
+	InverseBindPoses BindPoses;				//Built once from Skeleton at load time
+	vector<AnimationClip> Clips;
+	vector<ClipBounds> Bounds;				//Animated bounds, parallel to Clips
+
+	vector<unsigned int> ReducedBones;		//Indices of the bones in the reduced skeleton
+	vector<unsigned int> ReducedBoneMap;	//For every bone, the entry in ReducedBones it follows
+	vector<unsigned int> ReducedParents;	//Parent of every entry in ReducedBones, as an index in ReducedBones
+	InverseBindPoses ReducedBindPoses;
+
+	//True if the skeleton has parent indices and the keys of the clips are relative to the parent bone
+	bool HasBoneHierarchy(void) const;
+	//nullptr if there is no clip with that name
+	const AnimationClip* FindClip(const tstring& name) const;
+	//Index of the bone with that name, Bone::NO_PARENT if there is none
+	unsigned int FindBone(const tstring& name) const;
+
+	//See Model3D::SetReducedSkeleton, bones holds indices in Skeleton. An empty list removes the reduced skeleton.
+	void SetReducedSkeleton(vector<unsigned int> bones);
+	bool HasReducedSkeleton(void) const;
+
+	//Animated bounds of one of the clips, over the whole clip or the keys around tick. nullptr for clips without them.
+	const AABBox* GetBounds(const AnimationClip* pClip) const;
+	const AABBox* GetBounds(const AnimationClip* pClip, float tick) const;
+};
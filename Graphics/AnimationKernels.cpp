@@ -0,0 +1,349 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "AnimationKernels.h"
+#include "MeshAnimator.h"
+#include "../Helpers/SimdUtil.h"
+
+//Notation: a (x) b is the Hamilton product, which is b*a in tt::Quaternion (D3DX) order.
+//
+//Per bone, with r/d the real/dual parts of the lerped keys, n = |r| and br/bd the bind pose:
+//	rotation	= (r/n) (x) conj(br) / |br|^2
+//	translation	= rotate(vec(-2 conj(br)/|br|^2 (x) bd), r/n) + 2/n^2 * vec(d (x) conj(r))
+//The bind pose terms are constant and precomputed by InverseBindPoses::Initialize.
+//	palette		= (rotation, .5 * (translation,0) (x) rotation)
+//The scalar part of the extracted translations never reaches the palette, which is why
+//DualNumber::Sqrt's dual component drops out of the DLB normalization.
+
+namespace
+{
+	inline tt::Quaternion Hamilton(const tt::Quaternion& a, const tt::Quaternion& b)
+	{
+		return tt::Quaternion(a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y,
+							  a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x,
+							  a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w,
+							  a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z);
+	}
+
+	inline tt::Vector3 Rotate(const tt::Vector3& v, const tt::Quaternion& q)
+	{
+		tt::Vector3 u(q.x, q.y, q.z);
+		tt::Vector3 t = u.Cross(v) * 2.0f;
+		return v + t * q.w + u.Cross(t);
+	}
+
+	void BlendSkinningBone(const tt::DualQuaternion& prev, const tt::DualQuaternion& next, float blendFactor
+						  ,const InverseBindPoses& bindPoses, unsigned int bone, tt::DualQuaternion& out)
+	{
+		tt::Quaternion r = prev.Data[0] * (1-blendFactor) + next.Data[0] * blendFactor;
+		tt::Quaternion d = prev.Data[1] * (1-blendFactor) + next.Data[1] * blendFactor;
+
+		float invNormSq = 1.0f / (r.x*r.x + r.y*r.y + r.z*r.z + r.w*r.w);
+		tt::Quaternion rotation = r * sqrtf(invNormSq);
+
+		tt::Quaternion bindRotInv(bindPoses.RotX[bone], bindPoses.RotY[bone], bindPoses.RotZ[bone], bindPoses.RotW[bone]);
+		tt::Vector3 bindPos(bindPoses.PosX[bone], bindPoses.PosY[bone], bindPoses.PosZ[bone]);
+
+		tt::Quaternion animPos = Hamilton(d, tt::Quaternion::Conjugate(r));
+		tt::Vector3 pos = Rotate(bindPos, rotation)
+						+ tt::Vector3(animPos.x, animPos.y, animPos.z) * (2.0f * invNormSq);
+
+		out.Data[0] = Hamilton(rotation, bindRotInv);
+		out.Data[1] = Hamilton(tt::Quaternion(pos.x, pos.y, pos.z, 0), out.Data[0]) * .5f;
+	}
+
+#ifdef TT_SIMD_SSE
+	//4 quaternions, one register per component
+	struct QuaternionSoA
+	{
+		__m128 x, y, z, w;
+	};
+
+	inline QuaternionSoA Hamilton(const QuaternionSoA& a, const QuaternionSoA& b)
+	{
+		QuaternionSoA out;
+		out.x = _mm_sub_ps(SimdMulAdd(a.w, b.x, SimdMulAdd(a.x, b.w, _mm_mul_ps(a.y, b.z))), _mm_mul_ps(a.z, b.y));
+		out.y = _mm_add_ps(SimdMulAdd(a.w, b.y, _mm_mul_ps(a.y, b.w)), _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)));
+		out.z = _mm_add_ps(SimdMulAdd(a.w, b.z, _mm_mul_ps(a.z, b.w)), _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x)));
+		out.w = _mm_sub_ps(_mm_mul_ps(a.w, b.w), SimdMulAdd(a.x, b.x, SimdMulAdd(a.y, b.y, _mm_mul_ps(a.z, b.z))));
+		return out;
+	}
+
+	inline QuaternionSoA Conjugate(const QuaternionSoA& q)
+	{
+		__m128 zero = _mm_setzero_ps();
+		QuaternionSoA out = {_mm_sub_ps(zero, q.x), _mm_sub_ps(zero, q.y), _mm_sub_ps(zero, q.z), q.w};
+		return out;
+	}
+
+	inline __m128 LengthSq(const QuaternionSoA& q)
+	{
+		return SimdMulAdd(q.x, q.x, SimdMulAdd(q.y, q.y, SimdMulAdd(q.z, q.z, _mm_mul_ps(q.w, q.w))));
+	}
+
+	inline QuaternionSoA Scale(const QuaternionSoA& q, __m128 f)
+	{
+		QuaternionSoA out = {_mm_mul_ps(q.x, f), _mm_mul_ps(q.y, f), _mm_mul_ps(q.z, f), _mm_mul_ps(q.w, f)};
+		return out;
+	}
+
+	inline QuaternionSoA Lerp(const QuaternionSoA& a, const QuaternionSoA& b, __m128 wa, __m128 wb)
+	{
+		QuaternionSoA out = {SimdMulAdd(a.x, wa, _mm_mul_ps(b.x, wb)), SimdMulAdd(a.y, wa, _mm_mul_ps(b.y, wb)),
+							 SimdMulAdd(a.z, wa, _mm_mul_ps(b.z, wb)), SimdMulAdd(a.w, wa, _mm_mul_ps(b.w, wb))};
+		return out;
+	}
+
+	//Loads the real (part 0) or dual (part 1) quaternions of 4 consecutive dual quaternions
+	inline QuaternionSoA LoadSoA(const tt::DualQuaternion* pSrc, int part)
+	{
+		QuaternionSoA out = {_mm_loadu_ps(&pSrc[0].Data[part].x), _mm_loadu_ps(&pSrc[1].Data[part].x),
+							 _mm_loadu_ps(&pSrc[2].Data[part].x), _mm_loadu_ps(&pSrc[3].Data[part].x)};
+		_MM_TRANSPOSE4_PS(out.x, out.y, out.z, out.w);
+		return out;
+	}
+
+	inline void StoreSoA(tt::DualQuaternion* pDest, int part, QuaternionSoA q)
+	{
+		_MM_TRANSPOSE4_PS(q.x, q.y, q.z, q.w);
+		_mm_storeu_ps(&pDest[0].Data[part].x, q.x);
+		_mm_storeu_ps(&pDest[1].Data[part].x, q.y);
+		_mm_storeu_ps(&pDest[2].Data[part].x, q.z);
+		_mm_storeu_ps(&pDest[3].Data[part].x, q.w);
+	}
+#endif
+}
+
+//--------------------------
+//InverseBindPoses
+//--------------------------
+void InverseBindPoses::Initialize(const std::vector<Bone>& skeleton)
+{
+	unsigned int nrOfBones = skeleton.size();
+	RotX.resize(nrOfBones); RotY.resize(nrOfBones); RotZ.resize(nrOfBones); RotW.resize(nrOfBones);
+	PosX.resize(nrOfBones); PosY.resize(nrOfBones); PosZ.resize(nrOfBones);
+
+	for(unsigned int i=0; i < nrOfBones; ++i){
+		const tt::Quaternion& br = skeleton[i].BindPose.Data[0];
+		tt::Quaternion bindRotInv = tt::Quaternion::Conjugate(br) / (br.x*br.x + br.y*br.y + br.z*br.z + br.w*br.w);
+		tt::Quaternion bindPos = Hamilton(bindRotInv, skeleton[i].BindPose.Data[1]) * -2.0f;
+
+		RotX[i] = bindRotInv.x; RotY[i] = bindRotInv.y; RotZ[i] = bindRotInv.z; RotW[i] = bindRotInv.w;
+		PosX[i] = bindPos.x;	PosY[i] = bindPos.y;	PosZ[i] = bindPos.z;
+	}
+}
+
+unsigned int InverseBindPoses::Size(void) const
+{
+	return RotX.size();
+}
+
+//--------------------------
+//Kernels
+//--------------------------
+void BlendSkinningPalette(const tt::DualQuaternion* pPrevKey, const tt::DualQuaternion* pNextKey, float blendFactor
+						 ,const InverseBindPoses& bindPoses, tt::DualQuaternion* pPalette, unsigned int nrOfBones)
+{
+	unsigned int i = 0;
+
+#ifdef TT_SIMD_SSE
+	__m128 wPrev = _mm_set1_ps(1-blendFactor);
+	__m128 wNext = _mm_set1_ps(blendFactor);
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 two = _mm_set1_ps(2.0f);
+	__m128 half = _mm_set1_ps(.5f);
+
+	for(; i + 4 <= nrOfBones; i += 4){
+		QuaternionSoA r = Lerp(LoadSoA(pPrevKey + i, 0), LoadSoA(pNextKey + i, 0), wPrev, wNext);
+		QuaternionSoA d = Lerp(LoadSoA(pPrevKey + i, 1), LoadSoA(pNextKey + i, 1), wPrev, wNext);
+
+		__m128 invNormSq = _mm_div_ps(one, LengthSq(r));
+		QuaternionSoA rotation = Scale(r, _mm_sqrt_ps(invNormSq));
+
+		QuaternionSoA bindRotInv = {_mm_loadu_ps(&bindPoses.RotX[i]), _mm_loadu_ps(&bindPoses.RotY[i]),
+									_mm_loadu_ps(&bindPoses.RotZ[i]), _mm_loadu_ps(&bindPoses.RotW[i])};
+		QuaternionSoA bindPos = {_mm_loadu_ps(&bindPoses.PosX[i]), _mm_loadu_ps(&bindPoses.PosY[i]),
+								 _mm_loadu_ps(&bindPoses.PosZ[i]), _mm_setzero_ps()};
+
+		//Rotate the bind translation: v + w*t + u x t, with t = 2 u x v
+		__m128 tx = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(rotation.y, bindPos.z), _mm_mul_ps(rotation.z, bindPos.y)));
+		__m128 ty = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(rotation.z, bindPos.x), _mm_mul_ps(rotation.x, bindPos.z)));
+		__m128 tz = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(rotation.x, bindPos.y), _mm_mul_ps(rotation.y, bindPos.x)));
+
+		QuaternionSoA animPos = Scale(Hamilton(d, Conjugate(r)), _mm_mul_ps(two, invNormSq));
+
+		QuaternionSoA pos;
+		pos.x = _mm_add_ps(SimdMulAdd(rotation.w, tx, bindPos.x), _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rotation.y, tz), _mm_mul_ps(rotation.z, ty)), animPos.x));
+		pos.y = _mm_add_ps(SimdMulAdd(rotation.w, ty, bindPos.y), _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rotation.z, tx), _mm_mul_ps(rotation.x, tz)), animPos.y));
+		pos.z = _mm_add_ps(SimdMulAdd(rotation.w, tz, bindPos.z), _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rotation.x, ty), _mm_mul_ps(rotation.y, tx)), animPos.z));
+		pos.w = _mm_setzero_ps();
+
+		QuaternionSoA outRot = Hamilton(rotation, bindRotInv);
+		StoreSoA(pPalette + i, 0, outRot);
+		StoreSoA(pPalette + i, 1, Scale(Hamilton(pos, outRot), half));
+	}
+#endif
+
+	for(; i < nrOfBones; ++i)
+		BlendSkinningBone(pPrevKey[i], pNextKey[i], blendFactor, bindPoses, i, pPalette[i]);
+}
+
+void InterpolatePalettes(const tt::DualQuaternion* pFrom, const tt::DualQuaternion* pTo, float t, tt::DualQuaternion* pPalette, unsigned int nrOfBones)
+{
+	unsigned int i = 0;
+
+#ifdef TT_SIMD_SSE
+	__m128 wFrom = _mm_set1_ps(1-t);
+	__m128 wTo = _mm_set1_ps(t);
+	__m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 one = _mm_set1_ps(1.0f);
+
+	for(; i + 4 <= nrOfBones; i += 4){
+		QuaternionSoA rFrom = LoadSoA(pFrom + i, 0), rTo = LoadSoA(pTo + i, 0);
+		
+		//Flip the target weight where both rotations are in opposite hemispheres
+		__m128 dot = SimdMulAdd(rFrom.x, rTo.x, SimdMulAdd(rFrom.y, rTo.y, SimdMulAdd(rFrom.z, rTo.z, _mm_mul_ps(rFrom.w, rTo.w))));
+		__m128 wToSigned = _mm_xor_ps(wTo, _mm_and_ps(dot, signMask));
+
+		QuaternionSoA r = Lerp(rFrom, rTo, wFrom, wToSigned);
+		QuaternionSoA d = Lerp(LoadSoA(pFrom + i, 1), LoadSoA(pTo + i, 1), wFrom, wToSigned);
+		
+		__m128 invNorm = _mm_div_ps(one, _mm_sqrt_ps(LengthSq(r)));
+		StoreSoA(pPalette + i, 0, Scale(r, invNorm));
+		StoreSoA(pPalette + i, 1, Scale(d, invNorm));
+	}
+#endif
+
+	for(; i < nrOfBones; ++i){
+		const tt::Quaternion& rFrom = pFrom[i].Data[0];
+		const tt::Quaternion& rTo = pTo[i].Data[0];
+		float wTo = (rFrom.x*rTo.x + rFrom.y*rTo.y + rFrom.z*rTo.z + rFrom.w*rTo.w) < 0 ? -t : t;
+		
+		tt::Quaternion r = rFrom * (1-t) + rTo * wTo;
+		tt::Quaternion d = pFrom[i].Data[1] * (1-t) + pTo[i].Data[1] * wTo;
+		float invNorm = 1.0f / sqrtf(r.x*r.x + r.y*r.y + r.z*r.z + r.w*r.w);
+
+		pPalette[i].Data[0] = r * invNorm;
+		pPalette[i].Data[1] = d * invNorm;
+	}
+}
+
+void BlendPoses(const tt::DualQuaternion* pPoses, const float* pWeights, unsigned int nrOfPoses, tt::DualQuaternion* pPose, unsigned int nrOfBones)
+{
+	unsigned int i = 0;
+
+#ifdef TT_SIMD_SSE
+	__m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 one = _mm_set1_ps(1.0f);
+
+	for(; i + 4 <= nrOfBones; i += 4){
+		__m128 weight = _mm_set1_ps(pWeights[0]);
+		QuaternionSoA reference = LoadSoA(pPoses + i, 0);
+		QuaternionSoA r = Scale(reference, weight);
+		QuaternionSoA d = Scale(LoadSoA(pPoses + i, 1), weight);
+
+		for(unsigned int pose = 1; pose < nrOfPoses; ++pose){
+			const tt::DualQuaternion* pSrc = pPoses + pose * nrOfBones + i;
+			QuaternionSoA real = LoadSoA(pSrc, 0);
+
+			//Flip the weight where the rotation is in the other hemisphere than the reference
+			__m128 dot = SimdMulAdd(reference.x, real.x, SimdMulAdd(reference.y, real.y, SimdMulAdd(reference.z, real.z, _mm_mul_ps(reference.w, real.w))));
+			__m128 signedWeight = _mm_xor_ps(_mm_set1_ps(pWeights[pose]), _mm_and_ps(dot, signMask));
+
+			r = Lerp(r, real, one, signedWeight);
+			d = Lerp(d, LoadSoA(pSrc, 1), one, signedWeight);
+		}
+
+		__m128 invNorm = _mm_div_ps(one, _mm_sqrt_ps(LengthSq(r)));
+		StoreSoA(pPose + i, 0, Scale(r, invNorm));
+		StoreSoA(pPose + i, 1, Scale(d, invNorm));
+	}
+#endif
+
+	for(; i < nrOfBones; ++i){
+		const tt::Quaternion& reference = pPoses[i].Data[0];
+		tt::Quaternion r = reference * pWeights[0];
+		tt::Quaternion d = pPoses[i].Data[1] * pWeights[0];
+
+		for(unsigned int pose = 1; pose < nrOfPoses; ++pose){
+			const tt::DualQuaternion& src = pPoses[pose * nrOfBones + i];
+			const tt::Quaternion& real = src.Data[0];
+			float weight = (reference.x*real.x + reference.y*real.y + reference.z*real.z + reference.w*real.w) < 0 ? -pWeights[pose] : pWeights[pose];
+
+			r += real * weight;
+			d += src.Data[1] * weight;
+		}
+
+		float invNorm = 1.0f / sqrtf(r.x*r.x + r.y*r.y + r.z*r.z + r.w*r.w);
+		pPose[i].Data[0] = r * invNorm;
+		pPose[i].Data[1] = d * invNorm;
+	}
+}
+
+void BuildSkinningPalette(const tt::DualQuaternion* pPose, const InverseBindPoses& bindPoses, tt::DualQuaternion* pPalette, unsigned int nrOfBones)
+{
+	//The lerp with a zero weight is a negligible part of the kernel
+	BlendSkinningPalette(pPose, pPose, 0, bindPoses, pPalette, nrOfBones);
+}
+
+void LocalToModel(const tt::DualQuaternion* pLocal, const unsigned int* pParents, tt::DualQuaternion* pModel, unsigned int nrOfBones)
+{
+	unsigned int i = 0;
+
+	while(i < nrOfBones){
+#ifdef TT_SIMD_SSE
+		if(i + 4 <= nrOfBones){
+			bool bParentsDone = true;
+			for(unsigned int j = i; j < i + 4; ++j)
+				bParentsDone &= (pParents[j] == Bone::NO_PARENT || pParents[j] < i);
+
+			if(bParentsDone){
+				//Roots are composed with the identity
+				const tt::DualQuaternion* pParentDQs[4];
+				for(unsigned int j = 0; j < 4; ++j)
+					pParentDQs[j] = pParents[i + j] == Bone::NO_PARENT ? &tt::DualQuaternion::Identity : pModel + pParents[i + j];
+
+				QuaternionSoA parentReal = {_mm_loadu_ps(&pParentDQs[0]->Data[0].x), _mm_loadu_ps(&pParentDQs[1]->Data[0].x),
+											_mm_loadu_ps(&pParentDQs[2]->Data[0].x), _mm_loadu_ps(&pParentDQs[3]->Data[0].x)};
+				QuaternionSoA parentDual = {_mm_loadu_ps(&pParentDQs[0]->Data[1].x), _mm_loadu_ps(&pParentDQs[1]->Data[1].x),
+											_mm_loadu_ps(&pParentDQs[2]->Data[1].x), _mm_loadu_ps(&pParentDQs[3]->Data[1].x)};
+				_MM_TRANSPOSE4_PS(parentReal.x, parentReal.y, parentReal.z, parentReal.w);
+				_MM_TRANSPOSE4_PS(parentDual.x, parentDual.y, parentDual.z, parentDual.w);
+
+				QuaternionSoA localReal = LoadSoA(pLocal + i, 0), localDual = LoadSoA(pLocal + i, 1);
+				QuaternionSoA dual1 = Hamilton(parentReal, localDual), dual2 = Hamilton(parentDual, localReal);
+				QuaternionSoA dual = {_mm_add_ps(dual1.x, dual2.x), _mm_add_ps(dual1.y, dual2.y),
+									  _mm_add_ps(dual1.z, dual2.z), _mm_add_ps(dual1.w, dual2.w)};
+
+				StoreSoA(pModel + i, 0, Hamilton(parentReal, localReal));
+				StoreSoA(pModel + i, 1, dual);
+				i += 4;
+				continue;
+			}
+		}
+#endif
+
+		if(pParents[i] == Bone::NO_PARENT)
+			pModel[i] = pLocal[i];
+		else{
+			const tt::DualQuaternion& parent = pModel[pParents[i]];
+			pModel[i].Data[0] = Hamilton(parent.Data[0], pLocal[i].Data[0]);
+			pModel[i].Data[1] = Hamilton(parent.Data[0], pLocal[i].Data[1]) + Hamilton(parent.Data[1], pLocal[i].Data[0]);
+		}
+		++i;
+	}
+}
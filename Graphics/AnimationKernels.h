@@ -0,0 +1,61 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "../Helpers/Namespace.h"
+
+struct Bone;
+
+//Batched routines for skeletal animation. Bones are processed 4 at a time in SoA form (one register per
+//quaternion component) when SSE is available, leftovers and TT_NO_SIMD builds use the scalar equivalent.
+
+//Inverse bind pose of every bone of a skeleton, stored as one stream per component.
+//Immutable after Initialize, a Model3D builds it once at load time and all of its animators share it.
+struct InverseBindPoses
+{
+	//Rotation part, conj(r) / |r|^2
+	std::vector<float> RotX, RotY, RotZ, RotW;
+	//Translation part, expressed in bone space
+	std::vector<float> PosX, PosY, PosZ;
+
+	void Initialize(const std::vector<Bone>& skeleton);
+	unsigned int Size(void) const;
+};
+
+//Equal to Combine(Inverse(bindPose)*-1, DualQuaternion::DLB(prev, next, blendFactor)) for every bone,
+//written to pPalette. The dual part normalization is folded into the kernel.
+void BlendSkinningPalette(const tt::DualQuaternion* pPrevKey, const tt::DualQuaternion* pNextKey, float blendFactor
+						 ,const InverseBindPoses& bindPoses, tt::DualQuaternion* pPalette, unsigned int nrOfBones);
+
+//Combines a sampled pose with the inverse bind poses, BlendSkinningPalette without the blend
+void BuildSkinningPalette(const tt::DualQuaternion* pPose, const InverseBindPoses& bindPoses, tt::DualQuaternion* pPalette, unsigned int nrOfBones);
+
+//DLB between two palettes along the shortest path, normalized by the real part. Used by animators that only
+//evaluate a pose every few frames (see AnimationLOD).
+void InterpolatePalettes(const tt::DualQuaternion* pFrom, const tt::DualQuaternion* pTo, float t, tt::DualQuaternion* pPalette, unsigned int nrOfBones);
+
+//Weighted DLB of several poses of the same skeleton, used to blend animation layers. pPoses holds nrOfPoses poses
+//of nrOfBones transforms each, back to back. Every bone is flipped to the hemisphere of its transform in the first
+//pose, summed with pWeights and normalized by the real part. pPose may be the first pose.
+void BlendPoses(const tt::DualQuaternion* pPoses, const float* pWeights, unsigned int nrOfPoses, tt::DualQuaternion* pPose, unsigned int nrOfBones);
+
+//Composes a pose of parent relative (local space) bone transforms into model space, model = parent (x) local.
+//pParents[i] is the index of the parent of bone i, or Bone::NO_PARENT for roots. Parents have to precede their
+//children: the bones are processed in order, 4 at a time whenever the parents of all 4 are done already, which is
+//the common case for skeletons sorted by depth (see Model3D).
+void LocalToModel(const tt::DualQuaternion* pLocal, const unsigned int* pParents, tt::DualQuaternion* pModel, unsigned int nrOfBones);
@@ -0,0 +1,127 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "AnimationSystem.h"
+#include "MeshAnimator.h"
+#include "../Helpers/WorkerPool.h"
+
+std::vector<MeshAnimator*> AnimationSystem::s_Animators;
+std::vector<AnimationSystem::PoseRequest> AnimationSystem::s_Requests;
+std::vector<unsigned int> AnimationSystem::s_PoseStarts;
+float AnimationSystem::s_PoseCacheResolution = 0;
+
+bool AnimationSystem::PoseRequest::operator<(const PoseRequest& other) const
+{
+	if(pAnimationData != other.pAnimationData)
+		return std::less<const AnimationData*>()(pAnimationData, other.pAnimationData);
+	if(pClip != other.pClip)
+		return std::less<const AnimationClip*>()(pClip, other.pClip);
+	if(bReducedSkeleton != other.bReducedSkeleton)
+		return other.bReducedSkeleton;
+	return Tick < other.Tick;
+}
+
+bool AnimationSystem::PoseRequest::SharesPose(const PoseRequest& other) const
+{
+	return pAnimationData == other.pAnimationData && pClip == other.pClip && bReducedSkeleton == other.bReducedSkeleton && Tick == other.Tick
+		&& !bBlending && !other.bBlending;
+}
+
+void AnimationSystem::Submit(MeshAnimator* pAnimator)
+{
+	s_Animators.push_back(pAnimator);
+}
+
+void AnimationSystem::Remove(MeshAnimator* pAnimator)
+{
+	s_Animators.erase(remove(s_Animators.begin(), s_Animators.end(), pAnimator), s_Animators.end());
+}
+
+unsigned int AnimationSystem::Evaluate(float totalSeconds, float elapsedSeconds)
+{
+	//Look up which animators need a new pose this frame and where they are in their clip
+	s_Requests.clear();
+	for(auto pAnimator : s_Animators){
+		PoseRequest request;
+		if(!pAnimator->BeginFrame(totalSeconds, elapsedSeconds, request.Tick) )
+			continue;
+
+		request.pAnimationData = pAnimator->GetAnimationData();
+		request.pClip = pAnimator->GetAnimationClip();
+		request.bReducedSkeleton = pAnimator->UsesReducedSkeleton();
+		request.bBlending = pAnimator->IsBlending();
+		request.pAnimator = pAnimator;
+		request.bFailed = false;
+
+		if(s_PoseCacheResolution > 0){
+			float step = s_PoseCacheResolution * request.pClip->KeysPerSecond;
+			request.Tick = floor(request.Tick / step) * step;
+		}
+
+		s_Requests.push_back(request);
+	}
+
+	//Sorting puts requests for the same pose next to each other
+	sort(s_Requests.begin(), s_Requests.end());
+	
+	s_PoseStarts.clear();
+	for(unsigned int i = 0; i < s_Requests.size(); ++i)
+		if(i == 0 || !s_Requests[i].SharesPose(s_Requests[i-1]) )
+			s_PoseStarts.push_back(i);
+	
+	unsigned int nrOfPoses = s_PoseStarts.size();
+	s_PoseStarts.push_back(s_Requests.size() );
+
+	//Evaluate every distinct pose once, the animators sharing it copy the result
+	WorkerPool::GetInstance()->ParallelFor(nrOfPoses, GRAIN_SIZE, [&](unsigned int begin, unsigned int end){
+		for(unsigned int pose = begin; pose < end; ++pose){
+			auto& source = s_Requests[s_PoseStarts[pose]];
+			source.bFailed = !source.pAnimator->Evaluate(source.Tick);
+
+			//The animators sharing a failed pose keep their own rather than copying one that wasn't updated
+			if(source.bFailed)
+				continue;
+
+			for(unsigned int i = s_PoseStarts[pose] + 1; i < s_PoseStarts[pose+1]; ++i)
+				s_Requests[i].pAnimator->CopyPose(*source.pAnimator);
+		}
+	});
+
+	unsigned int nrOfFailures = 0;
+	for(unsigned int pose = 0; pose < nrOfPoses; ++pose)
+		if(s_Requests[s_PoseStarts[pose]].bFailed)
+			++nrOfFailures;
+
+	//Interpolated LODs fill in the frames between their evaluations
+	WorkerPool::GetInstance()->ParallelFor(s_Animators.size(), GRAIN_SIZE, [&](unsigned int begin, unsigned int end){
+		for(unsigned int i = begin; i < end; ++i)
+			s_Animators[i]->EndFrame();
+	});
+
+	s_Animators.clear();
+	return nrOfFailures;
+}
+
+void AnimationSystem::SetPoseCacheResolution(float seconds)
+{
+	s_PoseCacheResolution = seconds;
+}
+
+float AnimationSystem::GetPoseCacheResolution(void)
+{
+	return s_PoseCacheResolution;
+}
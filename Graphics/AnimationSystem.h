@@ -0,0 +1,76 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "../Helpers/Namespace.h"
+
+class MeshAnimator;
+struct AnimationData;
+struct AnimationClip;
+
+//Gathers the animators that need an update this frame and evaluates them in parallel on the WorkerPool.
+//Animators don't share any mutable state, so every one of them is an independent task.
+//
+//Animators playing the same clip of the same model at the same time end up with the same pose, so poses are
+//cached per (model, clip, time, skeleton LOD) for the frame: each distinct pose is evaluated once and copied to the others.
+class AnimationSystem final
+{
+public:
+	//Queues an animator for the next Evaluate, ModelComponent does this during the update pass
+	static void Submit(MeshAnimator* pAnimator);
+	//Removes a queued animator, for animators destroyed before the evaluation
+	static void Remove(MeshAnimator* pAnimator);
+	
+	//Updates all queued animators to the game time (in seconds) and clears the queue. Called by GameScene after updating
+	//its objects, the resulting palettes are read from the animators at draw time. Returns the number of poses that
+	//failed to evaluate, for the caller to report since the tasks can't log.
+	static unsigned int Evaluate(float totalSeconds, float elapsedSeconds);
+
+	//Snaps playback to multiples of this many seconds, so animators with different time offsets
+	//(see MeshAnimator::SetTimeOffset) still share poses. 0 (the default) only shares identical times.
+	static void SetPoseCacheResolution(float seconds);
+	static float GetPoseCacheResolution(void);
+
+private:
+	struct PoseRequest
+	{
+		const AnimationData* pAnimationData;
+		const AnimationClip* pClip;
+		float Tick;
+		bool bReducedSkeleton;
+		bool bBlending;		//Blends of several layers are never shared
+		bool bFailed;		//Set by the evaluation if the keys around the tick weren't found
+		MeshAnimator* pAnimator;
+
+		bool operator<(const PoseRequest& other) const;
+		bool SharesPose(const PoseRequest& other) const;
+	};
+
+	//Poses per task, large enough to amortize the dispatch, small enough to balance uneven skeletons
+	static const unsigned int GRAIN_SIZE = 4;
+
+	static std::vector<MeshAnimator*> s_Animators;
+	static std::vector<PoseRequest> s_Requests;
+	static std::vector<unsigned int> s_PoseStarts; //Index of the first request of every distinct pose
+	static float s_PoseCacheResolution;
+
+	//Disabling default constructor, copy constructor & assignment operator
+	AnimationSystem(void);
+	AnimationSystem(const AnimationSystem& src);// = delete;
+	AnimationSystem& operator=(const AnimationSystem& src);// = delete;
+};
@@ -0,0 +1,117 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "BoundingVolumes.h"
+
+Ray::Ray(const tt::Vector3& origin, const tt::Vector3& direction)
+{
+	Origin = origin;
+	Direction = direction;
+	InvDirection = tt::Vector3(1/direction.x, 1/direction.y, 1/direction.z);
+	sign[0] = (InvDirection.x < 0); 
+	sign[1] = (InvDirection.y < 0);
+	sign[2] = (InvDirection.z < 0);
+}
+	
+AABBox::AABBox(void)
+{
+	Bounds[0] = tt::Vector3(INFINITY);
+	Bounds[1] = tt::Vector3(-INFINITY);
+}
+
+AABBox::~AABBox(void){}
+
+void AABBox::Initialize(const vector<D3DXVECTOR3>& vertices)
+{
+	for(auto& vertex : vertices)
+	{
+		Bounds[0].x = min(vertex.x, Bounds[0].x);
+		Bounds[0].y = min(vertex.y, Bounds[0].y);
+		Bounds[0].z = min(vertex.z, Bounds[0].z);
+		
+		Bounds[1].x = max(vertex.x, Bounds[1].x);
+		Bounds[1].y = max(vertex.y, Bounds[1].y);
+		Bounds[1].z = max(vertex.z, Bounds[1].z);
+	}
+}
+
+void AABBox::GetVertices(tt::Vector3* targetArr) const
+{
+	targetArr[0] = tt::Vector3(Bounds[0].x, Bounds[0].y, Bounds[0].z);
+	targetArr[1] = tt::Vector3(Bounds[0].x, Bounds[0].y, Bounds[1].z);
+	targetArr[2] = tt::Vector3(Bounds[0].x, Bounds[1].y, Bounds[0].z);
+	targetArr[3] = tt::Vector3(Bounds[0].x, Bounds[1].y, Bounds[1].z);
+	targetArr[4] = tt::Vector3(Bounds[1].x, Bounds[0].y, Bounds[0].z);
+	targetArr[5] = tt::Vector3(Bounds[1].x, Bounds[0].y, Bounds[1].z);	
+	targetArr[6] = tt::Vector3(Bounds[1].x, Bounds[1].y, Bounds[0].z);
+	targetArr[7] = tt::Vector3(Bounds[1].x, Bounds[1].y, Bounds[1].z);
+}
+
+void AABBox::GetVertices(tt::Vector3* targetArr, const tt::Matrix4x4& transform) const
+{
+	GetVertices(targetArr);
+	tt::Vector3::TransformPoints(transform, targetArr, targetArr, 8);
+}
+
+//Optimized method to check ray-AABB intersection
+bool AABBox::Intersect(const Ray& ray, float t0, float t1) const
+{
+	float txMin = (Bounds[  ray.sign[0]].x - ray.Origin.x) * ray.InvDirection.x; 
+	float txMax = (Bounds[1-ray.sign[0]].x - ray.Origin.x) * ray.InvDirection.x; 
+	float tyMin = (Bounds[  ray.sign[1]].y - ray.Origin.y) * ray.InvDirection.y;
+	float tyMax = (Bounds[1-ray.sign[1]].y - ray.Origin.y) * ray.InvDirection.y;
+
+	if( (txMin > tyMax) || (tyMin > txMax) )
+		return false;
+	if(tyMin > txMin) 
+		txMin = tyMin;
+	if(tyMax < txMax) 
+		txMax = tyMax;
+	
+	float tzMin = (Bounds[  ray.sign[2]].z - ray.Origin.z) * ray.InvDirection.z; 
+	float tzMax = (Bounds[1-ray.sign[2]].z - ray.Origin.z) * ray.InvDirection.z;
+	
+	if( (txMin > tzMax) || (tzMin > txMax) )
+		return false;
+	if(tzMin > txMin)
+		txMin = tzMin;
+	if(tzMax < txMax)
+		txMax = tzMax;
+	
+	return( (txMin < t1) && (txMax > t0) );
+}
+
+void AABBox::Include(const tt::Vector3& point)
+{
+	Bounds[0].x = min(point.x, Bounds[0].x);
+	Bounds[0].y = min(point.y, Bounds[0].y);
+	Bounds[0].z = min(point.z, Bounds[0].z);
+	
+	Bounds[1].x = max(point.x, Bounds[1].x);
+	Bounds[1].y = max(point.y, Bounds[1].y);
+	Bounds[1].z = max(point.z, Bounds[1].z);
+}
+
+void AABBox::Include(const AABBox& box)
+{
+	//Default constructed boxes are empty
+	if(box.Bounds[0].x > box.Bounds[1].x)
+		return;
+
+	Include(box.Bounds[0]);
+	Include(box.Bounds[1]);
+}
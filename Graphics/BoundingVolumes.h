@@ -0,0 +1,47 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "../Helpers/D3DUtil.h"
+#include "../Helpers/Namespace.h"
+
+struct Ray
+{
+	Ray(const tt::Vector3& origin, const tt::Vector3& direction);
+	
+	tt::Vector3 Origin;
+	tt::Vector3 Direction;
+	tt::Vector3 InvDirection;
+	int sign[3];
+};
+
+struct AABBox
+{
+	AABBox(void);
+	~AABBox(void);
+
+	void Initialize(const vector<D3DXVECTOR3>& vertices);
+	void GetVertices(tt::Vector3* targetArr) const;
+	void GetVertices(tt::Vector3* targetArr, const tt::Matrix4x4& transform) const;
+	bool Intersect(const Ray& r, float t0, float t1) const;
+	//Grows the box to contain the point or box
+	void Include(const tt::Vector3& point);
+	void Include(const AABBox& box);
+
+	tt::Vector3 Bounds[2];
+};
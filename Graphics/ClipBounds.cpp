@@ -0,0 +1,234 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "ClipBounds.h"
+#include "MeshAnimator.h"
+
+namespace
+{
+	float Dot(const tt::Quaternion& a, const tt::Quaternion& b)
+	{
+		return a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w;
+	}
+
+	//Translation of a rigid transform, 2 * vec(d * conj(r)) for a unit r
+	tt::Vector3 GetTranslation(const tt::DualQuaternion& dq)
+	{
+		const tt::Quaternion& r = dq.Data[0];
+		const tt::Quaternion& d = dq.Data[1];
+		return tt::Vector3(2 * (-d.w*r.x + d.x*r.w - d.y*r.z + d.z*r.y),
+						   2 * (-d.w*r.y + d.x*r.z + d.y*r.w - d.z*r.x),
+						   2 * (-d.w*r.z - d.x*r.y + d.y*r.x + d.z*r.w));
+	}
+
+	tt::Vector3 TransformPoint(const tt::DualQuaternion& dq, const tt::Vector3& point)
+	{
+		tt::Vector3 u(dq.Data[0].x, dq.Data[0].y, dq.Data[0].z);
+		tt::Vector3 t = u.Cross(point) * 2.0f;
+		return point + t * dq.Data[0].w + u.Cross(t) + GetTranslation(dq);
+	}
+
+	//Largest distance a point at radius r from the center of a rotation moves when rotated by at most angle
+	float GetChord(float angle, float r)
+	{
+		return 2 * sinf(min(angle, static_cast<float>(D3DX_PI) ) * .5f) * r;
+	}
+
+	//Largest distance between a unit quaternion and the nearest representation of a rotation at most angle away from it
+	float GetQuaternionChord(float angle)
+	{
+		return 2 * sinf(min(angle, static_cast<float>(D3DX_PI) ) * .25f);
+	}
+
+	//How far a bone can move away from its transform at the start of an interval, in model space
+	struct BoneMotion
+	{
+		float Angle;		//Largest rotation relative to the start
+		float Translation;	//Largest distance its origin moves
+	};
+}
+
+ClipBounds::ClipBounds(void):SegmentKeys(1){}
+
+//The bounds of an interval between two keys are the skinned mesh at its first key, every vertex padded by how far it can
+//move before the next one. That distance is bounded per bone first:
+//	- local rotations follow the arc between both keys, so they turn at most the angle between them. Compressed tracks
+//	  interpolate their translations linearly, uncompressed ones use DLB, whose translation stays within
+//	  |t1 - t0| / n of the first key, where n² >= (1 + cos(angle / 2)) / 2 is the squared length of the blended rotation.
+//	- in model space a bone turns at most its parent's angle plus its own, and its origin moves by its own translation,
+//	  the parent's translation and the parent's rotation around the parent's origin.
+//	- a point at distance r from a bone's origin moves at most chord(angle) * r + translation along with it.
+//The skinned vertex is the dual quaternion blend of its bones, x = vec(sum(w_i * x_i * r_i * conj(R) ) ) / |R|² with
+//R = sum(w_i * r_i) and x_i the vertex moved by bone i alone. The factors sum to 1 and have a length of w_i / |R|, so
+//|x(t) - x(k)| <= sum(w_i * |x_i(t) - x(k)|) / |R(t)|. With the hemisphere flip to the first bone, |R| >= R . r_0, which
+//gives a lower bound from the dot products of the rotations at the key and how far they can turn.
+//Compressed clips are bounded from the poses they play back, so the error of their compression is part of the bounds.
+void ClipBounds::Build(const AnimationClip& clip, const SkinningStreams& streams, const InverseBindPoses& bindPoses
+					  ,const vector<unsigned int>& boneParents, unsigned int segmentKeys)
+{
+	Bounds = AABBox();
+	Segments.clear();
+	SegmentKeys = segmentKeys;
+
+	const auto& keys = clip.Keys;
+	const auto& compressed = clip.Compressed;
+	unsigned int nrOfKeys = keys.size();
+	unsigned int nrOfBones = bindPoses.Size();
+	unsigned int nrOfVertices = streams.Size();
+	if(keys.empty() || nrOfVertices == 0 || streams.NrOfBones > nrOfBones)
+		return;
+
+	if(!compressed.IsEmpty() ){
+		if(compressed.GetNrOfTracks() < nrOfBones)
+			return;
+	}
+	else
+		for(auto& key : keys)
+			if(key.BoneTransforms.size() < nrOfBones)
+				return;
+
+	bool bHierarchy = !boneParents.empty();
+	vector<unsigned int> trackCursors(compressed.GetNrOfTracks(), 0);
+	vector<tt::DualQuaternion> startPose(nrOfBones), endPose(nrOfBones), modelPose(nrOfBones), palette(nrOfBones);
+	vector<BoneMotion> motion(nrOfBones);
+	vector<tt::Vector3> positions;
+
+	//Bounds of the played poses between key prev and key next, next may be the first key when the clip loops
+	auto interval = [&](unsigned int prev, unsigned int next) -> AABBox {
+		AABBox box;
+
+		//Local poses at both ends, as playback samples them
+		if(!compressed.IsEmpty() ){
+			compressed.Sample(keys[prev].KeyTime, prev, trackCursors.data(), startPose.data() );
+			compressed.Sample(keys[next].KeyTime, prev, trackCursors.data(), endPose.data() );
+		}
+		else{
+			InterpolatePalettes(keys[prev].BoneTransforms.data(), keys[prev].BoneTransforms.data(), 0, startPose.data(), nrOfBones);
+			InterpolatePalettes(keys[next].BoneTransforms.data(), keys[next].BoneTransforms.data(), 0, endPose.data(), nrOfBones);
+		}
+
+		if(bHierarchy)
+			LocalToModel(startPose.data(), boneParents.data(), modelPose.data(), nrOfBones);
+		else
+			modelPose = startPose;
+		BuildSkinningPalette(modelPose.data(), bindPoses, palette.data(), nrOfBones);
+		if(!SkinVertices(streams, palette, positions) )
+			return box;
+
+		//Compressed tracks and the DLB of bones with a hierarchy take the shortest arc, BlendSkinningPalette doesn't
+		bool bShortestArc = bHierarchy || !compressed.IsEmpty();
+		for(unsigned int bone = 0; bone < nrOfBones; ++bone){
+			const tt::DualQuaternion& start = startPose[bone];
+			const tt::DualQuaternion& end = endPose[bone];
+			float cosHalfAngle = Dot(start.Data[0], end.Data[0]);
+			if(bShortestArc)
+				cosHalfAngle = fabs(cosHalfAngle);
+			cosHalfAngle = max(-1.0f, min(cosHalfAngle, 1.0f) );
+
+			float translation = (GetTranslation(end) - GetTranslation(start) ).Length();
+			if(compressed.IsEmpty() )
+				translation = cosHalfAngle > -1 ? translation * sqrtf(2 / (1 + cosHalfAngle) ) : FLT_MAX;
+
+			BoneMotion& boneMotion = motion[bone];
+			boneMotion.Angle = 2 * acosf(cosHalfAngle);
+			boneMotion.Translation = translation;
+
+			unsigned int parent = bHierarchy ? boneParents[bone] : Bone::NO_PARENT;
+			if(parent != Bone::NO_PARENT){
+				const BoneMotion& parentMotion = motion[parent];
+				float offset = (GetTranslation(modelPose[bone]) - GetTranslation(modelPose[parent]) ).Length();
+				boneMotion.Translation += parentMotion.Translation + GetChord(parentMotion.Angle, offset);
+				boneMotion.Angle += parentMotion.Angle;
+			}
+		}
+
+		for(unsigned int vertex = 0; vertex < nrOfVertices; ++vertex){
+			const tt::Vector3& position = positions[vertex];
+			tt::Vector3 bindPosition(streams.PosX[vertex], streams.PosY[vertex], streams.PosZ[vertex]);
+
+			unsigned int firstBone = streams.BoneIndices[0][vertex];
+			const tt::Quaternion& firstRotation = palette[firstBone].Data[0];
+			float firstChord = GetQuaternionChord(motion[firstBone].Angle);
+
+			float distance = 0, minLength = 0;
+			for(unsigned int i = 0; i < SkinningStreams::MAX_INFLUENCES; ++i){
+				float weight = streams.Weights[i][vertex];
+				if(weight <= 0)
+					continue;
+
+				unsigned int bone = streams.BoneIndices[i][vertex];
+				const BoneMotion& boneMotion = motion[bone];
+				tt::Vector3 bonePosition = TransformPoint(palette[bone], bindPosition);
+				float radius = (bonePosition - GetTranslation(modelPose[bone]) ).Length();
+				distance += weight * ((bonePosition - position).Length() + GetChord(boneMotion.Angle, radius) + boneMotion.Translation);
+
+				if(i == 0)
+					minLength += weight;
+				else{
+					float chord = GetQuaternionChord(boneMotion.Angle);
+					float cosine = fabs(Dot(firstRotation, palette[bone].Data[0]) ) - firstChord - chord - firstChord * chord;
+					minLength += weight * max(cosine, 0.0f);
+				}
+			}
+
+			//Rounding of the kernels, relative to the distance from the origin
+			float pad = minLength > 0 ? distance / minLength : FLT_MAX;
+			pad += 1e-5f * (1 + position.Length() );
+
+			box.Include(position - tt::Vector3(pad) );
+			box.Include(position + tt::Vector3(pad) );
+		}
+
+		return box;
+	};
+
+	//Segment s covers the keys [s*SegmentKeys, (s+1)*SegmentKeys] and everything in between
+	unsigned int nrOfSegments = max(1u, (nrOfKeys - 1 + SegmentKeys - 1) / SegmentKeys);
+	Segments.resize(nrOfSegments);
+
+	if(nrOfKeys == 1)
+		Segments[0] = interval(0, 0);
+	for(unsigned int key = 1; key < nrOfKeys; ++key)
+		Segments[(key - 1) / SegmentKeys].Include(interval(key - 1, key) );
+
+	for(auto& segment : Segments)
+		Bounds.Include(segment);
+
+	//Before the first key uncompressed playback blends from the last key back to the first. Compressed playback holds
+	//a pose of the last segment there, which the segments already cover.
+	if(nrOfKeys > 1 && compressed.IsEmpty() )
+		Bounds.Include(interval(nrOfKeys - 1, 0) );
+}
+
+bool ClipBounds::IsEmpty(void) const
+{
+	return Segments.empty();
+}
+
+const AABBox& ClipBounds::GetBounds(const AnimationClip& clip, float tick) const
+{
+	auto itNext = upper_bound(clip.Keys.begin(), clip.Keys.end(), tick, [](float t, const AnimationKey& key){
+		return t < key.KeyTime;
+	});
+
+	//Before the first key playback blends from the last key back to the first, which no segment covers
+	if(itNext == clip.Keys.begin() )
+		return Bounds;
+
+	unsigned int segment = (itNext - clip.Keys.begin() - 1) / SegmentKeys;
+	return Segments[min(segment, static_cast<unsigned int>(Segments.size() ) - 1)];
+}
@@ -0,0 +1,45 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "BoundingVolumes.h"
+#include "AnimationKernels.h"
+#include "CpuSkinning.h"
+
+struct AnimationClip;
+
+//Bounds of a skinned mesh while playing one clip, over the whole clip and per segment of a few keys (see Model3D::GetAABB).
+//The bounds contain every pose MeshAnimator plays back: the mesh is skinned at every key and each vertex padded by how far its
+//bones can move it before the next key.
+struct ClipBounds
+{
+	AABBox Bounds;
+	vector<AABBox> Segments; //One per SegmentKeys keys, including the first key of the next segment
+	unsigned int SegmentKeys;
+
+	ClipBounds(void);
+
+	//boneParents holds the parent of every bone for keys relative to the parent bone, and is empty for keys in model space.
+	//Bounds the poses of clip.Compressed if the clip has been compressed, else those of its keys.
+	//Leaves the bounds empty if the clip has no keys, the mesh no vertices or a key lacks some of the bones.
+	void Build(const AnimationClip& clip, const SkinningStreams& streams, const InverseBindPoses& bindPoses
+			  ,const vector<unsigned int>& boneParents, unsigned int segmentKeys);
+	bool IsEmpty(void) const;
+	//Segment playing at tick, or Bounds before the first key. Needs a built clip.
+	const AABBox& GetBounds(const AnimationClip& clip, float tick) const;
+};
@@ -0,0 +1,182 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "CookedMesh.h"
+#include "../Helpers/MappedFileReader.h"
+
+static_assert(sizeof(tt::Vector3) == 3 * sizeof(float), "Cooked bounds must match the .ttmesh layout");
+
+namespace
+{
+	template<typename T> void ReadAttributeData(MappedFileReader& meshFile, vector<T>& data, unsigned int count)
+	{
+		//Counts come from the file, check them before allocating
+		if(count > (meshFile.GetSize() - meshFile.GetPosition() ) / sizeof(T) )
+			throw exception("EOF found! Cannot continue reading file!");
+
+		data.resize(count);
+		meshFile.ReadArray(data.data(), count);
+	}
+
+	//Indices past the end of the vertex streams would make the GPU read outside of the vertex buffer
+	bool IndicesInRange(const vector<unsigned int>& indices, unsigned int nrOfVertices)
+	{
+		return find_if(indices.begin(), indices.end(), [&](unsigned int index){
+			return index >= nrOfVertices;
+		}) == indices.end();
+	}
+}
+
+CookedMesh::CookedMesh(void):NrOfVertices(0)
+{
+	Bounds[0] = Bounds[1] = tt::Vector3(0, 0, 0);
+}
+
+void WriteCookedMesh(const CookedMesh& mesh, vector<char>& file)
+{
+	unsigned int nrOfSections = mesh.Streams.size() + 2 + (mesh.LODs.empty() ? 0 : 1) + (mesh.Clusters.Size() == 0 ? 0 : 1);
+	CookedMeshHeader header = {COOKED_MESH_VERSION, static_cast<unsigned short>(nrOfSections), mesh.NrOfVertices, static_cast<unsigned int>(mesh.Indices.size() ), 0};
+	
+	//Sections are appended to the file in memory, every one of them aligned
+	vector<CookedMeshSection> sections;
+	file.assign(AlignCookedOffset(sizeof(CookedMeshHeader) + header.NrOfSections * sizeof(CookedMeshSection) ), 0);
+
+	auto addSection = [&](CookedSectionType type, unsigned int size, unsigned int stride, const void* pData) -> unsigned int {
+		CookedMeshSection section = {type, static_cast<unsigned int>(file.size() ), size, stride};
+		sections.push_back(section);
+		
+		file.resize(AlignCookedOffset(file.size() + size) );
+		if(pData && size > 0)
+			memcpy(&file[section.Offset], pData, size);
+		return section.Offset;
+	};
+
+	addSection(CookedSectionType::Bounds, sizeof(mesh.Bounds), 0, mesh.Bounds);
+	addSection(CookedSectionType::Indices, mesh.Indices.size() * sizeof(unsigned int), 0, mesh.Indices.data() );
+
+	if(!mesh.LODs.empty() ){
+		unsigned int tableSize = sizeof(unsigned int) + mesh.LODs.size() * sizeof(CookedMeshLOD);
+		char* pSection = &file[addSection(CookedSectionType::LODs, tableSize + mesh.LODIndices.size() * sizeof(unsigned int), 0, nullptr)];
+
+		*reinterpret_cast<unsigned int*>(pSection) = mesh.LODs.size();
+		memcpy(pSection + sizeof(unsigned int), mesh.LODs.data(), mesh.LODs.size() * sizeof(CookedMeshLOD) );
+		memcpy(pSection + tableSize, mesh.LODIndices.data(), mesh.LODIndices.size() * sizeof(unsigned int) );
+	}
+
+	const ClusterStreams& clusters = mesh.Clusters;
+	if(clusters.Size() > 0){
+		char* pSection = &file[addSection(CookedSectionType::Clusters, sizeof(unsigned int) + clusters.Size() * sizeof(CookedMeshCluster), 0, nullptr)];
+
+		*reinterpret_cast<unsigned int*>(pSection) = clusters.Size();
+		auto pClusters = reinterpret_cast<CookedMeshCluster*>(pSection + sizeof(unsigned int) );
+		for(unsigned int i = 0; i < clusters.Size(); ++i){
+			CookedMeshCluster cluster = {	{clusters.CenterX[i], clusters.CenterY[i], clusters.CenterZ[i]}, clusters.Radius[i]
+										,	{clusters.AxisX[i], clusters.AxisY[i], clusters.AxisZ[i]}, clusters.Cutoff[i]
+										,	clusters.StartIndex[i], clusters.NrOfIndices[i] };
+			memcpy(pClusters + i, &cluster, sizeof(CookedMeshCluster) );
+		}
+	}
+
+	for(auto& stream : mesh.Streams){
+		unsigned int dataOffset = CookedStreamDataOffset(stream.Elements.size() );
+		char* pSection = &file[addSection(CookedSectionType::VertexStream, dataOffset + stream.Data.size(), stream.Stride, nullptr)];
+
+		*reinterpret_cast<unsigned int*>(pSection) = stream.Elements.size();
+		memcpy(pSection + sizeof(unsigned int), stream.Elements.data(), stream.Elements.size() * sizeof(CookedStreamElement) );
+		memcpy(pSection + dataOffset, stream.Data.data(), stream.Data.size() );
+	}
+
+	memcpy(&file[0], &header, sizeof(CookedMeshHeader) );
+	memcpy(&file[sizeof(CookedMeshHeader)], sections.data(), sections.size() * sizeof(CookedMeshSection) );
+}
+
+void ReadCookedMesh(MappedFileReader& meshFile, CookedMesh& mesh)
+{
+	auto header = meshFile.Read<CookedMeshHeader>();
+	if(header.Version != COOKED_MESH_VERSION)
+		throw exception("Not a cooked mesh file of this version");
+
+	mesh.NrOfVertices = header.NrOfVertices;
+
+	vector<CookedMeshSection> sections;
+	ReadAttributeData(meshFile, sections, header.NrOfSections);
+	mesh.Streams.reserve(sections.size() );
+
+	for(auto& section : sections){
+		meshFile.Seek(section.Offset);
+
+		switch(section.Type){
+			case CookedSectionType::Bounds:
+				meshFile.ReadArray(mesh.Bounds, 2);
+				break;
+			case CookedSectionType::Indices:
+				ReadAttributeData(meshFile, mesh.Indices, header.NrOfIndices);
+				break;
+			case CookedSectionType::VertexStream:{
+				mesh.Streams.push_back(CookedStream() );
+				auto& stream = mesh.Streams.back();
+				
+				ReadAttributeData(meshFile, stream.Elements, meshFile.Read<unsigned int>() );
+				stream.Stride = section.Stride;
+				
+				//Sized in 64 bit, the vertex count and stride of a corrupt file can overflow 32
+				unsigned int dataOffset = CookedStreamDataOffset(stream.Elements.size() );
+				unsigned long long dataSize = static_cast<unsigned long long>(header.NrOfVertices) * section.Stride;
+				if(dataOffset > section.Size || dataSize > section.Size - dataOffset)
+					throw exception("Vertex stream larger than its section");
+
+				meshFile.Seek(section.Offset + dataOffset);
+				ReadAttributeData(meshFile, stream.Data, static_cast<unsigned int>(dataSize) );
+				break;
+			}
+			case CookedSectionType::LODs:{
+				ReadAttributeData(meshFile, mesh.LODs, meshFile.Read<unsigned int>() );
+
+				unsigned int nrOfLODIndices = 0;
+				for(auto& lod : mesh.LODs)
+					nrOfLODIndices += lod.NrOfIndices;
+
+				ReadAttributeData(meshFile, mesh.LODIndices, nrOfLODIndices);
+				break;
+			}
+			case CookedSectionType::Clusters:{
+				vector<CookedMeshCluster> cookedClusters;
+				ReadAttributeData(meshFile, cookedClusters, meshFile.Read<unsigned int>() );
+
+				auto& clusters = mesh.Clusters;
+				clusters.Resize(cookedClusters.size() );
+				for(unsigned int i = 0; i < cookedClusters.size(); ++i){
+					auto& cluster = cookedClusters[i];
+					clusters.CenterX[i] = cluster.Center[0];
+					clusters.CenterY[i] = cluster.Center[1];
+					clusters.CenterZ[i] = cluster.Center[2];
+					clusters.Radius[i] = cluster.Radius;
+					clusters.AxisX[i] = cluster.Axis[0];
+					clusters.AxisY[i] = cluster.Axis[1];
+					clusters.AxisZ[i] = cluster.Axis[2];
+					clusters.Cutoff[i] = cluster.Cutoff;
+					clusters.StartIndex[i] = cluster.StartIndex;
+					clusters.NrOfIndices[i] = cluster.NrOfIndices;
+				}
+				break;
+			}
+		}
+	}
+
+	if(!IndicesInRange(mesh.Indices, header.NrOfVertices) || !IndicesInRange(mesh.LODIndices, header.NrOfVertices) )
+		throw exception("Index out of range of the vertex streams");
+}
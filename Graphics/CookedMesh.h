@@ -0,0 +1,143 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "EffectTechnique.h"
+#include "MeshClusters.h"
+
+class MappedFileReader;
+
+//Cooked .ttmesh files hold vertex buffers that are already interleaved for the input layouts they were cooked for,
+//so loading them is a bulk read and buffer creation. Model3D::Cook converts source .ttmesh files (see MeshCooker.h).
+//They hold no skeleton or animation clips, models with animation data can only be loaded from their source files.
+//
+//file layout:
+//	CookedMeshHeader
+//	CookedMeshSection * NrOfSections
+//	sections, each starting at a multiple of COOKED_MESH_ALIGNMENT:
+//		Bounds		 : 24 bytes, min and max corner of the bounding box
+//		Indices		 : 4 bytes * NrOfIndices
+//		VertexStream : 4 bytes NrOfElements, CookedStreamElement * NrOfElements,
+//					   NrOfVertices * Stride bytes of vertex data at CookedStreamDataOffset(NrOfElements)
+//		LODs		 : optional, 4 bytes NrOfLODs, CookedMeshLOD * NrOfLODs, 4 bytes * the NrOfIndices of all LODs
+//		Clusters	 : optional, 4 bytes NrOfClusters, CookedMeshCluster * NrOfClusters
+
+//Takes the place of the version number of source files, whose versions stay below COOKED_MESH_VERSION_FIRST.
+//Cooked files of older versions have to be cooked again.
+static const unsigned short COOKED_MESH_VERSION_FIRST = 0x8000;
+static const unsigned short COOKED_MESH_VERSION = 0x8001;
+static const unsigned int COOKED_MESH_ALIGNMENT = 16;
+
+enum class CookedSectionType : unsigned int
+{
+	Bounds,
+	Indices,
+	VertexStream,
+	LODs,
+	Clusters
+};
+
+struct CookedMeshHeader
+{
+	unsigned short Version;
+	unsigned short NrOfSections;
+	unsigned int NrOfVertices;
+	unsigned int NrOfIndices;
+	unsigned int Reserved;
+};
+
+struct CookedMeshSection
+{
+	CookedSectionType Type;
+	unsigned int Offset; //From the start of the file
+	unsigned int Size;
+	unsigned int Stride; //Vertex size of a VertexStream, 0 for other sections
+};
+
+//Layout of one attribute in a cooked vertex stream, stored in the format of the layout it was cooked for (see VertexFormat.h)
+struct CookedStreamElement
+{
+	InputLayoutSemantic Semantic;
+	unsigned char SemanticIndex;
+	unsigned short Offset;
+	DXGI_FORMAT Format;
+};
+
+//Simplified level on top of the full mesh, see MeshLOD. Its indices follow the NrOfIndices of the full mesh in the index buffer.
+struct CookedMeshLOD
+{
+	unsigned int StartIndex;
+	unsigned int NrOfIndices;
+	unsigned int NrOfVertices;
+	float Error;
+};
+
+//Cluster of the full mesh, see ClusterStreams
+struct CookedMeshCluster
+{
+	float Center[3];
+	float Radius;
+	float Axis[3];
+	float Cutoff;
+	unsigned int StartIndex;
+	unsigned int NrOfIndices;
+};
+
+static_assert(sizeof(CookedMeshHeader) == 16 && sizeof(CookedMeshSection) == 16 && sizeof(CookedStreamElement) == 8 && sizeof(CookedMeshLOD) == 16
+			 && sizeof(CookedMeshCluster) == 40
+			 ,"Cooked mesh structures must match the file layout");
+
+inline unsigned int AlignCookedOffset(unsigned int offset)
+{
+	return (offset + COOKED_MESH_ALIGNMENT - 1) & ~(COOKED_MESH_ALIGNMENT - 1);
+}
+
+//Offset of the vertex data from the start of a VertexStream section
+inline unsigned int CookedStreamDataOffset(unsigned int nrOfElements)
+{
+	return AlignCookedOffset(sizeof(unsigned int) + nrOfElements * sizeof(CookedStreamElement) );
+}
+
+//Vertex data for one input layout, NrOfVertices * Stride bytes
+struct CookedStream
+{
+	vector<CookedStreamElement> Elements;
+	unsigned int Stride;
+	vector<char> Data;
+};
+
+//Contents of a cooked .ttmesh file. Model3DLoader reads cooked files through ReadCookedMesh, cooking writes them
+//with WriteCookedMesh.
+struct CookedMesh
+{
+	tt::Vector3 Bounds[2];
+	unsigned int NrOfVertices;
+	vector<unsigned int> Indices;
+	vector<CookedStream> Streams;
+	vector<CookedMeshLOD> LODs;
+	vector<unsigned int> LODIndices; //Indices of every LOD, each level following the one before it
+	ClusterStreams Clusters;
+
+	CookedMesh(void);
+};
+
+//Lays the mesh out as a cooked .ttmesh file in memory
+void WriteCookedMesh(const CookedMesh& mesh, vector<char>& file);
+//Reads a cooked .ttmesh from the start of meshFile. Throws if it isn't a cooked file of this version, ends early
+//or has indices out of the range of its vertices.
+void ReadCookedMesh(MappedFileReader& meshFile, CookedMesh& mesh);
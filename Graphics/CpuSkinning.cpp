@@ -0,0 +1,311 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "CpuSkinning.h"
+#include "../Helpers/SimdUtil.h"
+#include "../Helpers/WorkerPool.h"
+
+//Per vertex, identical to VS_Anim in SkinnedEffect.fx:
+//	dq		= sum(w_i * palette[i]), with every influence flipped to the hemisphere of the first one
+//	dq		/= |real(dq)|
+//	pos'	= pos + 2 r x (r x pos + r.w pos) + 2 (r.w d - d.w r + r x d)		(r, d: vector parts of real/dual)
+//	norm'	= norm + 2 r x (r x norm + r.w norm)
+
+namespace
+{
+	//Vertices per task, a multiple of the SIMD width
+	const unsigned int CHUNK_SIZE = 1024;
+
+	void SkinVertex(const SkinningStreams& streams, const tt::DualQuaternion* pPalette, unsigned int vertex
+				   ,tt::Vector3* pPosition, tt::Vector3* pNormal)
+	{
+		const tt::DualQuaternion& first = pPalette[streams.BoneIndices[0][vertex]];
+		tt::Quaternion real = first.Data[0] * streams.Weights[0][vertex];
+		tt::Quaternion dual = first.Data[1] * streams.Weights[0][vertex];
+
+		for(unsigned int i = 1; i < SkinningStreams::MAX_INFLUENCES; ++i){
+			const tt::DualQuaternion& dq = pPalette[streams.BoneIndices[i][vertex]];
+			const tt::Quaternion& r0 = first.Data[0];
+			float weight = (r0.x*dq.Data[0].x + r0.y*dq.Data[0].y + r0.z*dq.Data[0].z + r0.w*dq.Data[0].w) < 0 
+						 ? -streams.Weights[i][vertex] : streams.Weights[i][vertex];
+			
+			real += dq.Data[0] * weight;
+			dual += dq.Data[1] * weight;
+		}
+
+		float invLength = 1.0f / sqrtf(real.x*real.x + real.y*real.y + real.z*real.z + real.w*real.w);
+		real *= invLength;
+		dual *= invLength;
+
+		tt::Vector3 r(real.x, real.y, real.z), d(dual.x, dual.y, dual.z);
+		tt::Vector3 pos(streams.PosX[vertex], streams.PosY[vertex], streams.PosZ[vertex]);
+		
+		*pPosition = pos + r.Cross(r.Cross(pos) + pos * real.w) * 2.0f
+					+ (d * real.w - r * dual.w + r.Cross(d)) * 2.0f;
+
+		if(pNormal){
+			tt::Vector3 norm(streams.NormX[vertex], streams.NormY[vertex], streams.NormZ[vertex]);
+			*pNormal = norm + r.Cross(r.Cross(norm) + norm * real.w) * 2.0f;
+		}
+	}
+
+#ifdef TT_SIMD_SSE
+	//The block kernel is written once against these, a register holds the same component of WIDTH vertices
+	struct SimdSSE
+	{
+		typedef __m128 Reg;
+		static const unsigned int WIDTH = 4;
+
+		static Reg Set(float f)				{ return _mm_set1_ps(f); }
+		static Reg Load(const float* p)		{ return _mm_loadu_ps(p); }
+		static Reg Add(Reg a, Reg b)		{ return _mm_add_ps(a, b); }
+		static Reg Sub(Reg a, Reg b)		{ return _mm_sub_ps(a, b); }
+		static Reg Mul(Reg a, Reg b)		{ return _mm_mul_ps(a, b); }
+		static Reg MulAdd(Reg a, Reg b, Reg c) { return SimdMulAdd(a, b, c); }
+		static Reg Div(Reg a, Reg b)		{ return _mm_div_ps(a, b); }
+		static Reg Sqrt(Reg a)				{ return _mm_sqrt_ps(a); }
+		static Reg And(Reg a, Reg b)		{ return _mm_and_ps(a, b); }
+		static Reg Xor(Reg a, Reg b)		{ return _mm_xor_ps(a, b); }
+
+		//Real and dual parts of the palette entries of 4 vertices, transposed to one register per component
+		static void Gather(const tt::DualQuaternion* pPalette, const unsigned short* pIndices, Reg* pReal, Reg* pDual)
+		{
+			for(int part = 0; part < 2; ++part){
+				Reg* pOut = part == 0 ? pReal : pDual;
+				pOut[0] = _mm_loadu_ps(&pPalette[pIndices[0]].Data[part].x);
+				pOut[1] = _mm_loadu_ps(&pPalette[pIndices[1]].Data[part].x);
+				pOut[2] = _mm_loadu_ps(&pPalette[pIndices[2]].Data[part].x);
+				pOut[3] = _mm_loadu_ps(&pPalette[pIndices[3]].Data[part].x);
+				_MM_TRANSPOSE4_PS(pOut[0], pOut[1], pOut[2], pOut[3]);
+			}
+		}
+
+		static void StoreAoS3(tt::Vector3* pDest, Reg x, Reg y, Reg z)
+		{
+			SimdStoreAoS3(&pDest->x, x, y, z);
+		}
+	};
+
+#ifdef TT_SIMD_AVX
+	struct SimdAVX
+	{
+		typedef __m256 Reg;
+		static const unsigned int WIDTH = 8;
+
+		static Reg Set(float f)				{ return _mm256_set1_ps(f); }
+		static Reg Load(const float* p)		{ return _mm256_loadu_ps(p); }
+		static Reg Add(Reg a, Reg b)		{ return _mm256_add_ps(a, b); }
+		static Reg Sub(Reg a, Reg b)		{ return _mm256_sub_ps(a, b); }
+		static Reg Mul(Reg a, Reg b)		{ return _mm256_mul_ps(a, b); }
+		static Reg MulAdd(Reg a, Reg b, Reg c) { return SimdMulAdd8(a, b, c); }
+		static Reg Div(Reg a, Reg b)		{ return _mm256_div_ps(a, b); }
+		static Reg Sqrt(Reg a)				{ return _mm256_sqrt_ps(a); }
+		static Reg And(Reg a, Reg b)		{ return _mm256_and_ps(a, b); }
+		static Reg Xor(Reg a, Reg b)		{ return _mm256_xor_ps(a, b); }
+
+		//AVX has no gather, transpose both halves with SSE and combine them
+		static void Gather(const tt::DualQuaternion* pPalette, const unsigned short* pIndices, Reg* pReal, Reg* pDual)
+		{
+			__m128 lowReal[4], lowDual[4], highReal[4], highDual[4];
+			SimdSSE::Gather(pPalette, pIndices, lowReal, lowDual);
+			SimdSSE::Gather(pPalette, pIndices + 4, highReal, highDual);
+
+			for(int i = 0; i < 4; ++i){
+				pReal[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(lowReal[i]), highReal[i], 1);
+				pDual[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(lowDual[i]), highDual[i], 1);
+			}
+		}
+
+		static void StoreAoS3(tt::Vector3* pDest, Reg x, Reg y, Reg z)
+		{
+			SimdStoreAoS3(&pDest->x, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z));
+			SimdStoreAoS3(&pDest[4].x, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+		}
+	};
+#endif
+
+	//a x b, per component
+	template<typename S>
+	inline void Cross(typename S::Reg ax, typename S::Reg ay, typename S::Reg az, typename S::Reg bx, typename S::Reg by, typename S::Reg bz
+					 ,typename S::Reg& outX, typename S::Reg& outY, typename S::Reg& outZ)
+	{
+		outX = S::Sub(S::Mul(ay, bz), S::Mul(az, by));
+		outY = S::Sub(S::Mul(az, bx), S::Mul(ax, bz));
+		outZ = S::Sub(S::Mul(ax, by), S::Mul(ay, bx));
+	}
+
+	//Skins S::WIDTH vertices starting at first
+	template<typename S>
+	void SkinBlock(const SkinningStreams& streams, const tt::DualQuaternion* pPalette, unsigned int first
+				  ,tt::Vector3* pPositions, tt::Vector3* pNormals)
+	{
+		typedef typename S::Reg Reg;
+		const Reg signMask = S::Set(-0.0f);
+		const Reg two = S::Set(2.0f);
+
+		//Blend, every influence is flipped to the hemisphere of the first one
+		unsigned short indices[S::WIDTH];
+		Reg real[4], dual[4], firstReal[4], dqReal[4], dqDual[4];
+
+		for(unsigned int lane = 0; lane < S::WIDTH; ++lane)
+			indices[lane] = streams.BoneIndices[0][first + lane];
+		S::Gather(pPalette, indices, firstReal, dqDual);
+		
+		Reg weight = S::Load(&streams.Weights[0][first]);
+		for(int c = 0; c < 4; ++c){
+			real[c] = S::Mul(firstReal[c], weight);
+			dual[c] = S::Mul(dqDual[c], weight);
+		}
+
+		for(unsigned int i = 1; i < SkinningStreams::MAX_INFLUENCES; ++i){
+			for(unsigned int lane = 0; lane < S::WIDTH; ++lane)
+				indices[lane] = streams.BoneIndices[i][first + lane];
+			S::Gather(pPalette, indices, dqReal, dqDual);
+
+			Reg dot = S::MulAdd(firstReal[0], dqReal[0], S::MulAdd(firstReal[1], dqReal[1], S::MulAdd(firstReal[2], dqReal[2], S::Mul(firstReal[3], dqReal[3]))));
+			weight = S::Xor(S::Load(&streams.Weights[i][first]), S::And(dot, signMask));
+
+			for(int c = 0; c < 4; ++c){
+				real[c] = S::MulAdd(dqReal[c], weight, real[c]);
+				dual[c] = S::MulAdd(dqDual[c], weight, dual[c]);
+			}
+		}
+
+		Reg invLength = S::Div(S::Set(1.0f), S::Sqrt(S::MulAdd(real[0], real[0], S::MulAdd(real[1], real[1], S::MulAdd(real[2], real[2], S::Mul(real[3], real[3]))))));
+		for(int c = 0; c < 4; ++c){
+			real[c] = S::Mul(real[c], invLength);
+			dual[c] = S::Mul(dual[c], invLength);
+		}
+
+		//Position, rotated and translated
+		Reg px = S::Load(&streams.PosX[first]), py = S::Load(&streams.PosY[first]), pz = S::Load(&streams.PosZ[first]);
+		Reg tx, ty, tz, ux, uy, uz;
+		Cross<S>(real[0], real[1], real[2], px, py, pz, tx, ty, tz);
+		Cross<S>(real[0], real[1], real[2], S::MulAdd(px, real[3], tx), S::MulAdd(py, real[3], ty), S::MulAdd(pz, real[3], tz), ux, uy, uz);
+		Cross<S>(real[0], real[1], real[2], dual[0], dual[1], dual[2], tx, ty, tz);
+		
+		tx = S::Add(S::Sub(S::Mul(dual[0], real[3]), S::Mul(real[0], dual[3])), S::Add(tx, ux));
+		ty = S::Add(S::Sub(S::Mul(dual[1], real[3]), S::Mul(real[1], dual[3])), S::Add(ty, uy));
+		tz = S::Add(S::Sub(S::Mul(dual[2], real[3]), S::Mul(real[2], dual[3])), S::Add(tz, uz));
+		S::StoreAoS3(pPositions + first, S::MulAdd(two, tx, px), S::MulAdd(two, ty, py), S::MulAdd(two, tz, pz));
+
+		//Normal, rotated only
+		if(pNormals){
+			Reg nx = S::Load(&streams.NormX[first]), ny = S::Load(&streams.NormY[first]), nz = S::Load(&streams.NormZ[first]);
+			Cross<S>(real[0], real[1], real[2], nx, ny, nz, tx, ty, tz);
+			Cross<S>(real[0], real[1], real[2], S::MulAdd(nx, real[3], tx), S::MulAdd(ny, real[3], ty), S::MulAdd(nz, real[3], tz), ux, uy, uz);
+			S::StoreAoS3(pNormals + first, S::MulAdd(two, ux, nx), S::MulAdd(two, uy, ny), S::MulAdd(two, uz, nz));
+		}
+	}
+#endif
+}
+
+//--------------------------
+//SkinningStreams
+//--------------------------
+SkinningStreams::SkinningStreams(void):NrOfBones(0)
+{
+
+}
+
+void SkinningStreams::Resize(unsigned int nrOfVertices, bool bNormals)
+{
+	PosX.resize(nrOfVertices); PosY.resize(nrOfVertices); PosZ.resize(nrOfVertices);
+
+	unsigned int nrOfNormals = bNormals ? nrOfVertices : 0;
+	NormX.resize(nrOfNormals); NormY.resize(nrOfNormals); NormZ.resize(nrOfNormals);
+
+	for(unsigned int i = 0; i < MAX_INFLUENCES; ++i){
+		BoneIndices[i].resize(nrOfVertices);
+		Weights[i].resize(nrOfVertices);
+	}
+}
+
+void SkinningStreams::SetInfluences(unsigned int vertex, const float* pIndices, const float* pWeights)
+{
+	//The blend indices are floats, a negative one can't be converted to an unsigned bone index
+	unsigned short firstBone = pIndices[0] >= 0 ? static_cast<unsigned short>(pIndices[0]) : 0;
+	NrOfBones = max(NrOfBones, firstBone + 1u);
+	bool bInfluenced = false;
+
+	for(unsigned int i = 0; i < MAX_INFLUENCES; ++i){
+		bool bUsed = pIndices[i] >= 0 && (i == 0 || pWeights[i] > 0);
+		BoneIndices[i][vertex] = bUsed ? static_cast<unsigned short>(pIndices[i]) : firstBone;
+		Weights[i][vertex] = bUsed ? pWeights[i] : 0.0f;
+
+		if(bUsed)
+			NrOfBones = max(NrOfBones, BoneIndices[i][vertex] + 1u);
+		bInfluenced |= bUsed && pWeights[i] > 0;
+	}
+
+	//All weights 0 would leave the blended dual quaternion without a length
+	if(!bInfluenced)
+		Weights[0][vertex] = 1.0f;
+}
+
+unsigned int SkinningStreams::Size(void) const
+{
+	return PosX.size();
+}
+
+bool SkinningStreams::HasNormals(void) const
+{
+	return !NormX.empty();
+}
+
+//--------------------------
+//Kernels
+//--------------------------
+void SkinVertices(const SkinningStreams& streams, const tt::DualQuaternion* pPalette, unsigned int begin, unsigned int end
+				 ,tt::Vector3* pPositions, tt::Vector3* pNormals)
+{
+	unsigned int i = begin;
+
+#ifdef TT_SIMD_AVX
+	for(; i + SimdAVX::WIDTH <= end; i += SimdAVX::WIDTH)
+		SkinBlock<SimdAVX>(streams, pPalette, i, pPositions, pNormals);
+#endif
+
+#ifdef TT_SIMD_SSE
+	for(; i + SimdSSE::WIDTH <= end; i += SimdSSE::WIDTH)
+		SkinBlock<SimdSSE>(streams, pPalette, i, pPositions, pNormals);
+#endif
+
+	for(; i < end; ++i)
+		SkinVertex(streams, pPalette, i, pPositions + i, pNormals ? pNormals + i : nullptr);
+}
+
+bool SkinVertices(const SkinningStreams& streams, const std::vector<tt::DualQuaternion>& palette
+				 ,std::vector<tt::Vector3>& positions, std::vector<tt::Vector3>* pNormals)
+{
+	if(palette.size() < streams.NrOfBones)
+		return false;
+
+	positions.resize(streams.Size() );
+	
+	tt::Vector3* pNormalData = nullptr;
+	if(pNormals){
+		pNormals->resize(streams.HasNormals() ? streams.Size() : 0);
+		pNormalData = pNormals->empty() ? nullptr : pNormals->data();
+	}
+
+	WorkerPool::GetInstance()->ParallelFor(streams.Size(), CHUNK_SIZE, [&](unsigned int begin, unsigned int end){
+		SkinVertices(streams, palette.data(), begin, end, positions.data(), pNormalData);
+	});
+
+	return true;
+}
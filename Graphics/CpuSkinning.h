@@ -0,0 +1,57 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "../Helpers/Namespace.h"
+
+//CPU counterpart of the dual quaternion skinning in SkinnedEffect.fx, for code that needs the animated vertices
+//itself (ragdoll proxies, picking, server side hit detection). Works on the palette of a MeshAnimator and doesn't
+//touch the graphics device. Vertices are processed 8 (AVX) or 4 (SSE) at a time, with a scalar fallback.
+
+//Vertex data of a skinned model in the form the kernels consume: one stream per component, flattened from
+//Model3D's indexed vertex attributes. Immutable after Initialize, a Model3D builds it once at load time.
+struct SkinningStreams
+{
+	static const unsigned int MAX_INFLUENCES = 4;
+
+	std::vector<float> PosX, PosY, PosZ;
+	std::vector<float> NormX, NormY, NormZ; //Empty if the model has no normals
+	std::vector<unsigned short> BoneIndices[MAX_INFLUENCES];
+	std::vector<float> Weights[MAX_INFLUENCES];
+	unsigned int NrOfBones; //Highest bone index used + 1, the minimum palette size
+
+	SkinningStreams(void);
+
+	//Allocates every stream, the caller fills them in and sets NrOfBones (or fills the influences through SetInfluences)
+	void Resize(unsigned int nrOfVertices, bool bNormals);
+	//Sets the influences of a vertex from its blend indices and weights as a .ttmesh stores them, and raises NrOfBones to cover them.
+	//Unused influences, those with a negative index or a weight of 0, refer to the vertex's first bone with weight 0.
+	//A vertex without any weight follows its first bone, or bone 0 if it has none.
+	void SetInfluences(unsigned int vertex, const float* pIndices, const float* pWeights);
+	unsigned int Size(void) const;
+	bool HasNormals(void) const;
+};
+
+//Skins vertices [begin, end) on the calling thread
+void SkinVertices(const SkinningStreams& streams, const tt::DualQuaternion* pPalette, unsigned int begin, unsigned int end
+				 ,tt::Vector3* pPositions, tt::Vector3* pNormals);
+
+//Skins all vertices, split in chunks over the WorkerPool. Resizes the output to one entry per
+//vertex, pNormals may be nullptr. Returns false if the palette doesn't cover every bone the vertices refer to.
+bool SkinVertices(const SkinningStreams& streams, const std::vector<tt::DualQuaternion>& palette
+				 ,std::vector<tt::Vector3>& positions, std::vector<tt::Vector3>* pNormals = nullptr);
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -19,6 +19,7 @@
 #include "../Services/ServiceLocator.h"
 #include "GraphicsDevice.h"
 #include "../Diagnostics/Exceptions.h"
+#include "VertexFormat.h"
 
 std::vector< std::unique_ptr<InputLayout> > EffectTechnique::m_InputLayouts = std::vector< std::unique_ptr<InputLayout> >();
 
@@ -65,12 +66,23 @@ void EffectTechnique::BuildInputLayout(void)
 	vector<D3D10_INPUT_ELEMENT_DESC> layoutDesc; //This descriptor is used to create the input layout
 	unsigned int inputLayoutSize = 0;
 
+	//Techniques that only draw Model3D vertices can ask for compact vertex formats (see VertexFormat.h) with an annotation:
+	//technique10 Tech < bool QuantizeVertices = true; >
+	BOOL bQuantizeVertices = FALSE;
+	auto pQuantizeAnnotation = m_pTechnique->GetAnnotationByName("QuantizeVertices");
+	if(pQuantizeAnnotation->IsValid() )
+		pQuantizeAnnotation->AsScalar()->GetBool(&bQuantizeVertices);
+
 	//Read new inputlayout
 	InputLayout* pInputLayout = new InputLayout();
 	for(unsigned int i=0; i < effectShaderDesc.NumInputSignatureEntries; ++i)
 	{
 		passShaderDesc.pShaderVariable->GetInputSignatureElementDesc(passShaderDesc.ShaderIndex,i, &signParDesc);
 		InputLayoutElement ilElem = GetInputLayoutElement(signParDesc);
+		if(bQuantizeVertices){
+			ilElem.Format = GetQuantizedFormat(ilElem.Semantic, ilElem.Format);
+			ilElem.Offset = GetFormatSize(ilElem.Format);
+		}
 		
 		//Add element to descriptor
 		pInputLayout->InputLayoutDesc.push_back(ilElem);
@@ -128,7 +140,7 @@ InputLayoutElement EffectTechnique::GetInputLayoutElement(D3D10_SIGNATURE_PARAME
 	// 0111 = 7
 	// 1111 = 15
 	// Byte Offset = Active Bits * 4
-	// Active Bits = log(mask+1) * 4]
+	// Active Bits = ²log(mask+1) * 4]
 	double logMask = log(static_cast<double>(signParDesc.Mask+1));
 	ilElem.Offset = static_cast<unsigned int>(logMask*ELOG2_INV + .1) * 4; //0.1 is added to make sure floor rounding is done correctly
 
@@ -0,0 +1,240 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "Frustum.h"
+#include "BoundingVolumes.h"
+#include "../Helpers/SimdUtil.h"
+
+//Per plane, with the normal pointing into the frustum:
+//	boxes	: outside if dot(plane.xyz, p) + plane.w < 0, p the corner with the max bound on every axis the normal is positive on
+//	spheres	: outside if dot(plane.xyz, center) + plane.w < -radius
+//Anything outside of a single plane is culled.
+
+namespace
+{
+	//Corner of the boxes furthest along the normal, as a stream per axis
+	void GetFurthestCorners(const AABBoxStreams& boxes, const tt::Vector4& plane, const float** ppCorner)
+	{
+		ppCorner[0] = plane.x >= 0.0f ? &boxes.Max[0][0] : &boxes.Min[0][0];
+		ppCorner[1] = plane.y >= 0.0f ? &boxes.Max[1][0] : &boxes.Min[1][0];
+		ppCorner[2] = plane.z >= 0.0f ? &boxes.Max[2][0] : &boxes.Min[2][0];
+	}
+
+	void SetBits(VisibilityBits& visibility, unsigned int first, unsigned int bits)
+	{
+		visibility.Words[first / 32] |= bits << (first % 32);
+	}
+
+	//AVX builds only use the 8 wide version
+#if defined(TT_SIMD_SSE) && !defined(TT_SIMD_AVX)
+	//Bit i is set if box first + i can be visible
+	int CullBoxBlock4(const float* const* ppCorners, const __m128* pPlanes, unsigned int first)
+	{
+		__m128 culled = _mm_setzero_ps();
+		for(unsigned int i = 0; i < Frustum::NR_OF_PLANES; ++i){
+			const float* const* ppCorner = ppCorners + i * 3;
+			const __m128* pPlane = pPlanes + i * 4;
+			__m128 distance = SimdMulAdd(_mm_loadu_ps(ppCorner[0] + first), pPlane[0],
+							  SimdMulAdd(_mm_loadu_ps(ppCorner[1] + first), pPlane[1],
+							  SimdMulAdd(_mm_loadu_ps(ppCorner[2] + first), pPlane[2], pPlane[3]) ) );
+			culled = _mm_or_ps(culled, _mm_cmplt_ps(distance, _mm_setzero_ps() ) );
+		}
+
+		return ~_mm_movemask_ps(culled) & 0xF;
+	}
+#endif
+
+#ifdef TT_SIMD_SSE
+	//Bit i is set if sphere first + i can be visible
+	int CullSphereBlock4(const float* pCenterX, const float* pCenterY, const float* pCenterZ, const float* pRadius, const __m128* pPlanes
+						,unsigned int first)
+	{
+		__m128 cx = _mm_loadu_ps(pCenterX + first);
+		__m128 cy = _mm_loadu_ps(pCenterY + first);
+		__m128 cz = _mm_loadu_ps(pCenterZ + first);
+		__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(pRadius + first) );
+
+		__m128 culled = _mm_setzero_ps();
+		for(unsigned int i = 0; i < Frustum::NR_OF_PLANES; ++i){
+			const __m128* pPlane = pPlanes + i * 4;
+			__m128 distance = SimdMulAdd(cx, pPlane[0], SimdMulAdd(cy, pPlane[1], SimdMulAdd(cz, pPlane[2], pPlane[3]) ) );
+			culled = _mm_or_ps(culled, _mm_cmplt_ps(distance, negRadius) );
+		}
+
+		return ~_mm_movemask_ps(culled) & 0xF;
+	}
+#endif
+
+#ifdef TT_SIMD_AVX
+	int CullBoxBlock8(const float* const* ppCorners, const __m256* pPlanes, unsigned int first)
+	{
+		__m256 culled = _mm256_setzero_ps();
+		for(unsigned int i = 0; i < Frustum::NR_OF_PLANES; ++i){
+			const float* const* ppCorner = ppCorners + i * 3;
+			const __m256* pPlane = pPlanes + i * 4;
+			__m256 distance = SimdMulAdd8(_mm256_loadu_ps(ppCorner[0] + first), pPlane[0],
+							  SimdMulAdd8(_mm256_loadu_ps(ppCorner[1] + first), pPlane[1],
+							  SimdMulAdd8(_mm256_loadu_ps(ppCorner[2] + first), pPlane[2], pPlane[3]) ) );
+			culled = _mm256_or_ps(culled, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ) );
+		}
+
+		return ~_mm256_movemask_ps(culled) & 0xFF;
+	}
+#endif
+}
+
+//--------------------------
+//VisibilityBits
+//--------------------------
+void VisibilityBits::Resize(unsigned int nrOfBits)
+{
+	Words.assign( (nrOfBits + 31) / 32, 0);
+}
+
+bool VisibilityBits::IsSet(unsigned int index) const
+{
+	return (Words[index / 32] >> (index % 32) & 1) != 0;
+}
+
+//--------------------------
+//Frustum
+//--------------------------
+Frustum::Frustum(const tt::Matrix4x4& viewProjection)
+{
+	//Planes of the clip space volume -w <= x <= w, -w <= y <= w, 0 <= z <= w, taken back through the matrix (Gribb & Hartmann)
+	const tt::Matrix4x4& m = viewProjection;
+	tt::Vector4 columns[4] = {	tt::Vector4(m._11, m._21, m._31, m._41),
+								tt::Vector4(m._12, m._22, m._32, m._42),
+								tt::Vector4(m._13, m._23, m._33, m._43),
+								tt::Vector4(m._14, m._24, m._34, m._44) };
+
+	m_Planes[0] = columns[3] + columns[0];
+	m_Planes[1] = columns[3] - columns[0];
+	m_Planes[2] = columns[3] + columns[1];
+	m_Planes[3] = columns[3] - columns[1];
+	m_Planes[4] = columns[2];
+	m_Planes[5] = columns[3] - columns[2];
+
+	for(auto& plane : m_Planes){
+		float length = tt::Vector3(plane.x, plane.y, plane.z).Length();
+		if(length > 0.0f)
+			plane /= length;
+	}
+}
+
+bool Frustum::IsVisible(const AABBox& box) const
+{
+	for(auto& plane : m_Planes){
+		float x = plane.x >= 0.0f ? box.Bounds[1].x : box.Bounds[0].x;
+		float y = plane.y >= 0.0f ? box.Bounds[1].y : box.Bounds[0].y;
+		float z = plane.z >= 0.0f ? box.Bounds[1].z : box.Bounds[0].z;
+		if(plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+bool Frustum::IsVisible(const tt::Vector3& center, float radius) const
+{
+	for(auto& plane : m_Planes)
+		if(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+			return false;
+
+	return true;
+}
+
+void Frustum::Cull(const AABBoxStreams& boxes, VisibilityBits& visibility) const
+{
+	visibility.Resize(boxes.NrOfBoxes);
+	if(boxes.NrOfBoxes == 0)
+		return;
+
+	const float* pCorners[NR_OF_PLANES * 3];
+	for(unsigned int i = 0; i < NR_OF_PLANES; ++i)
+		GetFurthestCorners(boxes, m_Planes[i], pCorners + i * 3);
+
+#if defined(TT_SIMD_AVX)
+	__m256 planes[NR_OF_PLANES * 4];
+	for(unsigned int i = 0; i < NR_OF_PLANES; ++i){
+		planes[i * 4 + 0] = _mm256_set1_ps(m_Planes[i].x);
+		planes[i * 4 + 1] = _mm256_set1_ps(m_Planes[i].y);
+		planes[i * 4 + 2] = _mm256_set1_ps(m_Planes[i].z);
+		planes[i * 4 + 3] = _mm256_set1_ps(m_Planes[i].w);
+	}
+#elif defined(TT_SIMD_SSE)
+	__m128 planes[NR_OF_PLANES * 4];
+	for(unsigned int i = 0; i < NR_OF_PLANES; ++i){
+		planes[i * 4 + 0] = _mm_set1_ps(m_Planes[i].x);
+		planes[i * 4 + 1] = _mm_set1_ps(m_Planes[i].y);
+		planes[i * 4 + 2] = _mm_set1_ps(m_Planes[i].z);
+		planes[i * 4 + 3] = _mm_set1_ps(m_Planes[i].w);
+	}
+#endif
+
+	//The streams are padded to whole packets, bits of the padding are dropped
+	for(unsigned int first = 0; first < boxes.NrOfBoxes; first += RAY_PACKET_SIZE){
+		unsigned int nrOfLanes = min(RAY_PACKET_SIZE, boxes.NrOfBoxes - first);
+		unsigned int bits = 0;
+
+#if defined(TT_SIMD_AVX)
+		bits = CullBoxBlock8(pCorners, planes, first);
+#elif defined(TT_SIMD_SSE)
+		bits = CullBoxBlock4(pCorners, planes, first) | CullBoxBlock4(pCorners, planes, first + 4) << 4;
+#else
+		bits = (1 << nrOfLanes) - 1;
+		for(unsigned int i = 0; i < NR_OF_PLANES; ++i){
+			const float* const* ppCorner = pCorners + i * 3;
+			const tt::Vector4& plane = m_Planes[i];
+			for(unsigned int lane = 0, box = first; lane < nrOfLanes; ++lane, ++box)
+				if(plane.x * ppCorner[0][box] + plane.y * ppCorner[1][box] + plane.z * ppCorner[2][box] + plane.w < 0.0f)
+					bits &= ~(1 << lane);
+		}
+#endif
+
+		SetBits(visibility, first, bits & ( (1u << nrOfLanes) - 1) );
+	}
+}
+
+void Frustum::Cull(const float* pCenterX, const float* pCenterY, const float* pCenterZ, const float* pRadius, unsigned int nrOfSpheres
+				  ,VisibilityBits& visibility) const
+{
+	visibility.Resize(nrOfSpheres);
+	unsigned int i = 0;
+
+#ifdef TT_SIMD_SSE
+	__m128 planes[NR_OF_PLANES * 4];
+	for(unsigned int p = 0; p < NR_OF_PLANES; ++p){
+		planes[p * 4 + 0] = _mm_set1_ps(m_Planes[p].x);
+		planes[p * 4 + 1] = _mm_set1_ps(m_Planes[p].y);
+		planes[p * 4 + 2] = _mm_set1_ps(m_Planes[p].z);
+		planes[p * 4 + 3] = _mm_set1_ps(m_Planes[p].w);
+	}
+
+	for(; i + 4 <= nrOfSpheres; i += 4)
+		SetBits(visibility, i, CullSphereBlock4(pCenterX, pCenterY, pCenterZ, pRadius, planes, i) );
+#endif
+
+	for(; i < nrOfSpheres; ++i)
+		if(IsVisible(tt::Vector3(pCenterX[i], pCenterY[i], pCenterZ[i]), pRadius[i]) )
+			SetBits(visibility, i, 1);
+}
+
+const tt::Vector4& Frustum::GetPlane(unsigned int index) const
+{
+	return m_Planes[index];
+}
@@ -0,0 +1,60 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "RayPacket.h"
+
+//Planes of a view frustum, tested against the bounds of many objects at once. GameScene builds one from the active camera every
+//frame and culls the world bounds of all models submitted to it in a single pass (see GameScene::SubmitRenderable). Boxes are
+//tested with the corner furthest along each plane normal, spheres with their center and radius, 8 boxes or 4 spheres at a time
+//with AVX or SSE and one at a time without SIMD. The tests are conservative: bounds near an edge of the frustum can pass while
+//outside of it, bounds that overlap it never fail, however many of its planes they cross.
+
+//One bit per object, bit i % 32 of word i / 32
+struct VisibilityBits
+{
+	std::vector<unsigned int> Words;
+
+	//Clears every bit
+	void Resize(unsigned int nrOfBits);
+	bool IsSet(unsigned int index) const;
+};
+
+class Frustum
+{
+public:
+	static const unsigned int NR_OF_PLANES = 6;
+
+	//Planes of the clip volume of the matrix, in the space it transforms from: world space for view * projection,
+	//model space for world * view * projection
+	explicit Frustum(const tt::Matrix4x4& viewProjection);
+
+	bool IsVisible(const AABBox& box) const;
+	bool IsVisible(const tt::Vector3& center, float radius) const;
+
+	//Sets the bit of every box or sphere that can be visible and clears the others
+	void Cull(const AABBoxStreams& boxes, VisibilityBits& visibility) const;
+	void Cull(const float* pCenterX, const float* pCenterY, const float* pCenterZ, const float* pRadius, unsigned int nrOfSpheres
+			 ,VisibilityBits& visibility) const;
+
+	//Unit normal pointing inward in xyz, distance term in w
+	const tt::Vector4& GetPlane(unsigned int index) const;
+
+private:
+	tt::Vector4 m_Planes[NR_OF_PLANES];
+};
@@ -1,104 +1,454 @@
 #include "MeshAnimator.h"
-#include "Model3D.h"
-#include "../Services/ServiceLocator.h"
+#include "AnimationData.h"
+#include "AnimationKernels.h"
+#include "AnimationSystem.h"
 
-MeshAnimator::MeshAnimator(void):m_pModel(nullptr)
+void MeshAnimator::AnimationLayer::Swap(AnimationLayer& other)
+{
+	std::swap(pClip, other.pClip);
+	std::swap(Weight, other.Weight);
+	std::swap(TargetWeight, other.TargetWeight);
+	std::swap(FadeSpeed, other.FadeSpeed);
+	std::swap(Tick, other.Tick);
+	std::swap(KeyCursor, other.KeyCursor);
+	TrackCursors.swap(other.TrackCursors);
+}
+
+MeshAnimator::MeshAnimator(void):m_pAnimationData(nullptr)
+								,m_pCurrentClip(nullptr)
+								,m_TimeOffset(0)
+								,m_PoseTick(0)
+								,m_PoseSerial(0)
+								,m_UpdateInterval(1)
+								,m_FramesSinceEvaluation(0)
+								,m_bReducedSkeleton(false)
+								,m_NrOfLayers(0)
 {	
-	m_CurrentClip.Name = _T("");
-	m_CurrentClip.KeysPerSecond = 0;
+
 }
 
 MeshAnimator::~MeshAnimator(void)
 {
+	AnimationSystem::Remove(this);
+}
 
+const AnimationClip* MeshAnimator::FindClip(const std::tstring& name) const
+{
+	//Clips are owned by the model and never change after loading, so they are referenced rather than copied
+	return m_pAnimationData ? m_pAnimationData->FindClip(name) : nullptr;
+}
+
+MeshAnimator::AnimationLayer& MeshAnimator::GetLayer(const AnimationClip* pClip)
+{
+	for(unsigned int i = 0; i < m_NrOfLayers; ++i)
+		if(m_Layers[i].pClip == pClip)
+			return m_Layers[i];
+
+	//Take the slot of a finished layer if there is one
+	if(m_NrOfLayers == m_Layers.size() )
+		m_Layers.push_back(AnimationLayer() );
+
+	AnimationLayer& layer = m_Layers[m_NrOfLayers++];
+	layer.pClip = pClip;
+	layer.Weight = layer.TargetWeight = layer.FadeSpeed = 0;
+	layer.Tick = 0;
+	layer.KeyCursor = 0;
+	layer.TrackCursors.assign(pClip->Compressed.GetNrOfTracks(), 0);
+	return layer;
 }
 
 // Determine which animation clip should be played.
 bool MeshAnimator::SetAnimationClip(const std::tstring& name)
 {
-	auto it = find_if(m_pModel->m_AnimClips.begin(), m_pModel->m_AnimClips.end(), [&](AnimationClip thisClip){
-		return thisClip.Name == name;
-	});
+	const AnimationClip* pClip = FindClip(name);
+	if(!pClip)
+		return false;
+
+	m_NrOfLayers = 0;
+	AnimationLayer& layer = GetLayer(pClip);
+	layer.Weight = layer.TargetWeight = 1;
+	m_pCurrentClip = pClip;
+	return true;
+}
 
-	if(it == m_pModel->m_AnimClips.end())
+bool MeshAnimator::CrossFade(const std::tstring& name, float seconds)
+{
+	const AnimationClip* pClip = FindClip(name);
+	if(!pClip)
 		return false;
-	else{
-		m_CurrentClip = *it;
-		return true;
+
+	if(seconds <= 0 || m_NrOfLayers == 0)
+		return SetAnimationClip(name);
+
+	//All layers reach their target at the same time
+	GetLayer(pClip);
+	for(unsigned int i = 0; i < m_NrOfLayers; ++i){
+		AnimationLayer& layer = m_Layers[i];
+		layer.TargetWeight = (layer.pClip == pClip) ? 1.0f : 0.0f;
+		layer.FadeSpeed = fabs(layer.TargetWeight - layer.Weight) / seconds;
 	}
+
+	m_pCurrentClip = pClip;
+	return true;
 }
 
-tt::Vector3 ToVec3(const tt::Quaternion& q)
+bool MeshAnimator::SetLayerWeight(const std::tstring& name, float weight, float fadeSeconds)
 {
-	return tt::Vector3(q.x, q.y, q.z);
+	const AnimationClip* pClip = FindClip(name);
+	if(!pClip)
+		return false;
+
+	AnimationLayer& layer = GetLayer(pClip);
+	layer.TargetWeight = max(weight, 0.0f);
+	if(fadeSeconds > 0)
+		layer.FadeSpeed = fabs(layer.TargetWeight - layer.Weight) / fadeSeconds;
+	else
+		layer.Weight = layer.TargetWeight;
+
+	if(!m_pCurrentClip)
+		m_pCurrentClip = pClip;
+	return true;
 }
 
-tt::Quaternion ExtractPos(const tt::DualQuaternion& dq)
+unsigned int MeshAnimator::GetNrOfLayers(void) const
 {
-	return tt::Quaternion::Inverse(dq.Data[0]) * (dq.Data[1]*2);
+	return m_NrOfLayers;
 }
 
-tt::DualQuaternion Combine(const tt::DualQuaternion& lhs, const tt::DualQuaternion& rhs)
+bool MeshAnimator::IsBlending(void) const
 {
-	//Example: lhs = invBindpose, rhs = transform
-	return tt::DualQuaternion(lhs.Data[0] * rhs.Data[0]*-1, ToVec3(tt::Quaternion::Inverse(rhs.Data[0]) * ExtractPos(lhs) * rhs.Data[0] + ExtractPos(rhs)));
+	return m_NrOfLayers > 1;
 }
 
-//Calculate the bonetransforms
-void MeshAnimator::Update(const tt::GameContext& context)
+void MeshAnimator::UpdateLayers(float elapsedSeconds)
 {
-	float currentTick = context.GameTimer.GetTotalSeconds() * m_CurrentClip.KeysPerSecond;
-	
-	//Get remainder of currentTick and clipDuration
-	float clipDuration = (m_CurrentClip.Keys.end()-1)->KeyTime - m_CurrentClip.Keys.begin()->KeyTime;
-	float targetTick = currentTick - ((int)(currentTick/clipDuration)) * clipDuration;
-	
-	//Get animation tick after target tick
-	auto itNextTick = find_if(m_CurrentClip.Keys.begin(), m_CurrentClip.Keys.end(), [=](const AnimationKey& thisKey){
-		return thisKey.KeyTime > targetTick;
+	for(unsigned int i = 0; i < m_NrOfLayers; ){
+		AnimationLayer& layer = m_Layers[i];
+		float step = layer.FadeSpeed * elapsedSeconds;
+		layer.Weight = layer.Weight < layer.TargetWeight ? min(layer.Weight + step, layer.TargetWeight) : max(layer.Weight - step, layer.TargetWeight);
+
+		//Faded out layers move behind the active ones, their memory is reused by the next transition.
+		//The current clip keeps its layer, Evaluate falls back to it when no layer has any weight.
+		if(layer.Weight <= 0 && layer.TargetWeight <= 0 && layer.pClip != m_pCurrentClip){
+			layer.Swap(m_Layers[--m_NrOfLayers]);
+			continue;
+		}
+		++i;
+	}
+}
+
+//Returns the index of the first key after targetTick, or the number of keys if there is none
+unsigned int MeshAnimator::FindNextKey(AnimationLayer& layer, float targetTick)
+{
+	const auto& keys = layer.pClip->Keys;
+	unsigned int& cursor = layer.KeyCursor;
+
+	//Regular playback moves at most a few keys per frame, so step the cursor forward from where it was
+	if(cursor < keys.size() && (cursor == 0 || keys[cursor-1].KeyTime <= targetTick)){
+		for(unsigned int step = 0; step < MAX_CURSOR_STEPS; ++step, ++cursor)
+			if(cursor == keys.size() || keys[cursor].KeyTime > targetTick)
+				return cursor;
+	}
+
+	//Seeking (looping, time jumps, low framerates): binary search over the whole clip
+	auto itNext = upper_bound(keys.begin(), keys.end(), targetTick, [](float tick, const AnimationKey& key){
+		return tick < key.KeyTime;
 	});
 
+	cursor = itNext - keys.begin();
+	return cursor;
+}
+
+bool MeshAnimator::FindKeys(AnimationLayer& layer, unsigned int& prevKey, unsigned int& nextKey, float& blendFactor)
+{
+	const auto& keys = layer.pClip->Keys;
+
+	//Get animation tick after target tick
+	nextKey = FindNextKey(layer, layer.Tick);
+	if(nextKey == keys.size())
+		return false;
+
 	//Get animation tick before target tick
-	std::vector<AnimationKey>::iterator itPrevTick;
-	if(itNextTick == m_CurrentClip.Keys.end())
-		MyServiceLocator::GetInstance()->GetService<DebugService>()->Log(_T("Failed to find next animation tick."), LogLevel::Error);
-	else if(itNextTick == m_CurrentClip.Keys.begin())
-		itPrevTick = m_CurrentClip.Keys.end()-1;
-	else 
-		itPrevTick = itNextTick - 1;
+	prevKey = (nextKey == 0) ? keys.size()-1 : nextKey-1;
 
 	//Lerp between transformations of previous and next animation tick
-	float blendFactor = (targetTick - itPrevTick->KeyTime) / (itNextTick->KeyTime - itPrevTick->KeyTime);
-	
-	m_BoneTransforms.resize(itPrevTick->BoneTransforms.size());
-	m_DualQuats.resize(m_BoneTransforms.size());
+	blendFactor = (layer.Tick - keys[prevKey].KeyTime) / (keys[nextKey].KeyTime - keys[prevKey].KeyTime);
+	return true;
+}
 
-	for(UINT i = 0; i < itPrevTick->BoneTransforms.size(); ++i)
-	{		
-		tt::DualQuaternion bindposeInv = tt::DualQuaternion::Inverse(m_pModel->m_Skeleton[i].BindPose)*-1;
+const tt::DualQuaternion* MeshAnimator::GatherReducedKey(const AnimationKey& key, unsigned int half)
+{
+	const auto& reducedBones = m_pAnimationData->ReducedBones;
+	unsigned int nrOfBones = reducedBones.size();
+	m_KeyScratch.resize(2 * nrOfBones);
+
+	tt::DualQuaternion* pDest = m_KeyScratch.data() + half * nrOfBones;
+	for(unsigned int i = 0; i < nrOfBones; ++i)
+		pDest[i] = key.BoneTransforms[reducedBones[i]];
+	return pDest;
+}
+
+//Calculate the bonetransforms
+bool MeshAnimator::Update(float totalSeconds, float elapsedSeconds)
+{
+	float targetTick;
+	bool bSucceeded = !BeginFrame(totalSeconds, elapsedSeconds, targetTick) || Evaluate(targetTick);
+
+	EndFrame();
+	return bSucceeded;
+}
+
+bool MeshAnimator::BeginFrame(float totalSeconds, float elapsedSeconds, float& targetTick)
+{
+	UpdateLayers(elapsedSeconds);
+	if(!m_pCurrentClip || m_pCurrentClip->Keys.empty())
+		return false;
+
+	float timeAhead = 0;
+
+	//Frozen, only evaluate once so there is a pose to draw
+	if(m_UpdateInterval == 0){
+		if(!m_DualQuats.empty() )
+			return false;
+	}
+	else if(m_UpdateInterval > 1){
+		if(++m_FramesSinceEvaluation < m_UpdateInterval && !m_LODTo.empty() )
+			return false;
+
+		//The pose reached at the end of an interval is where the next one starts, or the current pose when entering this LOD
+		m_FramesSinceEvaluation = 0;
+		if(m_LODTo.empty() )
+			m_LODTo = m_DualQuats;
+		swap(m_LODFrom, m_LODTo);
+
+		//Evaluate where the animation will be at the end of the interval
+		timeAhead = m_UpdateInterval * elapsedSeconds;
+	}
+
+	for(unsigned int i = 0; i < m_NrOfLayers; ++i)
+		m_Layers[i].Tick = GetClipTick(m_Layers[i].pClip, totalSeconds, timeAhead);
+
+	targetTick = GetClipTick(totalSeconds, timeAhead);
+	return true;
+}
+
+void MeshAnimator::EndFrame(void)
+{
+	if(m_UpdateInterval < 2)
+		return;
+
+	if(m_FramesSinceEvaluation == 0){
+		m_LODTo = m_DualQuats;
+		if(m_LODFrom.size() != m_LODTo.size() )
+			m_LODFrom = m_LODTo;
+	}
+
+	++m_PoseSerial;
+	m_DualQuats.resize(m_LODTo.size() );
+	InterpolatePalettes(m_LODFrom.data(), m_LODTo.data(), static_cast<float>(m_FramesSinceEvaluation) / m_UpdateInterval
+					   ,m_DualQuats.data(), m_DualQuats.size() );
+}
+
+float MeshAnimator::GetClipTick(float totalSeconds, float timeAhead) const
+{
+	return GetClipTick(m_pCurrentClip, totalSeconds, timeAhead);
+}
+
+float MeshAnimator::GetClipTick(const AnimationClip* pClip, float totalSeconds, float timeAhead) const
+{
+	if(!pClip || pClip->Keys.empty())
+		return 0;
+
+	const auto& keys = pClip->Keys;
+	float currentTick = (totalSeconds + m_TimeOffset + timeAhead) * pClip->KeysPerSecond;
 	
-		auto trans1 = itPrevTick->BoneTransforms[i];
-		auto trans2 = itNextTick->BoneTransforms[i];
+	//Get remainder of currentTick and clipDuration
+	float clipDuration = (keys.end()-1)->KeyTime - keys.begin()->KeyTime;
+	float targetTick = currentTick - ((int)(currentTick/clipDuration)) * clipDuration;
 	
-		auto dlb = tt::DualQuaternion::DLB(trans1, trans2, blendFactor);
-		
-		m_DualQuats[i] = Combine(bindposeInv, dlb);
+	//Negative offsets can put us before the start of the clip
+	if(targetTick < 0)
+		targetTick += clipDuration;
+
+	return targetTick;
+}
+
+bool MeshAnimator::Evaluate(float targetTick)
+{
+	if(!m_pCurrentClip || m_pCurrentClip->Keys.empty())
+		return true;
+
+	m_PoseTick = targetTick;
+	++m_PoseSerial;
+
+	//Reduced LOD, only the bones of the reduced skeleton are evaluated and the others copy theirs
+	bool bReduced = UsesReducedSkeleton();
+	unsigned int nrOfBones = bReduced ? m_pAnimationData->ReducedBones.size() : m_pAnimationData->Skeleton.size();
+	const InverseBindPoses& bindPoses = bReduced ? m_pAnimationData->ReducedBindPoses : m_pAnimationData->BindPoses;
+	auto& palette = bReduced ? m_ReducedPalette : m_DualQuats;
+	palette.resize(nrOfBones);
+
+	//Layers contributing to the pose, the tick of the current clip may have been snapped by the pose cache
+	m_ActiveLayers.clear();
+	m_LayerWeights.clear();
+	unsigned int currentLayer = m_NrOfLayers;
+	for(unsigned int i = 0; i < m_NrOfLayers; ++i){
+		AnimationLayer& layer = m_Layers[i];
+		if(layer.pClip == m_pCurrentClip){
+			layer.Tick = targetTick;
+			currentLayer = i;
+		}
+
+		if(layer.Weight > 0 && !layer.pClip->Keys.empty() ){
+			m_ActiveLayers.push_back(i);
+			m_LayerWeights.push_back(layer.Weight);
+		}
+	}
+
+	//Everything is fading in from zero, show the current clip
+	if(m_ActiveLayers.empty() ){
+		if(currentLayer == m_NrOfLayers)
+			return true;
+
+		m_ActiveLayers.push_back(currentLayer);
+		m_LayerWeights.push_back(1);
+	}
+
+	AnimationLayer& firstLayer = m_Layers[m_ActiveLayers[0]];
+	if(m_ActiveLayers.size() == 1 && !m_pAnimationData->HasBoneHierarchy() && firstLayer.pClip->Compressed.IsEmpty() ){
+		unsigned int prevKey, nextKey;
+		float blendFactor;
+		if(!FindKeys(firstLayer, prevKey, nextKey, blendFactor) )
+			return false;
+
+		const auto& keys = firstLayer.pClip->Keys;
+		const tt::DualQuaternion* pPrevKey = bReduced ? GatherReducedKey(keys[prevKey], 0) : keys[prevKey].BoneTransforms.data();
+		const tt::DualQuaternion* pNextKey = bReduced ? GatherReducedKey(keys[nextKey], 1) : keys[nextKey].BoneTransforms.data();
+
+		//DLB between both keys, combined with the inverse bind pose, for all bones at once
+		BlendSkinningPalette(pPrevKey, pNextKey, blendFactor, bindPoses, palette.data(), nrOfBones);
+	}
+	else{
+		//Sample every layer into its own pose, then blend them all in one pass
+		m_LayerPoses.resize(m_ActiveLayers.size() * nrOfBones);
+		for(unsigned int i = 0; i < m_ActiveLayers.size(); ++i)
+			if(!SampleLayer(m_Layers[m_ActiveLayers[i]], bReduced, m_LayerPoses.data() + i * nrOfBones) )
+				return false;
+
+		if(m_ActiveLayers.size() > 1)
+			BlendPoses(m_LayerPoses.data(), m_LayerWeights.data(), m_ActiveLayers.size(), m_LayerPoses.data(), nrOfBones);
+
+		const tt::DualQuaternion* pModelPose = m_LayerPoses.data();
+		if(m_pAnimationData->HasBoneHierarchy() ){
+			const auto& parents = bReduced ? m_pAnimationData->ReducedParents : m_pAnimationData->BoneParents;
+			m_ModelPose.resize(nrOfBones);
+			LocalToModel(m_LayerPoses.data(), parents.data(), m_ModelPose.data(), nrOfBones);
+			pModelPose = m_ModelPose.data();
+		}
+
+		BuildSkinningPalette(pModelPose, bindPoses, palette.data(), nrOfBones);
+	}
+
+	if(bReduced)
+		ExpandReducedPalette();
+
+	return true;
+}
+
+bool MeshAnimator::SampleLayer(AnimationLayer& layer, bool bReduced, tt::DualQuaternion* pPose)
+{
+	unsigned int prevKey, nextKey;
+	float blendFactor;
+	if(!FindKeys(layer, prevKey, nextKey, blendFactor) )
+		return false;
+
+	const auto& reducedBones = m_pAnimationData->ReducedBones;
+	unsigned int nrOfBones = bReduced ? reducedBones.size() : m_pAnimationData->Skeleton.size();
+
+	//Every track of a compressed clip has its own keys
+	if(!layer.pClip->Compressed.IsEmpty()){
+		if(bReduced)
+			layer.pClip->Compressed.Sample(layer.Tick, prevKey, reducedBones.data(), nrOfBones, layer.TrackCursors.data(), pPose);
+		else
+			layer.pClip->Compressed.Sample(layer.Tick, prevKey, layer.TrackCursors.data(), pPose);
+		return true;
 	}
-		
+
+	const auto& keys = layer.pClip->Keys;
+	const tt::DualQuaternion* pPrevKey = bReduced ? GatherReducedKey(keys[prevKey], 0) : keys[prevKey].BoneTransforms.data();
+	const tt::DualQuaternion* pNextKey = bReduced ? GatherReducedKey(keys[nextKey], 1) : keys[nextKey].BoneTransforms.data();
+	InterpolatePalettes(pPrevKey, pNextKey, blendFactor, pPose, nrOfBones);
+	return true;
 }
-#include "../Graphics/Materials/DebugMaterial.h"
 //currently empty, can be used to visualize bone transforms later
 void MeshAnimator::Draw(const tt::GameContext& context)
 {/*
+	#include "../Graphics/Materials/DebugMaterial.h"
 	auto pModel = MyServiceLocator::GetInstance()->GetService<ResourceService>()->Load<Model3D>(_T("Resources/bone.bin"));
 	auto pMat = MyServiceLocator::GetInstance()->GetService<ResourceService>()->Load<DebugMaterial>(_T("BoneMat"));
 	for(auto& bone : m_BoneTransforms)
 		MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->Draw(pModel, tt::Matrix4x4(bone), pMat, context);*/
 }
 
-void MeshAnimator::SetModel(Model3D* pModel)
+void MeshAnimator::ExpandReducedPalette(void)
+{
+	const auto& boneMap = m_pAnimationData->ReducedBoneMap;
+	m_DualQuats.resize(boneMap.size() );
+
+	for(unsigned int bone = 0; bone < boneMap.size(); ++bone)
+		m_DualQuats[bone] = m_ReducedPalette[boneMap[bone]];
+}
+
+void MeshAnimator::CopyPose(const MeshAnimator& src)
+{
+	m_BoneTransforms = src.m_BoneTransforms;
+	m_DualQuats = src.m_DualQuats;
+	m_PoseTick = src.m_PoseTick;
+	++m_PoseSerial;
+}
+
+void MeshAnimator::SetLOD(unsigned int updateInterval, bool bReducedSkeleton)
+{
+	m_bReducedSkeleton = bReducedSkeleton;
+
+	if(updateInterval == m_UpdateInterval)
+		return;
+
+	//Start a fresh interval from whatever pose is shown now
+	m_UpdateInterval = updateInterval;
+	m_FramesSinceEvaluation = 0;
+	m_LODFrom.clear();
+	m_LODTo.clear();
+}
+
+bool MeshAnimator::UsesReducedSkeleton(void) const
+{
+	return m_bReducedSkeleton && m_pAnimationData && m_pAnimationData->HasReducedSkeleton();
+}
+
+void MeshAnimator::SetTimeOffset(float seconds)
+{
+	m_TimeOffset = seconds;
+}
+
+float MeshAnimator::GetTimeOffset(void) const
+{
+	return m_TimeOffset;
+}
+
+void MeshAnimator::SetAnimationData(const AnimationData* pAnimationData)
 { 
-	m_pModel = pModel; 
+	m_pAnimationData = pAnimationData; 
+}
+
+const AnimationData* MeshAnimator::GetAnimationData(void) const
+{
+	return m_pAnimationData;
+}
+
+const AnimationClip* MeshAnimator::GetAnimationClip(void) const
+{
+	return m_pCurrentClip;
 }
 
 const vector<D3DXMATRIX>& MeshAnimator::GetBoneTransforms(void) const 
@@ -110,3 +460,30 @@ const vector<tt::DualQuaternion>& MeshAnimator::GetDualQuats(void) const
 {
 	return m_DualQuats;
 }
+
+unsigned int MeshAnimator::GetPoseSerial(void) const
+{
+	return m_PoseSerial;
+}
+
+AABBox MeshAnimator::GetAABB(const AABBox& bindPoseBounds) const
+{
+	if(!m_pAnimationData)
+		return bindPoseBounds;
+
+	//A blend stays close to the poses of its layers, the bounds of their clips together cover it
+	if(IsBlending() ){
+		AABBox bounds;
+		for(unsigned int i = 0; i < m_NrOfLayers; ++i){
+			const AABBox* pClipBounds = m_pAnimationData->GetBounds(m_Layers[i].pClip);
+			bounds.Include(pClipBounds ? *pClipBounds : bindPoseBounds);
+		}
+		return bounds;
+	}
+
+	//Interpolated LODs show poses in between two evaluations, and reduced skeletons deviate from the full pose,
+	//the bounds of the whole clip cover both
+	const AABBox* pBounds = (m_UpdateInterval >= 2 || UsesReducedSkeleton() ) ? m_pAnimationData->GetBounds(m_pCurrentClip)
+																				: m_pAnimationData->GetBounds(m_pCurrentClip, m_PoseTick);
+	return pBounds ? *pBounds : bindPoseBounds;
+}
@@ -1,20 +1,26 @@
 #pragma once
 
 #include "../Helpers/Namespace.h"
-class Model3D;
+#include "AnimationKernels.h"
+#include "AnimationCompression.h"
+struct AnimationData;
+struct AABBox;
 
 struct Bone
 {
 	tstring Name;
 	//D3DXMATRIX BindPose;
-	tt::DualQuaternion BindPose;
+	tt::DualQuaternion BindPose;	//Model space
+	unsigned int Parent;			//Index in the skeleton, NO_PARENT for roots and skeletons without hierarchy
+
+	static const unsigned int NO_PARENT = 0xFFFFFFFF;
 };
 
 struct AnimationKey
 {
 	float KeyTime;
 	//vector<D3DXMATRIX> BoneTransforms;
-	vector<tt::DualQuaternion> BoneTransforms;
+	vector<tt::DualQuaternion> BoneTransforms; //Relative to the parent bone if the model has a hierarchy (see Model3D::HasBoneHierarchy), model space otherwise
 };
 
 struct AnimationClip
@@ -22,6 +28,15 @@ struct AnimationClip
 	tstring Name;
 	float KeysPerSecond;
 	vector<AnimationKey> Keys;
+	CompressedClip Compressed; //If not empty, the Keys only hold their KeyTime and poses are sampled from here
+};
+
+//Animation level of detail, see ModelComponent::SetAnimationLODs
+struct AnimationLOD
+{
+	float MinScreenSize;			//Level applies while the projected radius of the model is at least this fraction of half the screen height
+	unsigned int UpdateInterval;	//Evaluate a pose every n frames and interpolate in between, 1 is every frame and 0 freezes the pose
+	bool ReducedSkeleton;			//Only evaluate the bones of the model's reduced skeleton (see Model3D::SetReducedSkeleton)
 };
 
 class MeshAnimator final
@@ -30,30 +45,121 @@ public:
 	MeshAnimator(void);
 	~MeshAnimator(void);
 
-	// Determine which animation clip should be played.
+	// Determine which animation clip should be played, stops all other layers.
 	bool SetAnimationClip(const std::tstring& name);
+	//Fades the clip in over the given time while all other layers fade out, it becomes the current clip
+	bool CrossFade(const std::tstring& name, float seconds);
+	//Plays the clip as a layer and fades its weight to the given value, blending it with the other layers.
+	//Layers are removed once they faded out to 0, except for the current clip's. All layers play at the same time, each looping its own clip.
+	bool SetLayerWeight(const std::tstring& name, float weight, float fadeSeconds = 0);
+	unsigned int GetNrOfLayers(void) const;
+	//More than one layer, the pose is a blend and can't be shared with other animators (see AnimationSystem)
+	bool IsBlending(void) const;
+	
+	//Calculate the bonetransforms, only touches this animator so it can run on any thread (see AnimationSystem).
+	//Takes the game time in seconds, returns false if the keys around the tick can't be found.
+	bool Update(float totalSeconds, float elapsedSeconds);
+
+	//Update split in steps: BeginFrame advances the LOD schedule and returns whether a pose has to be evaluated
+	//this frame, and at which tick. The pose is then either evaluated or copied from another animator,
+	//EndFrame fills in the frames between evaluations of interpolated LODs.
+	bool BeginFrame(float totalSeconds, float elapsedSeconds, float& targetTick);
+	void EndFrame(void);
+	
+	//Calculate the bonetransforms for a position in the current clip, in ticks. Other layers are evaluated at the ticks set by BeginFrame.
+	//Returns false if the keys around a tick can't be found, the pose is then left as it was. Doesn't log, so it can run on any thread.
+	bool Evaluate(float targetTick);
+	//Take over the bonetransforms another animator evaluated for the same clip and time
+	void CopyPose(const MeshAnimator& src);
+	
+	//Returns the position in the current clip, in ticks, at the game time plus the time offset and timeAhead (all in seconds)
+	float GetClipTick(float totalSeconds, float timeAhead = 0) const;
+
+	//Set by ModelComponent from the active AnimationLOD
+	void SetLOD(unsigned int updateInterval, bool bReducedSkeleton);
+	bool UsesReducedSkeleton(void) const;
 	
-	//Calculate the bonetransforms
-	void Update(const tt::GameContext& context);
+	//Offset (in seconds) added to the game time, so instances playing the same clip don't move in lockstep
+	void SetTimeOffset(float seconds);
+	float GetTimeOffset(void) const;
 	//currently empty, can be used to visualize bone transforms later
 	void Draw(const tt::GameContext& context);
 
-	// Set the mesh filter
-	void SetModel(Model3D* pModel);
+	//Set the skeleton and clips to play, owned by the model (see Model3D::GetAnimationData)
+	void SetAnimationData(const AnimationData* pAnimationData);
+	const AnimationData* GetAnimationData(void) const;
+	
+	//Returns the current clip, the one last set or crossfaded to. nullptr if none was set.
+	const AnimationClip* GetAnimationClip(void) const;
 
 	// return the bone transforms
 	const vector<D3DXMATRIX>& GetBoneTransforms(void) const;
 
 	//return the dual quaternions
 	const vector<tt::DualQuaternion>& GetDualQuats(void) const;
+	//Changes every time the dual quaternions do, so data derived from a pose can be cached until the next one (see PickComponent)
+	unsigned int GetPoseSerial(void) const;
+
+	//Bounds of the model in the pose that is shown, see Model3D::GetAABB. Clips without animated bounds use bindPoseBounds.
+	AABBox GetAABB(const AABBox& bindPoseBounds) const;
 
 private:
 	static const int TICKS_PER_SECOND = 2800;
+	//Number of keys the playback cursor may step over before falling back to a binary search
+	static const unsigned int MAX_CURSOR_STEPS = 4;
 
-	Model3D* m_pModel;
+	//A clip contributing to the pose, its weight moves towards TargetWeight at FadeSpeed per second
+	struct AnimationLayer
+	{
+		const AnimationClip* pClip;
+		float Weight, TargetWeight, FadeSpeed;
+		float Tick;
+		unsigned int KeyCursor;
+		std::vector<unsigned int> TrackCursors; //Compressed clip playback state
+		
+		//Exchanges the cursor memory rather than copying it
+		void Swap(AnimationLayer& other);
+	};
+
+	const AnimationData* m_pAnimationData;
 	std::vector<D3DXMATRIX> m_BoneTransforms;
 	std::vector<tt::DualQuaternion> m_DualQuats;
-	AnimationClip m_CurrentClip;
+	const AnimationClip* m_pCurrentClip;
+	float m_TimeOffset;
+	float m_PoseTick; //Tick of the last evaluated pose
+	unsigned int m_PoseSerial;
+
+	//LOD state, interpolated LODs blend from m_LODFrom to m_LODTo over the update interval
+	unsigned int m_UpdateInterval, m_FramesSinceEvaluation;
+	bool m_bReducedSkeleton;
+	std::vector<tt::DualQuaternion> m_LODFrom, m_LODTo;
+	std::vector<tt::DualQuaternion> m_ReducedPalette;
+	
+	//Layers past m_NrOfLayers have faded out, their slots are reused so transitions don't allocate
+	std::vector<AnimationLayer> m_Layers;
+	unsigned int m_NrOfLayers;
+
+	//Scratch memory of Evaluate, kept between frames
+	std::vector<unsigned int> m_ActiveLayers;
+	std::vector<float> m_LayerWeights;
+	std::vector<tt::DualQuaternion> m_LayerPoses;	//One pose per active layer, back to back, the blend ends up in the first
+	std::vector<tt::DualQuaternion> m_ModelPose;	//Blended pose composed with the bone hierarchy
+	std::vector<tt::DualQuaternion> m_KeyScratch;	//Keys gathered for the reduced skeleton
+
+	const AnimationClip* FindClip(const std::tstring& name) const;
+	//Returns the layer playing the clip, adding one with weight 0 if there is none
+	AnimationLayer& GetLayer(const AnimationClip* pClip);
+	void UpdateLayers(float elapsedSeconds);
+	
+	float GetClipTick(const AnimationClip* pClip, float totalSeconds, float timeAhead) const;
+	unsigned int FindNextKey(AnimationLayer& layer, float targetTick);
+	//Keys around the layer's tick and the blend factor between them, false if there are none
+	bool FindKeys(AnimationLayer& layer, unsigned int& prevKey, unsigned int& nextKey, float& blendFactor);
+	//Copies the transforms of the reduced skeleton's bones to the first or second half of m_KeyScratch
+	const tt::DualQuaternion* GatherReducedKey(const AnimationKey& key, unsigned int half);
+	//Writes the layer's pose at its tick to pPose, local transforms if the model has a hierarchy
+	bool SampleLayer(AnimationLayer& layer, bool bReduced, tt::DualQuaternion* pPose);
+	void ExpandReducedPalette(void);
 
 private:
 	// -------------------------
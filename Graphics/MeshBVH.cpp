@@ -0,0 +1,519 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "MeshBVH.h"
+#include "BoundingVolumes.h"
+#include "RayPacket.h"
+#include "../Helpers/SimdUtil.h"
+
+namespace
+{
+	const unsigned int BVH_BINS = 16;
+	const unsigned int BVH_MAX_DEPTH = 64;
+	const unsigned int BVH_MAX_LEAF_TRIANGLES = 16;
+	//Cost of visiting a node, relative to testing a block of 4 triangles
+	const float BVH_TRAVERSAL_COST = 1.0f;
+	const unsigned int NO_TRIANGLE = UINT_MAX;
+
+	struct BinBounds
+	{
+		float Min[3], Max[3];
+
+		BinBounds(void)
+		{
+			Min[0] = Min[1] = Min[2] = FLT_MAX;
+			Max[0] = Max[1] = Max[2] = -FLT_MAX;
+		}
+
+		void Include(const float* pMin, const float* pMax)
+		{
+			for(unsigned int axis = 0; axis < 3; ++axis){
+				Min[axis] = min(Min[axis], pMin[axis]);
+				Max[axis] = max(Max[axis], pMax[axis]);
+			}
+		}
+
+		float Area(void) const
+		{
+			float dx = Max[0] - Min[0], dy = Max[1] - Min[1], dz = Max[2] - Min[2];
+			return dx < 0 ? 0.0f : 2 * (dx * dy + dy * dz + dz * dx);
+		}
+	};
+
+	unsigned int NrOfBlocks(unsigned int nrOfTriangles)
+	{
+		return (nrOfTriangles + 3) / 4;
+	}
+
+#ifndef TT_SIMD_SSE
+	//Moller-Trumbore on one slot of a block, double sided
+	bool IntersectTriangle(const TriangleBlock& block, unsigned int lane, const float* pOrigin, const float* pDirection, float maxDistance
+						  ,float& t, float& u, float& v)
+	{
+		tt::Vector3 edge1(block.Edge1[0][lane], block.Edge1[1][lane], block.Edge1[2][lane]);
+		tt::Vector3 edge2(block.Edge2[0][lane], block.Edge2[1][lane], block.Edge2[2][lane]);
+		tt::Vector3 direction(pDirection[0], pDirection[1], pDirection[2]);
+
+		tt::Vector3 p = direction.Cross(edge2);
+		float det = edge1.Dot(p);
+		if(det == 0.0f)
+			return false;
+
+		float invDet = 1.0f / det;
+		tt::Vector3 toOrigin(pOrigin[0] - block.V0[0][lane], pOrigin[1] - block.V0[1][lane], pOrigin[2] - block.V0[2][lane]);
+		u = toOrigin.Dot(p) * invDet;
+		if(u < 0.0f || u > 1.0f)
+			return false;
+
+		tt::Vector3 q = toOrigin.Cross(edge1);
+		v = direction.Dot(q) * invDet;
+		if(v < 0.0f || u + v > 1.0f)
+			return false;
+
+		t = edge2.Dot(q) * invDet;
+		return t >= 0.0f && t < maxDistance;
+	}
+#else
+	//Bit i is set if slot i is hit closer than maxDistance, with the results of every lane in pT, pU and pV
+	int IntersectBlock(const TriangleBlock& block, const __m128* pOrigin, const __m128* pDirection, float maxDistance, float* pT, float* pU, float* pV)
+	{
+		__m128 e1x = _mm_loadu_ps(block.Edge1[0]), e1y = _mm_loadu_ps(block.Edge1[1]), e1z = _mm_loadu_ps(block.Edge1[2]);
+		__m128 e2x = _mm_loadu_ps(block.Edge2[0]), e2y = _mm_loadu_ps(block.Edge2[1]), e2z = _mm_loadu_ps(block.Edge2[2]);
+		const __m128 &dx = pDirection[0], &dy = pDirection[1], &dz = pDirection[2];
+
+		__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+		__m128 det = SimdMulAdd(e1x, px, SimdMulAdd(e1y, py, _mm_mul_ps(e1z, pz)));
+		__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		__m128 tx = _mm_sub_ps(pOrigin[0], _mm_loadu_ps(block.V0[0]));
+		__m128 ty = _mm_sub_ps(pOrigin[1], _mm_loadu_ps(block.V0[1]));
+		__m128 tz = _mm_sub_ps(pOrigin[2], _mm_loadu_ps(block.V0[2]));
+		__m128 u = _mm_mul_ps(SimdMulAdd(tx, px, SimdMulAdd(ty, py, _mm_mul_ps(tz, pz))), invDet);
+
+		__m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+		__m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+		__m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+		__m128 v = _mm_mul_ps(SimdMulAdd(dx, qx, SimdMulAdd(dy, qy, _mm_mul_ps(dz, qz))), invDet);
+		__m128 t = _mm_mul_ps(SimdMulAdd(e2x, qx, SimdMulAdd(e2y, qy, _mm_mul_ps(e2z, qz))), invDet);
+
+		__m128 zero = _mm_setzero_ps();
+		__m128 hit = _mm_and_ps(_mm_cmpneq_ps(det, zero), _mm_cmpge_ps(u, zero));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+		hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(t, zero));
+		hit = _mm_and_ps(hit, _mm_cmplt_ps(t, _mm_set1_ps(maxDistance)));
+
+		_mm_storeu_ps(pT, t);
+		_mm_storeu_ps(pU, u);
+		_mm_storeu_ps(pV, v);
+		return _mm_movemask_ps(hit);
+	}
+#endif
+
+	//Tests every triangle of a leaf, closer hits than closest replace it and the slot and coordinates of the hit
+	void IntersectLeaf(const std::vector<TriangleBlock>& blocks, const BVHNode& leaf, const float* pOrigin, const float* pDirection
+					  ,float& closest, unsigned int& closestSlot, float& closestU, float& closestV)
+	{
+#ifdef TT_SIMD_SSE
+		__m128 origin[3] = {_mm_set1_ps(pOrigin[0]), _mm_set1_ps(pOrigin[1]), _mm_set1_ps(pOrigin[2])};
+		__m128 direction[3] = {_mm_set1_ps(pDirection[0]), _mm_set1_ps(pDirection[1]), _mm_set1_ps(pDirection[2])};
+#endif
+
+		for(unsigned int blockIndex = leaf.Offset; blockIndex < leaf.Offset + NrOfBlocks(leaf.NrOfTriangles); ++blockIndex){
+			const TriangleBlock& block = blocks[blockIndex];
+#ifdef TT_SIMD_SSE
+			float t[4], u[4], v[4];
+			int hitMask = IntersectBlock(block, origin, direction, closest, t, u, v);
+			for(unsigned int lane = 0; hitMask != 0; ++lane, hitMask >>= 1){
+				if( (hitMask & 1) && t[lane] < closest){
+					closest = t[lane];
+					closestSlot = blockIndex * 4 + lane;
+					closestU = u[lane];
+					closestV = v[lane];
+				}
+			}
+#else
+			for(unsigned int lane = 0; lane < 4; ++lane){
+				float t, u, v;
+				if(IntersectTriangle(block, lane, pOrigin, pDirection, closest, t, u, v) ){
+					closest = t;
+					closestSlot = blockIndex * 4 + lane;
+					closestU = u;
+					closestV = v;
+				}
+			}
+#endif
+		}
+	}
+}
+
+//Triangle as the build sorts it, kept together so every pass over a node reads memory in order
+struct MeshBVH::BuildTriangle
+{
+	float Min[3], Max[3], Centroid[3];
+	unsigned int Index;
+};
+
+MeshBVH::MeshBVH(void):m_Depth(0)
+{
+}
+
+MeshBVH::~MeshBVH(void)
+{
+}
+
+void MeshBVH::Build(const unsigned int* pIndices, unsigned int nrOfIndices, const float* pPositions, unsigned int positionStride)
+{
+	m_Nodes.clear();
+	m_BlockTriangles.clear();
+	m_Indices.assign(pIndices, pIndices + nrOfIndices - nrOfIndices % 3);
+	m_Depth = 0;
+
+	unsigned int nrOfTriangles = m_Indices.size() / 3;
+	if(nrOfTriangles == 0){
+		m_Blocks.clear();
+		return;
+	}
+
+	vector<BuildTriangle> triangles(nrOfTriangles);
+	for(unsigned int tri = 0; tri < nrOfTriangles; ++tri){
+		BuildTriangle& triangle = triangles[tri];
+		triangle.Index = tri;
+		for(unsigned int axis = 0; axis < 3; ++axis){
+			triangle.Min[axis] = FLT_MAX;
+			triangle.Max[axis] = -FLT_MAX;
+		}
+
+		for(unsigned int corner = 0; corner < 3; ++corner){
+			const float* pPosition = reinterpret_cast<const float*>(reinterpret_cast<const char*>(pPositions) + m_Indices[tri * 3 + corner] * positionStride);
+			for(unsigned int axis = 0; axis < 3; ++axis){
+				triangle.Min[axis] = min(triangle.Min[axis], pPosition[axis]);
+				triangle.Max[axis] = max(triangle.Max[axis], pPosition[axis]);
+			}
+		}
+
+		for(unsigned int axis = 0; axis < 3; ++axis)
+			triangle.Centroid[axis] = (triangle.Min[axis] + triangle.Max[axis]) * 0.5f;
+	}
+
+	m_Nodes.reserve(nrOfTriangles / 2 + 1);
+	BuildNode(triangles.data(), triangles.data() + nrOfTriangles, 0);
+	Refit(pPositions, positionStride);
+}
+
+void MeshBVH::BuildNode(BuildTriangle* pBegin, BuildTriangle* pEnd, unsigned int depth)
+{
+	unsigned int nodeIndex = m_Nodes.size();
+	m_Nodes.push_back(BVHNode() );
+	m_Depth = max(m_Depth, depth + 1);
+
+	BinBounds nodeBounds, centroidBounds;
+	for(auto pTriangle = pBegin; pTriangle != pEnd; ++pTriangle){
+		nodeBounds.Include(pTriangle->Min, pTriangle->Max);
+		centroidBounds.Include(pTriangle->Centroid, pTriangle->Centroid);
+	}
+
+	//Binned SAH, every candidate split between two of BVH_BINS bins along each axis
+	unsigned int nrOfTriangles = pEnd - pBegin;
+	float bestCost = FLT_MAX;
+	unsigned int bestAxis = 0, bestSplit = 0;
+	float nodeArea = nodeBounds.Area();
+
+	if(nrOfTriangles > 4 && depth + 1 < BVH_MAX_DEPTH && nodeArea > 0.0f){
+		for(unsigned int axis = 0; axis < 3; ++axis){
+			float extent = centroidBounds.Max[axis] - centroidBounds.Min[axis];
+			if(extent <= 0.0f)
+				continue;
+
+			BinBounds bins[BVH_BINS];
+			unsigned int counts[BVH_BINS] = {};
+			float scale = BVH_BINS / extent;
+			for(auto pTriangle = pBegin; pTriangle != pEnd; ++pTriangle){
+				unsigned int bin = min(static_cast<unsigned int>( (pTriangle->Centroid[axis] - centroidBounds.Min[axis]) * scale), BVH_BINS - 1);
+				bins[bin].Include(pTriangle->Min, pTriangle->Max);
+				++counts[bin];
+			}
+
+			//Sweep from the right for the cost of every right half, then from the left
+			float rightCosts[BVH_BINS];
+			BinBounds right;
+			unsigned int rightCount = 0;
+			for(unsigned int bin = BVH_BINS - 1; bin > 0; --bin){
+				right.Include(bins[bin].Min, bins[bin].Max);
+				rightCount += counts[bin];
+				rightCosts[bin] = right.Area() * NrOfBlocks(rightCount);
+			}
+
+			BinBounds left;
+			unsigned int leftCount = 0;
+			for(unsigned int split = 1; split < BVH_BINS; ++split){
+				left.Include(bins[split - 1].Min, bins[split - 1].Max);
+				leftCount += counts[split - 1];
+				if(leftCount == 0 || leftCount == nrOfTriangles)
+					continue;
+
+				float cost = BVH_TRAVERSAL_COST + (left.Area() * NrOfBlocks(leftCount) + rightCosts[split]) / nodeArea;
+				if(cost < bestCost){
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = split;
+				}
+			}
+		}
+	}
+
+	bool bLeaf = nrOfTriangles <= 4 || depth + 1 >= BVH_MAX_DEPTH || (bestCost >= NrOfBlocks(nrOfTriangles) && nrOfTriangles <= BVH_MAX_LEAF_TRIANGLES);
+	if(bLeaf){
+		m_Nodes[nodeIndex].Offset = m_BlockTriangles.size() / 4;
+		m_Nodes[nodeIndex].NrOfTriangles = nrOfTriangles;
+		for(auto pTriangle = pBegin; pTriangle != pEnd; ++pTriangle)
+			m_BlockTriangles.push_back(pTriangle->Index);
+		m_BlockTriangles.resize(m_BlockTriangles.size() + NrOfBlocks(nrOfTriangles) * 4 - nrOfTriangles, NO_TRIANGLE);
+		return;
+	}
+
+	//Without a split that pays off (all centroids in one spot) the triangles are halved as they are
+	BuildTriangle* pMiddle = pBegin + nrOfTriangles / 2;
+	if(bestCost < FLT_MAX){
+		float scale = BVH_BINS / (centroidBounds.Max[bestAxis] - centroidBounds.Min[bestAxis]);
+		pMiddle = std::partition(pBegin, pEnd, [&](const BuildTriangle& triangle){
+			unsigned int bin = min(static_cast<unsigned int>( (triangle.Centroid[bestAxis] - centroidBounds.Min[bestAxis]) * scale), BVH_BINS - 1);
+			return bin < bestSplit;
+		});
+	}
+
+	m_Nodes[nodeIndex].NrOfTriangles = 0;
+	BuildNode(pBegin, pMiddle, depth + 1);
+	m_Nodes[nodeIndex].Offset = m_Nodes.size();
+	BuildNode(pMiddle, pEnd, depth + 1);
+}
+
+void MeshBVH::Refit(const float* pPositions, unsigned int positionStride)
+{
+	WriteBlocks(pPositions, positionStride);
+
+	//Children are stored after their parent, so walking backwards visits them first
+	for(unsigned int i = m_Nodes.size(); i-- > 0; ){
+		BVHNode& node = m_Nodes[i];
+		BinBounds nodeBounds;
+
+		if(node.NrOfTriangles > 0){
+			for(unsigned int slot = node.Offset * 4; slot < node.Offset * 4 + node.NrOfTriangles; ++slot){
+				const TriangleBlock& block = m_Blocks[slot / 4];
+				unsigned int lane = slot % 4;
+				for(unsigned int axis = 0; axis < 3; ++axis){
+					float v0 = block.V0[axis][lane];
+					float v1 = v0 + block.Edge1[axis][lane], v2 = v0 + block.Edge2[axis][lane];
+					nodeBounds.Min[axis] = min(nodeBounds.Min[axis], min(v0, min(v1, v2) ) );
+					nodeBounds.Max[axis] = max(nodeBounds.Max[axis], max(v0, max(v1, v2) ) );
+				}
+			}
+		}
+		else{
+			const BVHNode &first = m_Nodes[i + 1], &second = m_Nodes[node.Offset];
+			nodeBounds.Include(first.Min, first.Max);
+			nodeBounds.Include(second.Min, second.Max);
+		}
+
+		memcpy(node.Min, nodeBounds.Min, sizeof(node.Min) );
+		memcpy(node.Max, nodeBounds.Max, sizeof(node.Max) );
+	}
+}
+
+void MeshBVH::WriteBlocks(const float* pPositions, unsigned int positionStride)
+{
+	auto getPosition = [&](unsigned int vertex) -> tt::Vector3 {
+		const float* pPosition = reinterpret_cast<const float*>(reinterpret_cast<const char*>(pPositions) + vertex * positionStride);
+		return tt::Vector3(pPosition[0], pPosition[1], pPosition[2]);
+	};
+
+	//Padding slots keep zero edges, which no ray hits
+	m_Blocks.assign(m_BlockTriangles.size() / 4, TriangleBlock() );
+	memset(m_Blocks.data(), 0, m_Blocks.size() * sizeof(TriangleBlock) );
+
+	for(unsigned int slot = 0; slot < m_BlockTriangles.size(); ++slot){
+		unsigned int tri = m_BlockTriangles[slot];
+		if(tri == NO_TRIANGLE)
+			continue;
+
+		tt::Vector3 v0 = getPosition(m_Indices[tri * 3]);
+		tt::Vector3 edge1 = getPosition(m_Indices[tri * 3 + 1]) - v0;
+		tt::Vector3 edge2 = getPosition(m_Indices[tri * 3 + 2]) - v0;
+
+		TriangleBlock& block = m_Blocks[slot / 4];
+		unsigned int lane = slot % 4;
+		block.V0[0][lane] = v0.x;		block.V0[1][lane] = v0.y;		block.V0[2][lane] = v0.z;
+		block.Edge1[0][lane] = edge1.x;	block.Edge1[1][lane] = edge1.y;	block.Edge1[2][lane] = edge1.z;
+		block.Edge2[0][lane] = edge2.x;	block.Edge2[1][lane] = edge2.y;	block.Edge2[2][lane] = edge2.z;
+	}
+}
+
+bool MeshBVH::Intersect(const Ray& ray, float maxDistance, RayHit& hit) const
+{
+	if(m_Nodes.empty() )
+		return false;
+
+	const float* pOrigin = &ray.Origin.x;
+	const float* pDirection = &ray.Direction.x;
+
+	float closest = maxDistance, tEntry;
+	unsigned int closestSlot = NO_TRIANGLE;
+	float closestU = 0.0f, closestV = 0.0f;
+
+	if(!IntersectRayBox(ray, m_Nodes[0].Min, m_Nodes[0].Max, 0.0f, closest, tEntry) )
+		return false;
+
+	//Nearest child first, the other one waits on the stack with the distance it is entered at
+	unsigned int stack[BVH_MAX_DEPTH];
+	float stackEntries[BVH_MAX_DEPTH];
+	unsigned int stackSize = 0, nodeIndex = 0;
+
+	for(;;){
+		const BVHNode& node = m_Nodes[nodeIndex];
+		bool bDescend = false;
+
+		if(node.NrOfTriangles > 0)
+			IntersectLeaf(m_Blocks, node, pOrigin, pDirection, closest, closestSlot, closestU, closestV);
+		else{
+			unsigned int first = nodeIndex + 1, second = node.Offset;
+			float tFirst, tSecond;
+			bool bFirst = IntersectRayBox(ray, m_Nodes[first].Min, m_Nodes[first].Max, 0.0f, closest, tFirst);
+			bool bSecond = IntersectRayBox(ray, m_Nodes[second].Min, m_Nodes[second].Max, 0.0f, closest, tSecond);
+
+			if(bFirst && bSecond){
+				if(tSecond < tFirst){
+					std::swap(first, second);
+					std::swap(tFirst, tSecond);
+				}
+
+				stack[stackSize] = second;
+				stackEntries[stackSize++] = tSecond;
+			}
+
+			if(bFirst || bSecond){
+				nodeIndex = bFirst ? first : second;
+				bDescend = true;
+			}
+		}
+
+		if(bDescend)
+			continue;
+
+		//Nodes entered beyond the closest hit found since they were pushed are skipped
+		while(stackSize > 0 && stackEntries[stackSize - 1] >= closest)
+			--stackSize;
+
+		if(stackSize == 0)
+			break;
+		nodeIndex = stack[--stackSize];
+	}
+
+	if(closestSlot == NO_TRIANGLE)
+		return false;
+
+	hit.Distance = closest;
+	hit.Triangle = m_BlockTriangles[closestSlot];
+	hit.U = closestU;
+	hit.V = closestV;
+	return true;
+}
+
+int MeshBVH::Intersect(const RayPacket& rays, RayHit* pHits) const
+{
+	if(m_Nodes.empty() )
+		return 0;
+
+	//Every ray shortens its own interval to its closest hit so far, nodes are tested against all of them at once
+	RayPacket packet = rays;
+	unsigned int closestSlots[RAY_PACKET_SIZE];
+	float closestU[RAY_PACKET_SIZE], closestV[RAY_PACKET_SIZE];
+	std::fill(closestSlots, closestSlots + RAY_PACKET_SIZE, NO_TRIANGLE);
+
+	//Both children are pushed at every level, one of them is popped right away
+	unsigned int stack[BVH_MAX_DEPTH + 1];
+	unsigned int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while(stackSize > 0){
+		unsigned int nodeIndex = stack[--stackSize];
+		const BVHNode& node = m_Nodes[nodeIndex];
+		int hitMask = IntersectRayPacket(packet, node.Min, node.Max) & packet.GetMask();
+		if(hitMask == 0)
+			continue;
+
+		if(node.NrOfTriangles > 0){
+			for(unsigned int lane = 0; hitMask != 0; ++lane, hitMask >>= 1){
+				if( !(hitMask & 1) )
+					continue;
+
+				float origin[3] = {packet.Origin[0][lane], packet.Origin[1][lane], packet.Origin[2][lane]};
+				float direction[3] = {packet.Direction[0][lane], packet.Direction[1][lane], packet.Direction[2][lane]};
+				IntersectLeaf(m_Blocks, node, origin, direction, packet.MaxDistance[lane], closestSlots[lane], closestU[lane], closestV[lane]);
+			}
+			continue;
+		}
+
+		//Children in the order the first ray that hit the node passes them, the nearer one is popped first
+		unsigned int first = nodeIndex + 1, second = node.Offset;
+		unsigned int lane = 0;
+		while( !(hitMask & (1 << lane) ) )
+			++lane;
+
+		float order = 0.0f;
+		for(unsigned int axis = 0; axis < 3; ++axis){
+			float firstCenter = m_Nodes[first].Min[axis] + m_Nodes[first].Max[axis];
+			float secondCenter = m_Nodes[second].Min[axis] + m_Nodes[second].Max[axis];
+			order += (secondCenter - firstCenter) * packet.Direction[axis][lane];
+		}
+		if(order < 0.0f)
+			std::swap(first, second);
+
+		stack[stackSize++] = second;
+		stack[stackSize++] = first;
+	}
+
+	int hitMask = 0;
+	for(unsigned int lane = 0; lane < packet.NrOfRays; ++lane){
+		if(closestSlots[lane] == NO_TRIANGLE)
+			continue;
+
+		pHits[lane].Distance = packet.MaxDistance[lane];
+		pHits[lane].Triangle = m_BlockTriangles[closestSlots[lane] ];
+		pHits[lane].U = closestU[lane];
+		pHits[lane].V = closestV[lane];
+		hitMask |= 1 << lane;
+	}
+
+	return hitMask;
+}
+
+bool MeshBVH::IsEmpty(void) const
+{
+	return m_Nodes.empty();
+}
+
+unsigned int MeshBVH::GetNrOfNodes(void) const
+{
+	return m_Nodes.size();
+}
+
+unsigned int MeshBVH::GetDepth(void) const
+{
+	return m_Depth;
+}
@@ -0,0 +1,85 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "../Helpers/Namespace.h"
+
+struct Ray;
+struct RayPacket;
+
+//Bounding volume hierarchy over the triangles of a mesh for exact ray queries (picking, line of sight). Built with the
+//surface area heuristic over binned triangle centroids. Nodes are stored depth first in 32 bytes each, the first child of
+//an inner node directly follows it so only the second child is referenced. Leaf triangles are stored in blocks of 4 in
+//SoA form, with their first vertex and two edges precomputed, and tested 4 at a time with SSE (scalar fallback).
+//Triangles are double sided, rays hit them from either side.
+
+struct BVHNode
+{
+	float Min[3];
+	unsigned int Offset;		//Inner nodes: index of the second child. Leaves: first TriangleBlock.
+	float Max[3];
+	unsigned int NrOfTriangles; //0 for inner nodes
+};
+
+struct TriangleBlock
+{
+	float V0[3][4];
+	float Edge1[3][4];
+	float Edge2[3][4];
+};
+
+struct RayHit
+{
+	float Distance;		//Along the ray, in units of its direction
+	unsigned int Triangle;	//Index of the first of its indices / 3
+	float U, V;			//Barycentric coordinates of the hit on the triangle, weights of its second and third vertex
+};
+
+class MeshBVH
+{
+public:
+	MeshBVH(void);
+	~MeshBVH(void);
+
+	//pPositions points to 3 floats every positionStride bytes
+	void Build(const unsigned int* pIndices, unsigned int nrOfIndices, const float* pPositions, unsigned int positionStride);
+	//Moves the triangles to new positions of the same vertices and refits the bounds, the tree itself is kept.
+	//Cheap enough to follow animated meshes, but queries slow down once the pose strays far from the one it was built for.
+	void Refit(const float* pPositions, unsigned int positionStride);
+
+	//Closest hit with a Distance below maxDistance, returns false if there is none
+	bool Intersect(const Ray& ray, float maxDistance, RayHit& hit) const;
+	//Closest hits of a packet of rays traversed together, each below the MaxDistance of its ray (MinDistance should be 0).
+	//Bit i of the result is set if ray i hit, pHits gets its hit in slot i. Pays off for rays that take similar paths.
+	int Intersect(const RayPacket& rays, RayHit* pHits) const;
+
+	bool IsEmpty(void) const;
+	unsigned int GetNrOfNodes(void) const;
+	unsigned int GetDepth(void) const;
+
+private:
+	struct BuildTriangle;
+	void BuildNode(BuildTriangle* pBegin, BuildTriangle* pEnd, unsigned int depth);
+	void WriteBlocks(const float* pPositions, unsigned int positionStride);
+
+	std::vector<BVHNode> m_Nodes;
+	std::vector<TriangleBlock> m_Blocks;
+	std::vector<unsigned int> m_BlockTriangles; //Triangle in every slot of m_Blocks, UINT_MAX for padding
+	std::vector<unsigned int> m_Indices;
+	unsigned int m_Depth;
+};
@@ -0,0 +1,237 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "MeshClusters.h"
+#include "Frustum.h"
+#include "../Helpers/SimdUtil.h"
+
+//Per cluster, with every test done in model space:
+//	frustum		: outside if dot(plane.xyz, center) + plane.w < -radius for any plane
+//	back faces	: every triangle faces away if dot(center - eye, axis) >= cutoff * |center - eye| + radius,
+//				  or dot(viewDirection, axis) >= cutoff for orthographic projections
+
+namespace
+{
+	//Clusters with triangles this close to perpendicular to the axis are never rejected, their cone is too wide to be worth it
+	const float MIN_CONE_DOT = 0.1f;
+	const float NO_CONE_CUTOFF = 2.0f;
+
+	bool IsClusterVisible(const ClusterStreams& clusters, const ClusterCamera& camera, unsigned int cluster)
+	{
+		tt::Vector3 center(clusters.CenterX[cluster], clusters.CenterY[cluster], clusters.CenterZ[cluster]);
+		float radius = clusters.Radius[cluster];
+
+		for(auto& plane : camera.Planes)
+			if(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+				return false;
+
+		if(!camera.bCullBackfaces)
+			return true;
+
+		tt::Vector3 axis(clusters.AxisX[cluster], clusters.AxisY[cluster], clusters.AxisZ[cluster]);
+		if(camera.bOrthographic)
+			return camera.Position.Dot(axis) < clusters.Cutoff[cluster];
+
+		tt::Vector3 toCenter = center - camera.Position;
+		return toCenter.Dot(axis) < clusters.Cutoff[cluster] * toCenter.Length() + radius;
+	}
+
+	void AddVisibleCluster(const ClusterStreams& clusters, unsigned int cluster, std::vector<IndexRange>& visibleRanges)
+	{
+		if(!visibleRanges.empty() && visibleRanges.back().StartIndex + visibleRanges.back().NrOfIndices == clusters.StartIndex[cluster]){
+			visibleRanges.back().NrOfIndices += clusters.NrOfIndices[cluster];
+			return;
+		}
+
+		IndexRange range = {clusters.StartIndex[cluster], clusters.NrOfIndices[cluster]};
+		visibleRanges.push_back(range);
+	}
+
+#ifdef TT_SIMD_SSE
+	//Bit i is set if cluster first + i can be visible
+	int CullClusterBlock(const ClusterStreams& clusters, const __m128* pPlanes, const ClusterCamera& camera, unsigned int first)
+	{
+		__m128 cx = _mm_loadu_ps(&clusters.CenterX[first]);
+		__m128 cy = _mm_loadu_ps(&clusters.CenterY[first]);
+		__m128 cz = _mm_loadu_ps(&clusters.CenterZ[first]);
+		__m128 radius = _mm_loadu_ps(&clusters.Radius[first]);
+		__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+
+		__m128 culled = _mm_setzero_ps();
+		for(unsigned int i = 0; i < 6; ++i){
+			const __m128* pPlane = pPlanes + i * 4;
+			__m128 distance = SimdMulAdd(cx, pPlane[0], SimdMulAdd(cy, pPlane[1], SimdMulAdd(cz, pPlane[2], pPlane[3])));
+			culled = _mm_or_ps(culled, _mm_cmplt_ps(distance, negRadius));
+		}
+
+		if(camera.bCullBackfaces){
+			__m128 ax = _mm_loadu_ps(&clusters.AxisX[first]);
+			__m128 ay = _mm_loadu_ps(&clusters.AxisY[first]);
+			__m128 az = _mm_loadu_ps(&clusters.AxisZ[first]);
+			__m128 cutoff = _mm_loadu_ps(&clusters.Cutoff[first]);
+			__m128 px = _mm_set1_ps(camera.Position.x), py = _mm_set1_ps(camera.Position.y), pz = _mm_set1_ps(camera.Position.z);
+
+			if(camera.bOrthographic){
+				__m128 dot = SimdMulAdd(ax, px, SimdMulAdd(ay, py, _mm_mul_ps(az, pz)));
+				culled = _mm_or_ps(culled, _mm_cmpge_ps(dot, cutoff));
+			}
+			else{
+				__m128 dx = _mm_sub_ps(cx, px), dy = _mm_sub_ps(cy, py), dz = _mm_sub_ps(cz, pz);
+				__m128 dot = SimdMulAdd(dx, ax, SimdMulAdd(dy, ay, _mm_mul_ps(dz, az)));
+				__m128 distance = _mm_sqrt_ps(SimdMulAdd(dx, dx, SimdMulAdd(dy, dy, _mm_mul_ps(dz, dz))));
+				culled = _mm_or_ps(culled, _mm_cmpge_ps(dot, SimdMulAdd(cutoff, distance, radius)));
+			}
+		}
+
+		return ~_mm_movemask_ps(culled) & 0xF;
+	}
+#endif
+}
+
+//--------------------------
+//ClusterStreams
+//--------------------------
+void ClusterStreams::Resize(unsigned int nrOfClusters)
+{
+	CenterX.resize(nrOfClusters); CenterY.resize(nrOfClusters); CenterZ.resize(nrOfClusters); Radius.resize(nrOfClusters);
+	AxisX.resize(nrOfClusters); AxisY.resize(nrOfClusters); AxisZ.resize(nrOfClusters); Cutoff.resize(nrOfClusters);
+	StartIndex.resize(nrOfClusters); NrOfIndices.resize(nrOfClusters);
+}
+
+unsigned int ClusterStreams::Size(void) const
+{
+	return StartIndex.size();
+}
+
+void BuildClusterStreams(const unsigned int* pIndices, const std::vector<unsigned int>& clusterStarts, const float* pPositions, unsigned int positionStride
+						,ClusterStreams& clusters)
+{
+	auto getPosition = [&](unsigned int vertex) -> tt::Vector3 {
+		const float* pPosition = reinterpret_cast<const float*>(reinterpret_cast<const char*>(pPositions) + vertex * positionStride);
+		return tt::Vector3(pPosition[0], pPosition[1], pPosition[2]);
+	};
+
+	clusters.Resize(clusterStarts.empty() ? 0 : clusterStarts.size() - 1);
+	std::vector<tt::Vector3> normals;
+
+	for(unsigned int c = 0; c < clusters.Size(); ++c){
+		unsigned int begin = clusterStarts[c], end = clusterStarts[c + 1];
+		clusters.StartIndex[c] = begin;
+		clusters.NrOfIndices[c] = end - begin;
+
+		//Sphere around the center of the bounding box
+		tt::Vector3 minimum(FLT_MAX), maximum(-FLT_MAX);
+		for(unsigned int i = begin; i < end; ++i){
+			tt::Vector3 p = getPosition(pIndices[i]);
+			minimum = tt::Vector3(min(minimum.x, p.x), min(minimum.y, p.y), min(minimum.z, p.z) );
+			maximum = tt::Vector3(max(maximum.x, p.x), max(maximum.y, p.y), max(maximum.z, p.z) );
+		}
+
+		tt::Vector3 center = (minimum + maximum) * 0.5f;
+		float radiusSq = 0.0f;
+		for(unsigned int i = begin; i < end; ++i)
+			radiusSq = max(radiusSq, (getPosition(pIndices[i]) - center).LengthSq() );
+
+		clusters.CenterX[c] = center.x;
+		clusters.CenterY[c] = center.y;
+		clusters.CenterZ[c] = center.z;
+		clusters.Radius[c] = sqrtf(radiusSq);
+
+		//Cone around the average normal that contains every triangle normal
+		normals.clear();
+		tt::Vector3 axis(0.0f);
+		for(unsigned int i = begin; i + 2 < end; i += 3){
+			tt::Vector3 p0 = getPosition(pIndices[i]);
+			tt::Vector3 normal = (getPosition(pIndices[i + 1]) - p0).Cross(getPosition(pIndices[i + 2]) - p0);
+			if(normal.LengthSq() <= 0.0f)
+				continue;
+
+			normals.push_back(tt::Vector3::Normalize(normal) );
+			axis += normals.back();
+		}
+
+		float minDot = -1.0f;
+		if(axis.LengthSq() > 0.0f){
+			axis.Normalize();
+			minDot = 1.0f;
+			for(auto& normal : normals)
+				minDot = min(minDot, normal.Dot(axis) );
+		}
+
+		clusters.AxisX[c] = axis.x;
+		clusters.AxisY[c] = axis.y;
+		clusters.AxisZ[c] = axis.z;
+		clusters.Cutoff[c] = minDot <= MIN_CONE_DOT ? NO_CONE_CUTOFF : sqrtf(1.0f - minDot * minDot);
+	}
+}
+
+//--------------------------
+//ClusterCamera
+//--------------------------
+ClusterCamera::ClusterCamera(const tt::Matrix4x4& world, const tt::Matrix4x4& view, const tt::Matrix4x4& projection, bool bCullBackfaces)
+	:bOrthographic(projection._34 == 0.0f)
+	,bCullBackfaces(bCullBackfaces)
+{
+	Frustum frustum(world * view * projection);
+	for(unsigned int i = 0; i < Frustum::NR_OF_PLANES; ++i)
+		Planes[i] = frustum.GetPlane(i);
+
+	//The eye is the origin of view space, orthographic cameras look along its z axis
+	tt::Matrix4x4 viewToModel = (world * view).Inverse();
+	if(bOrthographic)
+		Position = tt::Vector3::Normalize(tt::Vector3(viewToModel._31, viewToModel._32, viewToModel._33) );
+	else
+		Position = tt::Vector3(viewToModel._41, viewToModel._42, viewToModel._43);
+}
+
+//--------------------------
+//Culling
+//--------------------------
+unsigned int CullClusters(const ClusterStreams& clusters, const ClusterCamera& camera, std::vector<IndexRange>& visibleRanges)
+{
+	visibleRanges.clear();
+	unsigned int nrOfVisibleClusters = 0, i = 0, nrOfClusters = clusters.Size();
+
+#ifdef TT_SIMD_SSE
+	__m128 planes[6 * 4];
+	for(unsigned int p = 0; p < 6; ++p){
+		planes[p * 4 + 0] = _mm_set1_ps(camera.Planes[p].x);
+		planes[p * 4 + 1] = _mm_set1_ps(camera.Planes[p].y);
+		planes[p * 4 + 2] = _mm_set1_ps(camera.Planes[p].z);
+		planes[p * 4 + 3] = _mm_set1_ps(camera.Planes[p].w);
+	}
+
+	for(; i + 4 <= nrOfClusters; i += 4){
+		int visibleMask = CullClusterBlock(clusters, planes, camera, i);
+		for(unsigned int lane = 0; visibleMask != 0; ++lane, visibleMask >>= 1){
+			if(visibleMask & 1){
+				AddVisibleCluster(clusters, i + lane, visibleRanges);
+				++nrOfVisibleClusters;
+			}
+		}
+	}
+#endif
+
+	for(; i < nrOfClusters; ++i){
+		if(IsClusterVisible(clusters, camera, i) ){
+			AddVisibleCluster(clusters, i, visibleRanges);
+			++nrOfVisibleClusters;
+		}
+	}
+
+	return nrOfVisibleClusters;
+}
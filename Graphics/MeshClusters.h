@@ -0,0 +1,70 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "../Helpers/Namespace.h"
+
+//Clusters of up to CLUSTER_MAX_TRIANGLES triangles that are culled one by one on the CPU, so large static meshes only draw the parts
+//in view. Cooking splits meshes into clusters (see Model3D::SaveCooked), every cluster is a range of the index buffer with a bounding
+//sphere and a cone around its triangle normals. CullClusters tests 4 clusters at a time with SSE, with a scalar fallback, and only
+//needs the streams and a camera, so it runs (and can be timed) without a graphics device.
+
+const unsigned int CLUSTER_MAX_VERTICES = 64;
+const unsigned int CLUSTER_MAX_TRIANGLES = 124;
+
+//Meshes with fewer triangles are drawn at once, culling their clusters costs more than it saves
+const unsigned int CLUSTER_MIN_MESH_TRIANGLES = CLUSTER_MAX_TRIANGLES * 8;
+
+struct IndexRange
+{
+	unsigned int StartIndex;
+	unsigned int NrOfIndices;
+};
+
+//Bounds and normal cones of all clusters of a mesh, one stream per component
+struct ClusterStreams
+{
+	std::vector<float> CenterX, CenterY, CenterZ, Radius;
+	//Every triangle normal is within the cone around Axis, Cutoff is the sine of its half angle.
+	//Clusters with triangles facing away from the axis have a Cutoff above 1 and are never rejected as back facing.
+	std::vector<float> AxisX, AxisY, AxisZ, Cutoff;
+	std::vector<unsigned int> StartIndex, NrOfIndices;
+
+	void Resize(unsigned int nrOfClusters);
+	unsigned int Size(void) const;
+};
+
+//Computes the bounds and cones of the clusters BuildClusters made, clusterStarts as it returned them.
+//pPositions points to 3 floats every positionStride bytes.
+void BuildClusterStreams(const unsigned int* pIndices, const std::vector<unsigned int>& clusterStarts, const float* pPositions, unsigned int positionStride
+						,ClusterStreams& clusters);
+
+//View of a camera in the model space of the mesh being culled
+struct ClusterCamera
+{
+	tt::Vector4 Planes[6];	//Frustum planes with unit normals pointing inward
+	tt::Vector3 Position;	//Eye position, or the view direction for orthographic projections
+	bool bOrthographic;
+	bool bCullBackfaces;	//Only for materials that cull back faces, a cluster seen from behind is skipped entirely
+
+	ClusterCamera(const tt::Matrix4x4& world, const tt::Matrix4x4& view, const tt::Matrix4x4& projection, bool bCullBackfaces);
+};
+
+//Fills visibleRanges with the index ranges of the clusters that can be visible, neighbouring clusters merged into one range.
+//Returns the number of visible clusters.
+unsigned int CullClusters(const ClusterStreams& clusters, const ClusterCamera& camera, std::vector<IndexRange>& visibleRanges);
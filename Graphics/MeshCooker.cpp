@@ -0,0 +1,209 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "MeshCooker.h"
+#include "MeshOptimizer.h"
+#include "VertexFormat.h"
+#include "SourceMesh.h"
+#include "BoundingVolumes.h"
+
+namespace
+{
+	//Attribute of a source mesh being interleaved, its elements are the size of its source format
+	struct GatherAttribute
+	{
+		const char* pData;
+		const unsigned int* pIndices;
+		unsigned int Size;
+	};
+
+	template<typename T>
+	void AddAttribute(const SourceAttribute<T>& attribute, InputLayoutSemantic semantic, unsigned int semanticIndex
+					 ,vector<InputLayoutElement>& layout, vector<GatherAttribute>& attributes)
+	{
+		if(attribute.Data.empty() )
+			return;
+
+		InputLayoutElement element = {};
+		element.Semantic = semantic;
+		element.SemanticIndex = semanticIndex;
+		layout.push_back(element);
+
+		GatherAttribute gather = {reinterpret_cast<const char*>(attribute.Data.data() ), attribute.Indices.data(), sizeof(T)};
+		attributes.push_back(gather);
+	}
+}
+
+CookSource::CookSource(void):NrOfVertices(0)
+{
+	Bounds[0] = Bounds[1] = tt::Vector3(0, 0, 0);
+}
+
+unsigned int GetLayoutStride(const vector<InputLayoutElement>& layout)
+{
+	unsigned int stride = 0;
+	for(auto& element : layout){
+		unsigned int size = GetFormatSize(GetElementFormat(element) );
+		if(size == 0)
+			return 0;
+
+		stride += size;
+	}
+
+	return stride;
+}
+
+void CookMesh(const CookSource& source, CookedMesh& mesh, CookReport& report)
+{
+	unsigned int nrOfSourceVertices = source.NrOfVertices;
+	vector<unsigned int> strides;
+	for(auto& layout : source.Layouts)
+		strides.push_back(GetLayoutStride(layout) );
+
+	//All streams share one index buffer, so vertices are only merged if they are identical in every stream
+	unsigned int weldStride = accumulate(strides.begin(), strides.end(), 0u);
+	vector<char> weldVertices(nrOfSourceVertices * weldStride);
+	for(unsigned int i = 0, offset = 0; i < source.Layouts.size(); offset += strides[i++])
+		for(unsigned int vertex = 0; vertex < nrOfSourceVertices; ++vertex)
+			memcpy(&weldVertices[vertex * weldStride + offset], &source.Vertices[i][vertex * strides[i]], strides[i]);
+
+	vector<unsigned int> weldRemap;
+	unsigned int nrOfWeldedVertices = WeldVertices(weldVertices.data(), nrOfSourceVertices, weldStride, weldRemap);
+	
+	vector<unsigned int>& indices = mesh.Indices;
+	indices = source.Indices;
+	for(auto& index : indices)
+		index = weldRemap[index];
+
+	//Cooked meshes are drawn as stored, reorder them for the post-transform cache, overdraw and vertex fetches first
+	report.SourceACMR = CalculateACMR(source.Indices.data(), source.Indices.size(), nrOfSourceVertices);
+	OptimizeVertexCache(indices.data(), indices.size(), nrOfWeldedVertices);
+
+	mesh.Clusters.Resize(0);
+	if(!source.Positions.empty() ){
+		vector<float> positions(nrOfWeldedVertices * 3);
+		for(unsigned int i = 0; i < nrOfSourceVertices; ++i)
+			memcpy(&positions[weldRemap[i] * 3], &source.Positions[i * 3], sizeof(float) * 3);
+
+		OptimizeOverdraw(indices.data(), indices.size(), positions.data(), sizeof(float) * 3, nrOfWeldedVertices);
+
+		//Large meshes are split into clusters for CullClusters, which keeps most of the cache order within each cluster
+		if(indices.size() / 3 >= CLUSTER_MIN_MESH_TRIANGLES){
+			vector<unsigned int> clusterStarts;
+			BuildClusters(indices.data(), indices.size(), positions.data(), sizeof(float) * 3, nrOfWeldedVertices, clusterStarts
+						 ,CLUSTER_MAX_VERTICES, CLUSTER_MAX_TRIANGLES);
+			BuildClusterStreams(indices.data(), clusterStarts, positions.data(), sizeof(float) * 3, mesh.Clusters);
+		}
+	}
+
+	vector<unsigned int> fetchRemap;
+	unsigned int nrOfVertices = OptimizeVertexFetch(indices.data(), indices.size(), nrOfWeldedVertices, fetchRemap);
+	mesh.NrOfVertices = nrOfVertices;
+
+	report.NrOfSourceVertices = nrOfSourceVertices;
+	report.NrOfVertices = nrOfVertices;
+	report.CookedACMR = CalculateACMR(indices.data(), indices.size(), nrOfVertices);
+	report.NrOfClusters = mesh.Clusters.Size();
+
+	//LODs draw a subset of the same vertices, they are renumbered along and reordered for the cache on their own
+	mesh.LODIndices = source.LODIndices;
+	for(auto& index : mesh.LODIndices)
+		index = fetchRemap[weldRemap[index]];
+
+	mesh.LODs = source.LODs;
+	for(auto& lod : mesh.LODs){
+		unsigned int* pLODIndices = &mesh.LODIndices[lod.StartIndex - source.Indices.size()];
+		OptimizeVertexCache(pLODIndices, lod.NrOfIndices, nrOfVertices);
+		lod.NrOfVertices = CountUsedVertices(pLODIndices, lod.NrOfIndices, nrOfVertices);
+	}
+
+	mesh.Bounds[0] = source.Bounds[0];
+	mesh.Bounds[1] = source.Bounds[1];
+
+	mesh.Streams.resize(source.Layouts.size() );
+	for(unsigned int i = 0; i < source.Layouts.size(); ++i){
+		CookedStream& stream = mesh.Streams[i];
+		stream.Stride = strides[i];
+		stream.Elements.clear();
+
+		unsigned short elementOffset = 0;
+		for(auto& element : source.Layouts[i]){
+			CookedStreamElement cookedElement;
+			cookedElement.Semantic = element.Semantic;
+			cookedElement.SemanticIndex = static_cast<unsigned char>(element.SemanticIndex);
+			cookedElement.Offset = elementOffset;
+			cookedElement.Format = GetElementFormat(element);
+			stream.Elements.push_back(cookedElement);
+			
+			elementOffset += static_cast<unsigned short>(GetFormatSize(cookedElement.Format) );
+		}
+
+		//Every source vertex of a welded vertex holds the same data, any of them can be written
+		stream.Data.assign(nrOfVertices * stream.Stride, 0);
+		for(unsigned int vertex = 0; vertex < nrOfSourceVertices; ++vertex){
+			unsigned int cookedVertex = fetchRemap[weldRemap[vertex]];
+			if(cookedVertex != UNUSED_VERTEX)
+				memcpy(&stream.Data[cookedVertex * stream.Stride], &source.Vertices[i][vertex * stream.Stride], stream.Stride);
+		}
+	}
+}
+
+bool GatherCookSource(const SourceMesh& mesh, CookSource& source)
+{
+	if(!mesh.Skeleton.empty() || !mesh.BlendIndices.Data.empty() || !mesh.BlendWeights.Data.empty() )
+		return false;
+
+	source = CookSource();
+	source.NrOfVertices = mesh.GetNrOfVertices();
+	source.Layouts.resize(1);
+	source.Vertices.resize(1);
+
+	//Same attribute order as Model3D::GetAttributeLayout
+	vector<GatherAttribute> attributes;
+	AddAttribute(mesh.Positions, InputLayoutSemantic::Position, 0, source.Layouts[0], attributes);
+	for(unsigned int channel = 0; channel < mesh.TexCoords.size(); ++channel)
+		AddAttribute(mesh.TexCoords[channel], InputLayoutSemantic::TexCoord, channel, source.Layouts[0], attributes);
+	AddAttribute(mesh.Normals, InputLayoutSemantic::Normal, 0, source.Layouts[0], attributes);
+	AddAttribute(mesh.Tangents, InputLayoutSemantic::Tangent, 0, source.Layouts[0], attributes);
+	AddAttribute(mesh.Binormals, InputLayoutSemantic::Binormal, 0, source.Layouts[0], attributes);
+	AddAttribute(mesh.Colors, InputLayoutSemantic::Color, 0, source.Layouts[0], attributes);
+
+	unsigned int stride = GetLayoutStride(source.Layouts[0]);
+	vector<char>& vertices = source.Vertices[0];
+	vertices.resize(source.NrOfVertices * stride);
+	for(unsigned int vertex = 0; vertex < source.NrOfVertices; ++vertex){
+		char* pDest = &vertices[vertex * stride];
+		for(auto& attribute : attributes){
+			memcpy(pDest, attribute.pData + attribute.pIndices[vertex] * attribute.Size, attribute.Size);
+			pDest += attribute.Size;
+		}
+	}
+
+	if(!mesh.Positions.Data.empty() ){
+		source.Positions.resize(source.NrOfVertices * 3);
+		for(unsigned int vertex = 0; vertex < source.NrOfVertices; ++vertex)
+			memcpy(&source.Positions[vertex * 3], &mesh.Positions.Data[mesh.Positions.Indices[vertex] ], sizeof(float) * 3);
+	}
+
+	source.Indices = mesh.Indices;
+
+	AABBox bounds;
+	bounds.Initialize(mesh.Positions.Data);
+	source.Bounds[0] = bounds.Bounds[0];
+	source.Bounds[1] = bounds.Bounds[1];
+	return true;
+}
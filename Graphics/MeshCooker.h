@@ -0,0 +1,58 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "CookedMesh.h"
+
+struct SourceMesh;
+
+//Mesh to cook, every vertex written once for each stream's layout. Model3D::SaveCooked gathers it from a loaded model.
+struct CookSource
+{
+	vector<vector<InputLayoutElement> > Layouts;	//One cooked stream per layout
+	vector<vector<char> > Vertices;					//Per layout, NrOfVertices vertices in the formats of its elements (see GetElementFormat)
+	vector<float> Positions;						//xyz of every vertex for the overdraw and cluster passes, empty if the mesh has none
+	unsigned int NrOfVertices;
+	vector<unsigned int> Indices;					//Triangle list
+	vector<CookedMeshLOD> LODs;						//Simplified levels past the full mesh, see MeshLOD. NrOfVertices is recounted.
+	vector<unsigned int> LODIndices;				//Indices of the LODs, following Indices in the index buffer
+	tt::Vector3 Bounds[2];
+
+	CookSource(void);
+};
+
+//What cooking did, for the log
+struct CookReport
+{
+	unsigned int NrOfSourceVertices, NrOfVertices;
+	float SourceACMR, CookedACMR; //Average cache miss ratio of the full mesh, see CalculateACMR
+	unsigned int NrOfClusters;
+};
+
+//Size of a vertex in the formats of the layout, 0 if one of them can't be converted to
+unsigned int GetLayoutStride(const vector<InputLayoutElement>& layout);
+
+//Merges the vertices that are identical in every stream, reorders the triangles for the post-transform cache and overdraw,
+//splits large meshes into clusters and renumbers the vertices in the order they are fetched. LODs are renumbered along
+//and reordered for the cache on their own.
+void CookMesh(const CookSource& source, CookedMesh& mesh, CookReport& report);
+
+//Single stream with every attribute of a source mesh in its source format, the stream Model3D::SaveCooked cooks without layouts.
+//No LODs, they are generated when the cooked file is loaded. Returns false for meshes with a skeleton or skinning data,
+//cooked files can't hold those.
+bool GatherCookSource(const SourceMesh& mesh, CookSource& source);
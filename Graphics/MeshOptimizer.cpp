@@ -0,0 +1,752 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "MeshOptimizer.h"
+#include "../Helpers/Namespace.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	//Forsyth scores vertices against a larger, LRU shaped cache than the one we measure with
+	const unsigned int SCORING_CACHE_SIZE = 32;
+	const float CACHE_DECAY_POWER = 1.5f;
+	const float LAST_TRIANGLE_SCORE = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+
+	float GetVertexScore(int cachePosition, unsigned int nrOfRemainingTriangles)
+	{
+		if(nrOfRemainingTriangles == 0)
+			return -1.0f;
+
+		float score = 0.0f;
+		if(cachePosition >= 0){
+			//The vertices of the last triangle get a fixed score, so the next triangle doesn't simply reuse its edges
+			if(cachePosition < 3)
+				score = LAST_TRIANGLE_SCORE;
+			else
+				score = powf(1.0f - (cachePosition - 3) / static_cast<float>(SCORING_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+		}
+
+		//Vertices with few triangles left are finished first, otherwise they end up as expensive stragglers
+		return score + VALENCE_BOOST_SCALE * powf(static_cast<float>(nrOfRemainingTriangles), -VALENCE_BOOST_POWER);
+	}
+
+	//FNV-1a over the bytes of a vertex
+	unsigned int HashVertex(const char* pVertex, unsigned int stride)
+	{
+		unsigned int hash = 2166136261u;
+		for(unsigned int i = 0; i < stride; ++i)
+			hash = (hash ^ static_cast<unsigned char>(pVertex[i]) ) * 16777619u;
+
+		return hash;
+	}
+
+	//FIFO cache simulation, a vertex is cached while fewer than cacheSize misses happened after its own
+	class VertexCache
+	{
+	public:
+		VertexCache(unsigned int nrOfVertices, unsigned int cacheSize):m_Timestamps(nrOfVertices, 0),m_Time(cacheSize + 1),m_CacheSize(cacheSize){}
+
+		//Returns whether the vertex had to be transformed
+		bool Fetch(unsigned int vertex)
+		{
+			if(m_Time - m_Timestamps[vertex] <= m_CacheSize)
+				return false;
+
+			m_Timestamps[vertex] = m_Time++;
+			return true;
+		}
+
+		unsigned int FetchTriangle(const unsigned int* pTriangle)
+		{
+			return Fetch(pTriangle[0]) + Fetch(pTriangle[1]) + Fetch(pTriangle[2]);
+		}
+
+		void Flush(void)
+		{
+			m_Time += m_CacheSize + 1;
+		}
+
+	private:
+		std::vector<unsigned int> m_Timestamps;
+		unsigned int m_Time, m_CacheSize;
+	};
+
+	//Sum of squared distances to a set of planes, weighted by the area they stand for (Garland & Heckbert)
+	struct Quadric
+	{
+		double a00, a11, a22, a01, a02, a12;
+		double b0, b1, b2, c;
+		double Weight;
+
+		Quadric(void):a00(0),a11(0),a22(0),a01(0),a02(0),a12(0),b0(0),b1(0),b2(0),c(0),Weight(0){}
+
+		//Plane with unit normal n through point
+		Quadric(const tt::Vector3& n, const tt::Vector3& point, double weight)
+		{
+			double d = -n.Dot(point);
+			a00 = weight * n.x * n.x;	a11 = weight * n.y * n.y;	a22 = weight * n.z * n.z;
+			a01 = weight * n.x * n.y;	a02 = weight * n.x * n.z;	a12 = weight * n.y * n.z;
+			b0 = weight * n.x * d;		b1 = weight * n.y * d;		b2 = weight * n.z * d;
+			c = weight * d * d;
+			Weight = weight;
+		}
+
+		Quadric& operator+=(const Quadric& q)
+		{
+			a00 += q.a00; a11 += q.a11; a22 += q.a22; a01 += q.a01; a02 += q.a02; a12 += q.a12;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c;
+			Weight += q.Weight;
+			return *this;
+		}
+
+		//Mean squared distance of p to the planes
+		double GetError(const tt::Vector3& p) const
+		{
+			double error = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+						 + 2 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+						 + 2 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+
+			return Weight > 0 ? std::max(error / Weight, 0.0) : 0.0;
+		}
+	};
+
+	enum class VertexKind : unsigned char
+	{
+		Manifold,	//Can collapse onto any neighbour
+		Border,		//On an open border, only collapses along it
+		Locked		//Seams, corners and non-manifold vertices stay in place
+	};
+
+	//Undirected edge between two positions, as a sortable key
+	unsigned long long GetEdgeKey(unsigned int a, unsigned int b)
+	{
+		return a < b ? (static_cast<unsigned long long>(a) << 32) | b : (static_cast<unsigned long long>(b) << 32) | a;
+	}
+
+	unsigned int CountEdge(const std::vector<unsigned long long>& sortedEdges, unsigned int a, unsigned int b)
+	{
+		auto range = std::equal_range(sortedEdges.begin(), sortedEdges.end(), GetEdgeKey(a, b) );
+		return static_cast<unsigned int>(range.second - range.first);
+	}
+
+	struct Collapse
+	{
+		unsigned int From, To;
+		double Error;
+	};
+}
+
+unsigned int WeldVertices(char* pVertices, unsigned int nrOfVertices, unsigned int stride, std::vector<unsigned int>& remap)
+{
+	remap.resize(nrOfVertices);
+
+	//Open addressing table of unique vertices, at most half full
+	unsigned int tableSize = 1;
+	while(tableSize < nrOfVertices * 2)
+		tableSize <<= 1;
+
+	std::vector<unsigned int> table(tableSize, UNUSED_VERTEX);
+	unsigned int nrOfUniqueVertices = 0;
+
+	for(unsigned int i = 0; i < nrOfVertices; ++i){
+		const char* pVertex = pVertices + i * stride;
+		unsigned int slot = HashVertex(pVertex, stride) & (tableSize - 1);
+
+		while(table[slot] != UNUSED_VERTEX && memcmp(pVertices + table[slot] * stride, pVertex, stride) != 0)
+			slot = (slot + 1) & (tableSize - 1);
+
+		if(table[slot] == UNUSED_VERTEX){
+			//Unique vertices so far are packed at the front, always in front of this one
+			if(nrOfUniqueVertices != i)
+				memcpy(pVertices + nrOfUniqueVertices * stride, pVertex, stride);
+			
+			table[slot] = nrOfUniqueVertices++;
+		}
+
+		remap[i] = table[slot];
+	}
+
+	return nrOfUniqueVertices;
+}
+
+unsigned int CountUsedVertices(const unsigned int* pIndices, unsigned int nrOfIndices, unsigned int nrOfVertices)
+{
+	std::vector<char> used(nrOfVertices, 0);
+	unsigned int nrOfUsedVertices = 0;
+	for(unsigned int i = 0; i < nrOfIndices; ++i){
+		nrOfUsedVertices += !used[pIndices[i]];
+		used[pIndices[i]] = 1;
+	}
+
+	return nrOfUsedVertices;
+}
+
+float CalculateACMR(const unsigned int* pIndices, unsigned int nrOfIndices, unsigned int nrOfVertices, unsigned int cacheSize)
+{
+	unsigned int nrOfTriangles = nrOfIndices / 3;
+	if(nrOfTriangles == 0)
+		return 0.0f;
+
+	VertexCache cache(nrOfVertices, cacheSize);
+	unsigned int nrOfMisses = 0;
+	for(unsigned int i = 0; i < nrOfTriangles * 3; i += 3)
+		nrOfMisses += cache.FetchTriangle(pIndices + i);
+
+	return nrOfMisses / static_cast<float>(nrOfTriangles);
+}
+
+void OptimizeVertexCache(unsigned int* pIndices, unsigned int nrOfIndices, unsigned int nrOfVertices)
+{
+	unsigned int nrOfTriangles = nrOfIndices / 3;
+	if(nrOfTriangles == 0)
+		return;
+
+	//Triangles using each vertex, as ranges in one array. The first nrOfRemaining[v] entries of a range are the ones not emitted yet.
+	std::vector<unsigned int> nrOfRemaining(nrOfVertices, 0), firstTriangle(nrOfVertices + 1, 0);
+	for(unsigned int i = 0; i < nrOfTriangles * 3; ++i)
+		++nrOfRemaining[pIndices[i]];
+
+	for(unsigned int v = 0; v < nrOfVertices; ++v)
+		firstTriangle[v + 1] = firstTriangle[v] + nrOfRemaining[v];
+
+	std::vector<unsigned int> vertexTriangles(nrOfTriangles * 3), fillPosition(firstTriangle.begin(), firstTriangle.end() - 1);
+	for(unsigned int i = 0; i < nrOfTriangles * 3; ++i)
+		vertexTriangles[fillPosition[pIndices[i]]++] = i / 3;
+
+	std::vector<int> cachePositions(nrOfVertices, -1);
+	std::vector<float> vertexScores(nrOfVertices);
+	for(unsigned int v = 0; v < nrOfVertices; ++v)
+		vertexScores[v] = GetVertexScore(-1, nrOfRemaining[v]);
+
+	std::vector<float> triangleScores(nrOfTriangles);
+	std::vector<char> emitted(nrOfTriangles, 0);
+
+	int bestTriangle = 0;
+	for(unsigned int t = 0; t < nrOfTriangles; ++t){
+		const unsigned int* pTriangle = pIndices + t * 3;
+		triangleScores[t] = vertexScores[pTriangle[0]] + vertexScores[pTriangle[1]] + vertexScores[pTriangle[2]];
+		if(triangleScores[t] > triangleScores[bestTriangle])
+			bestTriangle = t;
+	}
+
+	std::vector<unsigned int> output;
+	output.reserve(nrOfTriangles * 3);
+
+	unsigned int cache[SCORING_CACHE_SIZE + 3], newCache[SCORING_CACHE_SIZE + 3];
+	unsigned int cacheSize = 0, nextUnemitted = 0;
+
+	while(bestTriangle >= 0){
+		const unsigned int* pTriangle = pIndices + bestTriangle * 3;
+		emitted[bestTriangle] = 1;
+		output.insert(output.end(), pTriangle, pTriangle + 3);
+
+		for(unsigned int i = 0; i < 3; ++i){
+			unsigned int v = pTriangle[i];
+			unsigned int* pBegin = &vertexTriangles[firstTriangle[v]];
+			unsigned int* pEnd = pBegin + nrOfRemaining[v];
+
+			*std::find(pBegin, pEnd, static_cast<unsigned int>(bestTriangle) ) = *(pEnd - 1);
+			--nrOfRemaining[v];
+		}
+
+		//The triangle's vertices move to the front of the cache, the rest shift back
+		unsigned int newCacheSize = 0;
+		for(unsigned int i = 0; i < 3; ++i)
+			newCache[newCacheSize++] = pTriangle[i];
+
+		for(unsigned int i = 0; i < cacheSize; ++i)
+			if(cache[i] != pTriangle[0] && cache[i] != pTriangle[1] && cache[i] != pTriangle[2])
+				newCache[newCacheSize++] = cache[i];
+
+		for(unsigned int i = 0; i < newCacheSize; ++i){
+			unsigned int v = newCache[i];
+			cachePositions[v] = i < SCORING_CACHE_SIZE ? static_cast<int>(i) : -1;
+			vertexScores[v] = GetVertexScore(cachePositions[v], nrOfRemaining[v]);
+		}
+
+		//Only triangles touching the old or new cache changed score, the best next triangle is almost always among them
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for(unsigned int i = 0; i < newCacheSize; ++i){
+			unsigned int v = newCache[i];
+			for(unsigned int j = firstTriangle[v], end = firstTriangle[v] + nrOfRemaining[v]; j < end; ++j){
+				unsigned int t = vertexTriangles[j];
+				const unsigned int* pCandidate = pIndices + t * 3;
+				triangleScores[t] = vertexScores[pCandidate[0]] + vertexScores[pCandidate[1]] + vertexScores[pCandidate[2]];
+
+				if(triangleScores[t] > bestScore){
+					bestScore = triangleScores[t];
+					bestTriangle = t;
+				}
+			}
+		}
+
+		cacheSize = std::min(newCacheSize, SCORING_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheSize, cache);
+
+		//Dead end, continue with the next triangle in the original order
+		if(bestTriangle < 0){
+			while(nextUnemitted < nrOfTriangles && emitted[nextUnemitted])
+				++nextUnemitted;
+
+			if(nextUnemitted < nrOfTriangles)
+				bestTriangle = nextUnemitted;
+		}
+	}
+
+	std::copy(output.begin(), output.end(), pIndices);
+}
+
+void OptimizeOverdraw(unsigned int* pIndices, unsigned int nrOfIndices, const float* pPositions, unsigned int positionStride
+					 ,unsigned int nrOfVertices, float threshold)
+{
+	unsigned int nrOfTriangles = nrOfIndices / 3;
+	if(nrOfTriangles == 0)
+		return;
+
+	auto getPosition = [&](unsigned int vertex) -> tt::Vector3 {
+		const float* pPosition = reinterpret_cast<const float*>(reinterpret_cast<const char*>(pPositions) + vertex * positionStride);
+		return tt::Vector3(pPosition[0], pPosition[1], pPosition[2]);
+	};
+
+	//Hard boundaries: triangles that miss the cache on all three vertices start over anyway
+	VertexCache cache(nrOfVertices, VERTEX_CACHE_SIZE);
+	std::vector<unsigned int> hardBoundaries;
+	for(unsigned int t = 0; t < nrOfTriangles; ++t)
+		if(cache.FetchTriangle(pIndices + t * 3) == 3 || t == 0)
+			hardBoundaries.push_back(t);
+
+	hardBoundaries.push_back(nrOfTriangles);
+
+	//Soft boundaries: split a run again wherever the part before the split is already about as cache efficient as the whole run
+	std::vector<unsigned int> clusters;
+	for(unsigned int i = 0; i + 1 < hardBoundaries.size(); ++i){
+		unsigned int begin = hardBoundaries[i], end = hardBoundaries[i + 1];
+
+		cache.Flush();
+		unsigned int nrOfRunMisses = 0;
+		for(unsigned int t = begin; t < end; ++t)
+			nrOfRunMisses += cache.FetchTriangle(pIndices + t * 3);
+
+		float maxACMR = threshold * nrOfRunMisses / static_cast<float>(end - begin);
+
+		cache.Flush();
+		clusters.push_back(begin);
+		unsigned int clusterBegin = begin, nrOfMisses = 0;
+		for(unsigned int t = begin; t < end; ++t){
+			nrOfMisses += cache.FetchTriangle(pIndices + t * 3);
+
+			if(t + 1 < end && nrOfMisses <= maxACMR * (t + 1 - clusterBegin) ){
+				clusterBegin = t + 1;
+				clusters.push_back(clusterBegin);
+				nrOfMisses = 0;
+				cache.Flush();
+			}
+		}
+	}
+	clusters.push_back(nrOfTriangles);
+
+	//Area weighted centroid and normal of the mesh and every cluster
+	tt::Vector3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	std::vector<tt::Vector3> clusterCentroids(clusters.size() - 1), clusterNormals(clusters.size() - 1);
+	for(unsigned int c = 0; c + 1 < clusters.size(); ++c){
+		tt::Vector3 centroid(0.0f), normal(0.0f);
+		float clusterArea = 0.0f;
+
+		for(unsigned int t = clusters[c]; t < clusters[c + 1]; ++t){
+			tt::Vector3 p0 = getPosition(pIndices[t * 3]), p1 = getPosition(pIndices[t * 3 + 1]), p2 = getPosition(pIndices[t * 3 + 2]);
+			tt::Vector3 triangleNormal = (p1 - p0).Cross(p2 - p0);
+			float area = triangleNormal.Length();
+
+			centroid += (p0 + p1 + p2) * (area / 3.0f);
+			normal += triangleNormal;
+			clusterArea += area;
+		}
+
+		meshCentroid += centroid;
+		meshArea += clusterArea;
+
+		clusterCentroids[c] = clusterArea > 0.0f ? centroid / clusterArea : getPosition(pIndices[clusters[c] * 3]);
+		clusterNormals[c] = normal.LengthSq() > 0.0f ? tt::Vector3::Normalize(normal) : normal;
+	}
+
+	if(meshArea > 0.0f)
+		meshCentroid /= meshArea;
+
+	//Clusters facing away from the center are in front of the others for most view directions, draw them first
+	std::vector<float> sortKeys(clusters.size() - 1);
+	std::vector<unsigned int> clusterOrder(clusters.size() - 1);
+	for(unsigned int c = 0; c < clusterOrder.size(); ++c){
+		sortKeys[c] = (clusterCentroids[c] - meshCentroid).Dot(clusterNormals[c]);
+		clusterOrder[c] = c;
+	}
+
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](unsigned int a, unsigned int b){
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	std::vector<unsigned int> output;
+	output.reserve(nrOfTriangles * 3);
+	for(auto c : clusterOrder)
+		output.insert(output.end(), pIndices + clusters[c] * 3, pIndices + clusters[c + 1] * 3);
+
+	std::copy(output.begin(), output.end(), pIndices);
+}
+
+unsigned int OptimizeVertexFetch(unsigned int* pIndices, unsigned int nrOfIndices, unsigned int nrOfVertices, std::vector<unsigned int>& remap)
+{
+	remap.assign(nrOfVertices, UNUSED_VERTEX);
+
+	unsigned int nrOfUsedVertices = 0;
+	for(unsigned int i = 0; i < nrOfIndices; ++i){
+		unsigned int& newIndex = remap[pIndices[i]];
+		if(newIndex == UNUSED_VERTEX)
+			newIndex = nrOfUsedVertices++;
+
+		pIndices[i] = newIndex;
+	}
+
+	return nrOfUsedVertices;
+}
+
+void BuildClusters(unsigned int* pIndices, unsigned int nrOfIndices, const float* pPositions, unsigned int positionStride, unsigned int nrOfVertices
+				  ,std::vector<unsigned int>& clusterStarts, unsigned int maxVertices, unsigned int maxTriangles)
+{
+	unsigned int nrOfTriangles = nrOfIndices / 3;
+	clusterStarts.clear();
+
+	auto getPosition = [&](unsigned int vertex) -> tt::Vector3 {
+		const float* pPosition = reinterpret_cast<const float*>(reinterpret_cast<const char*>(pPositions) + vertex * positionStride);
+		return tt::Vector3(pPosition[0], pPosition[1], pPosition[2]);
+	};
+
+	//Triangles using each vertex, as ranges in one array
+	std::vector<unsigned int> firstTriangle(nrOfVertices + 1, 0), vertexTriangles(nrOfTriangles * 3);
+	for(unsigned int i = 0; i < nrOfTriangles * 3; ++i)
+		++firstTriangle[pIndices[i] + 1];
+	for(unsigned int v = 0; v < nrOfVertices; ++v)
+		firstTriangle[v + 1] += firstTriangle[v];
+
+	std::vector<unsigned int> fillPosition(firstTriangle.begin(), firstTriangle.end() - 1);
+	for(unsigned int i = 0; i < nrOfTriangles * 3; ++i)
+		vertexTriangles[fillPosition[pIndices[i]]++] = i / 3;
+
+	std::vector<tt::Vector3> normals(nrOfTriangles);
+	for(unsigned int t = 0; t < nrOfTriangles; ++t){
+		tt::Vector3 p0 = getPosition(pIndices[t * 3]);
+		tt::Vector3 normal = (getPosition(pIndices[t * 3 + 1]) - p0).Cross(getPosition(pIndices[t * 3 + 2]) - p0);
+		normals[t] = normal.LengthSq() > 0.0f ? tt::Vector3::Normalize(normal) : normal;
+	}
+
+	//Cluster every vertex was last added to, and whether a triangle is waiting in the candidates or emitted already
+	std::vector<unsigned int> vertexCluster(nrOfVertices, UNUSED_VERTEX), candidates, output;
+	std::vector<char> emitted(nrOfTriangles, 0), isCandidate(nrOfTriangles, 0);
+	output.reserve(nrOfTriangles * 3);
+
+	unsigned int nextSeed = 0;
+	while(true){
+		while(nextSeed < nrOfTriangles && emitted[nextSeed])
+			++nextSeed;
+		if(nextSeed == nrOfTriangles)
+			break;
+
+		unsigned int cluster = clusterStarts.size(), nrOfClusterVertices = 0, nrOfClusterTriangles = 0;
+		tt::Vector3 clusterNormal(0.0f);
+		clusterStarts.push_back(output.size() );
+		candidates.clear();
+
+		unsigned int triangle = nextSeed;
+		while(true){
+			const unsigned int* pTriangle = pIndices + triangle * 3;
+			emitted[triangle] = 1;
+			output.insert(output.end(), pTriangle, pTriangle + 3);
+			clusterNormal += normals[triangle];
+			++nrOfClusterTriangles;
+
+			for(unsigned int i = 0; i < 3; ++i){
+				unsigned int v = pTriangle[i];
+				if(vertexCluster[v] == cluster)
+					continue;
+
+				vertexCluster[v] = cluster;
+				++nrOfClusterVertices;
+
+				for(unsigned int j = firstTriangle[v]; j < firstTriangle[v + 1]; ++j){
+					unsigned int neighbour = vertexTriangles[j];
+					if(!emitted[neighbour] && !isCandidate[neighbour]){
+						isCandidate[neighbour] = 1;
+						candidates.push_back(neighbour);
+					}
+				}
+			}
+
+			if(nrOfClusterTriangles == maxTriangles)
+				break;
+
+			//Neighbour that adds the fewest vertices, ties go to the one facing most like the cluster
+			int bestCandidate = -1;
+			float bestScore = FLT_MAX;
+			unsigned int nrOfKeptCandidates = 0;
+
+			for(auto candidate : candidates){
+				if(emitted[candidate]){
+					isCandidate[candidate] = 0;
+					continue;
+				}
+				candidates[nrOfKeptCandidates++] = candidate;
+
+				const unsigned int* pCandidate = pIndices + candidate * 3;
+				unsigned int nrOfNewVertices = (vertexCluster[pCandidate[0]] != cluster) + (vertexCluster[pCandidate[1]] != cluster) + (vertexCluster[pCandidate[2]] != cluster);
+				if(nrOfClusterVertices + nrOfNewVertices > maxVertices)
+					continue;
+
+				float score = nrOfNewVertices - normals[candidate].Dot(clusterNormal) / nrOfClusterTriangles * 0.5f;
+				if(score < bestScore){
+					bestScore = score;
+					bestCandidate = candidate;
+				}
+			}
+			candidates.resize(nrOfKeptCandidates);
+
+			if(bestCandidate < 0)
+				break;
+
+			triangle = bestCandidate;
+		}
+
+		for(auto candidate : candidates)
+			isCandidate[candidate] = 0;
+	}
+
+	clusterStarts.push_back(output.size() );
+	std::copy(output.begin(), output.end(), pIndices);
+}
+
+float SimplifyMesh(const unsigned int* pIndices, unsigned int nrOfIndices, const float* pPositions, unsigned int positionStride, unsigned int nrOfVertices
+				  ,unsigned int targetNrOfIndices, float maxError, std::vector<unsigned int>& result, const unsigned int* pVertexGroups)
+{
+	result.assign(pIndices, pIndices + nrOfIndices / 3 * 3);
+
+	auto getPosition = [&](unsigned int vertex) -> tt::Vector3 {
+		const float* pPosition = reinterpret_cast<const float*>(reinterpret_cast<const char*>(pPositions) + vertex * positionStride);
+		return tt::Vector3(pPosition[0], pPosition[1], pPosition[2]);
+	};
+
+	//Topology works on positions, vertices that only differ in their other attributes share one
+	std::vector<tt::Vector3> positions(nrOfVertices);
+	for(unsigned int v = 0; v < nrOfVertices; ++v)
+		positions[v] = getPosition(v);
+
+	std::vector<unsigned int> positionIds;
+	WeldVertices(reinterpret_cast<char*>(std::vector<tt::Vector3>(positions).data() ), nrOfVertices, sizeof(tt::Vector3), positionIds);
+
+	std::vector<unsigned long long> edges;
+	auto buildEdges = [&](void){
+		edges.clear();
+		for(unsigned int i = 0; i < result.size(); i += 3)
+			for(unsigned int j = 0; j < 3; ++j)
+				edges.push_back(GetEdgeKey(positionIds[result[i + j]], positionIds[result[i + (j + 1) % 3]]) );
+
+		std::sort(edges.begin(), edges.end() );
+	};
+	buildEdges();
+
+	//Quadrics of the triangle planes around every position, plus planes perpendicular to open borders to keep their outline
+	std::vector<Quadric> quadrics(nrOfVertices);
+	for(unsigned int i = 0; i < result.size(); i += 3){
+		tt::Vector3 p0 = positions[result[i]], p1 = positions[result[i + 1]], p2 = positions[result[i + 2]];
+		tt::Vector3 normal = (p1 - p0).Cross(p2 - p0);
+		float area = normal.Length();
+		if(area <= 0.0f)
+			continue;
+
+		normal /= area;
+		Quadric plane(normal, p0, area * 0.5f);
+		for(unsigned int j = 0; j < 3; ++j)
+			quadrics[positionIds[result[i + j]]] += plane;
+
+		for(unsigned int j = 0; j < 3; ++j){
+			unsigned int a = result[i + j], b = result[i + (j + 1) % 3];
+			if(CountEdge(edges, positionIds[a], positionIds[b]) != 1)
+				continue;
+
+			tt::Vector3 edge = positions[b] - positions[a];
+			tt::Vector3 borderNormal = edge.Cross(normal);
+			if(borderNormal.LengthSq() <= 0.0f)
+				continue;
+
+			Quadric borderPlane(tt::Vector3::Normalize(borderNormal), positions[a], edge.LengthSq() );
+			quadrics[positionIds[a]] += borderPlane;
+			quadrics[positionIds[b]] += borderPlane;
+		}
+	}
+
+	double maxSqError = static_cast<double>(maxError) * maxError, largestError = 0;
+	std::vector<VertexKind> kinds(nrOfVertices);
+	std::vector<unsigned int> nrOfWedges(nrOfVertices), nrOfBorderEdges(nrOfVertices), firstTriangle(nrOfVertices + 1), vertexTriangles, remap(nrOfVertices);
+	std::vector<char> used(nrOfVertices), locked(nrOfVertices);
+	std::vector<Collapse> collapses;
+
+	while(result.size() > targetNrOfIndices){
+		//Classify the positions of what is left of the mesh
+		std::fill(nrOfWedges.begin(), nrOfWedges.end(), 0);
+		std::fill(nrOfBorderEdges.begin(), nrOfBorderEdges.end(), 0);
+		std::fill(kinds.begin(), kinds.end(), VertexKind::Manifold);
+		std::fill(used.begin(), used.end(), 0);
+
+		for(auto v : result){
+			if(!used[v])
+				++nrOfWedges[positionIds[v]];
+			used[v] = 1;
+		}
+
+		for(unsigned int i = 0; i < edges.size(); ){
+			unsigned int count = 1;
+			while(i + count < edges.size() && edges[i + count] == edges[i])
+				++count;
+
+			unsigned int ends[] = {static_cast<unsigned int>(edges[i] >> 32), static_cast<unsigned int>(edges[i] & 0xFFFFFFFF)};
+			for(auto p : ends){
+				if(count == 1)
+					++nrOfBorderEdges[p];
+				else if(count > 2)
+					kinds[p] = VertexKind::Locked;
+			}
+			i += count;
+		}
+
+		for(unsigned int p = 0; p < nrOfVertices; ++p){
+			if(nrOfWedges[p] > 1 || (nrOfBorderEdges[p] != 0 && nrOfBorderEdges[p] != 2) )
+				kinds[p] = VertexKind::Locked;
+			else if(nrOfBorderEdges[p] == 2 && kinds[p] != VertexKind::Locked)
+				kinds[p] = VertexKind::Border;
+		}
+
+		//Triangles around every vertex
+		std::fill(firstTriangle.begin(), firstTriangle.end(), 0);
+		for(auto v : result)
+			++firstTriangle[v + 1];
+		for(unsigned int v = 0; v < nrOfVertices; ++v)
+			firstTriangle[v + 1] += firstTriangle[v];
+
+		vertexTriangles.resize(result.size() );
+		std::vector<unsigned int> fillPosition(firstTriangle.begin(), firstTriangle.end() - 1);
+		for(unsigned int i = 0; i < result.size(); ++i)
+			vertexTriangles[fillPosition[result[i]]++] = i / 3;
+
+		//Every half-edge collapse the vertex kinds allow, cheapest first
+		collapses.clear();
+		for(unsigned int i = 0; i < result.size(); ++i){
+			unsigned int a = result[i], b = result[i / 3 * 3 + (i + 1) % 3];
+			unsigned int directions[2][2] = {{a, b}, {b, a}};
+
+			for(auto& direction : directions){
+				unsigned int from = direction[0], to = direction[1];
+				VertexKind kind = kinds[positionIds[from]];
+
+				if(kind == VertexKind::Locked || positionIds[from] == positionIds[to])
+					continue;
+				if(kind == VertexKind::Border && CountEdge(edges, positionIds[from], positionIds[to]) != 1)
+					continue;
+				if(pVertexGroups && pVertexGroups[from] != pVertexGroups[to])
+					continue;
+
+				Quadric quadric = quadrics[positionIds[from]];
+				quadric += quadrics[positionIds[to]];
+
+				Collapse collapse = {from, to, quadric.GetError(positions[to])};
+				if(collapse.Error <= maxSqError)
+					collapses.push_back(collapse);
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b){
+			return a.Error < b.Error;
+		});
+
+		//Collapse as many as possible without two of them touching the same triangles, so each can be checked against the mesh as it is
+		for(unsigned int v = 0; v < nrOfVertices; ++v)
+			remap[v] = v;
+		std::fill(locked.begin(), locked.end(), 0);
+
+		unsigned int nrOfTrianglesToRemove = (result.size() - targetNrOfIndices + 2) / 3, nrOfRemovedTriangles = 0;
+		for(auto& collapse : collapses){
+			if(nrOfRemovedTriangles >= nrOfTrianglesToRemove)
+				break;
+			if(locked[collapse.From] || locked[collapse.To])
+				continue;
+
+			//Triangles that stay must not flip over when their corner moves
+			bool bFlips = false;
+			unsigned int nrOfCollapsingTriangles = 0;
+			for(unsigned int j = firstTriangle[collapse.From]; j < firstTriangle[collapse.From + 1] && !bFlips; ++j){
+				const unsigned int* pTriangle = &result[vertexTriangles[j] * 3];
+				if(pTriangle[0] == collapse.To || pTriangle[1] == collapse.To || pTriangle[2] == collapse.To){
+					++nrOfCollapsingTriangles;
+					continue;
+				}
+
+				tt::Vector3 corners[3], movedCorners[3];
+				for(unsigned int k = 0; k < 3; ++k){
+					corners[k] = positions[pTriangle[k]];
+					movedCorners[k] = pTriangle[k] == collapse.From ? positions[collapse.To] : corners[k];
+				}
+
+				tt::Vector3 normal = (corners[1] - corners[0]).Cross(corners[2] - corners[0]);
+				tt::Vector3 movedNormal = (movedCorners[1] - movedCorners[0]).Cross(movedCorners[2] - movedCorners[0]);
+				bFlips = normal.Dot(movedNormal) <= 0.0f;
+			}
+
+			if(bFlips)
+				continue;
+
+			remap[collapse.From] = collapse.To;
+			quadrics[positionIds[collapse.To]] += quadrics[positionIds[collapse.From]];
+			largestError = std::max(largestError, collapse.Error);
+			nrOfRemovedTriangles += nrOfCollapsingTriangles;
+
+			for(unsigned int j = firstTriangle[collapse.From]; j < firstTriangle[collapse.From + 1]; ++j)
+				for(unsigned int k = 0; k < 3; ++k)
+					locked[result[vertexTriangles[j] * 3 + k]] = 1;
+		}
+
+		if(nrOfRemovedTriangles == 0)
+			break;
+
+		//Drop the triangles that collapsed
+		unsigned int nrOfKeptIndices = 0;
+		for(unsigned int i = 0; i < result.size(); i += 3){
+			unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+			if(a == b || b == c || c == a)
+				continue;
+
+			result[nrOfKeptIndices++] = a;
+			result[nrOfKeptIndices++] = b;
+			result[nrOfKeptIndices++] = c;
+		}
+		result.resize(nrOfKeptIndices);
+
+		buildEdges();
+	}
+
+	return static_cast<float>(sqrt(largestError) );
+}
@@ -0,0 +1,68 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <vector>
+
+//Welding, reordering and simplification of indexed triangle lists for the GPU, run when vertex buffers are built or meshes are cooked (see Model3D).
+//Pure CPU work on index and vertex arrays, nothing here touches the graphics device. Indices must be smaller than nrOfVertices.
+
+//Size of the post-transform vertex cache the orderings are measured against
+const unsigned int VERTEX_CACHE_SIZE = 16;
+
+//Marks vertices OptimizeVertexFetch dropped because no triangle uses them
+const unsigned int UNUSED_VERTEX = 0xFFFFFFFF;
+
+//Merges vertices with identical bytes, compacting the stride sized vertices in pVertices in place. First occurrences keep their order.
+//Fills remap with the new index of every old vertex and returns the number of unique vertices.
+unsigned int WeldVertices(char* pVertices, unsigned int nrOfVertices, unsigned int stride, std::vector<unsigned int>& remap);
+
+//Number of different vertices the indices use
+unsigned int CountUsedVertices(const unsigned int* pIndices, unsigned int nrOfIndices, unsigned int nrOfVertices);
+
+//Average cache miss ratio: vertices transformed per triangle with a FIFO cache of cacheSize entries.
+//0.5 is the ideal for large closed meshes, 3 means every vertex is transformed again for every triangle.
+float CalculateACMR(const unsigned int* pIndices, unsigned int nrOfIndices, unsigned int nrOfVertices, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+//Reorders triangles so consecutive ones share vertices still in the post-transform cache (Forsyth's linear-speed algorithm)
+void OptimizeVertexCache(unsigned int* pIndices, unsigned int nrOfIndices, unsigned int nrOfVertices);
+
+//Runs after OptimizeVertexCache. Splits the triangle order into clusters where the cache restarts anyway, or where the ACMR
+//so far stays within threshold times that of the surrounding run, and draws outward facing clusters first to reduce overdraw.
+//pPositions points to 3 floats every positionStride bytes.
+void OptimizeOverdraw(unsigned int* pIndices, unsigned int nrOfIndices, const float* pPositions, unsigned int positionStride
+					 ,unsigned int nrOfVertices, float threshold = 1.05f);
+
+//Renumbers vertices in the order the triangles first use them, so vertex fetches walk memory linearly. Rewrites the indices and
+//fills remap with the new index of every old vertex, or UNUSED_VERTEX. Returns the number of vertices still in use.
+unsigned int OptimizeVertexFetch(unsigned int* pIndices, unsigned int nrOfIndices, unsigned int nrOfVertices, std::vector<unsigned int>& remap);
+
+//Splits the triangles into clusters of at most maxVertices vertices and maxTriangles triangles that lie together and face about the
+//same way, so they can be culled apart (see MeshClusters.h). Triangles are reordered so every cluster is one range of indices,
+//clusterStarts receives the first index of every cluster followed by nrOfIndices. Clusters grow from the first triangle left in the
+//current order, so an order from OptimizeOverdraw mostly carries over, and add neighbours that bring the fewest new vertices.
+void BuildClusters(unsigned int* pIndices, unsigned int nrOfIndices, const float* pPositions, unsigned int positionStride, unsigned int nrOfVertices
+				  ,std::vector<unsigned int>& clusterStarts, unsigned int maxVertices, unsigned int maxTriangles);
+
+//Quadric error simplification (Garland & Heckbert) by collapsing vertices onto one of their neighbours, so the vertices that are left
+//keep all of their attributes. Fills result with at most targetNrOfIndices indices into the same vertices, or as few as collapses
+//moving the surface less than maxError (in position units) get to. Vertices at a position shared with other vertices (attribute seams)
+//and on non-manifold edges stay in place, vertices on open borders only move along the border.
+//pVertexGroups is optional, vertices only collapse onto vertices of the same group. Returns the largest error of the collapses made.
+float SimplifyMesh(const unsigned int* pIndices, unsigned int nrOfIndices, const float* pPositions, unsigned int positionStride, unsigned int nrOfVertices
+				  ,unsigned int targetNrOfIndices, float maxError, std::vector<unsigned int>& result, const unsigned int* pVertexGroups = nullptr);
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -21,8 +21,30 @@
 #include "GraphicsDevice.h"
 #include "Material.h"
 #include "EffectTechnique.h"
+#include "MeshOptimizer.h"
+#include "MeshCooker.h"
+#include "VertexFormat.h"
+
+bool Model3D::s_bCompressClips = true;
+float Model3D::s_RotationTolerance = 0.001f;
+float Model3D::s_TranslationTolerance = 0.001f;
+unsigned int Model3D::s_NrOfLODs = 3;
+float Model3D::s_LODReduction = 0.5f;
+float Model3D::s_MaxLODError = 0.05f;
+
+namespace
+{
+	const CookedStreamElement* FindCookedElement(const vector<CookedStreamElement>& elements, const InputLayoutElement& ilDesc)
+	{
+		for(auto& element : elements)
+			if(element.Semantic == ilDesc.Semantic && element.SemanticIndex == ilDesc.SemanticIndex)
+				return &element;
+
+		return nullptr;
+	}
+}
 
-VertexBufferInfo::VertexBufferInfo(void):pDataStart(nullptr),pVertexBuffer(nullptr){}
+VertexBufferInfo::VertexBufferInfo(void):pDataStart(nullptr),pVertexBuffer(nullptr),pIndexBuffer(nullptr),IndexFormat(DXGI_FORMAT_R32_UINT){}
 
 void VertexBufferInfo::Release(void)
 {
@@ -30,81 +52,12 @@ void VertexBufferInfo::Release(void)
 
 	if(pVertexBuffer)
 		pVertexBuffer->Release();
-}
 
-Ray::Ray(const tt::Vector3& origin, const tt::Vector3& direction)
-{
-	Origin = origin;
-	Direction = direction;
-	InvDirection = tt::Vector3(1/direction.x, 1/direction.y, 1/direction.z);
-	sign[0] = (InvDirection.x < 0); 
-	sign[1] = (InvDirection.y < 0);
-	sign[2] = (InvDirection.z < 0);
-}
-	
-AABBox::AABBox(void)
-{
-	Bounds[0] = tt::Vector3(INFINITY);
-	Bounds[1] = tt::Vector3(-INFINITY);
+	if(pIndexBuffer)
+		pIndexBuffer->Release();
 }
 
-AABBox::~AABBox(void){}
-
-void AABBox::Initialize(const vector<D3DXVECTOR3>& vertices)
-{
-	for(auto& vertex : vertices)
-	{
-		Bounds[0].x = min(vertex.x, Bounds[0].x);
-		Bounds[0].y = min(vertex.y, Bounds[0].y);
-		Bounds[0].z = min(vertex.z, Bounds[0].z);
-		
-		Bounds[1].x = max(vertex.x, Bounds[1].x);
-		Bounds[1].y = max(vertex.y, Bounds[1].y);
-		Bounds[1].z = max(vertex.z, Bounds[1].z);
-	}
-}
-
-void AABBox::GetVertices(tt::Vector3* targetArr) const
-{
-	targetArr[0] = tt::Vector3(Bounds[0].x, Bounds[0].y, Bounds[0].z);
-	targetArr[1] = tt::Vector3(Bounds[0].x, Bounds[0].y, Bounds[1].z);
-	targetArr[2] = tt::Vector3(Bounds[0].x, Bounds[1].y, Bounds[0].z);
-	targetArr[3] = tt::Vector3(Bounds[0].x, Bounds[1].y, Bounds[1].z);
-	targetArr[4] = tt::Vector3(Bounds[1].x, Bounds[0].y, Bounds[0].z);
-	targetArr[5] = tt::Vector3(Bounds[1].x, Bounds[0].y, Bounds[1].z);	
-	targetArr[6] = tt::Vector3(Bounds[1].x, Bounds[1].y, Bounds[0].z);
-	targetArr[7] = tt::Vector3(Bounds[1].x, Bounds[1].y, Bounds[1].z);
-}
-
-//Optimized method to check ray-AABB intersection
-bool AABBox::Intersect(const Ray& ray, float t0, float t1) const
-{
-	float txMin = (Bounds[  ray.sign[0]].x - ray.Origin.x) * ray.InvDirection.x; 
-	float txMax = (Bounds[1-ray.sign[0]].x - ray.Origin.x) * ray.InvDirection.x; 
-	float tyMin = (Bounds[  ray.sign[1]].y - ray.Origin.y) * ray.InvDirection.y;
-	float tyMax = (Bounds[1-ray.sign[1]].y - ray.Origin.y) * ray.InvDirection.y;
-
-	if( (txMin > tyMax) || (tyMin > txMax) )
-		return false;
-	if(tyMin > txMin) 
-		txMin = tyMin;
-	if(tyMax < txMax) 
-		txMax = tyMax;
-	
-	float tzMin = (Bounds[  ray.sign[2]].z - ray.Origin.z) * ray.InvDirection.z; 
-	float tzMax = (Bounds[1-ray.sign[2]].z - ray.Origin.z) * ray.InvDirection.z;
-	
-	if( (txMin > tzMax) || (tzMin > txMax) )
-		return false;
-	if(tzMin > txMin)
-		txMin = tzMin;
-	if(tzMax < txMax)
-		txMax = tzMax;
-	
-	return( (txMin < t1) && (txMax > t0) );
-}
-
-Model3D::Model3D(void):m_pIndexBuffer(nullptr)
+Model3D::Model3D(void)
 {
 
 }
@@ -137,111 +90,44 @@ void Model3D::BuildVertexBuffer(resource_ptr<Material> pMaterial)
 		if(vertBufferInfo.pInputLayout == pMaterialInputLayout)
 			return;
 
-	unsigned int vbStride = 0;
+	const auto& layoutDesc = pMaterialInputLayout->InputLayoutDesc;
 
 	//Check if we have at least the data MaterialIL needs
-	for(auto& ilDesc : pMaterialInputLayout->InputLayoutDesc){
-		switch(ilDesc.Semantic){
-			case InputLayoutSemantic::Position:
-				if(m_Positions.data.empty())
-					throw exception();
-				else
-					vbStride += sizeof(D3DXVECTOR3);
-				break;
-			case InputLayoutSemantic::TexCoord:
-				if(m_TexCoords[ilDesc.SemanticIndex].data.empty())
-					throw exception();
-				else
-					vbStride += sizeof(D3DXVECTOR2);
-				break;
-			case InputLayoutSemantic::Normal:
-				if(m_Normals.data.empty())
-					throw exception();
-				else
-					vbStride += sizeof(D3DXVECTOR3);
-				break;
-			case InputLayoutSemantic::Tangent:
-				if(m_Tangents.data.empty())
-					throw exception();
-				else
-					vbStride += sizeof(D3DXVECTOR3);
-				break;
-			case InputLayoutSemantic::Binormal:
-				if(m_Binormals.data.empty())
-					throw exception();
-				else
-					vbStride += sizeof(D3DXVECTOR3);
-				break;
-			case InputLayoutSemantic::Color:
-				if(m_Colors.data.empty())
-					throw exception();
-				else
-					vbStride += sizeof(D3DXCOLOR);
-				break;
-			case InputLayoutSemantic::BlendIndices:
-				if(m_BlendIndices.data.empty())
-					throw exception();
-				else
-					vbStride += sizeof(D3DXVECTOR4);
-				break;
-			case InputLayoutSemantic::BlendWeights:
-				if(m_BlendWeights.data.empty())
-					throw exception();
-				else
-					vbStride += sizeof(D3DXVECTOR4);
-				break;
-		}
-	}
+	unsigned int vbStride = GetVertexStride(layoutDesc);
+	if(vbStride == 0)
+		throw exception();
 	
 	//Prepare VertBufferInfo
 	VertexBufferInfo vbInfo;
 	vbInfo.pInputLayout = pMaterialInputLayout;
 	vbInfo.VertexStride = vbStride;
-	vbInfo.BufferSize = vbStride * m_Positions.indices.size();
-
-	//Allocate memory for actual buffer
-	void* pDataLocation = malloc(vbInfo.BufferSize);	
-	vbInfo.pDataStart = pDataLocation;
-
-	//Write vertex data to buffer
-	for(unsigned int i=0; i < m_Positions.indices.size(); ++i){
-		for(auto& ilDesc : pMaterialInputLayout->InputLayoutDesc){
-			switch(ilDesc.Semantic){
-				case InputLayoutSemantic::Position:
-					memcpy(pDataLocation, &m_Positions.GetRefAt(i), sizeof(D3DXVECTOR3));
-					pDataLocation = static_cast<D3DXVECTOR3*>(pDataLocation) + 1;
-					break;
-				case InputLayoutSemantic::TexCoord:
-					memcpy(pDataLocation, &m_TexCoords[ilDesc.SemanticIndex].GetRefAt(i), sizeof(D3DXVECTOR2));
-					pDataLocation = static_cast<D3DXVECTOR2*>(pDataLocation) + 1;
-					break;
-				case InputLayoutSemantic::Normal:
-					memcpy(pDataLocation, &m_Normals.GetRefAt(i), sizeof(D3DXVECTOR3));
-					pDataLocation = static_cast<D3DXVECTOR3*>(pDataLocation) + 1;
-					break;
-				case InputLayoutSemantic::Tangent:
-					memcpy(pDataLocation, &m_Tangents.GetRefAt(i), sizeof(D3DXVECTOR3));
-					pDataLocation = static_cast<D3DXVECTOR3*>(pDataLocation) + 1;
-					break;
-				case InputLayoutSemantic::Binormal:
-					memcpy(pDataLocation, &m_Binormals.GetRefAt(i), sizeof(D3DXVECTOR3));
-					pDataLocation = static_cast<D3DXVECTOR3*>(pDataLocation) + 1;
-					break;
-				case InputLayoutSemantic::Color:
-					memcpy(pDataLocation, &m_Colors.GetRefAt(i), sizeof(D3DXCOLOR));
-					pDataLocation = static_cast<D3DXCOLOR*>(pDataLocation) + 1;
-					break;
-				case InputLayoutSemantic::BlendIndices:
-					memcpy(pDataLocation, &m_BlendIndices.GetRefAt(i), sizeof(D3DXVECTOR4));
-					pDataLocation = static_cast<D3DXVECTOR4*>(pDataLocation) + 1;
-					break;
-				case InputLayoutSemantic::BlendWeights:
-					memcpy(pDataLocation, &m_BlendWeights.GetRefAt(i), sizeof(D3DXVECTOR4));
-					pDataLocation = static_cast<D3DXVECTOR4*>(pDataLocation) + 1;
-					break;
-			}
-		}
+	vbInfo.NrOfVertices = GetNrOfVertices();
+
+	//A stream cooked for this layout is uploaded as it is (cooking welded it already), anything else is interleaved here
+	bool bExactMatch = false;
+	const CookedStream* pCookedStream = FindCookedStream(layoutDesc, bExactMatch);
+	const void* pVertexData = nullptr;
+	vector<unsigned int> indices(m_Indices);
+	indices.insert(indices.end(), m_LODIndices.begin(), m_LODIndices.end() );
+	
+	if(pCookedStream && bExactMatch)
+		pVertexData = pCookedStream->Data.data();
+	else{
+		//Allocate memory for actual buffer
+		vbInfo.pDataStart = malloc(vbStride * vbInfo.NrOfVertices);
+		WriteVertices(layoutDesc, static_cast<char*>(vbInfo.pDataStart) );
+
+		//Loader vertices are unique per combination of attribute indices, a layout that skips attributes (or equal values
+		//stored twice) still leaves duplicates to merge
+		vector<unsigned int> remap;
+		vbInfo.NrOfVertices = WeldVertices(static_cast<char*>(vbInfo.pDataStart), vbInfo.NrOfVertices, vbStride, remap);
+		for(auto& index : indices)
+			index = remap[index];
+
+		pVertexData = vbInfo.pDataStart;
 	}
+
+	vbInfo.BufferSize = vbStride * vbInfo.NrOfVertices;
 	
 	// Fill a D3D10 buffer description
 	D3D10_BUFFER_DESC bd = {};
@@ -252,41 +138,260 @@ void Model3D::BuildVertexBuffer(resource_ptr<Material> pMaterial)
 	bd.MiscFlags = 0;
 
 	D3D10_SUBRESOURCE_DATA initData;
-	initData.pSysMem = vbInfo.pDataStart;
+	initData.pSysMem = pVertexData;
 
 	// Create a ID3D10Buffer containing the vertex info
 	auto pD3DDevice = MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->GetGraphicsDevice()->GetDevice();
 	HR(pD3DDevice->CreateBuffer( &bd, &initData, &vbInfo.pVertexBuffer));
 
+	BuildIndexBuffer(vbInfo, indices);
+
 	//Add the vertex buffer info to the array
 	m_vecVertBufferInfo.push_back(vbInfo);
 }
 
-void Model3D::BuildIndexBuffer(bool force)
+unsigned int Model3D::GetNrOfVertices(void) const
 {
-	if(m_pIndexBuffer!=nullptr)
-	{
-		if(!force) //Exit if indexbuffer already exists
-			return;
-		else //Unless if forced
-			m_pIndexBuffer->Release();
+	if(!m_CookedStreams.empty() )
+		return m_CookedStreams[0].Data.size() / m_CookedStreams[0].Stride;
+
+	return m_Positions.indices.size();
+}
+
+unsigned int Model3D::GetVertexStride(const vector<InputLayoutElement>& layout) const
+{
+	unsigned int stride = 0;
+	
+	for(auto& ilDesc : layout){
+		bool bHasData = false;
+
+		if(!m_CookedStreams.empty() ){
+			for(auto& stream : m_CookedStreams)
+				bHasData = bHasData || FindCookedElement(stream.Elements, ilDesc) != nullptr;
+		}
+		else{
+			switch(ilDesc.Semantic){
+				case InputLayoutSemantic::Position:		bHasData = !m_Positions.data.empty();	 break;
+				case InputLayoutSemantic::TexCoord:		bHasData = ilDesc.SemanticIndex < m_TexCoords.size() && !m_TexCoords[ilDesc.SemanticIndex].data.empty(); break;
+				case InputLayoutSemantic::Normal:		bHasData = !m_Normals.data.empty();		 break;
+				case InputLayoutSemantic::Tangent:		bHasData = !m_Tangents.data.empty();	 break;
+				case InputLayoutSemantic::Binormal:		bHasData = !m_Binormals.data.empty();	 break;
+				case InputLayoutSemantic::Color:		bHasData = !m_Colors.data.empty();		 break;
+				case InputLayoutSemantic::BlendIndices:	bHasData = !m_BlendIndices.data.empty(); break;
+				case InputLayoutSemantic::BlendWeights:	bHasData = !m_BlendWeights.data.empty(); break;
+			}
+		}
+
+		unsigned int size = GetFormatSize(GetElementFormat(ilDesc) );
+		if(!bHasData || size == 0)
+			return 0;
+
+		stride += size;
+	}
+
+	return stride;
+}
+
+const CookedStream* Model3D::FindCookedStream(const vector<InputLayoutElement>& layout, bool& bExactMatch) const
+{
+	const CookedStream* pSuperset = nullptr;
+	bExactMatch = false;
+
+	for(auto& stream : m_CookedStreams){
+		bool bContainsLayout = true;
+		for(auto& ilDesc : layout)
+			bContainsLayout = bContainsLayout && FindCookedElement(stream.Elements, ilDesc) != nullptr;
+
+		if(!bContainsLayout)
+			continue;
+
+		//Elements are stored in layout order, so the same count means the same layout
+		if(stream.Elements.size() == layout.size() ){
+			bool bSameOrder = true;
+			for(unsigned int i=0; i < layout.size(); ++i)
+				bSameOrder = bSameOrder && stream.Elements[i].Semantic == layout[i].Semantic && stream.Elements[i].SemanticIndex == layout[i].SemanticIndex
+							&& stream.Elements[i].Format == GetElementFormat(layout[i]);
+
+			if(bSameOrder){
+				bExactMatch = true;
+				return &stream;
+			}
+		}
+
+		if(!pSuperset)
+			pSuperset = &stream;
+	}
+
+	return pSuperset;
+}
+
+void Model3D::WriteVertices(const vector<InputLayoutElement>& layout, char* pDataLocation) const
+{
+	//Cooked models only have their streams, gather the attributes from one that contains all of them
+	if(!m_CookedStreams.empty() ){
+		bool bExactMatch;
+		const CookedStream* pStream = FindCookedStream(layout, bExactMatch);
+		if(!pStream)
+			throw exception();
+
+		vector<const CookedStreamElement*> sourceElements;
+		for(auto& ilDesc : layout)
+			sourceElements.push_back(FindCookedElement(pStream->Elements, ilDesc) );
+
+		const char* pSourceVertex = pStream->Data.data();
+		for(unsigned int i=0, nrOfVertices = GetNrOfVertices(); i < nrOfVertices; ++i, pSourceVertex += pStream->Stride){
+			for(unsigned int j=0; j < layout.size(); ++j){
+				auto pElement = sourceElements[j];
+				pDataLocation += ConvertVertexElement(layout[j].Semantic, pElement->Format, pSourceVertex + pElement->Offset, GetElementFormat(layout[j]), pDataLocation);
+			}
+		}
+		return;
+	}
+
+	//Write vertex data to buffer, converted to the formats the layout asks for
+	for(unsigned int i=0; i < m_Positions.indices.size(); ++i){
+		for(auto& ilDesc : layout){
+			const void* pSource = nullptr;
+			switch(ilDesc.Semantic){
+				case InputLayoutSemantic::Position:		pSource = &m_Positions.GetRefAt(i);							break;
+				case InputLayoutSemantic::TexCoord:		pSource = &m_TexCoords[ilDesc.SemanticIndex].GetRefAt(i);	break;
+				case InputLayoutSemantic::Normal:		pSource = &m_Normals.GetRefAt(i);							break;
+				case InputLayoutSemantic::Tangent:		pSource = &m_Tangents.GetRefAt(i);							break;
+				case InputLayoutSemantic::Binormal:		pSource = &m_Binormals.GetRefAt(i);							break;
+				case InputLayoutSemantic::Color:		pSource = &m_Colors.GetRefAt(i);							break;
+				case InputLayoutSemantic::BlendIndices:	pSource = m_SkinnedSubmeshes.empty() ? &m_BlendIndices.GetRefAt(i) : &m_SubmeshBlendIndices.GetRefAt(i); break;
+				case InputLayoutSemantic::BlendWeights:	pSource = &m_BlendWeights.GetRefAt(i);						break;
+			}
+			pDataLocation += ConvertVertexElement(ilDesc.Semantic, GetSourceFormat(ilDesc.Semantic), pSource, GetElementFormat(ilDesc), pDataLocation);
+		}
+	}
+}
+
+bool Model3D::SaveCooked(const tstring& filePath, const vector<const InputLayout*>& layouts) const
+{
+	auto pDebugService = MyServiceLocator::GetInstance()->GetService<DebugService>();
+	
+	if(!m_AnimationData.Skeleton.empty() ){
+		pDebugService->Log(_T("Models with animation data can't be cooked, ") + filePath + _T(" not written."), LogLevel::Error);
+		return false;
+	}
+
+	//Streams to cook, without layouts a single one with every attribute of the model
+	vector<vector<InputLayoutElement>> streamLayouts;
+	for(auto pLayout : layouts)
+		streamLayouts.push_back(pLayout->InputLayoutDesc);
+
+	if(layouts.empty() )
+		streamLayouts.push_back(GetAttributeLayout() );
+
+	for(auto& layout : streamLayouts){
+		if(GetVertexStride(layout) == 0){
+			pDebugService->Log(_T("Model lacks attributes of an input layout, ") + filePath + _T(" not written."), LogLevel::Error);
+			return false;
+		}
+	}
+
+	//Every stream is written for all source vertices, CookMesh welds and reorders them
+	CookSource source;
+	source.Layouts = streamLayouts;
+	source.NrOfVertices = GetNrOfVertices();
+	for(auto& layout : streamLayouts){
+		source.Vertices.push_back(vector<char>(source.NrOfVertices * GetVertexStride(layout) ) );
+		WriteVertices(layout, source.Vertices.back().data() );
+	}
+
+	vector<InputLayoutElement> positionLayout(1, InputLayoutElement() );
+	positionLayout[0].Semantic = InputLayoutSemantic::Position;
+	if(GetVertexStride(positionLayout) > 0){
+		source.Positions.resize(source.NrOfVertices * 3);
+		WriteVertices(positionLayout, reinterpret_cast<char*>(source.Positions.data() ) );
+	}
+
+	source.Indices = m_Indices;
+	source.LODIndices = m_LODIndices;
+	for(unsigned int level = 1; level < m_LODs.size(); ++level){
+		const MeshLOD& lod = m_LODs[level];
+		CookedMeshLOD cookedLOD = {lod.StartIndex, lod.NrOfIndices, lod.NrOfVertices, lod.Error};
+		source.LODs.push_back(cookedLOD);
+	}
+	source.Bounds[0] = m_BoundingBox.Bounds[0];
+	source.Bounds[1] = m_BoundingBox.Bounds[1];
+
+	CookedMesh cooked;
+	CookReport report;
+	CookMesh(source, cooked, report);
+	pDebugService->Log(_T("Cooking ") + filePath + _T(", ") + to_tstring(report.NrOfSourceVertices) + _T(" -> ") + to_tstring(report.NrOfVertices)
+					  + _T(" vertices, ACMR ") + to_tstring(report.SourceACMR) + _T(" -> ") + to_tstring(report.CookedACMR) + _T(", ")
+					  + to_tstring(report.NrOfClusters) + _T(" clusters"), LogLevel::Info);
+
+	vector<char> file;
+	WriteCookedMesh(cooked, file);
+
+	std::ofstream outFile(filePath, ios::binary);
+	outFile.write(file.data(), file.size() );
+	
+	if(!outFile){
+		pDebugService->Log(_T("Failed to write cooked mesh ") + filePath, LogLevel::Error);
+		return false;
+	}
+
+	return true;
+}
+
+vector<InputLayoutElement> Model3D::GetAttributeLayout(void) const
+{
+	InputLayoutElement element = {};
+	const InputLayoutSemantic semantics[] = {InputLayoutSemantic::Position, InputLayoutSemantic::TexCoord, InputLayoutSemantic::Normal
+											,InputLayoutSemantic::Tangent, InputLayoutSemantic::Binormal, InputLayoutSemantic::Color
+											,InputLayoutSemantic::BlendIndices, InputLayoutSemantic::BlendWeights};
+	vector<InputLayoutElement> layout;
+	for(auto semantic : semantics){
+		element.Semantic = semantic;
+		unsigned int nrOfChannels = semantic == InputLayoutSemantic::TexCoord ? m_TexCoords.size() : 1;
+		
+		for(element.SemanticIndex = 0; element.SemanticIndex < nrOfChannels; ++element.SemanticIndex)
+			if(GetVertexStride(vector<InputLayoutElement>(1, element) ) > 0)
+				layout.push_back(element);
+	}
+
+	return layout;
+}
+
+bool Model3D::Cook(const tstring& sourceFile, const tstring& cookedFile, const vector<const InputLayout*>& layouts)
+{
+	return ResourceService::LoadResource<Model3D>(sourceFile)->SaveCooked(cookedFile, layouts);
+}
+
+void Model3D::BuildIndexBuffer(VertexBufferInfo& vbInfo, const vector<unsigned int>& indices) const
+{
+	//16 bit indices halve the size of the buffer and the bandwidth to read it
+	vector<unsigned short> shortIndices;
+	UINT indexSize = sizeof(unsigned int);
+	D3D10_SUBRESOURCE_DATA initData;
+    initData.pSysMem = indices.data();
+	vbInfo.IndexFormat = DXGI_FORMAT_R32_UINT;
+
+	if(vbInfo.NrOfVertices <= 0x10000){
+		shortIndices.reserve(indices.size() );
+		for(auto index : indices)
+			shortIndices.push_back(static_cast<unsigned short>(index) );
+		
+		indexSize = sizeof(unsigned short);
+		initData.pSysMem = shortIndices.data();
+		vbInfo.IndexFormat = DXGI_FORMAT_R16_UINT;
 	}
 
 	//Create index buffer descriptor
 	D3D10_BUFFER_DESC bd = {};
     bd.Usage = D3D10_USAGE_IMMUTABLE;
-    bd.ByteWidth = sizeof(int) * m_Indices.size();
+    bd.ByteWidth = indexSize * indices.size();
     bd.BindFlags = D3D10_BIND_INDEX_BUFFER;
     bd.CPUAccessFlags = 0;
     bd.MiscFlags = 0;
-    
-	//Provide pointer to index data
-	D3D10_SUBRESOURCE_DATA initData;
-    initData.pSysMem = m_Indices.data();
 	
 	//Create buffer
 	auto pD3DDevice = MyServiceLocator::GetInstance()->GetService<IGraphicsService>()->GetGraphicsDevice()->GetDevice();
-	HR(pD3DDevice->CreateBuffer(&bd, &initData, &m_pIndexBuffer));
+	HR(pD3DDevice->CreateBuffer(&bd, &initData, &vbInfo.pIndexBuffer));
 }
 
 const VertexBufferInfo& Model3D::GetVertexBufferInfo(resource_ptr<Material> pMaterial)
@@ -303,13 +408,6 @@ const VertexBufferInfo& Model3D::GetVertexBufferInfo(resource_ptr<Material> pMat
 	return m_vecVertBufferInfo.back();
 }
 
-ID3D10Buffer* Model3D::GetIndexBuffer(void)
-{
-	BuildIndexBuffer();
-
-	return m_pIndexBuffer;
-}
-
 unsigned int Model3D::GetNrOfIndices(void) const
 {
 	return m_Indices.size();
@@ -320,7 +418,471 @@ const AABBox& Model3D::GetAABB(void) const
 	return m_BoundingBox;
 }
 
+const AABBox& Model3D::GetAABB(const AnimationClip* pClip) const
+{
+	const AABBox* pBounds = m_AnimationData.GetBounds(pClip);
+	return pBounds ? *pBounds : m_BoundingBox;
+}
+
+const AABBox& Model3D::GetAABB(const AnimationClip* pClip, float tick) const
+{
+	const AABBox* pBounds = m_AnimationData.GetBounds(pClip, tick);
+	return pBounds ? *pBounds : m_BoundingBox;
+}
+
 bool Model3D::HasAnimData(void)
 {
-	return !m_AnimClips.empty();
+	return !m_AnimationData.Clips.empty();
+}
+
+bool Model3D::HasBoneHierarchy(void) const
+{
+	return m_AnimationData.HasBoneHierarchy();
+}
+
+const AnimationData& Model3D::GetAnimationData(void) const
+{
+	return m_AnimationData;
+}
+
+bool Model3D::SetReducedSkeleton(const vector<tstring>& boneNames)
+{
+	vector<unsigned int> reducedBones;
+	for(auto& name : boneNames){
+		unsigned int bone = m_AnimationData.FindBone(name);
+		if(bone == Bone::NO_PARENT){
+			MyServiceLocator::GetInstance()->GetService<DebugService>()->Log(_T("Bone ") + name + _T(" is not part of the skeleton, reduced skeleton not set."), LogLevel::Error);
+			return false;
+		}
+
+		reducedBones.push_back(bone);
+	}
+
+	m_AnimationData.SetReducedSkeleton(move(reducedBones) );
+	return true;
+}
+
+bool Model3D::HasReducedSkeleton(void) const
+{
+	return m_AnimationData.HasReducedSkeleton();
+}
+
+const vector<SkinnedSubmesh>& Model3D::GetSkinnedSubmeshes(void) const
+{
+	return m_SkinnedSubmeshes;
+}
+
+//Orders the bones by depth so every parent comes before its children, and remaps the parents and blend indices to match
+void Model3D::SortSkeleton(vector<unsigned int>& newBoneIndices)
+{
+	auto& skeleton = m_AnimationData.Skeleton;
+	unsigned int nrOfBones = skeleton.size();
+
+	//Depth of every bone in the hierarchy, bones with a parent that doesn't exist or is their own descendant become roots
+	vector<unsigned int> depths(nrOfBones);
+	for(unsigned int bone = 0; bone < nrOfBones; ++bone){
+		unsigned int depth = 0;
+		for(unsigned int ancestor = skeleton[bone].Parent; ancestor != Bone::NO_PARENT; ancestor = skeleton[ancestor].Parent){
+			if(ancestor >= nrOfBones || ++depth >= nrOfBones){
+				MyServiceLocator::GetInstance()->GetService<DebugService>()->Log(_T("Bone ") + skeleton[bone].Name + _T(" has an invalid parent, it is treated as a root."), LogLevel::Error);
+				skeleton[bone].Parent = Bone::NO_PARENT;
+				depth = 0;
+				break;
+			}
+		}
+		depths[bone] = depth;
+	}
+
+	//Breadth first: parents end up before their children, and bones on the same level next to each other
+	vector<unsigned int> order(nrOfBones);
+	for(unsigned int i = 0; i < nrOfBones; ++i)
+		order[i] = i;
+	stable_sort(order.begin(), order.end(), [&](unsigned int lhs, unsigned int rhs){
+		return depths[lhs] < depths[rhs];
+	});
+
+	newBoneIndices.resize(nrOfBones);
+	for(unsigned int i = 0; i < nrOfBones; ++i)
+		newBoneIndices[order[i]] = i;
+
+	vector<Bone> sortedSkeleton;
+	m_AnimationData.BoneParents.clear();
+	for(auto bone : order){
+		sortedSkeleton.push_back(skeleton[bone]);
+		
+		unsigned int& parent = sortedSkeleton.back().Parent;
+		if(parent != Bone::NO_PARENT)
+			parent = newBoneIndices[parent];
+		m_AnimationData.BoneParents.push_back(parent);
+	}
+	skeleton = move(sortedSkeleton);
+
+	//Unused influences have a negative index
+	for(auto& blendIndices : m_BlendIndices.data){
+		float* pIndices = blendIndices;
+		for(unsigned int i = 0; i < 4; ++i)
+			if(pIndices[i] >= 0 && pIndices[i] < nrOfBones)
+				pIndices[i] = static_cast<float>(newBoneIndices[static_cast<unsigned int>(pIndices[i])]);
+	}
+}
+
+//Grows one submesh at a time: take every triangle whose bones are already in the submesh, then the triangle adding the
+//fewest new bones, until nothing fits anymore. Every submesh then gets its own copy of the vertices it shares with
+//earlier ones, since a vertex can only hold one set of local blend indices.
+void Model3D::PartitionSkin(unsigned int maxBonesPerSubmesh)
+{
+	m_SkinnedSubmeshes.clear();
+	if(m_AnimationData.Skeleton.size() <= maxBonesPerSubmesh)
+		return;
+
+	//Bones a vertex depends on. Zero weight influences don't, except for the first one: the shader compares the
+	//hemisphere of every influence against it.
+	auto getVertexBones = [&](unsigned int vertex, unsigned short* pBones) -> unsigned int {
+		const float* pIndices = m_BlendIndices.GetRefAt(vertex);
+		const float* pWeights = m_BlendWeights.GetRefAt(vertex);
+		
+		unsigned int nrOfBones = 0;
+		for(unsigned int i=0; i < 4; ++i)
+			if(i == 0 || pWeights[i] > 0)
+				pBones[nrOfBones++] = static_cast<unsigned short>(pIndices[i]);
+		return nrOfBones;
+	};
+
+	unsigned int nrOfTriangles = m_Indices.size() / 3;
+	vector<unsigned short> triangleBones;
+	vector<unsigned int> triangleBoneOffsets(1, 0);
+	
+	for(unsigned int tri=0; tri < nrOfTriangles; ++tri){
+		unsigned short bones[12];
+		unsigned int nrOfBones = 0;
+		for(unsigned int corner=0; corner < 3; ++corner)
+			nrOfBones += getVertexBones(m_Indices[tri*3 + corner], bones + nrOfBones);
+
+		sort(bones, bones + nrOfBones);
+		triangleBones.insert(triangleBones.end(), bones, unique(bones, bones + nrOfBones) );
+		triangleBoneOffsets.push_back(triangleBones.size() );
+	}
+
+	vector<int> localBoneIndex(m_AnimationData.Skeleton.size(), -1);
+	vector<bool> bAssigned(nrOfTriangles, false);
+	vector<unsigned int> newIndices;
+	newIndices.reserve(m_Indices.size() );
+	
+	unsigned int nrOfVertices = m_Positions.indices.size();
+	vector<int> vertexOwner(nrOfVertices, -1);
+	vector<unsigned int> vertexCopy(nrOfVertices); //Most recent copy of every vertex, itself if there is none
+	for(unsigned int i=0; i < nrOfVertices; ++i)
+		vertexCopy[i] = i;
+	m_SubmeshBlendIndices.data.clear();
+	m_SubmeshBlendIndices.indices.assign(nrOfVertices, 0);
+
+	unsigned int nrOfAssigned = 0;
+	while(nrOfAssigned < nrOfTriangles){
+		SkinnedSubmesh submesh;
+		submesh.StartIndex = newIndices.size();
+
+		for(;;){
+			unsigned int bestTriangle = nrOfTriangles, bestNrOfNewBones = UINT_MAX;
+
+			for(unsigned int tri=0; tri < nrOfTriangles; ++tri){
+				if(bAssigned[tri])
+					continue;
+
+				unsigned int nrOfNewBones = 0;
+				for(unsigned int i = triangleBoneOffsets[tri]; i < triangleBoneOffsets[tri+1]; ++i)
+					if(localBoneIndex[triangleBones[i]] < 0)
+						++nrOfNewBones;
+				
+				if(nrOfNewBones == 0){
+					newIndices.insert(newIndices.end(), m_Indices.begin() + tri*3, m_Indices.begin() + tri*3 + 3);
+					bAssigned[tri] = true;
+					++nrOfAssigned;
+				}
+				else if(nrOfNewBones < bestNrOfNewBones && submesh.Bones.size() + nrOfNewBones <= maxBonesPerSubmesh){
+					bestTriangle = tri;
+					bestNrOfNewBones = nrOfNewBones;
+				}
+			}
+
+			if(bestTriangle == nrOfTriangles)
+				break;
+
+			//Its bones are added here, the triangle itself on the next scan
+			for(unsigned int i = triangleBoneOffsets[bestTriangle]; i < triangleBoneOffsets[bestTriangle+1]; ++i){
+				if(localBoneIndex[triangleBones[i]] < 0){
+					localBoneIndex[triangleBones[i]] = submesh.Bones.size();
+					submesh.Bones.push_back(triangleBones[i]);
+				}
+			}
+		}
+
+		submesh.NrOfIndices = newIndices.size() - submesh.StartIndex;
+		if(submesh.NrOfIndices == 0){
+			MyServiceLocator::GetInstance()->GetService<DebugService>()->Log(_T("Triangle uses more bones than a skinned submesh can hold, model left unpartitioned."), LogLevel::Error);
+			m_SkinnedSubmeshes.clear();
+			m_SubmeshBlendIndices = VertexAttribute<D3DXVECTOR4>();
+			return;
+		}
+
+		//Give the submesh its vertices and their local blend indices
+		int submeshIndex = m_SkinnedSubmeshes.size();
+		for(unsigned int i = submesh.StartIndex; i < newIndices.size(); ++i){
+			unsigned int vertex = newIndices[i];
+			
+			if(vertexOwner[vertex] == submeshIndex)
+				continue;
+			
+			if(vertexOwner[vertex] >= 0){
+				//Already used by an earlier submesh, use (or make) this submesh's copy
+				if(vertexCopy[vertex] == vertex || vertexOwner[vertexCopy[vertex]] != submeshIndex){
+					unsigned int copy = m_Positions.indices.size();
+					m_Positions.DuplicateVertex(vertex);
+					for(auto& texCoords : m_TexCoords)
+						texCoords.DuplicateVertex(vertex);
+					m_Normals.DuplicateVertex(vertex);
+					m_Tangents.DuplicateVertex(vertex);
+					m_Binormals.DuplicateVertex(vertex);
+					m_Colors.DuplicateVertex(vertex);
+					m_BlendWeights.DuplicateVertex(vertex);
+					m_BlendIndices.DuplicateVertex(vertex);
+					m_SubmeshBlendIndices.indices.push_back(0);
+					
+					vertexOwner.push_back(-1);
+					vertexCopy.push_back(copy);
+					vertexCopy[vertex] = copy;
+				}
+
+				newIndices[i] = vertex = vertexCopy[vertex];
+				if(vertexOwner[vertex] == submeshIndex)
+					continue;
+			}
+
+			vertexOwner[vertex] = submeshIndex;
+			
+			const float* pIndices = m_BlendIndices.GetRefAt(vertex);
+			const float* pWeights = m_BlendWeights.GetRefAt(vertex);
+			D3DXVECTOR4 localIndices;
+			float* pLocalIndices = localIndices;
+			for(unsigned int j=0; j < 4; ++j){
+				//Zero weight influences don't contribute, point them at the first influence
+				unsigned int bone = static_cast<unsigned int>( (j == 0 || pWeights[j] > 0) ? pIndices[j] : pIndices[0]);
+				pLocalIndices[j] = static_cast<float>(localBoneIndex[bone]);
+			}
+			
+			m_SubmeshBlendIndices.indices[vertex] = m_SubmeshBlendIndices.data.size();
+			m_SubmeshBlendIndices.data.push_back(localIndices);
+		}
+
+		for(auto bone : submesh.Bones)
+			localBoneIndex[bone] = -1;
+
+		m_SkinnedSubmeshes.push_back(submesh);
+	}
+
+	m_Indices.swap(newIndices);
+}
+
+const SkinningStreams& Model3D::GetSkinningStreams(void) const
+{
+	return m_SkinningStreams;
+}
+
+unsigned int Model3D::GetNrOfLODs(void) const
+{
+	return m_LODs.size();
+}
+
+const MeshLOD& Model3D::GetLOD(unsigned int level) const
+{
+	return m_LODs.at(level);
+}
+
+const ClusterStreams& Model3D::GetClusters(void) const
+{
+	return m_Clusters;
+}
+
+const MeshBVH& Model3D::GetBVH(void) const
+{
+	if(m_BVH.IsEmpty() && !m_Indices.empty() ){
+		vector<InputLayoutElement> layout(1, InputLayoutElement() );
+		layout[0].Semantic = InputLayoutSemantic::Position;
+		
+		if(GetVertexStride(layout) > 0){
+			vector<float> positions(GetNrOfVertices() * 3);
+			WriteVertices(layout, reinterpret_cast<char*>(positions.data() ) );
+			m_BVH.Build(m_Indices.data(), m_Indices.size(), positions.data(), sizeof(float) * 3);
+		}
+	}
+
+	return m_BVH;
+}
+
+void Model3D::BuildLODs(void)
+{
+	MeshLOD fullLOD;
+	fullLOD.StartIndex = 0;
+	fullLOD.NrOfIndices = m_Indices.size();
+	fullLOD.NrOfVertices = CountUsedVertices(m_Indices.data(), m_Indices.size(), GetNrOfVertices() );
+	fullLOD.Error = 0.0f;
+	fullLOD.Submeshes = m_SkinnedSubmeshes;
+	m_LODs.insert(m_LODs.begin(), fullLOD);
+
+	//Cooked models come with their LODs
+	if(m_LODs.size() > 1 || s_NrOfLODs == 0 || m_Indices.empty() )
+		return;
+
+	//Source vertices are unique per combination of attribute indices, merge the ones with equal values so only real seams stay in place.
+	//Cooking welded its vertices already, cooked models only need their positions.
+	bool bWeld = m_CookedStreams.empty();
+	vector<InputLayoutElement> layout(1, InputLayoutElement() );
+	layout[0].Semantic = InputLayoutSemantic::Position;
+	if(bWeld)
+		layout = GetAttributeLayout();
+
+	unsigned int stride = GetVertexStride(layout);
+	if(stride == 0 || layout[0].Semantic != InputLayoutSemantic::Position)
+		return;
+
+	unsigned int nrOfSourceVertices = GetNrOfVertices();
+	vector<char> vertices(nrOfSourceVertices * stride);
+	WriteVertices(layout, vertices.data() );
+
+	vector<unsigned int> weldRemap;
+	unsigned int nrOfVertices = nrOfSourceVertices;
+	if(bWeld)
+		nrOfVertices = WeldVertices(vertices.data(), nrOfSourceVertices, stride, weldRemap);
+	else
+		for(unsigned int i = 0; i < nrOfSourceVertices; ++i)
+			weldRemap.push_back(i);
+
+	vector<unsigned int> sourceVertices(nrOfVertices);
+	for(unsigned int i = nrOfSourceVertices; i-- > 0; )
+		sourceVertices[weldRemap[i]] = i;
+
+	//Skinned vertices only collapse onto vertices that mostly follow the same bone, so joints keep the triangles they bend with
+	vector<unsigned int> vertexGroups;
+	if(!m_BlendWeights.data.empty() ){
+		vertexGroups.resize(nrOfVertices);
+		for(unsigned int i = 0; i < nrOfSourceVertices; ++i){
+			const float* pWeights = m_BlendWeights.GetRefAt(i);
+			const float* pBoneIndices = m_BlendIndices.GetRefAt(i);
+			unsigned int dominant = static_cast<unsigned int>(max_element(pWeights, pWeights + 4) - pWeights);
+			vertexGroups[weldRemap[i]] = static_cast<unsigned int>(static_cast<int>(pBoneIndices[dominant]) );
+		}
+	}
+
+	//Skinned submeshes have their own palettes, they are simplified apart so every level keeps the same submeshes
+	vector<SkinnedSubmesh> ranges(m_SkinnedSubmeshes);
+	if(ranges.empty() ){
+		SkinnedSubmesh wholeModel;
+		wholeModel.StartIndex = 0;
+		wholeModel.NrOfIndices = m_Indices.size();
+		ranges.push_back(wholeModel);
+	}
+
+	float radius = (m_BoundingBox.Bounds[1] - m_BoundingBox.Bounds[0]).Length() * 0.5f;
+	if(radius <= 0.0f)
+		return;
+
+	vector<unsigned int> rangeIndices, simplified;
+	float reduction = 1.0f;
+
+	for(unsigned int level = 1; level <= s_NrOfLODs; ++level){
+		reduction *= s_LODReduction;
+
+		MeshLOD lod;
+		lod.StartIndex = m_Indices.size() + m_LODIndices.size();
+		lod.NrOfIndices = 0;
+		lod.Error = 0.0f;
+
+		for(auto& range : ranges){
+			//Every level starts from the full model, so its error is measured against the full model
+			rangeIndices.clear();
+			for(unsigned int i = range.StartIndex; i < range.StartIndex + range.NrOfIndices; ++i)
+				rangeIndices.push_back(weldRemap[m_Indices[i]]);
+
+			unsigned int targetNrOfIndices = static_cast<unsigned int>(rangeIndices.size() / 3 * reduction) * 3;
+			float error = SimplifyMesh(rangeIndices.data(), rangeIndices.size(), reinterpret_cast<const float*>(vertices.data() ), stride, nrOfVertices
+									  ,targetNrOfIndices, s_MaxLODError * radius, simplified, vertexGroups.empty() ? nullptr : vertexGroups.data() );
+			OptimizeVertexCache(simplified.data(), simplified.size(), nrOfVertices);
+
+			if(!m_SkinnedSubmeshes.empty() ){
+				SkinnedSubmesh submesh(range);
+				submesh.StartIndex = lod.StartIndex + lod.NrOfIndices;
+				submesh.NrOfIndices = simplified.size();
+				lod.Submeshes.push_back(submesh);
+			}
+
+			for(auto index : simplified)
+				m_LODIndices.push_back(sourceVertices[index]);
+
+			lod.NrOfIndices += simplified.size();
+			lod.Error = max(lod.Error, error / radius);
+		}
+
+		//Levels that barely simplify any further only cost memory
+		if(lod.NrOfIndices > m_LODs.back().NrOfIndices * 0.9f){
+			m_LODIndices.resize(lod.StartIndex - m_Indices.size() );
+			break;
+		}
+
+		lod.NrOfVertices = CountUsedVertices(&m_LODIndices[lod.StartIndex - m_Indices.size()], lod.NrOfIndices, nrOfSourceVertices);
+		m_LODs.push_back(lod);
+	}
+}
+
+void Model3D::BuildSkinningStreams(void)
+{
+	unsigned int nrOfVertices = m_Positions.indices.size();
+	bool bNormals = !m_Normals.data.empty();
+	m_SkinningStreams.Resize(nrOfVertices, bNormals);
+	m_SkinningStreams.NrOfBones = 0;
+
+	for(unsigned int i=0; i < nrOfVertices; ++i){
+		const D3DXVECTOR3& pos = m_Positions.GetRefAt(i);
+		m_SkinningStreams.PosX[i] = pos.x;
+		m_SkinningStreams.PosY[i] = pos.y;
+		m_SkinningStreams.PosZ[i] = pos.z;
+
+		if(bNormals){
+			const D3DXVECTOR3& norm = m_Normals.GetRefAt(i);
+			m_SkinningStreams.NormX[i] = norm.x;
+			m_SkinningStreams.NormY[i] = norm.y;
+			m_SkinningStreams.NormZ[i] = norm.z;
+		}
+
+		m_SkinningStreams.SetInfluences(i, m_BlendIndices.GetRefAt(i), m_BlendWeights.GetRefAt(i) );
+	}
+}
+
+void Model3D::BuildClipBounds(const AnimationClip& clip)
+{
+	auto& bounds = m_AnimationData.Bounds;
+	bounds.push_back(ClipBounds() );
+	bounds.back().Build(clip, m_SkinningStreams, m_AnimationData.BindPoses, m_AnimationData.BoneParents, BOUNDS_SEGMENT_KEYS);
+}
+
+//Half float positions are off by up to 1/2048th of a coordinate, which only stays small for meshes modelled around their origin.
+//Checked once when a source file is loaded, cooked files were checked when their source was.
+void Model3D::CheckPositionPrecision(void) const
+{
+	const tt::Vector3* bounds = m_BoundingBox.Bounds;
+	float maxCoordinate = max(max(max(fabs(bounds[0].x), fabs(bounds[1].x) ), max(fabs(bounds[0].y), fabs(bounds[1].y) ) ), max(fabs(bounds[0].z), fabs(bounds[1].z) ) );
+	if(maxCoordinate > 2.0f * (bounds[1] - bounds[0]).Length() )
+		MyServiceLocator::GetInstance()->GetService<DebugService>()->Log(_T("Mesh lies far from its origin, half float positions of quantized layouts lose more than 0.1% of its size."), LogLevel::Warning);
+}
+
+void Model3D::SetClipCompression(bool bEnabled, float rotationTolerance, float translationTolerance)
+{
+	s_bCompressClips = bEnabled;
+	s_RotationTolerance = rotationTolerance;
+	s_TranslationTolerance = translationTolerance;
+}
+
+void Model3D::SetLODGeneration(unsigned int nrOfLODs, float reduction, float maxError)
+{
+	s_NrOfLODs = nrOfLODs;
+	s_LODReduction = reduction;
+	s_MaxLODError = maxError;
 }
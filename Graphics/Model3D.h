@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -21,16 +21,24 @@
 #include "../Helpers/resrc_ptr.hpp"
 #include "../Helpers/Namespace.h"
 #include "MeshAnimator.h"
+#include "CpuSkinning.h"
+#include "BoundingVolumes.h"
+#include "AnimationData.h"
+#include "CookedMesh.h"
+#include "MeshClusters.h"
+#include "MeshBVH.h"
 
 class Material;
-struct InputLayout;
 
 struct VertexBufferInfo
 {
 	void* pDataStart;
 	ID3D10Buffer* pVertexBuffer;
+	ID3D10Buffer* pIndexBuffer; //Vertices are welded per input layout, so every vertex buffer has its own indices
+	DXGI_FORMAT IndexFormat; //R16_UINT whenever NrOfVertices allows it
 	UINT BufferSize;
 	UINT VertexStride;
+	UINT NrOfVertices;
 	InputLayout* pInputLayout;
 
 	VertexBufferInfo(void);
@@ -38,31 +46,27 @@ struct VertexBufferInfo
 	void Release(void);
 };
 
-struct Ray
+//Part of a skinned model that only uses a limited set of bones, so it fits the palette of the skinning shader.
+//The blend indices of its vertices are local: index i refers to palette entry Bones[i].
+struct SkinnedSubmesh
 {
-	Ray(const tt::Vector3& origin, const tt::Vector3& direction);
-	
-	tt::Vector3 Origin;
-	tt::Vector3 Direction;
-	tt::Vector3 InvDirection;
-	int sign[3];
+	unsigned int StartIndex;
+	unsigned int NrOfIndices;
+	vector<unsigned short> Bones;
 };
 
-struct AABBox
+//Simplified version of a model, drawn with a range of the model's index buffer that follows the full model (see Model3D::GetLOD)
+struct MeshLOD
 {
-	AABBox(void);
-	~AABBox(void);
-
-	void Initialize(const vector<D3DXVECTOR3>& vertices);
-	void GetVertices(tt::Vector3* targetArr) const;
-	bool Intersect(const Ray& r, float t0, float t1) const;
-
-	tt::Vector3 Bounds[2];
+	unsigned int StartIndex;
+	unsigned int NrOfIndices;
+	unsigned int NrOfVertices;		//Vertices the indices refer to
+	float Error;					//Largest distance the surface moved, as a fraction of the radius around the bounding box
+	vector<SkinnedSubmesh> Submeshes; //Index ranges of the skinned submeshes in this level, empty unless the model has them
 };
 
 class Model3D
 {
-	friend class MeshAnimator;
 	friend class ResourceService;
 
 	template <typename T>
@@ -80,6 +84,13 @@ class Model3D
 		{
 			return data.at(indices.at(vertexIndex));
 		}
+
+		//Appends a vertex referring to the same data as vertexIndex
+		void DuplicateVertex(unsigned int vertexIndex)
+		{
+			if(!indices.empty())
+				indices.push_back(indices[vertexIndex]);
+		}
 	};
 
 public:
@@ -88,15 +99,64 @@ public:
 	virtual ~Model3D(void);
 
 	//Methods
+	//Builds the vertex and index buffer for the material's input layout, with the vertices that are identical in that layout merged
 	void BuildVertexBuffer(resource_ptr<Material> pMaterial);
-	void BuildIndexBuffer(bool force = false);
 	
 	const VertexBufferInfo& GetVertexBufferInfo(resource_ptr<Material> pMaterial);
-	ID3D10Buffer* GetIndexBuffer(void);
 	unsigned int GetNrOfIndices(void) const;
 	const AABBox& GetAABB(void) const;
+	//Bounds of the skinned mesh while playing one of this model's clips, over the whole clip or only over
+	//the range of keys around tick. Falls back to the bind pose bounds for models without that clip.
+	//They contain every pose playback can produce, compressed or not, but can be a bit loose for fast motion.
+	const AABBox& GetAABB(const AnimationClip* pClip) const;
+	const AABBox& GetAABB(const AnimationClip* pClip, float tick) const;
 
 	bool HasAnimData(void);
+	//True if the skeleton has parent indices and the keys of the clips are relative to the parent bone
+	bool HasBoneHierarchy(void) const;
+	//Skeleton and clips the model's animators play (see MeshAnimator::SetAnimationData)
+	const AnimationData& GetAnimationData(void) const;
+
+	//Bones evaluated by animators running at a reduced animation LOD (see AnimationLOD). Every other bone
+	//follows the listed bone closest to it in the bind pose. Returns false if a name isn't part of the skeleton.
+	//With a bone hierarchy the ancestors of the listed bones are evaluated as well.
+	bool SetReducedSkeleton(const vector<tstring>& boneNames);
+	bool HasReducedSkeleton(void) const;
+
+	//Submeshes of a skinned model whose skeleton doesn't fit the skinning shader's palette,
+	//every one of them is drawn with its own palette. Empty if the model can be drawn at once.
+	const vector<SkinnedSubmesh>& GetSkinnedSubmeshes(void) const;
+
+	//Vertex data for skinning on the CPU (see SkinVertices), empty for models without animation data
+	const SkinningStreams& GetSkinningStreams(void) const;
+
+	//Level 0 is the full model, every next level has fewer triangles and a larger Error. Vertices are never moved or merged,
+	//simplified levels draw a subset of them, so skinned levels keep the blend data of the full model.
+	unsigned int GetNrOfLODs(void) const;
+	const MeshLOD& GetLOD(unsigned int level) const;
+
+	//Clusters of the full model for CullClusters. Only cooked models are split into clusters, and only those with at least
+	//CLUSTER_MIN_MESH_TRIANGLES triangles, the streams are empty otherwise.
+	const ClusterStreams& GetClusters(void) const;
+
+	//Triangle BVH of the full model in its bind pose for exact ray queries, built on the first call
+	const MeshBVH& GetBVH(void) const;
+
+	//LODs generated for models loaded afterwards, nrOfLODs levels on top of the full model with at most reduction times the triangles
+	//of the previous level each. Generation stops early once simplifying moves the surface more than maxError, as a fraction of the
+	//radius around the bounding box. Cooked models keep the LODs they were cooked with. 0 levels disables generation.
+	static void SetLODGeneration(unsigned int nrOfLODs, float reduction = 0.5f, float maxError = 0.05f);
+
+	//Compression applied to the animation clips of models loaded afterwards.
+	//rotationTolerance in radians, translationTolerance in model units, see CompressedClip.
+	static void SetClipCompression(bool bEnabled, float rotationTolerance = 0.001f, float translationTolerance = 0.001f);
+
+	//Writes the model as a cooked .ttmesh (see CookedMesh.h) with a vertex stream for every layout, or a single stream
+	//holding every attribute if layouts is empty. Cooked files hold no skeleton or clips, so models with animation data aren't cooked
+	//and fail with an error, load those from their source files. See CookMesh for what cooking does to the mesh.
+	bool SaveCooked(const tstring& filePath, const vector<const InputLayout*>& layouts) const;
+	//Loads a source or cooked .ttmesh and writes it to cookedFile with SaveCooked
+	static bool Cook(const tstring& sourceFile, const tstring& cookedFile, const vector<const InputLayout*>& layouts);
 
 private:
 	//Datamembers
@@ -110,15 +170,53 @@ private:
 	VertexAttribute<D3DXCOLOR>	m_Colors;
 	VertexAttribute<D3DXVECTOR4> m_BlendWeights;
 	VertexAttribute<D3DXVECTOR4> m_BlendIndices;
+	VertexAttribute<D3DXVECTOR4> m_SubmeshBlendIndices; //Local blend indices, replace m_BlendIndices in the vertex buffer when partitioned
 	
 	vector<unsigned int> m_Indices;
-	
-	ID3D10Buffer* m_pIndexBuffer;
+	vector<unsigned int> m_LODIndices; //Indices of the simplified levels, they follow m_Indices in the index buffers
+	vector<MeshLOD> m_LODs;
+	ClusterStreams m_Clusters;
+	mutable MeshBVH m_BVH;
 
 	AABBox m_BoundingBox;
 
-	vector<Bone> m_Skeleton;
-	vector<AnimationClip> m_AnimClips;
+	AnimationData m_AnimationData;
+
+	vector<SkinnedSubmesh> m_SkinnedSubmeshes;
+	SkinningStreams m_SkinningStreams;
+
+	vector<CookedStream> m_CookedStreams; //Vertex data of cooked models, which have no per attribute data
+
+	//Internal methods
+	unsigned int GetNrOfVertices(void) const;
+	//Size of a vertex in a buffer for the layout, 0 if the model lacks one of its attributes
+	unsigned int GetVertexStride(const vector<InputLayoutElement>& layout) const;
+	//Cooked stream with exactly the attributes of the layout, or else one that contains all of them. nullptr if there is none.
+	const CookedStream* FindCookedStream(const vector<InputLayoutElement>& layout, bool& bExactMatch) const;
+	//Interleaves the attributes of the layout, pDest receives GetNrOfVertices() * GetVertexStride(layout) bytes
+	void WriteVertices(const vector<InputLayoutElement>& layout, char* pDest) const;
+	//Layout with every attribute the model has, in source formats
+	vector<InputLayoutElement> GetAttributeLayout(void) const;
+	//Adds level 0 in front of the LODs loaded so far and generates the others if there are none, needs the bounding box
+	void BuildLODs(void);
+	//Uploads the indices for vbInfo's vertices, as 16 bit indices if vbInfo.NrOfVertices allows it
+	void BuildIndexBuffer(VertexBufferInfo& vbInfo, const vector<unsigned int>& indices) const;
+	//Sorts the skeleton by depth and remaps the blend indices, newBoneIndices receives the new index of every bone
+	void SortSkeleton(vector<unsigned int>& newBoneIndices);
+	void PartitionSkin(unsigned int maxBonesPerSubmesh);
+	void BuildSkinningStreams(void);
+	//Appends the animated bounds of a clip to m_AnimationData.Bounds, from its compressed poses if it has them and its keys otherwise
+	void BuildClipBounds(const AnimationClip& clip);
+	//Warns if quantized layouts would lose too much position precision, needs the bounding box
+	void CheckPositionPrecision(void) const;
+
+	//Keys per segment of the animated bounds, trades culling precision for memory
+	static const unsigned int BOUNDS_SEGMENT_KEYS = 8;
+
+	static bool s_bCompressClips;
+	static float s_RotationTolerance, s_TranslationTolerance;
+	static unsigned int s_NrOfLODs;
+	static float s_LODReduction, s_MaxLODError;
 
 	//Disabling default copy constructor & assignment operator
 	Model3D(const Model3D& src);
@@ -0,0 +1,262 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "RayPacket.h"
+#include "BoundingVolumes.h"
+#include "../Helpers/SimdUtil.h"
+
+//Per axis, with the bounds ordered by the sign of the inverse direction:
+//	near = (nearBound - origin) * invDirection, far = (farBound - origin) * invDirection
+//	entry = max(near over all axes, minDistance), exit = min(far over all axes, maxDistance), hit if entry <= exit
+//A ray in the plane of a slab gives 0 * inf = NaN there, the max and min are ordered so a NaN leaves the interval alone,
+//the same in every version.
+
+namespace
+{
+	bool SlabTest(const float* pOrigin, const float* pInvDirection, const float* pMin, const float* pMax, float tNear, float tFar, float& tEntry)
+	{
+		for(unsigned int axis = 0; axis < 3; ++axis){
+			bool bNegative = pInvDirection[axis] < 0.0f;
+			float t0 = ( (bNegative ? pMax : pMin)[axis] - pOrigin[axis]) * pInvDirection[axis];
+			float t1 = ( (bNegative ? pMin : pMax)[axis] - pOrigin[axis]) * pInvDirection[axis];
+			tNear = t0 > tNear ? t0 : tNear;
+			tFar = t1 < tFar ? t1 : tFar;
+		}
+
+		tEntry = tNear;
+		return tNear <= tFar;
+	}
+
+	const float EMPTY_BOX_MIN = FLT_MAX;
+	const float EMPTY_BOX_MAX = -FLT_MAX;
+
+	//_mm_max_ps and _mm_min_ps return their second operand if either is NaN, so the slab distance goes first.
+	//AVX builds only use the 8 wide versions.
+#if defined(TT_SIMD_SSE) && !defined(TT_SIMD_AVX)
+	int IntersectRayPacket4(const RayPacket& rays, unsigned int first, const float* pMin, const float* pMax, float* pEntryDistances)
+	{
+		__m128 tNear = _mm_loadu_ps(&rays.MinDistance[first]);
+		__m128 tFar = _mm_loadu_ps(&rays.MaxDistance[first]);
+
+		for(unsigned int axis = 0; axis < 3; ++axis){
+			__m128 origin = _mm_loadu_ps(&rays.Origin[axis][first]);
+			__m128 invDirection = _mm_loadu_ps(&rays.InvDirection[axis][first]);
+			__m128 negative = _mm_cmplt_ps(invDirection, _mm_setzero_ps());
+			__m128 boxMin = _mm_set1_ps(pMin[axis]), boxMax = _mm_set1_ps(pMax[axis]);
+
+			__m128 nearBound = _mm_or_ps(_mm_and_ps(negative, boxMax), _mm_andnot_ps(negative, boxMin));
+			__m128 farBound = _mm_or_ps(_mm_and_ps(negative, boxMin), _mm_andnot_ps(negative, boxMax));
+			tNear = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(nearBound, origin), invDirection), tNear);
+			tFar = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(farBound, origin), invDirection), tFar);
+		}
+
+		if(pEntryDistances)
+			_mm_storeu_ps(pEntryDistances + first, tNear);
+		return _mm_movemask_ps(_mm_cmple_ps(tNear, tFar) );
+	}
+
+	int IntersectBoxPacket4(const Ray& ray, const __m128* pOrigin, const __m128* pInvDirection, __m128 tNear, __m128 tFar
+						   ,const AABBoxStreams& boxes, unsigned int first, float* pEntryDistances)
+	{
+		for(unsigned int axis = 0; axis < 3; ++axis){
+			const float* pNear = ray.sign[axis] ? &boxes.Max[axis][first] : &boxes.Min[axis][first];
+			const float* pFar = ray.sign[axis] ? &boxes.Min[axis][first] : &boxes.Max[axis][first];
+			tNear = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pNear), pOrigin[axis]), pInvDirection[axis]), tNear);
+			tFar = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pFar), pOrigin[axis]), pInvDirection[axis]), tFar);
+		}
+
+		if(pEntryDistances)
+			_mm_storeu_ps(pEntryDistances, tNear);
+		return _mm_movemask_ps(_mm_cmple_ps(tNear, tFar) );
+	}
+#endif
+
+#ifdef TT_SIMD_AVX
+	int IntersectRayPacket8(const RayPacket& rays, const float* pMin, const float* pMax, float* pEntryDistances)
+	{
+		__m256 tNear = _mm256_loadu_ps(rays.MinDistance);
+		__m256 tFar = _mm256_loadu_ps(rays.MaxDistance);
+
+		for(unsigned int axis = 0; axis < 3; ++axis){
+			__m256 origin = _mm256_loadu_ps(rays.Origin[axis]);
+			__m256 invDirection = _mm256_loadu_ps(rays.InvDirection[axis]);
+			__m256 negative = _mm256_cmp_ps(invDirection, _mm256_setzero_ps(), _CMP_LT_OQ);
+			__m256 boxMin = _mm256_set1_ps(pMin[axis]), boxMax = _mm256_set1_ps(pMax[axis]);
+
+			__m256 nearBound = _mm256_blendv_ps(boxMin, boxMax, negative);
+			__m256 farBound = _mm256_blendv_ps(boxMax, boxMin, negative);
+			tNear = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(nearBound, origin), invDirection), tNear);
+			tFar = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(farBound, origin), invDirection), tFar);
+		}
+
+		if(pEntryDistances)
+			_mm256_storeu_ps(pEntryDistances, tNear);
+		return _mm256_movemask_ps(_mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ) );
+	}
+
+	int IntersectBoxPacket8(const Ray& ray, const __m256* pOrigin, const __m256* pInvDirection, __m256 tNear, __m256 tFar
+						   ,const AABBoxStreams& boxes, unsigned int first, float* pEntryDistances)
+	{
+		for(unsigned int axis = 0; axis < 3; ++axis){
+			const float* pNear = ray.sign[axis] ? &boxes.Max[axis][first] : &boxes.Min[axis][first];
+			const float* pFar = ray.sign[axis] ? &boxes.Min[axis][first] : &boxes.Max[axis][first];
+			tNear = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(pNear), pOrigin[axis]), pInvDirection[axis]), tNear);
+			tFar = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(pFar), pOrigin[axis]), pInvDirection[axis]), tFar);
+		}
+
+		if(pEntryDistances)
+			_mm256_storeu_ps(pEntryDistances, tNear);
+		return _mm256_movemask_ps(_mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ) );
+	}
+#endif
+}
+
+//--------------------------
+//RayPacket
+//--------------------------
+RayPacket::RayPacket(const Ray* pRays, unsigned int nrOfRays, float minDistance, float maxDistance)
+	:NrOfRays(min(nrOfRays, RAY_PACKET_SIZE) )
+{
+	for(unsigned int lane = 0; lane < RAY_PACKET_SIZE; ++lane){
+		//Unused lanes repeat the first ray with an interval no box can be hit in
+		const Ray& ray = pRays[lane < NrOfRays ? lane : 0];
+		for(unsigned int axis = 0; axis < 3; ++axis){
+			Origin[axis][lane] = (&ray.Origin.x)[axis];
+			Direction[axis][lane] = (&ray.Direction.x)[axis];
+			InvDirection[axis][lane] = (&ray.InvDirection.x)[axis];
+		}
+
+		MinDistance[lane] = lane < NrOfRays ? minDistance : FLT_MAX;
+		MaxDistance[lane] = lane < NrOfRays ? maxDistance : -FLT_MAX;
+	}
+}
+
+int RayPacket::GetMask(void) const
+{
+	return (1 << NrOfRays) - 1;
+}
+
+//--------------------------
+//AABBoxStreams
+//--------------------------
+AABBoxStreams::AABBoxStreams(void)
+	:NrOfBoxes(0)
+{
+}
+
+void AABBoxStreams::Resize(unsigned int nrOfBoxes)
+{
+	unsigned int paddedSize = (nrOfBoxes + RAY_PACKET_SIZE - 1) / RAY_PACKET_SIZE * RAY_PACKET_SIZE;
+	for(unsigned int axis = 0; axis < 3; ++axis){
+		Min[axis].resize(paddedSize);
+		Max[axis].resize(paddedSize);
+		std::fill(Min[axis].begin() + nrOfBoxes, Min[axis].end(), EMPTY_BOX_MIN);
+		std::fill(Max[axis].begin() + nrOfBoxes, Max[axis].end(), EMPTY_BOX_MAX);
+	}
+
+	NrOfBoxes = nrOfBoxes;
+}
+
+void AABBoxStreams::Set(unsigned int index, const AABBox& box)
+{
+	for(unsigned int axis = 0; axis < 3; ++axis){
+		Min[axis][index] = (&box.Bounds[0].x)[axis];
+		Max[axis][index] = (&box.Bounds[1].x)[axis];
+	}
+}
+
+//--------------------------
+//Intersection
+//--------------------------
+bool IntersectRayBox(const Ray& ray, const float* pMin, const float* pMax, float minDistance, float maxDistance, float& tEntry)
+{
+	return SlabTest(&ray.Origin.x, &ray.InvDirection.x, pMin, pMax, minDistance, maxDistance, tEntry);
+}
+
+int IntersectRayPacket(const RayPacket& rays, const float* pMin, const float* pMax, float* pEntryDistances)
+{
+#if defined(TT_SIMD_AVX)
+	return IntersectRayPacket8(rays, pMin, pMax, pEntryDistances);
+#elif defined(TT_SIMD_SSE)
+	int hitMask = IntersectRayPacket4(rays, 0, pMin, pMax, pEntryDistances);
+	if(rays.NrOfRays > 4)
+		hitMask |= IntersectRayPacket4(rays, 4, pMin, pMax, pEntryDistances) << 4;
+	return hitMask;
+#else
+	int hitMask = 0;
+	for(unsigned int lane = 0; lane < rays.NrOfRays; ++lane){
+		float origin[3] = {rays.Origin[0][lane], rays.Origin[1][lane], rays.Origin[2][lane]};
+		float invDirection[3] = {rays.InvDirection[0][lane], rays.InvDirection[1][lane], rays.InvDirection[2][lane]};
+		float tEntry;
+		if(SlabTest(origin, invDirection, pMin, pMax, rays.MinDistance[lane], rays.MaxDistance[lane], tEntry) )
+			hitMask |= 1 << lane;
+		if(pEntryDistances)
+			pEntryDistances[lane] = tEntry;
+	}
+	return hitMask;
+#endif
+}
+
+int IntersectRayPacket(const RayPacket& rays, const AABBox& box)
+{
+	return IntersectRayPacket(rays, &box.Bounds[0].x, &box.Bounds[1].x);
+}
+
+int IntersectBoxPacket(const Ray& ray, float minDistance, float maxDistance, const AABBoxStreams& boxes, unsigned int first
+					  ,float* pEntryDistances)
+{
+#if defined(TT_SIMD_AVX)
+	__m256 origin[3] = {_mm256_set1_ps(ray.Origin.x), _mm256_set1_ps(ray.Origin.y), _mm256_set1_ps(ray.Origin.z)};
+	__m256 invDirection[3] = {_mm256_set1_ps(ray.InvDirection.x), _mm256_set1_ps(ray.InvDirection.y), _mm256_set1_ps(ray.InvDirection.z)};
+	return IntersectBoxPacket8(ray, origin, invDirection, _mm256_set1_ps(minDistance), _mm256_set1_ps(maxDistance), boxes, first, pEntryDistances);
+#elif defined(TT_SIMD_SSE)
+	__m128 origin[3] = {_mm_set1_ps(ray.Origin.x), _mm_set1_ps(ray.Origin.y), _mm_set1_ps(ray.Origin.z)};
+	__m128 invDirection[3] = {_mm_set1_ps(ray.InvDirection.x), _mm_set1_ps(ray.InvDirection.y), _mm_set1_ps(ray.InvDirection.z)};
+	__m128 tNear = _mm_set1_ps(minDistance), tFar = _mm_set1_ps(maxDistance);
+	int hitMask = IntersectBoxPacket4(ray, origin, invDirection, tNear, tFar, boxes, first, pEntryDistances);
+	hitMask |= IntersectBoxPacket4(ray, origin, invDirection, tNear, tFar, boxes, first + 4, pEntryDistances ? pEntryDistances + 4 : nullptr) << 4;
+	return hitMask;
+#else
+	int hitMask = 0;
+	for(unsigned int lane = 0; lane < RAY_PACKET_SIZE; ++lane){
+		float boxMin[3] = {boxes.Min[0][first + lane], boxes.Min[1][first + lane], boxes.Min[2][first + lane]};
+		float boxMax[3] = {boxes.Max[0][first + lane], boxes.Max[1][first + lane], boxes.Max[2][first + lane]};
+		float tEntry;
+		if(SlabTest(&ray.Origin.x, &ray.InvDirection.x, boxMin, boxMax, minDistance, maxDistance, tEntry) )
+			hitMask |= 1 << lane;
+		if(pEntryDistances)
+			pEntryDistances[lane] = tEntry;
+	}
+	return hitMask;
+#endif
+}
+
+void IntersectBoxes(const Ray& ray, float minDistance, float maxDistance, const AABBoxStreams& boxes, std::vector<BoxHit>& hits)
+{
+	hits.clear();
+
+	float entryDistances[RAY_PACKET_SIZE];
+	for(unsigned int first = 0; first < boxes.NrOfBoxes; first += RAY_PACKET_SIZE){
+		int hitMask = IntersectBoxPacket(ray, minDistance, maxDistance, boxes, first, entryDistances);
+		for(unsigned int lane = 0; hitMask != 0; ++lane, hitMask >>= 1){
+			if(hitMask & 1){
+				BoxHit hit = {first + lane, entryDistances[lane]};
+				hits.push_back(hit);
+			}
+		}
+	}
+}
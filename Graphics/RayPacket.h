@@ -0,0 +1,79 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "../Helpers/Namespace.h"
+
+struct Ray;
+struct AABBox;
+
+//Slab tests of rays against axis aligned boxes, several at a time: a packet of rays against one box (frustum edges, BVH traversal
+//of ray bundles) or one ray against a stream of boxes (picking among scene objects). Packets are RAY_PACKET_SIZE wide and tested
+//8 lanes at once with AVX, as two halves of 4 with SSE, or one lane at a time without SIMD. Every test only counts a box as hit
+//if the ray enters it before leaving it within its own [min, max] distance interval, in units of the ray direction.
+
+const unsigned int RAY_PACKET_SIZE = 8;
+
+//Up to RAY_PACKET_SIZE rays, one stream per axis. Unused lanes have an empty interval and never hit.
+struct RayPacket
+{
+	float Origin[3][RAY_PACKET_SIZE];
+	float Direction[3][RAY_PACKET_SIZE];
+	float InvDirection[3][RAY_PACKET_SIZE];
+	float MinDistance[RAY_PACKET_SIZE];
+	float MaxDistance[RAY_PACKET_SIZE];
+	unsigned int NrOfRays;
+
+	RayPacket(const Ray* pRays, unsigned int nrOfRays, float minDistance, float maxDistance);
+
+	//Bit i is set for every ray in the packet
+	int GetMask(void) const;
+};
+
+//Boxes with one stream per axis, padded with empty boxes to a multiple of RAY_PACKET_SIZE so packets never read past the end
+struct AABBoxStreams
+{
+	std::vector<float> Min[3], Max[3];
+	unsigned int NrOfBoxes;
+
+	AABBoxStreams(void);
+
+	void Resize(unsigned int nrOfBoxes);
+	void Set(unsigned int index, const AABBox& box);
+};
+
+struct BoxHit
+{
+	unsigned int Box;
+	float Distance;	//Where the ray enters the box, clamped to its minimum distance
+};
+
+//One ray against one box given by its corners, the scalar version of the tests below. tEntry is where the ray enters the box.
+bool IntersectRayBox(const Ray& ray, const float* pMin, const float* pMax, float minDistance, float maxDistance, float& tEntry);
+
+//Bit i is set if ray i of the packet hits the box. pEntryDistances receives RAY_PACKET_SIZE entry distances when not null.
+int IntersectRayPacket(const RayPacket& rays, const float* pMin, const float* pMax, float* pEntryDistances = nullptr);
+int IntersectRayPacket(const RayPacket& rays, const AABBox& box);
+
+//Bit i is set if the ray hits box first + i, for the RAY_PACKET_SIZE boxes from first (a multiple of RAY_PACKET_SIZE).
+//pEntryDistances receives RAY_PACKET_SIZE entry distances when not null.
+int IntersectBoxPacket(const Ray& ray, float minDistance, float maxDistance, const AABBoxStreams& boxes, unsigned int first
+					  ,float* pEntryDistances = nullptr);
+
+//Fills hits with every box the ray hits, in the order of the boxes
+void IntersectBoxes(const Ray& ray, float minDistance, float maxDistance, const AABBoxStreams& boxes, std::vector<BoxHit>& hits);
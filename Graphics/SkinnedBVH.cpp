@@ -0,0 +1,45 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "SkinnedBVH.h"
+
+SkinnedBVH::SkinnedBVH(void):m_PoseSerial(0),m_bSkinned(false)
+{
+
+}
+
+SkinnedBVH::~SkinnedBVH(void)
+{
+
+}
+
+bool SkinnedBVH::Intersect(const MeshBVH& bindBVH, const SkinningStreams& streams, const std::vector<tt::DualQuaternion>& palette
+						  ,unsigned int poseSerial, const Ray& ray, float maxDistance, RayHit& hit)
+{
+	//The tree is copied on the first query, an empty one hasn't seen any pose yet
+	if(m_BVH.IsEmpty() || m_PoseSerial != poseSerial){
+		if(m_BVH.IsEmpty() )
+			m_BVH = bindBVH;
+
+		m_PoseSerial = poseSerial;
+		m_bSkinned = SkinVertices(streams, palette, m_Positions) && !m_Positions.empty();
+		if(m_bSkinned)
+			m_BVH.Refit(&m_Positions[0].x, sizeof(tt::Vector3) );
+	}
+
+	return m_bSkinned ? m_BVH.Intersect(ray, maxDistance, hit) : bindBVH.Intersect(ray, maxDistance, hit);
+}
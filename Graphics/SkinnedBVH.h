@@ -0,0 +1,46 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "MeshBVH.h"
+#include "CpuSkinning.h"
+
+//A copy of a model's MeshBVH refitted to its CPU skinned vertices, for exact ray queries against the current animation pose
+//(see PickComponent). Skins and refits once per pose, identified by MeshAnimator::GetPoseSerial, so repeated queries of the
+//same frame reuse it. A pose that can't be skinned isn't tried again either, queries fall back to the bind pose until the next one.
+class SkinnedBVH
+{
+public:
+	SkinnedBVH(void);
+	~SkinnedBVH(void);
+
+	//Closest hit with the mesh in the pose with serial poseSerial, skinned from the streams and the palette when the serial changes.
+	//bindBVH is the model's BVH over the same vertices as the streams.
+	bool Intersect(const MeshBVH& bindBVH, const SkinningStreams& streams, const std::vector<tt::DualQuaternion>& palette
+				  ,unsigned int poseSerial, const Ray& ray, float maxDistance, RayHit& hit);
+
+private:
+	MeshBVH m_BVH;
+	std::vector<tt::Vector3> m_Positions;
+	unsigned int m_PoseSerial;	//Pose of the last skinning attempt
+	bool m_bSkinned;			//False if that attempt failed
+
+	//Disabling default copy constructor & assignment operator
+	SkinnedBVH(const SkinnedBVH& src);
+	SkinnedBVH& operator=(const SkinnedBVH& src);
+};
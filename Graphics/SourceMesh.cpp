@@ -0,0 +1,185 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "SourceMesh.h"
+#include "CookedMesh.h"
+#include "../Helpers/MappedFileReader.h"
+
+//Files of this version and up store a parent index per bone and keys relative to the parent bone
+static const unsigned short BONE_HIERARCHY_VERSION = 2;
+
+//Attribute arrays are copied straight from the file, which stores them as tightly packed floats
+static_assert(sizeof(D3DXVECTOR2) == 2 * sizeof(float) && sizeof(D3DXVECTOR3) == 3 * sizeof(float) && sizeof(D3DXCOLOR) == 4 * sizeof(float)
+			 ,"Vertex attribute types must match the .ttmesh layout");
+static_assert(sizeof(tt::DualQuaternion) == 8 * sizeof(float), "Bone transforms must match the .ttmesh layout");
+
+namespace
+{
+	template<typename T> void ReadAttributeData(MappedFileReader& meshFile, vector<T>& data, unsigned int count)
+	{
+		//Counts come from the file, check them before allocating
+		if(count > (meshFile.GetSize() - meshFile.GetPosition() ) / sizeof(T) )
+			throw exception("EOF found! Cannot continue reading file!");
+
+		data.resize(count);
+		meshFile.ReadArray(data.data(), count);
+	}
+}
+
+SourceMesh::SourceMesh(void):Version(0)
+{
+
+}
+
+unsigned int SourceMesh::GetNrOfVertices(void) const
+{
+	return Positions.Indices.size();
+}
+
+bool SourceMesh::HasBoneHierarchy(void) const
+{
+	return Version >= BONE_HIERARCHY_VERSION;
+}
+
+void ReadSourceMesh(MappedFileReader& meshFile, SourceMesh& mesh)
+{
+	mesh.Version = meshFile.Read<unsigned short>();
+	if(mesh.Version >= COOKED_MESH_VERSION_FIRST)
+		throw exception("Cooked mesh files have no source data");
+
+	auto vertexFormat = meshFile.Read<unsigned char>();
+	auto nrOfTexCoordChannels = meshFile.Read<unsigned char>();
+
+	vector<unsigned int> nrOfTexCoordsArr(nrOfTexCoordChannels);
+	unsigned int nrOfPositions=0, nrOfNormals=0, nrOfTangents=0, nrOfBinormals=0, nrOfVertexColors=0, nrOfAnimData=0;
+	
+	nrOfPositions = meshFile.Read<unsigned int>();
+	meshFile.ReadArray<unsigned int>(nrOfTexCoordsArr.data(), nrOfTexCoordChannels);
+
+	if(vertexFormat & 1)
+		nrOfNormals = meshFile.Read<unsigned int>();
+	if(vertexFormat & 2)
+		nrOfTangents = meshFile.Read<unsigned int>();
+	if(vertexFormat & 4)
+		nrOfBinormals = meshFile.Read<unsigned int>();
+	if(vertexFormat & 8)
+		nrOfVertexColors = meshFile.Read<unsigned int>();
+	if(vertexFormat & 16)
+		nrOfAnimData = meshFile.Read<unsigned int>();
+	
+	auto nrOfVertices = meshFile.Read<unsigned int>();
+	auto nrOfIndices = meshFile.Read<unsigned int>();
+
+	//Read vertex attributes, counts of absent attributes are 0
+	ReadAttributeData(meshFile, mesh.Positions.Data, nrOfPositions);
+	
+	mesh.TexCoords.resize(nrOfTexCoordChannels);
+	for(unsigned int channel = 0; channel < nrOfTexCoordChannels; ++channel)
+		ReadAttributeData(meshFile, mesh.TexCoords[channel].Data, nrOfTexCoordsArr[channel]);
+
+	ReadAttributeData(meshFile, mesh.Normals.Data, nrOfNormals);
+	ReadAttributeData(meshFile, mesh.Tangents.Data, nrOfTangents);
+	ReadAttributeData(meshFile, mesh.Binormals.Data, nrOfBinormals);
+	ReadAttributeData(meshFile, mesh.Colors.Data, nrOfVertexColors);
+	
+	//Read blend indices & blend weights, entries store up to 4 influences each
+	mesh.BlendIndices.Data.resize(nrOfAnimData);
+	mesh.BlendWeights.Data.resize(nrOfAnimData);
+	for(unsigned int i=0; i < nrOfAnimData; ++i){
+		auto nrOfInfluences = min(meshFile.Read<unsigned int>(), 4u);
+
+		unsigned int indices[4];
+		float weights[4];
+		meshFile.ReadArray(indices, nrOfInfluences);
+		meshFile.ReadArray(weights, nrOfInfluences);
+
+		float* pBlendIndices = mesh.BlendIndices.Data[i];
+		float* pBlendWeights = mesh.BlendWeights.Data[i];
+		for(unsigned int j=0; j < 4; ++j){
+			pBlendIndices[j] = j < nrOfInfluences ? static_cast<float>(indices[j]) : -1.0f;
+			pBlendWeights[j] = j < nrOfInfluences ? weights[j] : 0.0f;
+		}
+	}
+
+	//Read vertices, a table of attribute indices per vertex, de-interleaved one attribute at a time
+	unsigned int vertexStride = 1 + nrOfTexCoordChannels + (nrOfNormals > 0) + (nrOfTangents > 0) + (nrOfBinormals > 0) + (nrOfVertexColors > 0) + (nrOfAnimData > 0);
+	const unsigned int* pVertices = meshFile.View<unsigned int>(static_cast<size_t>(nrOfVertices) * vertexStride);
+	unsigned int nextField = 0;
+
+	auto readIndices = [&](vector<unsigned int>& indices){
+		indices.resize(nrOfVertices);
+		for(unsigned int i=0; i < nrOfVertices; ++i)
+			indices[i] = pVertices[i * vertexStride + nextField];
+		++nextField;
+	};
+
+	readIndices(mesh.Positions.Indices);
+	for(unsigned int channel=0; channel < nrOfTexCoordChannels; ++channel)
+		readIndices(mesh.TexCoords[channel].Indices);
+	if(nrOfNormals > 0)
+		readIndices(mesh.Normals.Indices);
+	if(nrOfTangents > 0)
+		readIndices(mesh.Tangents.Indices);
+	if(nrOfBinormals > 0)
+		readIndices(mesh.Binormals.Indices);
+	if(nrOfVertexColors > 0)
+		readIndices(mesh.Colors.Indices);
+	if(nrOfAnimData > 0){
+		readIndices(mesh.BlendIndices.Indices);
+		mesh.BlendWeights.Indices = mesh.BlendIndices.Indices;
+	}
+
+	//Read indices
+	ReadAttributeData(meshFile, mesh.Indices, nrOfIndices);
+
+	mesh.Skeleton.clear();
+	mesh.AnimClips.clear();
+	if(nrOfAnimData == 0)
+		return;
+
+	//Read bones
+	bool bHierarchy = mesh.HasBoneHierarchy();
+
+	mesh.Skeleton.resize(meshFile.Read<unsigned int>() );
+	for(auto& newBone : mesh.Skeleton){
+		newBone.Name = meshFile.ReadString();
+		newBone.Parent = bHierarchy ? meshFile.Read<unsigned int>() : Bone::NO_PARENT;
+		meshFile.ReadArray(&newBone.BindPose, 1);
+	}
+
+	//Read AnimClips, filled in place to avoid copying their keys
+	mesh.AnimClips.resize(meshFile.Read<unsigned int>() );
+	for(auto& newClip : mesh.AnimClips){
+		newClip.Name = meshFile.ReadString();
+		newClip.KeysPerSecond = meshFile.Read<float>();
+
+		newClip.Keys.resize(meshFile.Read<unsigned int>() );
+		for(auto& newKey : newClip.Keys){
+			newKey.KeyTime = meshFile.Read<float>();
+			ReadAttributeData(meshFile, newKey.BoneTransforms, mesh.Skeleton.size() );
+		}
+	}
+}
+
+void ReadSourceMesh(const tstring& filePath, SourceMesh& mesh)
+{
+	MappedFileReader meshFile(filePath);
+	if(!meshFile.IsOpen() )
+		throw exception("Can't open the mesh file");
+
+	ReadSourceMesh(meshFile, mesh);
+}
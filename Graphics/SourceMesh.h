@@ -0,0 +1,57 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "MeshAnimator.h"
+
+class MappedFileReader;
+
+//Contents of a source .ttmesh file as it is stored (see the layout at the end of Model3DLoader.cpp), before Model3D sorts
+//the skeleton and builds its derived data. Model3DLoader reads source files through ReadSourceMesh, tools and tests
+//that need real meshes without the graphics device use it directly.
+
+template<typename T>
+struct SourceAttribute
+{
+	vector<T> Data;
+	vector<unsigned int> Indices; //One per vertex, into Data
+};
+
+struct SourceMesh
+{
+	unsigned short Version;
+	SourceAttribute<D3DXVECTOR3> Positions;
+	vector<SourceAttribute<D3DXVECTOR2> > TexCoords;
+	SourceAttribute<D3DXVECTOR3> Normals, Tangents, Binormals;
+	SourceAttribute<D3DXCOLOR> Colors;
+	SourceAttribute<D3DXVECTOR4> BlendIndices, BlendWeights; //Unused influences have index -1 and weight 0
+	vector<unsigned int> Indices; //Triangle list
+	vector<Bone> Skeleton;		  //In file order
+	vector<AnimationClip> AnimClips; //Uncompressed, bone transforms in file order
+
+	SourceMesh(void);
+
+	unsigned int GetNrOfVertices(void) const;
+	//True if the file stores a parent index per bone and keys relative to the parent bone
+	bool HasBoneHierarchy(void) const;
+};
+
+//Reads a source .ttmesh from the start of meshFile. Throws if the file is cooked or ends early.
+void ReadSourceMesh(MappedFileReader& meshFile, SourceMesh& mesh);
+//Same, opening the file first. Throws if it can't be opened.
+void ReadSourceMesh(const tstring& filePath, SourceMesh& mesh);
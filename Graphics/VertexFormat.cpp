@@ -0,0 +1,274 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "VertexFormat.h"
+#include <cmath>
+
+namespace
+{
+	enum class ComponentType
+	{
+		Float32,
+		Uint32,
+		Sint32,
+		Float16,
+		Unorm8,
+		Snorm8,
+		Uint8,
+		Unsupported
+	};
+
+	ComponentType GetComponentType(DXGI_FORMAT format, unsigned int& nrOfComponents)
+	{
+		switch(format){
+			case DXGI_FORMAT_R32_FLOAT:				nrOfComponents = 1; return ComponentType::Float32;
+			case DXGI_FORMAT_R32G32_FLOAT:			nrOfComponents = 2; return ComponentType::Float32;
+			case DXGI_FORMAT_R32G32B32_FLOAT:		nrOfComponents = 3; return ComponentType::Float32;
+			case DXGI_FORMAT_R32G32B32A32_FLOAT:	nrOfComponents = 4; return ComponentType::Float32;
+			case DXGI_FORMAT_R32_UINT:				nrOfComponents = 1; return ComponentType::Uint32;
+			case DXGI_FORMAT_R32G32_UINT:			nrOfComponents = 2; return ComponentType::Uint32;
+			case DXGI_FORMAT_R32G32B32_UINT:		nrOfComponents = 3; return ComponentType::Uint32;
+			case DXGI_FORMAT_R32G32B32A32_UINT:		nrOfComponents = 4; return ComponentType::Uint32;
+			case DXGI_FORMAT_R32_SINT:				nrOfComponents = 1; return ComponentType::Sint32;
+			case DXGI_FORMAT_R32G32_SINT:			nrOfComponents = 2; return ComponentType::Sint32;
+			case DXGI_FORMAT_R32G32B32_SINT:		nrOfComponents = 3; return ComponentType::Sint32;
+			case DXGI_FORMAT_R32G32B32A32_SINT:		nrOfComponents = 4; return ComponentType::Sint32;
+			case DXGI_FORMAT_R16G16_FLOAT:			nrOfComponents = 2; return ComponentType::Float16;
+			case DXGI_FORMAT_R16G16B16A16_FLOAT:	nrOfComponents = 4; return ComponentType::Float16;
+			case DXGI_FORMAT_R8G8B8A8_UNORM:		nrOfComponents = 4; return ComponentType::Unorm8;
+			case DXGI_FORMAT_R8G8B8A8_SNORM:		nrOfComponents = 4; return ComponentType::Snorm8;
+			case DXGI_FORMAT_R8G8B8A8_UINT:			nrOfComponents = 4; return ComponentType::Uint8;
+			default:								nrOfComponents = 0; return ComponentType::Unsupported;
+		}
+	}
+
+	unsigned int GetComponentSize(ComponentType type)
+	{
+		switch(type){
+			case ComponentType::Float16:
+				return 2;
+			case ComponentType::Unorm8:
+			case ComponentType::Snorm8:
+			case ComponentType::Uint8:
+				return 1;
+			case ComponentType::Unsupported:
+				return 0;
+			default:
+				return 4;
+		}
+	}
+
+	float Clamp(float value, float minValue, float maxValue)
+	{
+		return value < minValue ? minValue : (value > maxValue ? maxValue : value);
+	}
+
+	int Round(float value)
+	{
+		return static_cast<int>(floor(value + 0.5f) );
+	}
+}
+
+DXGI_FORMAT GetSourceFormat(InputLayoutSemantic semantic)
+{
+	switch(semantic){
+		case InputLayoutSemantic::TexCoord:
+			return DXGI_FORMAT_R32G32_FLOAT;
+		case InputLayoutSemantic::Color:
+		case InputLayoutSemantic::BlendIndices:
+		case InputLayoutSemantic::BlendWeights:
+			return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		default:
+			return DXGI_FORMAT_R32G32B32_FLOAT;
+	}
+}
+
+DXGI_FORMAT GetElementFormat(const InputLayoutElement& element)
+{
+	return element.Format != DXGI_FORMAT_UNKNOWN ? element.Format : GetSourceFormat(element.Semantic);
+}
+
+DXGI_FORMAT GetQuantizedFormat(InputLayoutSemantic semantic, DXGI_FORMAT shaderFormat)
+{
+	unsigned int nrOfComponents;
+	ComponentType type = GetComponentType(shaderFormat, nrOfComponents);
+
+	//Bone indices can only go to 8 bits if the shader reads them as integers, the input assembler doesn't convert those to floats
+	if(semantic == InputLayoutSemantic::BlendIndices)
+		return type == ComponentType::Uint32 && nrOfComponents == 4 ? DXGI_FORMAT_R8G8B8A8_UINT : shaderFormat;
+
+	if(type != ComponentType::Float32)
+		return shaderFormat;
+
+	switch(semantic){
+		case InputLayoutSemantic::Position:
+			return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		case InputLayoutSemantic::TexCoord:
+			return nrOfComponents <= 2 ? DXGI_FORMAT_R16G16_FLOAT : DXGI_FORMAT_R16G16B16A16_FLOAT;
+		case InputLayoutSemantic::Normal:
+		case InputLayoutSemantic::Tangent:
+		case InputLayoutSemantic::Binormal:
+			return DXGI_FORMAT_R8G8B8A8_SNORM;
+		case InputLayoutSemantic::Color:
+		case InputLayoutSemantic::BlendWeights:
+			return DXGI_FORMAT_R8G8B8A8_UNORM;
+		default:
+			return shaderFormat;
+	}
+}
+
+unsigned int GetFormatSize(DXGI_FORMAT format)
+{
+	unsigned int nrOfComponents;
+	ComponentType type = GetComponentType(format, nrOfComponents);
+	return nrOfComponents * GetComponentSize(type);
+}
+
+void DecodeVertexElement(DXGI_FORMAT format, const char* pSource, float* pValue)
+{
+	pValue[0] = pValue[1] = pValue[2] = 0.0f;
+	pValue[3] = 1.0f;
+
+	unsigned int nrOfComponents;
+	ComponentType type = GetComponentType(format, nrOfComponents);
+
+	for(unsigned int i = 0; i < nrOfComponents; ++i){
+		switch(type){
+			case ComponentType::Float32:	pValue[i] = reinterpret_cast<const float*>(pSource)[i];												break;
+			case ComponentType::Uint32:		pValue[i] = static_cast<float>(reinterpret_cast<const unsigned int*>(pSource)[i]);					break;
+			case ComponentType::Sint32:		pValue[i] = static_cast<float>(reinterpret_cast<const int*>(pSource)[i]);							break;
+			case ComponentType::Float16:	pValue[i] = HalfToFloat(reinterpret_cast<const unsigned short*>(pSource)[i]);						break;
+			case ComponentType::Unorm8:		pValue[i] = reinterpret_cast<const unsigned char*>(pSource)[i] / 255.0f;							break;
+			case ComponentType::Snorm8:		pValue[i] = max(reinterpret_cast<const signed char*>(pSource)[i] / 127.0f, -1.0f);					break;
+			case ComponentType::Uint8:		pValue[i] = reinterpret_cast<const unsigned char*>(pSource)[i];										break;
+			case ComponentType::Unsupported:																									break; //Has no components
+		}
+	}
+}
+
+void EncodeVertexElement(InputLayoutSemantic semantic, DXGI_FORMAT format, const float* pValue, char* pDest)
+{
+	unsigned int nrOfComponents;
+	ComponentType type = GetComponentType(format, nrOfComponents);
+
+	for(unsigned int i = 0; i < nrOfComponents; ++i){
+		switch(type){
+			case ComponentType::Float32:	reinterpret_cast<float*>(pDest)[i] = pValue[i];																break;
+			case ComponentType::Uint32:		reinterpret_cast<unsigned int*>(pDest)[i] = static_cast<unsigned int>(max(Round(pValue[i]), 0) );			break;
+			case ComponentType::Sint32:		reinterpret_cast<int*>(pDest)[i] = Round(pValue[i]);														break;
+			case ComponentType::Float16:	reinterpret_cast<unsigned short*>(pDest)[i] = FloatToHalf(pValue[i]);										break;
+			case ComponentType::Unorm8:		reinterpret_cast<unsigned char*>(pDest)[i] = static_cast<unsigned char>(Round(Clamp(pValue[i], 0.0f, 1.0f) * 255.0f) );	break;
+			case ComponentType::Snorm8:		reinterpret_cast<signed char*>(pDest)[i] = static_cast<signed char>(Round(Clamp(pValue[i], -1.0f, 1.0f) * 127.0f) );	break;
+			case ComponentType::Uint8:		reinterpret_cast<unsigned char*>(pDest)[i] = static_cast<unsigned char>(min(max(Round(pValue[i]), 0), 255) );			break;
+			case ComponentType::Unsupported:																												break; //Has no components
+		}
+	}
+
+	//Rounding each weight on its own can leave the sum a few steps off 1, which shows as vertices pulled to the origin or past
+	//their bones. Hand out the 255 steps over the normalized weights by largest remainder instead.
+	if(semantic == InputLayoutSemantic::BlendWeights && type == ComponentType::Unorm8){
+		auto pWeights = reinterpret_cast<unsigned char*>(pDest);
+		float sum = 0.0f, remainders[4];
+		for(unsigned int i = 0; i < nrOfComponents; ++i)
+			sum += Clamp(pValue[i], 0.0f, 1.0f);
+
+		if(sum <= 0.0f)
+			return;
+
+		int total = 0;
+		for(unsigned int i = 0; i < nrOfComponents; ++i){
+			float scaled = Clamp(pValue[i], 0.0f, 1.0f) / sum * 255.0f;
+			pWeights[i] = static_cast<unsigned char>(min(floor(scaled), 255.0f) );
+			remainders[i] = scaled - pWeights[i];
+			total += pWeights[i];
+		}
+
+		for(; total < 255; ++total){
+			unsigned int largest = static_cast<unsigned int>(max_element(remainders, remainders + nrOfComponents) - remainders);
+			++pWeights[largest];
+			remainders[largest] = -1.0f;
+		}
+	}
+}
+
+unsigned int ConvertVertexElement(InputLayoutSemantic semantic, DXGI_FORMAT sourceFormat, const void* pSource, DXGI_FORMAT destFormat, char* pDest)
+{
+	unsigned int size = GetFormatSize(destFormat);
+
+	if(sourceFormat == destFormat)
+		memcpy(pDest, pSource, size);
+	else{
+		float value[4];
+		DecodeVertexElement(sourceFormat, static_cast<const char*>(pSource), value);
+		EncodeVertexElement(semantic, destFormat, value, pDest);
+	}
+
+	return size;
+}
+
+unsigned short FloatToHalf(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(float) );
+
+	unsigned int sign = (bits >> 16) & 0x8000;
+	unsigned int mantissa = bits & 0x7FFFFF;
+	int exponent = static_cast<int>( (bits >> 23) & 0xFF) - 127 + 15;
+
+	//Infinity and NaN
+	if( ( (bits >> 23) & 0xFF) == 0xFF)
+		return static_cast<unsigned short>(sign | 0x7C00 | (mantissa ? 0x200 : 0) );
+
+	if(exponent >= 31)
+		return static_cast<unsigned short>(sign | 0x7C00);
+
+	//Denormals, with the implicit leading bit made explicit
+	unsigned int shift = 13;
+	if(exponent <= 0){
+		if(exponent < -10)
+			return static_cast<unsigned short>(sign);
+
+		mantissa |= 0x800000;
+		shift = 14 - exponent;
+		exponent = 0;
+	}
+
+	//Round to nearest even, a carry out of the mantissa correctly bumps the exponent
+	unsigned int half = (static_cast<unsigned int>(exponent) << 10) + (mantissa >> shift);
+	unsigned int rest = mantissa & ( (1u << shift) - 1), halfway = 1u << (shift - 1);
+	if(rest > halfway || (rest == halfway && (half & 1) ) )
+		++half;
+
+	return static_cast<unsigned short>(sign | half);
+}
+
+float HalfToFloat(unsigned short value)
+{
+	unsigned int sign = (value & 0x8000) << 16;
+	unsigned int exponent = (value >> 10) & 0x1F;
+	unsigned int mantissa = value & 0x3FF;
+
+	if(exponent == 0){
+		float result = ldexp(static_cast<float>(mantissa), -24);
+		return sign ? -result : result;
+	}
+
+	unsigned int bits = sign | (mantissa << 13) | (exponent == 31 ? 0x7F800000 : (exponent + 112) << 23);
+	float result;
+	memcpy(&result, &bits, sizeof(float) );
+	return result;
+}
@@ -0,0 +1,50 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "EffectTechnique.h"
+
+//Conversions between vertex attributes and the DXGI formats they are stored as in vertex buffers and cooked streams.
+//Model3D keeps attributes in their source types (float vectors), layouts can ask for any format listed below instead.
+//
+//quantized formats, for techniques with a QuantizeVertices annotation (see EffectTechnique::BuildInputLayout):
+//	Position					: R16G16B16A16_FLOAT, w = 1
+//	TexCoord					: R16G16_FLOAT
+//	Normal, Tangent, Binormal	: R8G8B8A8_SNORM
+//	Color, BlendWeights			: R8G8B8A8_UNORM, weights are rounded so they still add up to 1
+//	BlendIndices				: R8G8B8A8_UINT, for shaders that declare them as uint4
+
+//Format an attribute has in Model3D, R32_FLOAT variants with as many components as its source type
+DXGI_FORMAT GetSourceFormat(InputLayoutSemantic semantic);
+//Format the element is written in, its own or the source format if it has none
+DXGI_FORMAT GetElementFormat(const InputLayoutElement& element);
+//Compact replacement for shaderFormat, the format a shader input is reflected as. shaderFormat itself if there is none.
+DXGI_FORMAT GetQuantizedFormat(InputLayoutSemantic semantic, DXGI_FORMAT shaderFormat);
+
+//Size in bytes of one element, 0 for formats that can't be converted
+unsigned int GetFormatSize(DXGI_FORMAT format);
+
+//Reads an element into 4 floats, components the format lacks are set to (0, 0, 0, 1)
+void DecodeVertexElement(DXGI_FORMAT format, const char* pSource, float* pValue);
+//Writes 4 floats as an element, clamping to the range of normalized formats
+void EncodeVertexElement(InputLayoutSemantic semantic, DXGI_FORMAT format, const float* pValue, char* pDest);
+//Converts one element between formats, a plain copy if they are the same. Returns the number of bytes written.
+unsigned int ConvertVertexElement(InputLayoutSemantic semantic, DXGI_FORMAT sourceFormat, const void* pSource, DXGI_FORMAT destFormat, char* pDest);
+
+unsigned short FloatToHalf(float value);
+float HalfToFloat(unsigned short value);
@@ -0,0 +1,210 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "Namespace.h"
+#include "SimdUtil.h"
+
+using namespace tt;
+
+//------------------------------------
+// Vector3 : batched stream transforms
+//------------------------------------
+
+//The SoA kernels work on 8 elements per iteration with AVX and 4 with SSE, the AoS kernels
+//always use 4-wide SSE (4 Vector3s are exactly 3 registers) and transpose in and out of SoA.
+//Leftover elements go through the scalar Vector3::TransformPoint/TransformVector.
+//Input and output streams may be the same array, partially overlapping streams are not supported.
+
+#ifdef TT_SIMD_SSE
+
+namespace
+{
+	struct SimdMatrix
+	{
+		__m128 m11, m12, m13, m14,
+			   m21, m22, m23, m24,
+			   m31, m32, m33, m34,
+			   m41, m42, m43, m44;
+
+		explicit SimdMatrix(const Matrix4x4& mat)
+			:m11(_mm_set1_ps(mat._11)), m12(_mm_set1_ps(mat._12)), m13(_mm_set1_ps(mat._13)), m14(_mm_set1_ps(mat._14))
+			,m21(_mm_set1_ps(mat._21)), m22(_mm_set1_ps(mat._22)), m23(_mm_set1_ps(mat._23)), m24(_mm_set1_ps(mat._24))
+			,m31(_mm_set1_ps(mat._31)), m32(_mm_set1_ps(mat._32)), m33(_mm_set1_ps(mat._33)), m34(_mm_set1_ps(mat._34))
+			,m41(_mm_set1_ps(mat._41)), m42(_mm_set1_ps(mat._42)), m43(_mm_set1_ps(mat._43)), m44(_mm_set1_ps(mat._44))
+		{}
+	};
+
+	inline void TransformPoints4(const SimdMatrix& m, __m128& x, __m128& y, __m128& z)
+	{
+		__m128 outX = SimdMulAdd(x, m.m11, SimdMulAdd(y, m.m21, SimdMulAdd(z, m.m31, m.m41)));
+		__m128 outY = SimdMulAdd(x, m.m12, SimdMulAdd(y, m.m22, SimdMulAdd(z, m.m32, m.m42)));
+		__m128 outZ = SimdMulAdd(x, m.m13, SimdMulAdd(y, m.m23, SimdMulAdd(z, m.m33, m.m43)));
+		__m128 outW = SimdMulAdd(x, m.m14, SimdMulAdd(y, m.m24, SimdMulAdd(z, m.m34, m.m44)));
+
+		//Full precision division, _mm_rcp_ps is too inaccurate for clip space coordinates
+		__m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), outW);
+		x = _mm_mul_ps(outX, invW);
+		y = _mm_mul_ps(outY, invW);
+		z = _mm_mul_ps(outZ, invW);
+	}
+
+	inline void TransformVectors4(const SimdMatrix& m, __m128& x, __m128& y, __m128& z)
+	{
+		__m128 outX = SimdMulAdd(x, m.m11, SimdMulAdd(y, m.m21, _mm_mul_ps(z, m.m31)));
+		__m128 outY = SimdMulAdd(x, m.m12, SimdMulAdd(y, m.m22, _mm_mul_ps(z, m.m32)));
+		__m128 outZ = SimdMulAdd(x, m.m13, SimdMulAdd(y, m.m23, _mm_mul_ps(z, m.m33)));
+		x = outX;
+		y = outY;
+		z = outZ;
+	}
+
+#ifdef TT_SIMD_AVX
+	struct SimdMatrix8
+	{
+		__m256 m11, m12, m13, m14,
+			   m21, m22, m23, m24,
+			   m31, m32, m33, m34,
+			   m41, m42, m43, m44;
+
+		explicit SimdMatrix8(const Matrix4x4& mat)
+			:m11(_mm256_set1_ps(mat._11)), m12(_mm256_set1_ps(mat._12)), m13(_mm256_set1_ps(mat._13)), m14(_mm256_set1_ps(mat._14))
+			,m21(_mm256_set1_ps(mat._21)), m22(_mm256_set1_ps(mat._22)), m23(_mm256_set1_ps(mat._23)), m24(_mm256_set1_ps(mat._24))
+			,m31(_mm256_set1_ps(mat._31)), m32(_mm256_set1_ps(mat._32)), m33(_mm256_set1_ps(mat._33)), m34(_mm256_set1_ps(mat._34))
+			,m41(_mm256_set1_ps(mat._41)), m42(_mm256_set1_ps(mat._42)), m43(_mm256_set1_ps(mat._43)), m44(_mm256_set1_ps(mat._44))
+		{}
+	};
+#endif
+}
+
+#endif
+
+void Vector3::TransformPoints(const Matrix4x4& matTransform, const Vector3* pIn, Vector3* pOut, unsigned int count)
+{
+	unsigned int i = 0;
+
+#ifdef TT_SIMD_SSE
+	SimdMatrix m(matTransform);
+	for(; i + 4 <= count; i += 4){
+		__m128 x, y, z;
+		SimdLoadAoS3(&pIn[i].x, x, y, z);
+		TransformPoints4(m, x, y, z);
+		SimdStoreAoS3(&pOut[i].x, x, y, z);
+	}
+#endif
+
+	for(; i < count; ++i)
+		pOut[i] = pIn[i].TransformPoint(matTransform);
+}
+
+void Vector3::TransformVectors(const Matrix4x4& matTransform, const Vector3* pIn, Vector3* pOut, unsigned int count)
+{
+	unsigned int i = 0;
+
+#ifdef TT_SIMD_SSE
+	SimdMatrix m(matTransform);
+	for(; i + 4 <= count; i += 4){
+		__m128 x, y, z;
+		SimdLoadAoS3(&pIn[i].x, x, y, z);
+		TransformVectors4(m, x, y, z);
+		SimdStoreAoS3(&pOut[i].x, x, y, z);
+	}
+#endif
+
+	for(; i < count; ++i)
+		pOut[i] = pIn[i].TransformVector(matTransform);
+}
+
+void Vector3::TransformPointsSoA(const Matrix4x4& matTransform, const float* pInX, const float* pInY, const float* pInZ
+								,float* pOutX, float* pOutY, float* pOutZ, unsigned int count)
+{
+	unsigned int i = 0;
+
+#ifdef TT_SIMD_AVX
+	SimdMatrix8 m8(matTransform);
+	for(; i + 8 <= count; i += 8){
+		__m256 x = _mm256_loadu_ps(pInX + i);
+		__m256 y = _mm256_loadu_ps(pInY + i);
+		__m256 z = _mm256_loadu_ps(pInZ + i);
+
+		__m256 outW = SimdMulAdd8(x, m8.m14, SimdMulAdd8(y, m8.m24, SimdMulAdd8(z, m8.m34, m8.m44)));
+		__m256 invW = _mm256_div_ps(_mm256_set1_ps(1.0f), outW);
+
+		_mm256_storeu_ps(pOutX + i, _mm256_mul_ps(SimdMulAdd8(x, m8.m11, SimdMulAdd8(y, m8.m21, SimdMulAdd8(z, m8.m31, m8.m41))), invW));
+		_mm256_storeu_ps(pOutY + i, _mm256_mul_ps(SimdMulAdd8(x, m8.m12, SimdMulAdd8(y, m8.m22, SimdMulAdd8(z, m8.m32, m8.m42))), invW));
+		_mm256_storeu_ps(pOutZ + i, _mm256_mul_ps(SimdMulAdd8(x, m8.m13, SimdMulAdd8(y, m8.m23, SimdMulAdd8(z, m8.m33, m8.m43))), invW));
+	}
+#endif
+
+#ifdef TT_SIMD_SSE
+	SimdMatrix m(matTransform);
+	for(; i + 4 <= count; i += 4){
+		__m128 x = _mm_loadu_ps(pInX + i);
+		__m128 y = _mm_loadu_ps(pInY + i);
+		__m128 z = _mm_loadu_ps(pInZ + i);
+		TransformPoints4(m, x, y, z);
+		_mm_storeu_ps(pOutX + i, x);
+		_mm_storeu_ps(pOutY + i, y);
+		_mm_storeu_ps(pOutZ + i, z);
+	}
+#endif
+
+	for(; i < count; ++i){
+		Vector3 v = Vector3(pInX[i], pInY[i], pInZ[i]).TransformPoint(matTransform);
+		pOutX[i] = v.x;
+		pOutY[i] = v.y;
+		pOutZ[i] = v.z;
+	}
+}
+
+void Vector3::TransformVectorsSoA(const Matrix4x4& matTransform, const float* pInX, const float* pInY, const float* pInZ
+								 ,float* pOutX, float* pOutY, float* pOutZ, unsigned int count)
+{
+	unsigned int i = 0;
+
+#ifdef TT_SIMD_AVX
+	SimdMatrix8 m8(matTransform);
+	for(; i + 8 <= count; i += 8){
+		__m256 x = _mm256_loadu_ps(pInX + i);
+		__m256 y = _mm256_loadu_ps(pInY + i);
+		__m256 z = _mm256_loadu_ps(pInZ + i);
+
+		_mm256_storeu_ps(pOutX + i, SimdMulAdd8(x, m8.m11, SimdMulAdd8(y, m8.m21, _mm256_mul_ps(z, m8.m31))));
+		_mm256_storeu_ps(pOutY + i, SimdMulAdd8(x, m8.m12, SimdMulAdd8(y, m8.m22, _mm256_mul_ps(z, m8.m32))));
+		_mm256_storeu_ps(pOutZ + i, SimdMulAdd8(x, m8.m13, SimdMulAdd8(y, m8.m23, _mm256_mul_ps(z, m8.m33))));
+	}
+#endif
+
+#ifdef TT_SIMD_SSE
+	SimdMatrix m(matTransform);
+	for(; i + 4 <= count; i += 4){
+		__m128 x = _mm_loadu_ps(pInX + i);
+		__m128 y = _mm_loadu_ps(pInY + i);
+		__m128 z = _mm_loadu_ps(pInZ + i);
+		TransformVectors4(m, x, y, z);
+		_mm_storeu_ps(pOutX + i, x);
+		_mm_storeu_ps(pOutY + i, y);
+		_mm_storeu_ps(pOutZ + i, z);
+	}
+#endif
+
+	for(; i < count; ++i){
+		Vector3 v = Vector3(pInX[i], pInY[i], pInZ[i]).TransformVector(matTransform);
+		pOutX[i] = v.x;
+		pOutY[i] = v.y;
+		pOutZ[i] = v.z;
+	}
+}
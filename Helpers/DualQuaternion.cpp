@@ -23,34 +23,6 @@ DualQuaternion::DualQuaternion(const Quaternion& rotation, const Vector3& transl
 	Data[1].w = -.5f * ( translation.x * rotation.x + translation.y * rotation.y + translation.z * rotation.z ) ; 
 }
 
-DualQuaternion::DualQuaternion(const DualQuaternion& src)
-{
-	Data[0].x = src.Data[0].x;
-	Data[0].y = src.Data[0].y;
-	Data[0].z = src.Data[0].z;
-	Data[0].w = src.Data[0].w;
-	
-	Data[1].x = src.Data[1].x;
-	Data[1].y = src.Data[1].y;
-	Data[1].z = src.Data[1].z;
-	Data[1].w = src.Data[1].w;
-}
-
-DualQuaternion& DualQuaternion::operator=(const DualQuaternion& src)
-{
-	Data[0].x = src.Data[0].x;
-	Data[0].y = src.Data[0].y;
-	Data[0].z = src.Data[0].z;
-	Data[0].w = src.Data[0].w;
-	
-	Data[1].x = src.Data[1].x;
-	Data[1].y = src.Data[1].y;
-	Data[1].z = src.Data[1].z;
-	Data[1].w = src.Data[1].w;
-
-	return *this;
-}
-
 DualQuaternion DualQuaternion::operator+(const DualQuaternion& dualQuat) const
 {
 	DualQuaternion newDQ;
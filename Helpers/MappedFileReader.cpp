@@ -0,0 +1,118 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "MappedFileReader.h"
+
+MappedFileReader::MappedFileReader(const std::tstring& filename):m_hFile(INVALID_HANDLE_VALUE)
+																,m_hMapping(NULL)
+																,m_pData(nullptr)
+																,m_Size(0)
+																,m_Position(0)
+{
+	m_hFile = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(m_hFile == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(m_hFile, &fileSize) || static_cast<unsigned long long>(fileSize.QuadPart) > static_cast<size_t>(-1))
+		return;
+
+	m_Size = static_cast<size_t>(fileSize.QuadPart);
+	
+	//Empty files can't be mapped, but are still valid to open
+	if(m_Size == 0)
+		return;
+
+	m_hMapping = CreateFileMapping(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(m_hMapping)
+		m_pData = static_cast<const char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0) );
+
+	if(!m_pData)
+		m_Size = 0;
+}
+
+MappedFileReader::~MappedFileReader(void)
+{
+	if(m_pData)
+		UnmapViewOfFile(m_pData);
+	if(m_hMapping)
+		CloseHandle(m_hMapping);
+	if(m_hFile != INVALID_HANDLE_VALUE)
+		CloseHandle(m_hFile);
+}
+
+//Methods
+
+bool MappedFileReader::IsOpen(void) const
+{
+	return m_hFile != INVALID_HANDLE_VALUE && (m_pData || m_Size == 0);
+}
+
+size_t MappedFileReader::GetSize(void) const
+{
+	return m_Size;
+}
+
+size_t MappedFileReader::GetPosition(void) const
+{
+	return m_Position;
+}
+
+const char* MappedFileReader::Claim(size_t nrOfBytes)
+{
+	if(nrOfBytes > m_Size - m_Position)
+		throw exception("EOF found! Cannot continue reading file!");
+
+	const char* pCurrent = m_pData + m_Position;
+	m_Position += nrOfBytes;
+	return pCurrent;
+}
+
+void MappedFileReader::Advance(size_t nrOfBytesToSkip)
+{
+	Claim(nrOfBytesToSkip);
+}
+
+void MappedFileReader::Seek(size_t position)
+{
+	if(position > m_Size)
+		throw exception("EOF found! Cannot continue reading file!");
+
+	m_Position = position;
+}
+
+std::tstring MappedFileReader::ReadString(void)
+{
+	//Same layout as BinaryReader: a 1 byte length followed by the characters
+	auto strLen = static_cast<unsigned char>(Read<char>() );
+	const char* pStr = Claim(strLen);
+	
+	return StringToTstring(std::string(pStr, pStr + strLen) );
+}
+
+std::tstring MappedFileReader::ReadNullTerminatedString(void)
+{
+	const char* pStr = m_pData + m_Position;
+	size_t strLen = 0;
+	while(m_Position + strLen < m_Size && pStr[strLen] != '\0')
+		++strLen;
+
+	//Consume the terminator as well, if there is one
+	Claim(m_Position + strLen < m_Size ? strLen + 1 : strLen);
+	
+	return StringToTstring(std::string(pStr, pStr + strLen) );
+}
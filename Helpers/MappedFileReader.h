@@ -0,0 +1,88 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+//    __  __      ______            _          
+//   / /_/ /__ _ / ____/___  ____ _(_)___  ___ 
+//  / __/ __(_|_) __/ / __ \/ __ `/ / __ \/ _ \
+// / /_/ /__ _ / /___/ / / / /_/ / / / / /  __/
+// \__/\__(_|_)_____/_/ /_/\__, /_/_/ /_/\___/ 
+//                        /____/               
+//
+// MappedFileReader.h : file containing a reader for memory mapped binary files
+// Copyright © 2013 Tom Tondeur
+//
+
+#pragma once
+
+#include "stdafx.h"
+
+//Read-only view of a whole file, with the interface of BinaryReader.
+//Reads are memcpys out of the mapping, so arrays can be read in bulk without going through a stream. Only trivially copyable
+//types can be read that way.
+class MappedFileReader final{
+public:
+	MappedFileReader(const std::tstring& filename);
+	~MappedFileReader(void);
+
+	//False if the file doesn't exist or couldn't be mapped
+	bool IsOpen(void) const;
+	size_t GetSize(void) const;
+	size_t GetPosition(void) const;
+
+	template<typename T> T Read(void)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "MappedFileReader copies bytes, T has to be trivially copyable");
+		T retVal;
+		memcpy(&retVal, Claim(sizeof(T)), sizeof(T));
+		return retVal;
+	}
+	
+	template<typename T> void ReadArray(T* outArray, size_t size)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "MappedFileReader copies bytes, T has to be trivially copyable");
+		if(size > 0)
+			memcpy(outArray, Claim(sizeof(T) * size), sizeof(T) * size);
+	}
+
+	//Skips size elements and returns a pointer to them inside the mapping, valid for the lifetime of the reader.
+	//The data is as aligned as the file layout makes it.
+	template<typename T> const T* View(size_t size)
+	{
+		return reinterpret_cast<const T*>(Claim(sizeof(T) * size) );
+	}
+
+	void Advance(size_t nrOfBytesToSkip);
+	//Moves to an absolute position, throws when that is past the end of the file
+	void Seek(size_t position);
+	
+	std::tstring ReadString(void);	
+	std::tstring ReadNullTerminatedString(void);
+	
+private:
+	//Returns the current position and moves past nrOfBytes, throws when that runs past the end of the file
+	const char* Claim(size_t nrOfBytes);
+
+	//Datamembers
+	HANDLE m_hFile, m_hMapping;
+	const char* m_pData;
+	size_t m_Size, m_Position;
+
+	//Disabling default constructor, copy constructor & assignment operator
+	MappedFileReader(void);// = delete;
+	MappedFileReader(const MappedFileReader& src);// = delete;
+	MappedFileReader& operator=(const MappedFileReader& src);// = delete;
+};
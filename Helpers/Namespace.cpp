@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -22,10 +22,11 @@
 // \__/\__(_|_)_____/_/ /_/\__, /_/_/ /_/\___/ 
 //                        /____/               
 //
-// Namespace.cpp - Copyright  2013 Tom Tondeur
+// Namespace.cpp - Copyright © 2013 Tom Tondeur
 //
 
 #include "Namespace.h"
+#include "SimdUtil.h"
 
 using namespace std;
 using namespace tt;
@@ -147,7 +148,7 @@ Vector2& Vector2::operator-=(const Vector2& v)
 
 Vector2 Vector2::operator*(float f) const
 {
-	return Vector2() *= f;
+	return Vector2(*this) *= f;
 }
 
 Vector2& Vector2::operator*=(float f)
@@ -159,7 +160,7 @@ Vector2& Vector2::operator*=(float f)
 
 Vector2 Vector2::operator/(float f) const
 {
-	return Vector2() /= f;
+	return Vector2(*this) /= f;
 }
 
 Vector2& Vector2::operator/=(float f)
@@ -340,51 +341,39 @@ float Vector3::LengthSq(void) const
 
 Vector3 Vector3::TransformVector(const Matrix4x4& matTransform) const
 {
-	D3DXVECTOR3 vec;
-	D3DXVec3TransformNormal(&vec, &static_cast<D3DXVECTOR3>(*this), &static_cast<D3DXMATRIX>(matTransform) );
-	return static_cast<Vector3>(vec);
+	//Row vector * upper 3x3, translation is ignored
+	return Vector3(x*matTransform._11 + y*matTransform._21 + z*matTransform._31,
+				   x*matTransform._12 + y*matTransform._22 + z*matTransform._32,
+				   x*matTransform._13 + y*matTransform._23 + z*matTransform._33);
 }
 
 Vector3 Vector3::TransformPoint(const Matrix4x4& matTransform) const
-{/*
-	Vector3 out;
-	float w = x*matTransform._14 + y*matTransform._24 + z*matTransform._34 + matTransform._44;
-	out.x = (x*matTransform._11 + y*matTransform._21 + z*matTransform._31 + matTransform._41) / w;
-	out.y = (x*matTransform._12 + y*matTransform._22 + z*matTransform._32 + matTransform._42) / w;
-	out.z = (x*matTransform._13 + y*matTransform._23 + z*matTransform._33 + matTransform._43) / w;
-	return out;
-	*/
-	D3DXVECTOR3 vec;
-	D3DXVec3TransformCoord(&vec, &static_cast<D3DXVECTOR3>(*this), &static_cast<D3DXMATRIX>(matTransform) );
-	return static_cast<Vector3>(vec);
+{
+	//Row vector * matrix, followed by the homogeneous divide
+	float invW = 1.0f / (x*matTransform._14 + y*matTransform._24 + z*matTransform._34 + matTransform._44);
+	return Vector3((x*matTransform._11 + y*matTransform._21 + z*matTransform._31 + matTransform._41) * invW,
+				   (x*matTransform._12 + y*matTransform._22 + z*matTransform._32 + matTransform._42) * invW,
+				   (x*matTransform._13 + y*matTransform._23 + z*matTransform._33 + matTransform._43) * invW);
 }
 
 Vector3 Vector3::TransformPoint(const Quaternion& rotQuat) const
 {
-	auto rotMat = Matrix4x4::Rotation(rotQuat);
-	return TransformPoint(rotMat);
+	//v' = v + 2w(q x v) + 2q x (q x v), equal to Matrix4x4::Rotation(rotQuat) for unit quaternions
+	Vector3 q(rotQuat.x, rotQuat.y, rotQuat.z);
+	Vector3 t = q.Cross(*this) * 2.0f;
+	return *this + t * rotQuat.w + q.Cross(t);
 }
 
 Vector3 Vector3::Cross(const Vector3& v) const
-{/*
-	//Cross product calculation: http://en.wikipedia.org/wiki/Cross_product#Matrix_notation
-	//(v1.y * v2*z - v1.z * v2.y) * i + (v1.x * v2.z + v1.z * v2.x) * j + (v1.x * v2.y + v1.y * v2.x) * k
-	//Find determinant using cofactor expansion
-	Vector3 i(1,0,0);
-	Vector3 j(0,1,0);
-	Vector3 k(0,0,1);
-	i *= y*v.z - z*v.y;
-	j *= x*v.z - z*v.x;
-	k *= x*v.y - y*v.x;
-	return i-j+k;*/
-	D3DXVECTOR3 vec;
-	D3DXVec3Cross(&vec, &static_cast<D3DXVECTOR3>(*this), &static_cast<D3DXVECTOR3>(v));
-	return static_cast<Vector3>(vec);
+{
+	return Vector3(y*v.z - z*v.y,
+				   z*v.x - x*v.z,
+				   x*v.y - y*v.x);
 }
 
 float Vector3::Dot(const Vector3& v) const
 {
-	return D3DXVec3Dot(&static_cast<D3DXVECTOR3>(*this), &static_cast<D3DXVECTOR3>(v));
+	return x*v.x + y*v.y + z*v.z;
 }
 
 //--------
@@ -423,7 +412,7 @@ Vector4::Vector4(const D3DXVECTOR4& v)
 		
 Vector4 Vector4::operator+(const Vector4& v) const
 {
-	return Vector4() += v;
+	return Vector4(*this) += v;
 }
 
 Vector4& Vector4::operator+=(const Vector4& v)
@@ -437,7 +426,7 @@ Vector4& Vector4::operator+=(const Vector4& v)
 
 Vector4 Vector4::operator-(const Vector4& v) const
 {
-	return Vector4() -= v;
+	return Vector4(*this) -= v;
 }
 
 Vector4& Vector4::operator-=(const Vector4& v)
@@ -451,7 +440,7 @@ Vector4& Vector4::operator-=(const Vector4& v)
 
 Vector4 Vector4::operator*(float f) const
 {
-	return Vector4() *= f;
+	return Vector4(*this) *= f;
 }
 
 Vector4& Vector4::operator*=(float f)
@@ -465,7 +454,7 @@ Vector4& Vector4::operator*=(float f)
 
 Vector4 Vector4::operator/(float f) const
 {
-	return Vector4() /= f;
+	return Vector4(*this) /= f;
 }
 
 Vector4& Vector4::operator/=(float f)
@@ -488,16 +477,14 @@ Vector4::operator D3DXCOLOR(void) const
 }
 
 Vector4& Vector4::Normalize(void)
-{/*
+{
 	float len = Length();
-	x /= len;
-	y /= len;
-	z /= len;
-	w /= len;
-	return (*this);*/
-	D3DXVECTOR4 vec;
-	D3DXVec4Normalize(&vec, &static_cast<D3DXVECTOR4>(*this));
-	return *this = static_cast<Vector4>(vec);
+
+	//Zero-length vectors normalize to the zero vector
+	if(len == 0)
+		return *this = Vector4(0);
+
+	return *this *= 1.0f / len;
 }
 
 Vector4 Vector4::Normalize(const Vector4& vec)
@@ -561,38 +548,39 @@ Matrix4x4 Matrix4x4::Translation(Vector3 displacement)
 
 Matrix4x4 Matrix4x4::Rotation(Quaternion q)
 {
-	D3DXMATRIX mat;
-	D3DXMatrixRotationQuaternion(&mat, &static_cast<D3DXQUATERNION>(q));
-	return Matrix4x4(mat);
+	float xx = q.x*q.x, yy = q.y*q.y, zz = q.z*q.z;
+	float xy = q.x*q.y, xz = q.x*q.z, yz = q.y*q.z;
+	float wx = q.w*q.x, wy = q.w*q.y, wz = q.w*q.z;
+
+	return Matrix4x4(1 - 2*(yy + zz),		2*(xy + wz),		2*(xz - wy),		0,
+						 2*(xy - wz),	1 - 2*(xx + zz),		2*(yz + wx),		0,
+						 2*(xz + wy),		2*(yz - wx),	1 - 2*(xx + yy),		0,
+									0,					0,					0,		1);
 }
 
 Matrix4x4 Matrix4x4::Rotation(tt::Vector3 yawPitchRoll)
 {
-	D3DXMATRIX mat;
-	D3DXMatrixRotationYawPitchRoll(&mat, yawPitchRoll.x, yawPitchRoll.y, yawPitchRoll.z);
-	return Matrix4x4(mat);
+	float sy = sinf(yawPitchRoll.x), cy = cosf(yawPitchRoll.x);
+	float sp = sinf(yawPitchRoll.y), cp = cosf(yawPitchRoll.y);
+	float sr = sinf(yawPitchRoll.z), cr = cosf(yawPitchRoll.z);
+
+	//Roll (z), then pitch (x), then yaw (y)
+	return Matrix4x4(sr*sp*sy + cr*cy,	sr*cp,	sr*sp*cy - cr*sy,	0,
+					 cr*sp*sy - sr*cy,	cr*cp,	cr*sp*cy + sr*sy,	0,
+					 cp*sy,				-sp,	cp*cy,				0,
+					 0,					0,		0,					1);
 }
 
 Matrix4x4 Matrix4x4::Rotation(tt::Vector3 axis, float angle)
-{/*
+{
 	//Calculations found at http://inside.mines.edu/~gmurray/ArbitraryAxisRotation/
 	axis.Normalize();
-	Matrix4x4 out = Matrix4x4::Identity;
-	out._11 = axis.x*axis.x + (axis.y*axis.y + axis.z*axis.z) * cosf(angle);
-	out._12 = axis.x*axis.y * (1 - cosf(angle)) + axis.z * sinf(angle);
-	out._13 = axis.x*axis.z * (1 - cosf(angle)) - axis.y * sinf(angle);
-	
-	out._21 = axis.x*axis.y * (1 - cosf(angle)) - axis.z * sinf(angle);
-	out._22 = axis.y*axis.y + (axis.x*axis.x + axis.z*axis.z) * cosf(angle);
-	out._23 = axis.y*axis.z * (1 - cosf(angle)) + axis.x * sinf(angle);
-	
-	out._31 = axis.x*axis.z * (1 - cosf(angle)) + axis.y * sinf(angle);
-	out._32 = axis.y*axis.z * (1 - cosf(angle)) - axis.x * sinf(angle);
-	out._33 = axis.z*axis.z + (axis.x*axis.x + axis.y*axis.y) * cosf(angle);
-	return out;*/
-	D3DXMATRIX mat;
-	D3DXMatrixRotationAxis(&mat, &static_cast<D3DXVECTOR3>(axis), angle);
-	return static_cast<Matrix4x4>(mat);
+	float s = sinf(angle), c = cosf(angle), t = 1 - c;
+
+	return Matrix4x4(t*axis.x*axis.x + c,			t*axis.x*axis.y + s*axis.z,		t*axis.x*axis.z - s*axis.y,		0,
+					 t*axis.x*axis.y - s*axis.z,	t*axis.y*axis.y + c,			t*axis.y*axis.z + s*axis.x,		0,
+					 t*axis.x*axis.z + s*axis.y,	t*axis.y*axis.z - s*axis.x,		t*axis.z*axis.z + c,			0,
+					 0,								0,								0,								1);
 }
 
 Matrix4x4 Matrix4x4::Scale(Vector3 scale)
@@ -615,10 +603,33 @@ Matrix4x4 Matrix4x4::Scale(float scale)
 
 Matrix4x4 Matrix4x4::operator*(const Matrix4x4& mat) const
 {
-    D3DXMATRIX matT;
-    D3DXMatrixMultiply(&matT, &static_cast<D3DXMATRIX>(*this), &static_cast<D3DXMATRIX>(mat) );
-    
-	return Matrix4x4(matT);
+	Matrix4x4 out;
+	const float* lhs = &_11;
+	float* pOut = &out._11;
+
+#ifdef TT_SIMD_SSE
+	//Each output row is a linear combination of the rows of mat
+	__m128 row0 = _mm_loadu_ps(&mat._11);
+	__m128 row1 = _mm_loadu_ps(&mat._21);
+	__m128 row2 = _mm_loadu_ps(&mat._31);
+	__m128 row3 = _mm_loadu_ps(&mat._41);
+
+	for(unsigned int i = 0; i < 4; ++i, lhs += 4, pOut += 4){
+		__m128 res = _mm_mul_ps(_mm_set1_ps(lhs[0]), row0);
+		res = SimdMulAdd(_mm_set1_ps(lhs[1]), row1, res);
+		res = SimdMulAdd(_mm_set1_ps(lhs[2]), row2, res);
+		res = SimdMulAdd(_mm_set1_ps(lhs[3]), row3, res);
+		_mm_storeu_ps(pOut, res);
+	}
+#else
+	const float* rhs = &mat._11;
+
+	for(unsigned int i = 0; i < 4; ++i, lhs += 4, pOut += 4)
+		for(unsigned int j = 0; j < 4; ++j)
+			pOut[j] = lhs[0]*rhs[j] + lhs[1]*rhs[4+j] + lhs[2]*rhs[8+j] + lhs[3]*rhs[12+j];
+#endif
+
+	return out;
 }
 
 Matrix4x4& Matrix4x4::operator*=(const Matrix4x4& mat)
@@ -636,22 +647,123 @@ Matrix4x4::operator D3DXMATRIX(void) const
 
 void Matrix4x4::Decompose(Vector3& pos, Quaternion& rot, Vector3& scale) const
 {
-	D3DXMATRIX transform = static_cast<D3DXMATRIX>(*this);
-	D3DXVECTOR3 _pos, _scale;
-	D3DXQUATERNION _rot;
+	//Scale is the length of each basis vector, translation is stored in the 4th row
+	Vector3 right(_11, _12, _13), up(_21, _22, _23), forward(_31, _32, _33);
+	
+	scale = Vector3(right.Length(), up.Length(), forward.Length());
+	pos = Vector3(_41, _42, _43);
+
+	//Can't extract a rotation from a degenerate matrix
+	if(scale.x == 0 || scale.y == 0 || scale.z == 0)
+		return;
 
-	D3DXMatrixDecompose(&_scale,&_rot,&_pos,&transform); //Decompose matrix
+	right /= scale.x;
+	up /= scale.y;
+	forward /= scale.z;
 
-	pos =	tt::Vector3(_pos);
-	rot =	tt::Quaternion(_rot);
-	scale = tt::Vector3(_scale);
+	rot = Quaternion::FromRotationMatrix(Matrix4x4(	right.x,	right.y,	right.z,	0,
+													up.x,		up.y,		up.z,		0,
+													forward.x,	forward.y,	forward.z,	0,
+													0,			0,			0,			1) );
 }
 
+//Block-wise inverse using 2x2 sub-matrices A, B, C, D (M = [A B; C D]) and their adjugates (A#)
 Matrix4x4 Matrix4x4::Inverse(void) const
 {
-	D3DXMATRIX temp;
-	D3DXMatrixInverse(&temp, nullptr, &static_cast<D3DXMATRIX>(*this) );
-	return static_cast<Matrix4x4>(temp);
+	Matrix4x4 out;
+
+#ifdef TT_SIMD_SSE
+	__m128 row0 = _mm_loadu_ps(&_11);
+	__m128 row1 = _mm_loadu_ps(&_21);
+	__m128 row2 = _mm_loadu_ps(&_31);
+	__m128 row3 = _mm_loadu_ps(&_41);
+
+	//2x2 sub-matrices, stored row-major in one register each
+	__m128 A = _mm_movelh_ps(row0, row1);
+	__m128 B = _mm_movehl_ps(row1, row0);
+	__m128 C = _mm_movelh_ps(row2, row3);
+	__m128 D = _mm_movehl_ps(row3, row2);
+
+	//(|A|, |B|, |C|, |D|)
+	__m128 detSub = _mm_sub_ps(	_mm_mul_ps(TT_SHUFFLE(row0, row2, 0,2,0,2), TT_SHUFFLE(row1, row3, 1,3,1,3)),
+								_mm_mul_ps(TT_SHUFFLE(row0, row2, 1,3,1,3), TT_SHUFFLE(row1, row3, 0,2,0,2)) );
+	__m128 detA = TT_SPLAT(detSub, 0);
+	__m128 detB = TT_SPLAT(detSub, 1);
+	__m128 detC = TT_SPLAT(detSub, 2);
+	__m128 detD = TT_SPLAT(detSub, 3);
+
+	//2x2 products: X*Y, X#*Y and X*Y#
+	#define MAT2_MUL(X, Y)		_mm_add_ps(_mm_mul_ps(X, TT_SWIZZLE(Y, 0,3,0,3)), _mm_mul_ps(TT_SWIZZLE(X, 1,0,3,2), TT_SWIZZLE(Y, 2,1,2,1)))
+	#define MAT2_ADJMUL(X, Y)	_mm_sub_ps(_mm_mul_ps(TT_SWIZZLE(X, 3,3,0,0), Y), _mm_mul_ps(TT_SWIZZLE(X, 1,1,2,2), TT_SWIZZLE(Y, 2,3,0,1)))
+	#define MAT2_MULADJ(X, Y)	_mm_sub_ps(_mm_mul_ps(X, TT_SWIZZLE(Y, 3,0,3,0)), _mm_mul_ps(TT_SWIZZLE(X, 1,0,3,2), TT_SWIZZLE(Y, 2,1,2,1)))
+
+	__m128 D_C = MAT2_ADJMUL(D, C);
+	__m128 A_B = MAT2_ADJMUL(A, B);
+	__m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), MAT2_MUL(B, D_C));
+	__m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), MAT2_MUL(C, A_B));
+	__m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), MAT2_MULADJ(D, A_B));
+	__m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), MAT2_MULADJ(A, D_C));
+
+	#undef MAT2_MUL
+	#undef MAT2_ADJMUL
+	#undef MAT2_MULADJ
+
+	//|M| = |A||D| + |B||C| - tr((A#B)(D#C))
+	__m128 tr = SimdHorizontalAdd(_mm_mul_ps(A_B, TT_SWIZZLE(D_C, 0,2,1,3)));
+	__m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+	//Singular matrix, there is no inverse
+	if(_mm_cvtss_f32(detM) == 0)
+		return Matrix4x4::Identity;
+
+	__m128 invDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+	X_ = _mm_mul_ps(X_, invDetM);
+	Y_ = _mm_mul_ps(Y_, invDetM);
+	Z_ = _mm_mul_ps(Z_, invDetM);
+	W_ = _mm_mul_ps(W_, invDetM);
+
+	//Take the adjugate of each block and store the rows
+	_mm_storeu_ps(&out._11, TT_SHUFFLE(X_, Y_, 3,1,3,1));
+	_mm_storeu_ps(&out._21, TT_SHUFFLE(X_, Y_, 2,0,2,0));
+	_mm_storeu_ps(&out._31, TT_SHUFFLE(Z_, W_, 3,1,3,1));
+	_mm_storeu_ps(&out._41, TT_SHUFFLE(Z_, W_, 2,0,2,0));
+#else
+	//Cofactor expansion using the 2x2 sub-determinants of the upper and lower two rows
+	float s0 = _11*_22 - _21*_12, s1 = _11*_23 - _21*_13, s2 = _11*_24 - _21*_14;
+	float s3 = _12*_23 - _22*_13, s4 = _12*_24 - _22*_14, s5 = _13*_24 - _23*_14;
+	float c5 = _33*_44 - _43*_34, c4 = _32*_44 - _42*_34, c3 = _32*_43 - _42*_33;
+	float c2 = _31*_44 - _41*_34, c1 = _31*_43 - _41*_33, c0 = _31*_42 - _41*_32;
+
+	float det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+
+	//Singular matrix, there is no inverse
+	if(det == 0)
+		return Matrix4x4::Identity;
+
+	float invDet = 1.0f / det;
+
+	out._11 = ( _22*c5 - _23*c4 + _24*c3) * invDet;
+	out._12 = (-_12*c5 + _13*c4 - _14*c3) * invDet;
+	out._13 = ( _42*s5 - _43*s4 + _44*s3) * invDet;
+	out._14 = (-_32*s5 + _33*s4 - _34*s3) * invDet;
+
+	out._21 = (-_21*c5 + _23*c2 - _24*c1) * invDet;
+	out._22 = ( _11*c5 - _13*c2 + _14*c1) * invDet;
+	out._23 = (-_41*s5 + _43*s2 - _44*s1) * invDet;
+	out._24 = ( _31*s5 - _33*s2 + _34*s1) * invDet;
+
+	out._31 = ( _21*c4 - _22*c2 + _24*c0) * invDet;
+	out._32 = (-_11*c4 + _12*c2 - _14*c0) * invDet;
+	out._33 = ( _41*s4 - _42*s2 + _44*s0) * invDet;
+	out._34 = (-_31*s4 + _32*s2 - _34*s0) * invDet;
+
+	out._41 = (-_21*c3 + _22*c1 - _23*c0) * invDet;
+	out._42 = ( _11*c3 - _12*c1 + _13*c0) * invDet;
+	out._43 = (-_41*s3 + _42*s1 - _43*s0) * invDet;
+	out._44 = ( _31*s3 - _32*s1 + _33*s0) * invDet;
+#endif
+
+	return out;
 }
 
 //----------
@@ -662,12 +774,6 @@ const Quaternion Quaternion::Identity = Quaternion(0,0,0,1);
 Quaternion::Quaternion(void): x(0), y(0), z(0), w(0)
 {}
 
-Quaternion::Quaternion(const Quaternion& quat): x(quat.x),
-												y(quat.y),
-												z(quat.z),
-												w(quat.w)
-{}
-
 Quaternion::Quaternion(float _x, float _y, float _z, float _w): x(_x), y(_y), z(_z), w(_w)
 {}
 
@@ -684,15 +790,13 @@ Quaternion::Quaternion(const NxQuat& quat): x(quat.x),
 {}
 
 Quaternion::Quaternion(const Vector3& axis, float angle)
-{/*
+{
+	auto normAxis = Vector3::Normalize(axis);
 	float s = sinf(angle * .5f);
-	x = s * axis.x;
-	y = s * axis.y;
-	z = s * axis.z;
-	w = cosf(angle * .5f);*/
-	D3DXQUATERNION quat;
-	D3DXQuaternionRotationAxis(&quat, &static_cast<D3DXVECTOR3>(axis), angle);
-	*this = static_cast<Quaternion>(quat);
+	x = s * normAxis.x;
+	y = s * normAxis.y;
+	z = s * normAxis.z;
+	w = cosf(angle * .5f);
 }
 
 Quaternion Quaternion::operator+(const Quaternion& quat) const
@@ -725,21 +829,29 @@ Quaternion& Quaternion::operator-=(const Quaternion& quat)
 	return *this;
 }
 		
+//Follows the D3DX convention: (q1 * q2) represents the rotation q1 followed by q2
 Quaternion Quaternion::operator*(const Quaternion& quat) const
 {
 	Quaternion out;
-	/*
+
+#ifdef TT_SIMD_SSE
+	__m128 lhs = _mm_loadu_ps(&x);
+	__m128 rhs = _mm_loadu_ps(&quat.x);
+
+	__m128 res = _mm_mul_ps(TT_SPLAT(rhs, 3), lhs);
+	res = SimdMulAdd(TT_SPLAT(rhs, 0), _mm_mul_ps(TT_SWIZZLE(lhs, 3,2,1,0), _mm_setr_ps( 1,-1, 1,-1)), res);
+	res = SimdMulAdd(TT_SPLAT(rhs, 1), _mm_mul_ps(TT_SWIZZLE(lhs, 2,3,0,1), _mm_setr_ps( 1, 1,-1,-1)), res);
+	res = SimdMulAdd(TT_SPLAT(rhs, 2), _mm_mul_ps(TT_SWIZZLE(lhs, 1,0,3,2), _mm_setr_ps(-1, 1, 1,-1)), res);
+	_mm_storeu_ps(&out.x, res);
+#else
 	//Quaternion multiplication: http://www.euclideanspace.com/maths/algebra/realNormedAlgebra/quaternions/code/index.htm#mul
-	out.x =  x * quat.w + y * quat.z - z * quat.y + w * quat.x;
-	out.y = -x * quat.z + y * quat.w + z * quat.x + w * quat.y;
-	out.z =  x * quat.y - y * quat.x + z * quat.w + w * quat.z;
-	out.w = -x * quat.x - y * quat.y - z * quat.z + w * quat.w;
-	return out;*/
-	D3DXQUATERNION outQuat;
-	D3DXQuaternionMultiply(&outQuat, &static_cast<D3DXQUATERNION>(*this), &static_cast<D3DXQUATERNION>(quat));
-
-	return static_cast<Quaternion>(outQuat);
-	
+	out.x =  quat.x * w + quat.y * z - quat.z * y + quat.w * x;
+	out.y = -quat.x * z + quat.y * w + quat.z * x + quat.w * y;
+	out.z =  quat.x * y - quat.y * x + quat.z * w + quat.w * z;
+	out.w = -quat.x * x - quat.y * y - quat.z * z + quat.w * w;
+#endif
+
+	return out;
 }
 
 Quaternion& Quaternion::operator*=(const Quaternion& quat)
@@ -779,9 +891,14 @@ bool Quaternion::operator!=(const Quaternion& quat)
 
 Quaternion Quaternion::FromEuler(const Vector3& eulerAngles)
 {
-	D3DXQUATERNION quat;
-	D3DXQuaternionRotationYawPitchRoll(&quat, eulerAngles.x, eulerAngles.y, eulerAngles.z);
-	return Quaternion(quat);
+	float sy = sinf(eulerAngles.x * .5f), cy = cosf(eulerAngles.x * .5f);
+	float sp = sinf(eulerAngles.y * .5f), cp = cosf(eulerAngles.y * .5f);
+	float sr = sinf(eulerAngles.z * .5f), cr = cosf(eulerAngles.z * .5f);
+
+	return Quaternion(sy*cp*sr + cy*sp*cr,
+					  sy*cp*cr - cy*sp*sr,
+					  cy*cp*sr - sy*sp*cr,
+					  cy*cp*cr + sy*sp*sr);
 }
 
 Quaternion Quaternion::FromEuler(float yaw, float pitch, float roll)
@@ -790,25 +907,47 @@ Quaternion Quaternion::FromEuler(float yaw, float pitch, float roll)
 }
 
 Quaternion Quaternion::FromRotationMatrix(Matrix4x4 rotMat)
-{ /*
+{
 	Quaternion out;
-	out.w = sqrtf( max(.0f, 1 + rotMat._11 + rotMat._22 + rotMat._33) ) * .5f;
-	out.x = sqrtf( max(.0f, 1 + rotMat._11 - rotMat._22 - rotMat._33) ) * .5f;
-	out.y = sqrtf( max(.0f, 1 - rotMat._11 + rotMat._22 - rotMat._33) ) * .5f;
-	out.z = sqrtf( max(.0f, 1 - rotMat._11 - rotMat._22 + rotMat._33) ) * .5f;
-	out.x = static_cast<float>( _copysign(static_cast<double>(out.x), static_cast<double>(rotMat._23 - rotMat._32) ) );
-	out.y = static_cast<float>( _copysign(static_cast<double>(out.y), static_cast<double>(rotMat._31 - rotMat._13) ) );
-	out.z = static_cast<float>( _copysign(static_cast<double>(out.z), static_cast<double>(rotMat._12 - rotMat._21) ) );
-	return out;*/
-	D3DXQUATERNION quat;
-	D3DXQuaternionRotationMatrix(&quat, &static_cast<D3DXMATRIX>(rotMat) );
-	return static_cast<Quaternion>(quat);
-} 
+	float trace = rotMat._11 + rotMat._22 + rotMat._33;
+
+	//Pick the largest of w, x, y and z to divide by, for numerical stability
+	if(trace > 0){
+		float s = 2 * sqrtf(trace + 1);
+		out.x = (rotMat._23 - rotMat._32) / s;
+		out.y = (rotMat._31 - rotMat._13) / s;
+		out.z = (rotMat._12 - rotMat._21) / s;
+		out.w = .25f * s;
+	}
+	else if(rotMat._11 >= rotMat._22 && rotMat._11 >= rotMat._33){
+		float s = 2 * sqrtf(1 + rotMat._11 - rotMat._22 - rotMat._33);
+		out.x = .25f * s;
+		out.y = (rotMat._12 + rotMat._21) / s;
+		out.z = (rotMat._13 + rotMat._31) / s;
+		out.w = (rotMat._23 - rotMat._32) / s;
+	}
+	else if(rotMat._22 >= rotMat._33){
+		float s = 2 * sqrtf(1 + rotMat._22 - rotMat._11 - rotMat._33);
+		out.x = (rotMat._12 + rotMat._21) / s;
+		out.y = .25f * s;
+		out.z = (rotMat._23 + rotMat._32) / s;
+		out.w = (rotMat._31 - rotMat._13) / s;
+	}
+	else{
+		float s = 2 * sqrtf(1 + rotMat._33 - rotMat._11 - rotMat._22);
+		out.x = (rotMat._13 + rotMat._31) / s;
+		out.y = (rotMat._23 + rotMat._32) / s;
+		out.z = .25f * s;
+		out.w = (rotMat._12 - rotMat._21) / s;
+	}
+
+	return out;
+}
 
 Quaternion Quaternion::Inverse(const Quaternion& quat)
 {
-	//Conjugate / norm
-	//norm = sqrt(x+y+z+w) => norm = x+y+z+w
+	//Conjugate / norm²
+	//norm = sqrt(x²+y²+z²+w²) => norm² = x²+y²+z²+w²
 	return Conjugate(quat) / (quat.x * quat.x + quat.y * quat.y + quat.z * quat.z + quat.w * quat.w);
 }
 
@@ -845,18 +984,14 @@ Vector3 Quaternion::GetYawPitchRoll(void) const
 }
 
 Quaternion& Quaternion::Normalize(void)
-{/*
-	float invMag = 1.0f/sqrtf(x*x + y*y + z*z + w*w);
-	x *= invMag;
-	y *= invMag;
-	z *= invMag;
-	w *= invMag;
-	return *this;
-	*/
-	D3DXQUATERNION quat;
-	D3DXQuaternionNormalize(&quat, &static_cast<D3DXQUATERNION>(*this));
-	*this = static_cast<Quaternion>(quat);
-	return *this;
+{
+	float mag = sqrtf(x*x + y*y + z*z + w*w);
+
+	//Zero quaternions normalize to the zero quaternion
+	if(mag == 0)
+		return *this = Quaternion(0,0,0,0);
+
+	return *this *= 1.0f / mag;
 }
 
 //------------
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -40,6 +40,7 @@ namespace tt
 	struct Vector4;
 	struct Matrix3x3;
 	struct Matrix4x4;
+	struct Transform3x4;
 	struct Quaternion;
 	struct ViewportInfo;
 	struct GameContext;
@@ -125,6 +126,14 @@ namespace tt
 		Vector3 TransformVector(const Matrix4x4& matTransform) const;
 		Vector3 TransformPoint(const Matrix4x4& matTransform) const;
 		Vector3 TransformPoint(const Quaternion& rotQuat) const;
+
+		//Batched transforms over contiguous streams, pIn and pOut may point to the same array
+		static void TransformPoints(const Matrix4x4& matTransform, const Vector3* pIn, Vector3* pOut, unsigned int count);
+		static void TransformVectors(const Matrix4x4& matTransform, const Vector3* pIn, Vector3* pOut, unsigned int count);
+		static void TransformPointsSoA(const Matrix4x4& matTransform, const float* pInX, const float* pInY, const float* pInZ
+									  ,float* pOutX, float* pOutY, float* pOutZ, unsigned int count);
+		static void TransformVectorsSoA(const Matrix4x4& matTransform, const float* pInX, const float* pInY, const float* pInZ
+									   ,float* pOutX, float* pOutY, float* pOutZ, unsigned int count);
 		
 		Vector3 Cross(const Vector3& v) const;
 		float Dot(const Vector3& v) const;
@@ -198,13 +207,41 @@ namespace tt
 
 		static const Matrix4x4 Identity;
 	};
+
+	//Affine transform, stored as the first 3 columns of a row-vector Matrix4x4 (the last column is implicitly 0,0,0,1)
+	struct Transform3x4
+	{
+		float	_11, _12, _13,
+				_21, _22, _23,
+				_31, _32, _33,
+				_41, _42, _43;
+
+		Transform3x4(void);
+		explicit Transform3x4(const Matrix4x4& mat);
+		Transform3x4(float __11, float __12, float __13
+					,float __21, float __22, float __23
+					,float __31, float __32, float __33
+					,float __41, float __42, float __43);
+		Transform3x4 operator*(const Transform3x4& transform) const;
+		Transform3x4& operator*=(const Transform3x4& transform);
+
+		Matrix4x4 ToMatrix4x4(void) const;
+
+		Vector3 TransformVector(const Vector3& vec) const;
+		Vector3 TransformPoint(const Vector3& point) const;
+		Transform3x4 Inverse(void) const;
+
+		//Equal to Matrix4x4::Scale(scale) * Matrix4x4::Rotation(rotation) * Matrix4x4::Translation(position)
+		static Transform3x4 FromTRS(const Vector3& position, const Quaternion& rotation, const Vector3& scale);
+
+		static const Transform3x4 Identity;
+	};
 	
 	struct Quaternion
 	{
 		float x,y,z,w;
 
 		Quaternion(void);
-		Quaternion(const Quaternion& quat);
 		Quaternion(float _x, float _y, float _z, float _w);
 		Quaternion(const Vector3& axis, float angle);
 		explicit Quaternion(const D3DXQUATERNION& quat);
@@ -289,9 +326,6 @@ namespace tt
 	
 		DualQuaternion(void);
 		DualQuaternion(const Quaternion& rotation, const Vector3& translation);// convert unit quaternion and translation to unit dual quaternion
-		DualQuaternion(const DualQuaternion& src);
-
-		DualQuaternion& operator=(const DualQuaternion& src);
 		
 		DualQuaternion operator+(const DualQuaternion& dualQuat) const;
 		DualQuaternion& operator+=(const DualQuaternion& dualQuat);
@@ -0,0 +1,115 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+//    __  __      ______            _          
+//   / /_/ /__ _ / ____/___  ____ _(_)___  ___ 
+//  / __/ __(_|_) __/ / __ \/ __ `/ / __ \/ _ \
+// / /_/ /__ _ / /___/ / / / /_/ / / / / /  __/
+// \__/\__(_|_)_____/_/ /_/\__, /_/_/ /_/\___/ 
+//                        /____/               
+//
+// SimdUtil.h : file containing includes and various utilities regarding SSE/AVX intrinsics
+// Copyright © 2013 Tom Tondeur
+//
+
+#pragma once
+
+//*****************************************************************************
+// Instruction set selection
+// TT_SIMD_SSE is defined when SSE is available (always the case on x64),
+// TT_SIMD_AVX when compiling with /arch:AVX. Define TT_NO_SIMD to force the scalar fallback.
+//*****************************************************************************
+#if !defined(TT_NO_SIMD) && (defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__))
+	#define TT_SIMD_SSE
+	#include <xmmintrin.h>
+#endif
+
+#if defined(TT_SIMD_SSE) && defined(__AVX__)
+	#define TT_SIMD_AVX
+	#include <immintrin.h>
+#endif
+
+#ifdef TT_SIMD_SSE
+
+//*****************************************************************************
+// Shuffle helpers
+//*****************************************************************************
+
+//Picks (a[x], a[y], b[z], b[w]), with indices in memory order
+#define TT_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE(w, z, y, x))
+//Picks (v[x], v[y], v[z], v[w]), with indices in memory order
+#define TT_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(w, z, y, x))
+//Broadcasts v[i] to all 4 lanes
+#define TT_SPLAT(v, i) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(i, i, i, i))
+
+//Returns the sum of all 4 lanes, broadcast to all lanes
+inline __m128 SimdHorizontalAdd(__m128 v)
+{
+	__m128 sum = _mm_add_ps(v, TT_SWIZZLE(v, 1, 0, 3, 2));
+	return _mm_add_ps(sum, TT_SWIZZLE(sum, 2, 3, 0, 1));
+}
+
+//Multiply-add, out = a*b + c
+inline __m128 SimdMulAdd(__m128 a, __m128 b, __m128 c)
+{
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+#ifdef TT_SIMD_AVX
+//8-wide SimdMulAdd
+inline __m256 SimdMulAdd8(__m256 a, __m256 b, __m256 c)
+{
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+}
+#endif
+
+//*****************************************************************************
+// AoS <-> SoA
+//*****************************************************************************
+
+//Loads 4 consecutive float3s (12 floats) and transposes them to x, y and z registers
+inline void SimdLoadAoS3(const float* pSrc, __m128& x, __m128& y, __m128& z)
+{
+	__m128 a = _mm_loadu_ps(pSrc);		// x0 y0 z0 x1
+	__m128 b = _mm_loadu_ps(pSrc + 4);	// y1 z1 x2 y2
+	__m128 c = _mm_loadu_ps(pSrc + 8);	// z2 x3 y3 z3
+
+	__m128 xy23 = TT_SHUFFLE(b, c, 2, 3, 1, 2);	// x2 y2 x3 y3
+	__m128 yz01 = TT_SHUFFLE(a, b, 1, 2, 0, 1);	// y0 z0 y1 z1
+	__m128 z01  = TT_SHUFFLE(a, b, 2, 2, 1, 1);	// z0 z0 z1 z1
+
+	x = TT_SHUFFLE(a, xy23, 0, 3, 0, 2);
+	y = TT_SHUFFLE(yz01, xy23, 0, 2, 1, 3);
+	z = TT_SHUFFLE(z01, c, 0, 2, 0, 3);
+}
+
+//Inverse of SimdLoadAoS3
+inline void SimdStoreAoS3(float* pDest, __m128 x, __m128 y, __m128 z)
+{
+	__m128 xy01 = TT_SHUFFLE(x, y, 0, 1, 0, 1);	// x0 x1 y0 y1
+	__m128 zx01 = TT_SHUFFLE(z, x, 0, 0, 1, 1);	// z0 z0 x1 x1
+	__m128 yz11 = TT_SHUFFLE(y, z, 1, 1, 1, 1);	// y1 y1 z1 z1
+	__m128 xy22 = TT_SHUFFLE(x, y, 2, 2, 2, 2);	// x2 x2 y2 y2
+	__m128 zx23 = TT_SHUFFLE(z, x, 2, 2, 3, 3);	// z2 z2 x3 x3
+	__m128 yz33 = TT_SHUFFLE(y, z, 3, 3, 3, 3);	// y3 y3 z3 z3
+
+	_mm_storeu_ps(pDest,	 TT_SHUFFLE(xy01, zx01, 0, 2, 0, 2));
+	_mm_storeu_ps(pDest + 4, TT_SHUFFLE(yz11, xy22, 0, 2, 0, 2));
+	_mm_storeu_ps(pDest + 8, TT_SHUFFLE(zx23, yz33, 0, 2, 0, 2));
+}
+
+#endif
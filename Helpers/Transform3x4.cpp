@@ -0,0 +1,127 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "Namespace.h"
+
+using namespace tt;
+
+//------------
+//Transform3x4
+//------------
+const Transform3x4 Transform3x4::Identity = Transform3x4(1,0,0,
+														 0,1,0,
+														 0,0,1,
+														 0,0,0);
+
+Transform3x4::Transform3x4(void)
+{
+	*this = Transform3x4::Identity;
+}
+
+Transform3x4::Transform3x4(const Matrix4x4& mat)
+{
+	_11 = mat._11; _12 = mat._12; _13 = mat._13;
+	_21 = mat._21; _22 = mat._22; _23 = mat._23;
+	_31 = mat._31; _32 = mat._32; _33 = mat._33;
+	_41 = mat._41; _42 = mat._42; _43 = mat._43;
+}
+
+Transform3x4::Transform3x4(float __11, float __12, float __13
+						  ,float __21, float __22, float __23
+						  ,float __31, float __32, float __33
+						  ,float __41, float __42, float __43)
+{
+	_11 = __11; _12 = __12; _13 = __13;
+	_21 = __21; _22 = __22; _23 = __23;
+	_31 = __31; _32 = __32; _33 = __33;
+	_41 = __41; _42 = __42; _43 = __43;
+}
+
+Transform3x4 Transform3x4::operator*(const Transform3x4& t) const
+{
+	//Only the 3x3 part is multiplied, the translation row is transformed by t and offset: 36 multiply-adds instead of 64
+	return Transform3x4(_11*t._11 + _12*t._21 + _13*t._31,	_11*t._12 + _12*t._22 + _13*t._32,	_11*t._13 + _12*t._23 + _13*t._33,
+						_21*t._11 + _22*t._21 + _23*t._31,	_21*t._12 + _22*t._22 + _23*t._32,	_21*t._13 + _22*t._23 + _23*t._33,
+						_31*t._11 + _32*t._21 + _33*t._31,	_31*t._12 + _32*t._22 + _33*t._32,	_31*t._13 + _32*t._23 + _33*t._33,
+						_41*t._11 + _42*t._21 + _43*t._31 + t._41,	_41*t._12 + _42*t._22 + _43*t._32 + t._42,	_41*t._13 + _42*t._23 + _43*t._33 + t._43);
+}
+
+Transform3x4& Transform3x4::operator*=(const Transform3x4& t)
+{
+	*this = *this * t;
+	return *this;
+}
+
+Matrix4x4 Transform3x4::ToMatrix4x4(void) const
+{
+	return Matrix4x4(_11, _12, _13, 0,
+					 _21, _22, _23, 0,
+					 _31, _32, _33, 0,
+					 _41, _42, _43, 1);
+}
+
+Vector3 Transform3x4::TransformVector(const Vector3& v) const
+{
+	return Vector3(v.x*_11 + v.y*_21 + v.z*_31,
+				   v.x*_12 + v.y*_22 + v.z*_32,
+				   v.x*_13 + v.y*_23 + v.z*_33);
+}
+
+Vector3 Transform3x4::TransformPoint(const Vector3& p) const
+{
+	//No homogeneous divide, w is always 1 for affine transforms
+	return Vector3(p.x*_11 + p.y*_21 + p.z*_31 + _41,
+				   p.x*_12 + p.y*_22 + p.z*_32 + _42,
+				   p.x*_13 + p.y*_23 + p.z*_33 + _43);
+}
+
+Transform3x4 Transform3x4::Inverse(void) const
+{
+	//Inverse of the 3x3 part through its adjugate, the translation becomes -t * inv(3x3)
+	float c11 = _22*_33 - _23*_32;
+	float c12 = _23*_31 - _21*_33;
+	float c13 = _21*_32 - _22*_31;
+
+	float det = _11*c11 + _12*c12 + _13*c13;
+	if(det == 0)
+		return Transform3x4::Identity; //Singular, same behaviour as Matrix4x4::Inverse
+
+	float invDet = 1.0f / det;
+
+	Transform3x4 out(c11 * invDet,	(_13*_32 - _12*_33) * invDet,	(_12*_23 - _13*_22) * invDet,
+					 c12 * invDet,	(_11*_33 - _13*_31) * invDet,	(_13*_21 - _11*_23) * invDet,
+					 c13 * invDet,	(_12*_31 - _11*_32) * invDet,	(_11*_22 - _12*_21) * invDet,
+					 0, 0, 0);
+
+	out._41 = -(_41*out._11 + _42*out._21 + _43*out._31);
+	out._42 = -(_41*out._12 + _42*out._22 + _43*out._32);
+	out._43 = -(_41*out._13 + _42*out._23 + _43*out._33);
+	return out;
+}
+
+Transform3x4 Transform3x4::FromTRS(const Vector3& position, const Quaternion& q, const Vector3& scale)
+{
+	//Rows of Matrix4x4::Rotation(q), scaled per axis
+	float xx = q.x*q.x, yy = q.y*q.y, zz = q.z*q.z;
+	float xy = q.x*q.y, xz = q.x*q.z, yz = q.y*q.z;
+	float wx = q.w*q.x, wy = q.w*q.y, wz = q.w*q.z;
+
+	return Transform3x4(scale.x * (1 - 2*(yy + zz)),	scale.x * 2*(xy + wz),			scale.x * 2*(xz - wy),
+						scale.y * 2*(xy - wz),			scale.y * (1 - 2*(xx + zz)),	scale.y * 2*(yz + wx),
+						scale.z * 2*(xz + wy),			scale.z * 2*(yz - wx),			scale.z * (1 - 2*(xx + yy)),
+						position.x,						position.y,						position.z);
+}
@@ -0,0 +1,138 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "WorkerPool.h"
+
+std::unique_ptr<WorkerPool> WorkerPool::s_pInstance = nullptr;
+
+WorkerPool::WorkerPool(unsigned int nrOfWorkers):m_JobGeneration(0)
+												,m_bTerminate(false)
+{
+	for(unsigned int i=0; i < nrOfWorkers; ++i)
+		m_Workers.push_back(std::thread(&WorkerPool::WorkerProc, this));
+}
+
+WorkerPool::~WorkerPool(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bTerminate = true;
+	}
+	m_WorkAvailable.notify_all();
+
+	for(auto& worker : m_Workers)
+		worker.join();
+}
+
+WorkerPool* WorkerPool::GetInstance(void)
+{
+	if(s_pInstance.get() == nullptr){
+		unsigned int nrOfThreads = std::thread::hardware_concurrency();
+		s_pInstance = std::unique_ptr<WorkerPool>(new WorkerPool(nrOfThreads > 1 ? nrOfThreads-1 : 0));
+	}
+	return s_pInstance.get();
+}
+
+//Methods
+
+void WorkerPool::ParallelFor(unsigned int count, unsigned int grainSize, const RangeFunction& func)
+{
+	if(count == 0)
+		return;
+	if(grainSize == 0)
+		grainSize = 1;
+
+	//Nothing to split, or no way to dispatch without waiting on ourselves
+	std::unique_lock<std::mutex> dispatchLock(m_DispatchMutex, std::try_to_lock);
+	if(m_Workers.empty() || count <= grainSize || !dispatchLock.owns_lock() || IsWorkerThread()){
+		func(0, count);
+		return;
+	}
+
+	//Every job gets its own counters, so a worker waking up late can't pick up chunks of the next one
+	auto pJob = std::make_shared<Job>();
+	pJob->pFunc = &func;
+	pJob->Count = count;
+	pJob->GrainSize = grainSize;
+	pJob->NrOfChunks = (count + grainSize - 1) / grainSize;
+	pJob->NextChunk = 0;
+	pJob->CompletedChunks = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_pJob = pJob;
+		++m_JobGeneration;
+	}
+	m_WorkAvailable.notify_all();
+
+	RunChunks(*pJob);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_WorkDone.wait(lock, [&](){ return pJob->CompletedChunks == pJob->NrOfChunks; });
+	m_pJob.reset();
+}
+
+unsigned int WorkerPool::GetNrOfWorkers(void) const
+{
+	return m_Workers.size();
+}
+
+void WorkerPool::WorkerProc(void)
+{
+	unsigned int lastGeneration = 0;
+
+	for(;;){
+		std::shared_ptr<Job> pJob;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkAvailable.wait(lock, [&](){ return m_bTerminate || m_JobGeneration != lastGeneration; });
+			
+			if(m_bTerminate)
+				return;
+
+			lastGeneration = m_JobGeneration;
+			pJob = m_pJob;
+		}
+
+		if(pJob)
+			RunChunks(*pJob);
+	}
+}
+
+void WorkerPool::RunChunks(Job& job)
+{
+	for(unsigned int chunk = job.NextChunk++; chunk < job.NrOfChunks; chunk = job.NextChunk++){
+		unsigned int begin = chunk * job.GrainSize;
+		unsigned int end = begin + job.GrainSize < job.Count ? begin + job.GrainSize : job.Count;
+		(*job.pFunc)(begin, end);
+
+		if(++job.CompletedChunks == job.NrOfChunks){
+			//Lock, so the notification can't slip in between the dispatcher's check and its wait
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_WorkDone.notify_all();
+		}
+	}
+}
+
+bool WorkerPool::IsWorkerThread(void) const
+{
+	auto id = std::this_thread::get_id();
+	for(auto& worker : m_Workers)
+		if(worker.get_id() == id)
+			return true;
+	return false;
+}
@@ -0,0 +1,90 @@
+// Copyright © 2013 Tom Tondeur
+// 
+// This file is part of tt::Engine.
+// 
+// tt::Engine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// tt::Engine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with tt::Engine.  If not, see <http://www.gnu.org/licenses/>.
+
+//    __  __      ______            _          
+//   / /_/ /__ _ / ____/___  ____ _(_)___  ___ 
+//  / __/ __(_|_) __/ / __ \/ __ `/ / __ \/ _ \
+// / /_/ /__ _ / /___/ / / / /_/ / / / / /  __/
+// \__/\__(_|_)_____/_/ /_/\__, /_/_/ /_/\___/ 
+//                        /____/               
+//
+// WorkerPool.h : file containing a pool of threads for data parallel work
+// Copyright © 2013 Tom Tondeur
+//
+
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//Pool of worker threads executing data parallel loops.
+//The calling thread takes part in the work, so a pool with 0 workers simply runs loops serially.
+class WorkerPool final
+{
+public:
+	//Called with a [begin, end) subrange of the loop
+	typedef std::function<void(unsigned int begin, unsigned int end)> RangeFunction;
+
+	//Default constructor & destructor
+	explicit WorkerPool(unsigned int nrOfWorkers);
+	~WorkerPool(void);
+
+	//Shared pool with one thread per hardware thread, including the caller
+	static WorkerPool* GetInstance(void);
+
+	//Methods
+	//Splits [0, count) in chunks of grainSize and runs func on them, returns when every chunk is done.
+	//Calls made from inside a job, or while another thread is dispatching, run serially on the calling thread.
+	void ParallelFor(unsigned int count, unsigned int grainSize, const RangeFunction& func);
+	
+	unsigned int GetNrOfWorkers(void) const;
+
+private:
+	struct Job
+	{
+		const RangeFunction* pFunc;
+		unsigned int Count, GrainSize, NrOfChunks;
+		std::atomic<unsigned int> NextChunk, CompletedChunks;
+	};
+
+	//Datamembers
+	std::vector<std::thread> m_Workers;
+	
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable, m_WorkDone;
+	std::shared_ptr<Job> m_pJob;
+	unsigned int m_JobGeneration;
+	bool m_bTerminate;
+
+	std::mutex m_DispatchMutex;
+
+	static std::unique_ptr<WorkerPool> s_pInstance;
+
+	//Internal methods
+	void WorkerProc(void);
+	void RunChunks(Job& job);
+	bool IsWorkerThread(void) const;
+
+	//Disabling default copy constructor & assignment operator
+	WorkerPool(const WorkerPool& src);// = delete;
+	WorkerPool& operator=(const WorkerPool& src);// = delete;
+};
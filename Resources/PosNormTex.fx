@@ -80,7 +80,7 @@ float4 PSNoNormal(VS_OUTPUT input):SV_TARGET
 	return color;
 }
 
-technique10 TechSolid
+technique10 TechSolid < bool QuantizeVertices = true; >
 {
 	pass one
 	{
@@ -92,7 +92,7 @@ technique10 TechSolid
 	}
 }
 
-technique10 TechWireframe
+technique10 TechWireframe < bool QuantizeVertices = true; >
 {
 	pass one
 	{
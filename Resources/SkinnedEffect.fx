@@ -44,7 +44,7 @@ struct VS_INPUT
 	float3 Position : POSITION;
 	float3 Normal : NORMAL;
 	float2 TexCoord : TEXCOORD0;
-	float4 BlendIndices : BLENDINDICES;
+	uint4 BlendIndices : BLENDINDICES; //Integers, so quantized vertices can store them in 8 bits
 	float4 BlendWeight : BLENDWEIGHTS;
 };
 
@@ -133,7 +133,7 @@ float4 PS(VS_OUTPUT input):SV_TARGET
 	return float4(diffuse,1);
 }
 
-technique10 SkinnedAnimationTechnique
+technique10 SkinnedAnimationTechnique < bool QuantizeVertices = true; >
 {
 	pass one
 	{
@@ -169,7 +169,7 @@ PS_OUTPUT PS_Deferred(VS_OUTPUT input)
 	return mrtOut;
 }
 
-technique10 TechDeferred
+technique10 TechDeferred < bool QuantizeVertices = true; >
 {
 	pass one
 	{
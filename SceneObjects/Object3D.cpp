@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -31,6 +31,7 @@ Object3D::Object3D(const std::tstring& meshFile)
 	SetComponent<TransformComponent>(pTransform);
 
 	SetComponent<ModelComponent>(pModel);
+	SetComponent<PickComponent>(new PickComponent(this, pModel) );
 	/*
 	SetComponent<RigidBodyComponent>(pRigidbody);
 	SetComponent<MeshColliderComponent>(new MeshColliderComponent(pRigidbody, _T("Resources/box.convexphysx"), MeshType::Convex));
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -24,8 +24,9 @@
 #include "../Components/Physics/RigidBodyComponent.h"
 #include "../Components/Physics/Colliders/MeshColliderComponent.h"
 #include "../Components/ScriptComponent.h"
+#include "../Components/PickComponent.h"
 
-class Object3D : public GenericSceneObject<TransformComponent, ModelComponent, RigidBodyComponent, MeshColliderComponent, ScriptComponent>
+class Object3D : public GenericSceneObject<TransformComponent, ModelComponent, RigidBodyComponent, MeshColliderComponent, ScriptComponent, PickComponent>
 {
 public:
 	//Default constructor & destructor
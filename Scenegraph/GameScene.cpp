@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -17,17 +17,25 @@
 
 #include "GameScene.h"
 #include "../Components/CameraComponent.h"
+#include "../Components/ModelComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/ParticleEmitterComponent.h"
 #include "../Graphics/PostProcessingEffect.h"
 #include "../Graphics/GraphicsDevice.h"
 #include "../Graphics/RenderTarget2D.h"
 #include "../Graphics/SpriteBatch.h"
+#include "../Graphics/AnimationSystem.h"
+#include "../Graphics/Model3D.h"
+#include "../Graphics/RayPacket.h"
 #include "../Services/ServiceLocator.h"
 
 GameScene* GameScene::s_pActiveScene = nullptr;
 
-GameScene::GameScene():m_pPhysicsScene(nullptr), m_pActiveCamera(nullptr){}
+GameScene::GameScene():m_pPhysicsScene(nullptr), m_pActiveCamera(nullptr)
+{
+	ZeroMemory(&m_MeshLODStats, sizeof(MeshLODStats) );
+}
+
 GameScene::~GameScene()
 {
 	for(auto pObj : m_Objects)
@@ -58,14 +66,24 @@ void GameScene::InitializeScene(void)
 
 void GameScene::UpdateScene(const tt::GameContext& context)
 {
+	m_Renderables.clear();
+
 	for(auto pObj : m_Objects){
 		pObj->Update(context);
 		pObj->UpdateObject(context);
 	}
+
+	//Failures are logged here rather than by the animation tasks, the log isn't thread-safe
+	unsigned int nrOfFailures = AnimationSystem::Evaluate(context.GameTimer.GetTotalSeconds(), context.GameTimer.GetElapsedSeconds() );
+	if(nrOfFailures > 0)
+		MyServiceLocator::GetInstance()->GetService<DebugService>()->Log(_T("Failed to find next animation tick."), LogLevel::Error);
 }
 
 void GameScene::DrawScene(const tt::GameContext& context)
 {
+	ZeroMemory(&m_MeshLODStats, sizeof(MeshLODStats) );
+	CullRenderables();
+
 	for(auto pObj : m_Objects){
 		pObj->Draw(context);
 		pObj->DrawObject(context);
@@ -119,6 +137,100 @@ const CameraComponent* GameScene::GetActiveCamera(void) const
 	return m_pActiveCamera;
 }
 
+const MeshLODStats& GameScene::GetMeshLODStats(void) const
+{
+	return m_MeshLODStats;
+}
+
+SceneObject* GameScene::Pick(const Ray& ray, float maxDistance, RayHit* pHit) const
+{
+	SceneObject* pClosest = nullptr;
+	RayHit hit;
+
+	auto raycast = [&](SceneObject* pObj){
+		if(pObj->RaycastObject(ray, maxDistance, hit) ){
+			maxDistance = hit.Distance;
+			pClosest = pObj;
+			if(pHit)
+				*pHit = hit;
+		}
+	};
+	
+	//Objects with bounds are only raycast if the ray passes through them, nearest first so the rest can stop at the closest hit
+	vector<SceneObject*> boundedObjects;
+	vector<AABBox> bounds;
+	for(auto pObj : m_Objects){
+		AABBox box;
+		if(!pObj->GetRaycastBounds(box) )
+			raycast(pObj);
+		else if(box.Bounds[0].x <= box.Bounds[1].x){
+			boundedObjects.push_back(pObj);
+			bounds.push_back(box);
+		}
+	}
+
+	AABBoxStreams boxStreams;
+	boxStreams.Resize(bounds.size() );
+	for(unsigned int i = 0; i < bounds.size(); ++i)
+		boxStreams.Set(i, bounds[i]);
+
+	vector<BoxHit> boxHits;
+	IntersectBoxes(ray, 0, maxDistance, boxStreams, boxHits);
+	sort(boxHits.begin(), boxHits.end(), [](const BoxHit& a, const BoxHit& b){return a.Distance < b.Distance;});
+
+	for(auto& boxHit : boxHits){
+		if(boxHit.Distance >= maxDistance)
+			break;
+		raycast(boundedObjects[boxHit.Box]);
+	}
+
+	return pClosest;
+}
+
+SceneObject* GameScene::Pick(const POINT& screenPosition, const tt::GameContext& context, RayHit* pHit) const
+{
+	if(m_pActiveCamera == nullptr)
+		return nullptr;
+
+	return Pick(m_pActiveCamera->GetPickRay(screenPosition, context.vpInfo), FLT_MAX, pHit);
+}
+
+void GameScene::AddToMeshLODStats(const MeshLOD& fullLOD, const MeshLOD& drawnLOD, unsigned int nrOfCulledIndices)
+{
+	m_MeshLODStats.FullTriangles += fullLOD.NrOfIndices / 3;
+	m_MeshLODStats.DrawnTriangles += (drawnLOD.NrOfIndices - nrOfCulledIndices) / 3;
+	m_MeshLODStats.CulledTriangles += nrOfCulledIndices / 3;
+	m_MeshLODStats.FullVertices += fullLOD.NrOfVertices;
+	m_MeshLODStats.DrawnVertices += drawnLOD.NrOfVertices;
+}
+
+unsigned int GameScene::SubmitRenderable(const ModelComponent* pModel)
+{
+	m_Renderables.push_back(pModel);
+	return m_Renderables.size() - 1;
+}
+
+bool GameScene::IsRenderableVisible(unsigned int index, const ModelComponent* pModel) const
+{
+	if(index >= m_RenderableBounds.NrOfBoxes || index >= m_Renderables.size() || m_Renderables[index] != pModel)
+		return true;
+
+	return m_RenderableVisibility.IsSet(index);
+}
+
+void GameScene::CullRenderables(void)
+{
+	m_RenderableBounds.Resize(m_pActiveCamera ? m_Renderables.size() : 0);
+	if(m_RenderableBounds.NrOfBoxes == 0)
+		return;
+
+	for(unsigned int i = 0; i < m_Renderables.size(); ++i)
+		m_RenderableBounds.Set(i, m_Renderables[i]->GetWorldBounds() );
+
+	Frustum frustum(m_pActiveCamera->GetView() * m_pActiveCamera->GetProjection() );
+	frustum.Cull(m_RenderableBounds, m_RenderableVisibility);
+}
+
 void GameScene::AddSceneObject(SceneObject* pObject)
 {
 	m_Objects.push_back(pObject);
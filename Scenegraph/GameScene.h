@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -23,15 +23,28 @@
 //                        /____/               
 //
 // GameScene.h : file containing class that holds scene objects
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 //
 
 #pragma once
 
 #include "SceneObject.h"
+#include "../Graphics/Frustum.h"
 
 class CameraComponent;
+class ModelComponent;
 class PostProcessingEffect;
+struct MeshLOD;
+struct Ray;
+struct RayHit;
+
+//Triangles and vertices of the models drawn by a scene, at full detail and at the mesh LODs they were drawn with.
+//Triangles of culled clusters (see CullClusters) are counted in CulledTriangles instead of DrawnTriangles.
+struct MeshLODStats
+{
+	unsigned int FullTriangles, DrawnTriangles, CulledTriangles;
+	unsigned int FullVertices, DrawnVertices;
+};
 
 class GameScene
 {
@@ -53,16 +66,38 @@ public:
 	NxScene* GetPhysicsScene(void) const;
 	void SetActiveCamera(CameraComponent* pCam);
 	const CameraComponent* GetActiveCamera(void) const;
+
+	//Closest scene object hit by a world space ray within maxDistance, nullptr if there is none. Only objects with
+	//components that implement ObjectComponent::Raycast (PickComponent) take part, unlike physics picking no collider is needed.
+	SceneObject* Pick(const Ray& ray, float maxDistance = FLT_MAX, RayHit* pHit = nullptr) const;
+	//Picks along the ray through a pixel of the viewport, see CameraComponent::GetPickRay. Returns nullptr without an active camera.
+	SceneObject* Pick(const POINT& screenPosition, const tt::GameContext& context, RayHit* pHit = nullptr) const;
+
+	//Totals of the last DrawScene, every model counts once per draw call
+	const MeshLODStats& GetMeshLODStats(void) const;
+	void AddToMeshLODStats(const MeshLOD& fullLOD, const MeshLOD& drawnLOD, unsigned int nrOfCulledIndices = 0);
+
+	//Models submit themselves every update and are frustum culled all at once before the scene is drawn, against the active
+	//camera. Returns the index to check visibility with. Models that weren't submitted this frame are always visible.
+	unsigned int SubmitRenderable(const ModelComponent* pModel);
+	bool IsRenderableVisible(unsigned int index, const ModelComponent* pModel) const;
 	
 protected:
 	void AddSceneObject(SceneObject* pObject);
 	void AddPostProcessingEffect(PostProcessingEffect* pPostProEffect, unsigned int priority);
 
 private:
+	//Fills m_RenderableVisibility for the world bounds of every submitted model
+	void CullRenderables(void);
+
 	vector<SceneObject*> m_Objects;
 	std::tstring m_Name;
 	NxScene* m_pPhysicsScene;
 	CameraComponent* m_pActiveCamera;
+	MeshLODStats m_MeshLODStats;
+	vector<const ModelComponent*> m_Renderables;
+	AABBoxStreams m_RenderableBounds;
+	VisibilityBits m_RenderableVisibility;
 	static GameScene* s_pActiveScene;
 
 	std::multimap<unsigned int, PostProcessingEffect*, std::greater_equal<unsigned int> > m_PostProEffects;
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -24,6 +24,8 @@ ObjectComponent::~ObjectComponent(){}
 void ObjectComponent::Initialize(){}
 void ObjectComponent::Update(const tt::GameContext& context){}
 void ObjectComponent::Draw(const tt::GameContext& context){}
+bool ObjectComponent::Raycast(const Ray& ray, float maxDistance, RayHit& hit){return false;}
+bool ObjectComponent::GetRaycastBounds(AABBox& worldBounds) const{return true;}
 
 void ObjectComponent::SetActive(bool b)
 {
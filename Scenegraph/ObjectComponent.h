@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -23,7 +23,7 @@
 //                        /____/               
 //
 // ObjectComponent.h : file containing class that represents a component part of an entity in a GameScene
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 //
 
 #pragma once
@@ -31,6 +31,10 @@
 #include "../Helpers/stdafx.h"
 #include "../Helpers/Namespace.h"
 
+struct Ray;
+struct RayHit;
+struct AABBox;
+
 class ObjectComponent
 {
 	friend class SceneObject;
@@ -41,6 +45,11 @@ public:
 	virtual void Initialize();
 	virtual void Update(const tt::GameContext& context);
 	virtual void Draw(const tt::GameContext& context);
+	//Closest hit of a world space ray with the component within maxDistance, for GameScene::Pick. Components without geometry never hit.
+	virtual bool Raycast(const Ray& ray, float maxDistance, RayHit& hit);
+	//Grows worldBounds to contain everything Raycast can hit, so GameScene::Pick only tests the components a ray comes near.
+	//Components that override Raycast override this as well, returning false means the component must always be tested.
+	virtual bool GetRaycastBounds(AABBox& worldBounds) const;
 
 	virtual void SetActive(bool b);
 	bool IsActive(void) const;
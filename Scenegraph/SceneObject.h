@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -23,7 +23,7 @@
 //                        /____/               
 //
 // SceneObject.h : file containing class that represents an entity in a scene
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 //
 
 #pragma once
@@ -43,6 +43,10 @@ public:
 	virtual void InitializeObject(void)=0;
 	virtual void UpdateObject(const tt::GameContext& context)=0;
 	virtual void DrawObject(const tt::GameContext& context)=0;
+	//Closest hit of its components, see ObjectComponent::Raycast
+	virtual bool RaycastObject(const Ray& ray, float maxDistance, RayHit& hit)=0;
+	//Bounds of its components, see ObjectComponent::GetRaycastBounds
+	virtual bool GetRaycastBounds(AABBox& worldBounds)=0;
 
 	virtual void Initialize(void);
 	virtual void Update(const tt::GameContext& context);
@@ -92,6 +96,30 @@ public:
 										});
 	}
 
+	bool RaycastObject(const Ray& ray, float maxDistance, RayHit& hit)
+	{
+		bool bHit = false;
+		m_Components.ForEach<T...>([&](ObjectComponent* pComp)
+										{
+											if(pComp->Raycast(ray, maxDistance, hit) ){
+												maxDistance = hit.Distance;
+												bHit = true;
+											}
+										});
+		return bHit;
+	}
+
+	bool GetRaycastBounds(AABBox& worldBounds)
+	{
+		bool bBounded = true;
+		m_Components.ForEach<T...>([&](ObjectComponent* pComp)
+										{
+											if(!pComp->GetRaycastBounds(worldBounds) )
+												bBounded = false;
+										});
+		return bBounded;
+	}
+
 	template<typename ComponentType, size_t index = 0>
 	ComponentType* GetComponent(void)
 	{
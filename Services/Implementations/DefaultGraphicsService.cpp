@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -57,7 +57,13 @@ DefaultGraphicsService::~DefaultGraphicsService(void)
 
 //Methods
 
-void DefaultGraphicsService::Draw(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context)
+void DefaultGraphicsService::Draw(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context, unsigned int startIndex, unsigned int nrOfIndices)
+{
+	IndexRange range = {startIndex, nrOfIndices > 0 ? nrOfIndices : pModel->GetNrOfIndices()};
+	Draw(pModel, worldMat, pMat, context, vector<IndexRange>(1, range) );
+}
+
+void DefaultGraphicsService::Draw(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context, const vector<IndexRange>& ranges)
 {
 	auto pD3DDevice = m_pGraphicsDevice->GetDevice();
 
@@ -74,7 +80,7 @@ void DefaultGraphicsService::Draw(resource_ptr<Model3D> pModel, const tt::Matrix
 	pD3DDevice->IASetVertexBuffers(0, 1, &vertexDataInfo.pVertexBuffer , &vertexDataInfo.VertexStride, &offset);
    	
 	// Set index buffer
-	pD3DDevice->IASetIndexBuffer(pModel->GetIndexBuffer(), DXGI_FORMAT_R32_UINT, 0);
+	pD3DDevice->IASetIndexBuffer(vertexDataInfo.pIndexBuffer, vertexDataInfo.IndexFormat, 0);
 
     // Set primitive topology
     pD3DDevice->IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -87,11 +93,18 @@ void DefaultGraphicsService::Draw(resource_ptr<Model3D> pModel, const tt::Matrix
     for(UINT p = 0; p < techDesc.Passes; ++p)
     {
         tech->GetPassByIndex(p)->Apply(0);
-		pD3DDevice->DrawIndexed(pModel->GetNrOfIndices(), 0, 0); 
+		for(auto& range : ranges)
+			pD3DDevice->DrawIndexed(range.NrOfIndices, range.StartIndex, 0); 
     }
 }
 
-void DefaultGraphicsService::DrawDeferred(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context)
+void DefaultGraphicsService::DrawDeferred(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context, unsigned int startIndex, unsigned int nrOfIndices, bool bClear)
+{
+	IndexRange range = {startIndex, nrOfIndices > 0 ? nrOfIndices : pModel->GetNrOfIndices()};
+	DrawDeferred(pModel, worldMat, pMat, context, vector<IndexRange>(1, range), bClear);
+}
+
+void DefaultGraphicsService::DrawDeferred(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context, const vector<IndexRange>& ranges, bool bClear)
 {
 	auto pD3DDevice = m_pGraphicsDevice->GetDevice();
 
@@ -99,10 +112,12 @@ void DefaultGraphicsService::DrawDeferred(resource_ptr<Model3D> pModel, const tt
 	auto pOldRT = m_pGraphicsDevice->GetRenderTarget();
 
 	//Clear G-Buffers
-	float clearColor[] = {0.0f,0.0f,0.0f,0.0f};
-	pD3DDevice->ClearRenderTargetView(m_pPositionRT, clearColor);
-	pD3DDevice->ClearRenderTargetView(m_pNormalRT, clearColor);
-	pD3DDevice->ClearDepthStencilView(m_pDeferredDepthStencilView, D3D10_CLEAR_DEPTH|D3D10_CLEAR_STENCIL, 1.0f, 0);
+	if(bClear){
+		float clearColor[] = {0.0f,0.0f,0.0f,0.0f};
+		pD3DDevice->ClearRenderTargetView(m_pPositionRT, clearColor);
+		pD3DDevice->ClearRenderTargetView(m_pNormalRT, clearColor);
+		pD3DDevice->ClearDepthStencilView(m_pDeferredDepthStencilView, D3D10_CLEAR_DEPTH|D3D10_CLEAR_STENCIL, 1.0f, 0);
+	}
 
 	//Set G-buffers
 	ID3D10RenderTargetView* targets[] = {m_pPositionRT, m_pNormalRT};
@@ -125,7 +140,7 @@ void DefaultGraphicsService::DrawDeferred(resource_ptr<Model3D> pModel, const tt
 	pD3DDevice->IASetVertexBuffers(0, 1, &vertexDataInfo.pVertexBuffer , &vertexDataInfo.VertexStride, &offset);
    	
 	// Set index buffer
-	pD3DDevice->IASetIndexBuffer(pModel->GetIndexBuffer(), DXGI_FORMAT_R32_UINT, 0);
+	pD3DDevice->IASetIndexBuffer(vertexDataInfo.pIndexBuffer, vertexDataInfo.IndexFormat, 0);
 
     // Set primitive topology
     pD3DDevice->IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -138,7 +153,8 @@ void DefaultGraphicsService::DrawDeferred(resource_ptr<Model3D> pModel, const tt
     for(UINT p = 0; p < techDesc.Passes; ++p)
     {
         tech->GetPassByIndex(p)->Apply(0);
-		pD3DDevice->DrawIndexed(pModel->GetNrOfIndices(), 0, 0); 
+		for(auto& range : ranges)
+			pD3DDevice->DrawIndexed(range.NrOfIndices, range.StartIndex, 0); 
     }
 	
 
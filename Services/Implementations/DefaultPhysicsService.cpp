@@ -6,6 +6,7 @@
 #include "../../Helpers/TemplateUtil.h"
 #include "../../AbstractGame.h"
 #include "../../Components/CameraComponent.h"
+#include "../../Graphics/Model3D.h"
 
 #define INV255f 0.0039215686274509803921568627451f
 
@@ -233,22 +234,10 @@ NxScene* DefaultPhysicsService::GetActiveScene(void) const
 
 SceneObject* DefaultPhysicsService::Pick(const POINT& mousePosition, const tt::GameContext& context) const
 {
-	tt::Vector2 ndcCoords;
-	tt::Vector2 halfDimensions(context.vpInfo.width * .5f, context.vpInfo.height * .5f);
-	auto pCamera = context.pGame->GetActiveScene()->GetActiveCamera();
-	
-	//Calculate NDC
-	ndcCoords.x = (mousePosition.x - halfDimensions.x)/halfDimensions.x;
-	ndcCoords.y = (halfDimensions.y - mousePosition.y)/halfDimensions.y;
-
-	//Transform near and far point
-	tt::Matrix4x4 matViewProj = (pCamera->GetView() * pCamera->GetProjection()).Inverse();
-	tt::Vector3 start	= tt::Vector3(ndcCoords.x, ndcCoords.y, 0).TransformPoint(matViewProj);
-	tt::Vector3 end		= tt::Vector3(ndcCoords.x, ndcCoords.y, 1).TransformPoint(matViewProj);
-	tt::Vector3 direction = tt::Vector3::Normalize(end - start);
+	Ray pickRay = context.pGame->GetActiveScene()->GetActiveCamera()->GetPickRay(mousePosition, context.vpInfo);
 
 	//Raycast
-	NxRay ray(static_cast<NxVec3>(start), static_cast<NxVec3>(direction) );
+	NxRay ray(static_cast<NxVec3>(pickRay.Origin), static_cast<NxVec3>(pickRay.Direction) );
 	auto pShape = GetClosestShape(ray, NX_ALL_SHAPES, NX_MAX_F32);
 
 	if(!pShape)
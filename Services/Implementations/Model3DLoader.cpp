@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -18,253 +18,121 @@
 #include "../Interfaces/ResourceService.h"
 
 #include "../../Graphics/Model3D.h"
-#include "../../Helpers/BinaryReader.h"
+#include "../../Graphics/Materials/SkinnedMaterial.h"
+#include "../../Graphics/CookedMesh.h"
+#include "../../Graphics/SourceMesh.h"
+#include "../../Helpers/MappedFileReader.h"
 
 template<> unique_ptr<Model3D> ResourceService::LoadResource<Model3D>(const std::tstring& filePath)
 {
-	auto pModel = new Model3D();
-	BinaryReader meshFile(filePath);
-	unsigned int inputLayoutID = 0;
+	MappedFileReader meshFile(filePath);
+	if(!meshFile.IsOpen() )
+		throw LoaderException(std::tstring(_T("mesh ")) + filePath);
 
 	auto versionNumber = meshFile.Read<unsigned short>();
+	if(versionNumber >= COOKED_MESH_VERSION_FIRST && versionNumber != COOKED_MESH_VERSION)
+		throw LoaderException(std::tstring(_T("mesh ")) + filePath, _T("Cooked with an older version, cook it again from its source file."));
 
-	auto vertexFormat = meshFile.Read<unsigned char>();
-	auto nrOfTexCoordChannels = meshFile.Read<unsigned char>();
-
-	unsigned int* nrOfTexCoordsArr;
-	unsigned int nrOfPositions=0, nrOfNormals=0, nrOfTangents=0, nrOfBinormals=0, nrOfVertexColors=0, nrOfAnimData=0;
-	
-	nrOfPositions = meshFile.Read<unsigned int>();
+	auto pModel = new Model3D();
 
-	if(nrOfTexCoordChannels > 0){
-		nrOfTexCoordsArr = new unsigned int[nrOfTexCoordChannels];
-		meshFile.ReadArray<unsigned int>(nrOfTexCoordsArr, nrOfTexCoordChannels);
-	}
-	if(vertexFormat & 1)
-		nrOfNormals = meshFile.Read<unsigned int>();
-	if(vertexFormat & 2)
-		nrOfTangents = meshFile.Read<unsigned int>();
-	if(vertexFormat & 4)
-		nrOfBinormals = meshFile.Read<unsigned int>();
-	if(vertexFormat & 8)
-		nrOfVertexColors = meshFile.Read<unsigned int>();
-	if(vertexFormat & 16)
-		nrOfAnimData = meshFile.Read<unsigned int>();
-	
-	auto nrOfVertices = meshFile.Read<unsigned int>();
-	auto nrOfIndices = meshFile.Read<unsigned int>();
-
-	//Read vertex positions
-	for(unsigned int i=0; i < nrOfPositions; ++i){
-		auto x = meshFile.Read<float>();
-		auto y = meshFile.Read<float>();
-		auto z = meshFile.Read<float>();
-
-		pModel->m_Positions.data.push_back(D3DXVECTOR3(x,y,z));
-	}
-	
-	//Read texture coordinates
-	if(nrOfTexCoordChannels > 0){
-		pModel->m_TexCoords.resize(nrOfTexCoordChannels);
-		for(unsigned short channel = 0; channel < nrOfTexCoordChannels; ++channel){
-			for(unsigned int i = 0; i < nrOfTexCoordsArr[channel]; ++i){
-				auto u = meshFile.Read<float>();
-				auto v = meshFile.Read<float>();
-
-				pModel->m_TexCoords[channel].data.push_back(D3DXVECTOR2(u,v));
-			}
+	//Cooked files only need their sections copied out, see CookedMesh.h
+	if(versionNumber == COOKED_MESH_VERSION){
+		CookedMesh cooked;
+		meshFile.Seek(0);
+		ReadCookedMesh(meshFile, cooked);
+
+		pModel->m_BoundingBox.Bounds[0] = cooked.Bounds[0];
+		pModel->m_BoundingBox.Bounds[1] = cooked.Bounds[1];
+		pModel->m_Indices.swap(cooked.Indices);
+		pModel->m_CookedStreams.swap(cooked.Streams);
+		pModel->m_LODIndices.swap(cooked.LODIndices);
+		pModel->m_Clusters = std::move(cooked.Clusters);
+
+		for(auto& cookedLOD : cooked.LODs){
+			MeshLOD lod;
+			lod.StartIndex = cookedLOD.StartIndex;
+			lod.NrOfIndices = cookedLOD.NrOfIndices;
+			lod.NrOfVertices = cookedLOD.NrOfVertices;
+			lod.Error = cookedLOD.Error;
+			pModel->m_LODs.push_back(lod);
 		}
-		delete[] nrOfTexCoordsArr;
-	}
-
-	//Read vertex normals
-	if(vertexFormat & 1){
-		for(unsigned int i=0; i < nrOfNormals; ++i){
-			auto x = meshFile.Read<float>();
-			auto y = meshFile.Read<float>();
-			auto z = meshFile.Read<float>();
 
-			pModel->m_Normals.data.push_back(D3DXVECTOR3(x,y,z));
-		}
-	}
-	
-	//Read vertex tangents
-	if(vertexFormat & 2){
-		for(unsigned int i=0; i < nrOfTangents; ++i){
-			auto x = meshFile.Read<float>();
-			auto y = meshFile.Read<float>();
-			auto z = meshFile.Read<float>();
-
-			pModel->m_Tangents.data.push_back(D3DXVECTOR3(x,y,z));
-		}
-	}
-	
-	//Read vertex binormals
-	if(vertexFormat & 4){
-		for(unsigned int i=0; i < nrOfBinormals; ++i){
-			auto x = meshFile.Read<float>();
-			auto y = meshFile.Read<float>();
-			auto z = meshFile.Read<float>();
-
-			pModel->m_Binormals.data.push_back(D3DXVECTOR3(x,y,z));
-		}
-	}
-	
-	//Read vertex color
-	if(vertexFormat & 8){
-		for(unsigned int i=0; i < nrOfVertexColors; ++i){
-			auto r = meshFile.Read<float>();
-			auto g = meshFile.Read<float>();
-			auto b = meshFile.Read<float>();
-			auto a = meshFile.Read<float>();
-
-			pModel->m_Colors.data.push_back(D3DXCOLOR(r,g,b,a));
-		}
-	}
-	
-	if(vertexFormat & 16){
-	//Read blend indices & blend weights
-		for(unsigned int i=0; i < nrOfAnimData; ++i){
-			auto nrOfIndices = meshFile.Read<unsigned int>();
-
-			auto x = nrOfIndices > 0 ? static_cast<float>( meshFile.Read<unsigned int>() ) : -1.0f;
-			auto y = nrOfIndices > 1 ? static_cast<float>( meshFile.Read<unsigned int>() ) : -1.0f;
-			auto z = nrOfIndices > 2 ? static_cast<float>( meshFile.Read<unsigned int>() ) : -1.0f;
-			auto w = nrOfIndices > 3 ? static_cast<float>( meshFile.Read<unsigned int>() ) : -1.0f;
-
-			pModel->m_BlendIndices.data.push_back(D3DXVECTOR4(x,y,z,w));
-			
-			x = nrOfIndices > 0 ? meshFile.Read<float>() : 0.0f;
-			y = nrOfIndices > 1 ? meshFile.Read<float>() : 0.0f;
-			z = nrOfIndices > 2 ? meshFile.Read<float>() : 0.0f;
-			w = nrOfIndices > 3 ? meshFile.Read<float>() : 0.0f;
-
-			pModel->m_BlendWeights.data.push_back(D3DXVECTOR4(x,y,z,w));
-		}
-	}
-	
-
-	//Read vertices
-	for(unsigned int i=0; i < nrOfVertices; ++i)
-	{
-		auto iPos = meshFile.Read<unsigned int>();
-		pModel->m_Positions.indices.push_back(iPos);
-
-		if(nrOfTexCoordChannels > 0){
-			auto iTexCoordArr = new unsigned int[nrOfTexCoordChannels];
-			meshFile.ReadArray<unsigned int>(iTexCoordArr, nrOfTexCoordChannels);
-
-			for(unsigned int channel=0; channel < nrOfTexCoordChannels; ++channel)
-				pModel->m_TexCoords[channel].indices.push_back(iTexCoordArr[channel]);
-								
-			delete[] iTexCoordArr;
-		}
-		if(nrOfNormals > 0){
-			auto iNormal = meshFile.Read<unsigned int>();
-			pModel->m_Normals.indices.push_back(iNormal);
-		}
-		if(nrOfTangents > 0){
-			auto iTangent = meshFile.Read<unsigned int>();
-			pModel->m_Tangents.indices.push_back(iTangent);
-		}
-		if(nrOfBinormals > 0){
-			auto iBinormal = meshFile.Read<unsigned int>();
-			pModel->m_Binormals.indices.push_back(iBinormal);
-		}
-		if(nrOfVertexColors > 0){
-			auto iVertexColor = meshFile.Read<unsigned int>();
-			pModel->m_Colors.indices.push_back(iVertexColor);
-		}
-		if(nrOfAnimData > 0){
-			auto iAnimData = meshFile.Read<unsigned int>();
-			pModel->m_BlendIndices.indices.push_back(iAnimData);
-			pModel->m_BlendWeights.indices.push_back(iAnimData);
-		}
+		pModel->BuildLODs();
+		return std::unique_ptr<Model3D>(pModel);
 	}
 
-	//Read indices
-	for(unsigned int i=0; i < nrOfIndices; ++i)
-		pModel->m_Indices.push_back(meshFile.Read<unsigned int>());
-
-	if(nrOfAnimData > 0){
-		//Read bones
-		auto nrOfBones = meshFile.Read<unsigned int>();
-
-		for(unsigned int i=0; i < nrOfBones; ++i){
-			Bone newBone;
-			newBone.Name = meshFile.ReadString();
-			/*
-			for(unsigned int row=0; row < 4; ++row)
-				for(unsigned int col=0; col < 3; ++col)
-					newBone.BindPose.m[row][col] = meshFile.Read<float>();
-
-			newBone.BindPose._14 = newBone.BindPose._24 = newBone.BindPose._34 = 0;
-			newBone.BindPose._44 = 1;
-			*/
-			newBone.BindPose.Data[0].x = meshFile.Read<float>();
-			newBone.BindPose.Data[0].y = meshFile.Read<float>();
-			newBone.BindPose.Data[0].z = meshFile.Read<float>();
-			newBone.BindPose.Data[0].w = meshFile.Read<float>();
-			
-			newBone.BindPose.Data[1].x = meshFile.Read<float>();
-			newBone.BindPose.Data[1].y = meshFile.Read<float>();
-			newBone.BindPose.Data[1].z = meshFile.Read<float>();
-			newBone.BindPose.Data[1].w = meshFile.Read<float>();
-			
-			pModel->m_Skeleton.push_back(newBone);
-			
-		}
+	//Source files are read as they are stored, then the skeleton is sorted and everything derived from it is built
+	SourceMesh source;
+	meshFile.Seek(0);
+	ReadSourceMesh(meshFile, source);
+
+	pModel->m_Positions.data.swap(source.Positions.Data);
+	pModel->m_Positions.indices.swap(source.Positions.Indices);
+	pModel->m_TexCoords.resize(source.TexCoords.size() );
+	for(unsigned int channel = 0; channel < source.TexCoords.size(); ++channel){
+		pModel->m_TexCoords[channel].data.swap(source.TexCoords[channel].Data);
+		pModel->m_TexCoords[channel].indices.swap(source.TexCoords[channel].Indices);
+	}
+	pModel->m_Normals.data.swap(source.Normals.Data);
+	pModel->m_Normals.indices.swap(source.Normals.Indices);
+	pModel->m_Tangents.data.swap(source.Tangents.Data);
+	pModel->m_Tangents.indices.swap(source.Tangents.Indices);
+	pModel->m_Binormals.data.swap(source.Binormals.Data);
+	pModel->m_Binormals.indices.swap(source.Binormals.Indices);
+	pModel->m_Colors.data.swap(source.Colors.Data);
+	pModel->m_Colors.indices.swap(source.Colors.Indices);
+	pModel->m_BlendIndices.data.swap(source.BlendIndices.Data);
+	pModel->m_BlendIndices.indices.swap(source.BlendIndices.Indices);
+	pModel->m_BlendWeights.data.swap(source.BlendWeights.Data);
+	pModel->m_BlendWeights.indices.swap(source.BlendWeights.Indices);
+	pModel->m_Indices.swap(source.Indices);
+
+	if(!pModel->m_BlendIndices.data.empty() ){
+		auto& animationData = pModel->m_AnimationData;
+		animationData.Skeleton.swap(source.Skeleton);
+		unsigned int nrOfBones = animationData.Skeleton.size();
+		bool bHierarchy = source.HasBoneHierarchy();
+
+		//Bones are evaluated parent first, the file order is remapped to that
+		vector<unsigned int> newBoneIndices;
+		if(bHierarchy)
+			pModel->SortSkeleton(newBoneIndices);
+
+		//The skeleton is immutable from here on, precompute what every animator needs
+		animationData.BindPoses.Initialize(animationData.Skeleton);
+		
+		//Skeletons over the shader's palette size are drawn in parts
+		pModel->PartitionSkin(SkinnedMaterial::MAX_NR_OF_BONES);
+		pModel->BuildSkinningStreams();
 		
-		//Read AnimClips
-		auto nrOfAnimClips = meshFile.Read<unsigned int>();
-
-		for(unsigned int i=0; i < nrOfAnimClips; ++i){
-			AnimationClip newClip;
-
-			newClip.Name = meshFile.ReadString();
-			newClip.KeysPerSecond = meshFile.Read<float>();
-
-			auto nrOfKeys = meshFile.Read<unsigned int>();
-
-			for(unsigned int iKey=0; iKey < nrOfKeys; ++iKey){
-				AnimationKey newKey;
-
-				newKey.KeyTime = meshFile.Read<float>();
-				
-				for(unsigned int iBone=0; iBone < nrOfBones; ++iBone){
-					/*
-					D3DXMATRIX transform;
-					for(unsigned int row=0; row < 4; ++row)
-						for(unsigned int col=0; col < 3; ++col)
-							transform.m[row][col] = meshFile.Read<float>();
-
-					transform._14 = transform._24 = transform._34 = 0;
-					transform._44 = 1;
-					newKey.BoneTransforms.push_back(transform);
-					*/
-					tt::DualQuaternion newDQ;
-					newDQ.Data[0].x = meshFile.Read<float>();
-					newDQ.Data[0].y = meshFile.Read<float>();
-					newDQ.Data[0].z = meshFile.Read<float>();
-					newDQ.Data[0].w = meshFile.Read<float>();
-					
-					newDQ.Data[1].x = meshFile.Read<float>();
-					newDQ.Data[1].y = meshFile.Read<float>();
-					newDQ.Data[1].z = meshFile.Read<float>();
-					newDQ.Data[1].w = meshFile.Read<float>();
-					
-					newKey.BoneTransforms.push_back(newDQ);					
-					
+		animationData.Clips.swap(source.AnimClips);
+		for(auto& newClip : animationData.Clips){
+			if(bHierarchy){
+				vector<tt::DualQuaternion> fileOrder(nrOfBones);
+				for(auto& newKey : newClip.Keys){
+					fileOrder.swap(newKey.BoneTransforms);
+					newKey.BoneTransforms.resize(nrOfBones);
+					for(unsigned int iBone=0; iBone < nrOfBones; ++iBone)
+						newKey.BoneTransforms[newBoneIndices[iBone]] = fileOrder[iBone];
 				}
-
-				newClip.Keys.push_back(newKey);
 			}
-			pModel->m_AnimClips.push_back(newClip);
+
+			//Bound the mesh over the clip for culling, from the poses playback samples
+			bool bCompressed = Model3D::s_bCompressClips && newClip.Compressed.Compress(newClip, Model3D::s_RotationTolerance, Model3D::s_TranslationTolerance);
+			pModel->BuildClipBounds(newClip);
+
+			//Only the key times are needed once a clip is compressed
+			if(bCompressed)
+				for(auto& key : newClip.Keys)
+					vector<tt::DualQuaternion>().swap(key.BoneTransforms);
 		}
 	}
 
 	//Build bounding box
 	pModel->m_BoundingBox.Initialize(pModel->m_Positions.data);
+	pModel->CheckPositionPrecision();
+
+	pModel->BuildLODs();
 
 	return std::unique_ptr<Model3D>(pModel);
 }
@@ -276,7 +144,7 @@ file layout:
 // metadata
 //----------------
 
-2 bytes: version number
+2 bytes: version number, COOKED_MESH_VERSION for cooked files which have their own layout (see CookedMesh.h)
 
 1 byte: vertex format
 
@@ -330,5 +198,32 @@ file layout:
 //--------
 4 bytes * nrOfIndices : indices
 
+//---------
+// skeleton (only if nrOfAnimData > 0)
+//---------
+4 bytes : nrOfBones
+
+	string   : name
+	4 bytes  : parent index, 0xFFFFFFFF for roots (version 2 and up)
+	32 bytes : bind pose, model space dual quaternion (real xyzw, dual xyzw)
+
+^-- * nrOfBones
+
+//----------------
+// animation clips
+//----------------
+4 bytes : nrOfAnimClips
+
+	string  : name
+	4 bytes : keys per second
+	4 bytes : nrOfKeys
+
+		4 bytes				  : key time
+		32 bytes * nrOfBones  : bone transforms, relative to the parent bone (version 2 and up) or model space
+
+	^-- * nrOfKeys
+
+^-- * nrOfAnimClips
+
 EOF
 */
\ No newline at end of file
@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -34,7 +34,7 @@ std::unique_ptr<ID3D10ShaderResourceView> ResourceService::LoadResource<ID3D10Sh
 	return std::unique_ptr<ID3D10ShaderResourceView>(pTextureRV);
 }
 
-//We assume the input value is an even power of 2 (2, 4, 8, 16, 32, 64, 128, 256, 512, 1024)
+//We assume the input value is an even power of 2 (2², 4², 8², 16², 32², 64², 128², 256², 512², 1024²)
 //For these numbers, sqrt is the same as halving the number of trailing zeroes
 inline unsigned short FastSqrt(unsigned int v)
 {
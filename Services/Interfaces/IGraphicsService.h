@@ -1,4 +1,4 @@
-// Copyright  2013 Tom Tondeur
+// Copyright © 2013 Tom Tondeur
 // 
 // This file is part of tt::Engine.
 // 
@@ -30,6 +30,7 @@ struct GameContext;
 class SpriteBatch;
 class PostProcessingEffect;
 struct Sprite;
+struct IndexRange;
 
 class IGraphicsService : public Service
 {
@@ -41,8 +42,13 @@ public:
 	//Methods
 	virtual void InitWindow(int windowWidth, int windowHeight, TTengine* pEngine)=0;
 
-	virtual void Draw(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context)=0;
-	virtual void DrawDeferred(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context)=0;
+	//nrOfIndices indices starting at startIndex are drawn, 0 draws the whole model.
+	//DrawDeferred clears the G-buffers first if bClear is set, models drawn in parts only clear for their first part.
+	virtual void Draw(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context, unsigned int startIndex = 0, unsigned int nrOfIndices = 0)=0;
+	virtual void DrawDeferred(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context, unsigned int startIndex = 0, unsigned int nrOfIndices = 0, bool bClear = true)=0;
+	//Draws every range with a single setup of the material and buffers, e.g. the visible clusters of a model (see CullClusters)
+	virtual void Draw(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context, const std::vector<IndexRange>& ranges)=0;
+	virtual void DrawDeferred(resource_ptr<Model3D> pModel, const tt::Matrix4x4& worldMat, resource_ptr<Material> pMat, const tt::GameContext& context, const std::vector<IndexRange>& ranges, bool bClear = true)=0;
 
 	virtual Sprite RenderPostProcessing(const tt::GameContext& context, std::multimap<unsigned int, PostProcessingEffect*, std::greater_equal<unsigned int> >& postProEffects)=0;
 
@@ -0,0 +1,96 @@
+#include "BenchmarkFramework.h"
+#include "../Graphics/AnimationKernels.h"
+#include "AnimationFixtures.h"
+
+using namespace tt;
+
+namespace
+{
+	std::mt19937 g_Random(7);
+}
+
+TT_BENCHMARK(Animation, SkinningPalette)
+{
+	const unsigned int nrOfBones = 64, nrOfFrames = 20000;
+
+	std::vector<Bone> skeleton(nrOfBones);
+	std::vector<DualQuaternion> prevKey(nrOfBones), nextKey(nrOfBones), palette(nrOfBones);
+	for(unsigned int i = 0; i < nrOfBones; ++i){
+		skeleton[i].BindPose = RandomTransform(g_Random);
+		skeleton[i].Parent = Bone::NO_PARENT;
+		prevKey[i] = RandomTransform(g_Random);
+		nextKey[i] = RandomTransform(g_Random);
+	}
+
+	InverseBindPoses bindPoses;
+	bindPoses.Initialize(skeleton);
+
+	double perBone = MeasureMilliseconds([&]{
+		for(unsigned int frame = 0; frame < nrOfFrames; ++frame){
+			float blendFactor = (frame % 100) / 100.0f;
+			for(unsigned int i = 0; i < nrOfBones; ++i)
+				palette[i] = BlendPaletteEntry(prevKey[i], nextKey[i], blendFactor, skeleton[i].BindPose);
+			DoNotOptimize(palette.data() );
+		}
+	});
+
+	double batched = MeasureMilliseconds([&]{
+		for(unsigned int frame = 0; frame < nrOfFrames; ++frame){
+			float blendFactor = (frame % 100) / 100.0f;
+			BlendSkinningPalette(prevKey.data(), nextKey.data(), blendFactor, bindPoses, palette.data(), nrOfBones);
+			DoNotOptimize(palette.data() );
+		}
+	});
+
+	ReportTiming("DLB, Inverse and Combine per bone", perBone, nrOfBones * nrOfFrames, "bone");
+	ReportTiming("BlendSkinningPalette", batched, nrOfBones * nrOfFrames, "bone");
+}
+
+TT_BENCHMARK(Animation, ClipCompression)
+{
+	const unsigned int nrOfBones = 60, nrOfKeys = 600, nrOfPoses = 20000;
+
+	AnimationClip clip = MakeClip(nrOfBones, nrOfKeys);
+	InverseBindPoses bindPoses;
+	bindPoses.Initialize(MakeSkeleton(nrOfBones) );
+
+	CompressedClip compressed;
+	double compressTime = MeasureMilliseconds([&]{ compressed.Compress(clip, 0.001f, 0.001f); }, 1);
+
+	unsigned int rawSize = GetRawClipSize(clip);
+	printf("  %-40s %10u bytes\n", "raw keys", rawSize);
+	printf("  %-40s %10u bytes (%.1f%%)\n", "compressed", compressed.GetMemorySize(), 100.0 * compressed.GetMemorySize() / rawSize);
+	ReportTiming("Compress", compressTime);
+
+	//Sample at the same ticks both ways, 0.37 keys apart the way a 30 keys per second clip plays at ~80 fps
+	std::vector<unsigned int> cursors(nrOfBones, 0);
+	std::vector<DualQuaternion> pose(nrOfBones), palette(nrOfBones);
+	auto getTick = [&](unsigned int i, unsigned int& prevKey){
+		float tick = fmodf(i * 0.37f, (float)(nrOfKeys - 1) );
+		prevKey = std::min( (unsigned int)tick, nrOfKeys - 2);
+		return tick;
+	};
+
+	double rawTime = MeasureMilliseconds([&]{
+		for(unsigned int i = 0; i < nrOfPoses; ++i){
+			unsigned int prevKey;
+			float tick = getTick(i, prevKey);
+			BlendSkinningPalette(clip.Keys[prevKey].BoneTransforms.data(), clip.Keys[prevKey + 1].BoneTransforms.data(), tick - prevKey
+								,bindPoses, palette.data(), nrOfBones);
+			DoNotOptimize(palette.data() );
+		}
+	});
+
+	double compressedTime = MeasureMilliseconds([&]{
+		for(unsigned int i = 0; i < nrOfPoses; ++i){
+			unsigned int prevKey;
+			float tick = getTick(i, prevKey);
+			compressed.Sample(tick, prevKey, cursors.data(), pose.data() );
+			BuildSkinningPalette(pose.data(), bindPoses, palette.data(), nrOfBones);
+			DoNotOptimize(palette.data() );
+		}
+	});
+
+	ReportTiming("raw keys, BlendSkinningPalette", rawTime, nrOfPoses, "pose");
+	ReportTiming("Sample and BuildSkinningPalette", compressedTime, nrOfPoses, "pose");
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+//Synthetic skeletons and clips shared by the animation tests and benchmarks
+
+#include "../Graphics/MeshAnimator.h"
+#include "../Graphics/AnimationData.h"
+#include <random>
+#include <cmath>
+
+inline tt::DualQuaternion RandomTransform(std::mt19937& random)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f), position(-3.0f, 3.0f);
+	tt::Quaternion rotation(unit(random), unit(random), unit(random), unit(random) );
+	rotation.Normalize();
+	return tt::DualQuaternion(rotation, tt::Vector3(position(random), position(random), position(random) ) );
+}
+
+inline std::vector<Bone> MakeSkeleton(unsigned int nrOfBones)
+{
+	std::vector<Bone> skeleton(nrOfBones);
+	for(unsigned int i = 0; i < nrOfBones; ++i){
+		skeleton[i].BindPose = tt::DualQuaternion(tt::Quaternion(tt::Vector3(0, 1, 0), i * 0.1f), tt::Vector3(0, i * 0.1f, 0) );
+		skeleton[i].Parent = Bone::NO_PARENT;
+	}
+
+	return skeleton;
+}
+
+//Smooth motion at 30 keys per second: every third bone holds still, the others swing around a fixed axis and drift.
+//A few keys are stored with the opposite sign, as exporters do.
+inline AnimationClip MakeClip(unsigned int nrOfBones, unsigned int nrOfKeys)
+{
+	AnimationClip clip;
+	clip.KeysPerSecond = 30;
+	clip.Keys.resize(nrOfKeys);
+	for(unsigned int k = 0; k < nrOfKeys; ++k){
+		AnimationKey& key = clip.Keys[k];
+		key.KeyTime = (float)k;
+		float time = k / clip.KeysPerSecond;
+		for(unsigned int b = 0; b < nrOfBones; ++b){
+			float angle = b % 3 == 0 ? 0.3f : 0.8f * sinf(time * (1 + b * 0.1f) );
+			tt::Quaternion rotation(tt::Vector3(sinf(b * 1.0f), cosf(b * 2.0f), 0.5f).Normalize(), angle);
+			if(k % 7 == 3 && b % 5 == 0)
+				rotation = rotation * -1;
+
+			tt::Vector3 position(b * 0.1f + 0.05f * sinf(time * 2), b % 4 == 0 ? 0 : cosf(time) * 0.2f, 1);
+			key.BoneTransforms.push_back(tt::DualQuaternion(rotation, position) );
+		}
+	}
+
+	return clip;
+}
+
+//Skeleton without hierarchy playing MakeClip as "Walk", the way Model3DLoader fills in a model's animation data
+inline AnimationData MakeAnimationData(unsigned int nrOfBones, unsigned int nrOfKeys)
+{
+	AnimationData data;
+	data.Skeleton = MakeSkeleton(nrOfBones);
+	data.BindPoses.Initialize(data.Skeleton);
+	data.Clips.push_back(MakeClip(nrOfBones, nrOfKeys) );
+	data.Clips.back().Name = _T("Walk");
+	return data;
+}
+
+//One palette entry the way MeshAnimator::Update built it before BlendSkinningPalette: DLB, Inverse and Combine per bone
+inline tt::DualQuaternion BlendPaletteEntry(const tt::DualQuaternion& prevKey, const tt::DualQuaternion& nextKey, float blendFactor
+										   ,const tt::DualQuaternion& bindPose)
+{
+	tt::DualQuaternion lhs = tt::DualQuaternion::Inverse(bindPose)*-1;
+	tt::DualQuaternion rhs = tt::DualQuaternion::DLB(prevKey, nextKey, blendFactor);
+
+	tt::Quaternion lhsPos = tt::Quaternion::Inverse(lhs.Data[0]) * (lhs.Data[1]*2);
+	tt::Quaternion rhsPos = tt::Quaternion::Inverse(rhs.Data[0]) * (rhs.Data[1]*2);
+	tt::Quaternion pos = tt::Quaternion::Inverse(rhs.Data[0]) * lhsPos * rhs.Data[0] + rhsPos;
+	return tt::DualQuaternion(lhs.Data[0] * rhs.Data[0]*-1, tt::Vector3(pos.x, pos.y, pos.z) );
+}
+
+//One bone of BlendPoses: weighted DLB of the bone's transform in every pose, flipped to the hemisphere of the first.
+//Both parts are divided by the length of the real part, as the kernel does, rather than by the dual norm.
+inline tt::DualQuaternion BlendPoseEntry(const tt::DualQuaternion* pTransforms, const float* pWeights, unsigned int nrOfPoses)
+{
+	const tt::Quaternion& first = pTransforms[0].Data[0];
+	tt::DualQuaternion sum = pTransforms[0] * pWeights[0];
+	for(unsigned int i = 1; i < nrOfPoses; ++i){
+		const tt::Quaternion& real = pTransforms[i].Data[0];
+		float sign = first.x * real.x + first.y * real.y + first.z * real.z + first.w * real.w < 0.0f ? -1.0f : 1.0f;
+		sum = sum + pTransforms[i] * (pWeights[i] * sign);
+	}
+
+	const tt::Quaternion& r = sum.Data[0];
+	return sum * (1.0f / sqrtf(r.x * r.x + r.y * r.y + r.z * r.z + r.w * r.w) );
+}
+
+//Bytes the raw keys of a clip take
+inline unsigned int GetRawClipSize(const AnimationClip& clip)
+{
+	unsigned int size = 0;
+	for(auto& key : clip.Keys)
+		size += sizeof(AnimationKey) + key.BoneTransforms.size() * sizeof(tt::DualQuaternion);
+
+	return size;
+}
+
+//Largest component difference between two palettes, q and -q counting as the same transform
+inline float GetPaletteError(const tt::DualQuaternion& a, const tt::DualQuaternion& b)
+{
+	const tt::Quaternion& ar = a.Data[0];
+	const tt::Quaternion& br = b.Data[0];
+	float sign = ar.x * br.x + ar.y * br.y + ar.z * br.z + ar.w * br.w < 0.0f ? -1.0f : 1.0f;
+
+	float error = 0.0f;
+	for(unsigned int i = 0; i < 2; ++i){
+		const float* pA = &a.Data[i].x;
+		const float* pB = &b.Data[i].x;
+		for(unsigned int c = 0; c < 4; ++c)
+			error = std::max(error, fabsf(pA[c] * sign - pB[c]) );
+	}
+
+	return error;
+}
@@ -0,0 +1,124 @@
+#include "TestFramework.h"
+#include "../Graphics/AnimationKernels.h"
+#include "AnimationFixtures.h"
+
+using namespace tt;
+
+namespace
+{
+	std::mt19937 g_Random(11);
+}
+
+TT_TEST(Animation, SkinningPaletteMatchesPerBonePath)
+{
+	//Not a multiple of 4, so the scalar leftovers are covered in the SIMD build too
+	const unsigned int nrOfBones = 23;
+
+	std::vector<Bone> skeleton(nrOfBones);
+	std::vector<DualQuaternion> prevKey(nrOfBones), nextKey(nrOfBones), palette(nrOfBones);
+	for(unsigned int i = 0; i < nrOfBones; ++i){
+		skeleton[i].BindPose = RandomTransform(g_Random);
+		skeleton[i].Parent = Bone::NO_PARENT;
+		prevKey[i] = RandomTransform(g_Random);
+		nextKey[i] = RandomTransform(g_Random);
+	}
+
+	InverseBindPoses bindPoses;
+	bindPoses.Initialize(skeleton);
+
+	for(float blendFactor = 0.0f; blendFactor <= 1.0f; blendFactor += 0.125f){
+		BlendSkinningPalette(prevKey.data(), nextKey.data(), blendFactor, bindPoses, palette.data(), nrOfBones);
+		for(unsigned int i = 0; i < nrOfBones; ++i){
+			DualQuaternion expected = BlendPaletteEntry(prevKey[i], nextKey[i], blendFactor, skeleton[i].BindPose);
+			TT_CHECK_NEAR_N(&palette[i].Data[0].x, &expected.Data[0].x, 4, 1e-4);
+			TT_CHECK_NEAR_N(&palette[i].Data[1].x, &expected.Data[1].x, 4, 1e-4);
+		}
+	}
+}
+
+TT_TEST(Animation, CompressedClipMatchesRawKeys)
+{
+	const unsigned int nrOfBones = 30, nrOfKeys = 200;
+
+	AnimationClip clip = MakeClip(nrOfBones, nrOfKeys);
+	InverseBindPoses bindPoses;
+	bindPoses.Initialize(MakeSkeleton(nrOfBones) );
+
+	CompressedClip compressed;
+	TT_CHECK(compressed.Compress(clip, 0.001f, 0.001f) );
+	TT_CHECK(compressed.GetNrOfTracks() == nrOfBones);
+	TT_CHECK(compressed.GetMemorySize() < GetRawClipSize(clip) / 2);
+
+	std::vector<unsigned int> cursors(nrOfBones, 0);
+	std::vector<DualQuaternion> pose(nrOfBones), palette(nrOfBones), expected(nrOfBones);
+	float maxError = 0.0f;
+	for(unsigned int i = 0; i < 2000; ++i){
+		float tick = fmodf(i * 0.37f, (float)(nrOfKeys - 1) );
+		unsigned int prevKey = std::min( (unsigned int)tick, nrOfKeys - 2);
+		compressed.Sample(tick, prevKey, cursors.data(), pose.data() );
+		BuildSkinningPalette(pose.data(), bindPoses, palette.data(), nrOfBones);
+		BlendSkinningPalette(clip.Keys[prevKey].BoneTransforms.data(), clip.Keys[prevKey + 1].BoneTransforms.data(), tick - prevKey
+							,bindPoses, expected.data(), nrOfBones);
+
+		for(unsigned int b = 0; b < nrOfBones; ++b){
+			//Keys stored with opposite signs take the long way round between them in the raw path
+			const Quaternion& prev = clip.Keys[prevKey].BoneTransforms[b].Data[0];
+			const Quaternion& next = clip.Keys[prevKey + 1].BoneTransforms[b].Data[0];
+			if(prev.x * next.x + prev.y * next.y + prev.z * next.z + prev.w * next.w < 0.0f)
+				continue;
+
+			maxError = std::max(maxError, GetPaletteError(palette[b], expected[b]) );
+		}
+	}
+
+	TT_CHECK(maxError < 5e-3f);
+}
+
+TT_TEST(Animation, QuantizedRotationRoundTrip)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	for(unsigned int i = 0; i < 10000; ++i){
+		Quaternion rotation(unit(g_Random), unit(g_Random), unit(g_Random), unit(g_Random) );
+		rotation.Normalize();
+
+		Quaternion decoded = QuantizedRotation::Encode(rotation).Decode();
+		if(rotation.x * decoded.x + rotation.y * decoded.y + rotation.z * decoded.z + rotation.w * decoded.w < 0.0f)
+			decoded = decoded * -1;
+
+		//15 bits over [-1/sqrt(2), 1/sqrt(2)] leave steps of 4.3e-5 per component
+		TT_CHECK_NEAR_N(&decoded.x, &rotation.x, 4, 1e-4);
+	}
+}
+
+TT_TEST(Animation, BlendPosesMatchesPerBoneDLB)
+{
+	//Not a multiple of 4, so the scalar leftovers are covered in the SIMD build too
+	const unsigned int nrOfBones = 23, maxNrOfPoses = 4;
+
+	std::uniform_real_distribution<float> weight(0.05f, 1.0f);
+	std::vector<DualQuaternion> poses(maxNrOfPoses * nrOfBones), blend(nrOfBones);
+	for(unsigned int nrOfPoses = 1; nrOfPoses <= maxNrOfPoses; ++nrOfPoses){
+		std::vector<float> weights(nrOfPoses);
+		for(auto& w : weights)
+			w = weight(g_Random);
+		for(auto& transform : poses)
+			transform = RandomTransform(g_Random);
+
+		BlendPoses(poses.data(), weights.data(), nrOfPoses, blend.data(), nrOfBones);
+
+		std::vector<DualQuaternion> transforms(nrOfPoses);
+		for(unsigned int b = 0; b < nrOfBones; ++b){
+			for(unsigned int i = 0; i < nrOfPoses; ++i)
+				transforms[i] = poses[i * nrOfBones + b];
+
+			DualQuaternion expected = BlendPoseEntry(transforms.data(), weights.data(), nrOfPoses);
+			TT_CHECK_NEAR_N(&blend[b].Data[0].x, &expected.Data[0].x, 4, 1e-4);
+			TT_CHECK_NEAR_N(&blend[b].Data[1].x, &expected.Data[1].x, 4, 1e-4);
+		}
+
+		//Blending into the first pose, the way MeshAnimator does
+		BlendPoses(poses.data(), weights.data(), nrOfPoses, poses.data(), nrOfBones);
+		for(unsigned int b = 0; b < nrOfBones; ++b)
+			TT_CHECK(GetPaletteError(poses[b], blend[b]) == 0);
+	}
+}
@@ -0,0 +1,539 @@
+#include "TestFramework.h"
+#include "../Graphics/MeshAnimator.h"
+#include "../Graphics/AnimationData.h"
+#include "../Graphics/AnimationSystem.h"
+#include "AnimationFixtures.h"
+#include <algorithm>
+
+using namespace tt;
+
+namespace
+{
+	std::mt19937 g_Random(23);
+
+	//Turns the flipped keys of MakeClip back: blending across hemispheres cancels the real part, which makes
+	//the comparison with the per bone path meaningless
+	void AlignHemispheres(AnimationClip& clip)
+	{
+		auto& keys = clip.Keys;
+		for(unsigned int k = 1; k < keys.size(); ++k)
+			for(unsigned int b = 0; b < keys[k].BoneTransforms.size(); ++b){
+				const Quaternion& prev = keys[k-1].BoneTransforms[b].Data[0];
+				const Quaternion& next = keys[k].BoneTransforms[b].Data[0];
+				if(prev.x * next.x + prev.y * next.y + prev.z * next.z + prev.w * next.w < 0)
+					keys[k].BoneTransforms[b] = keys[k].BoneTransforms[b] * -1;
+			}
+	}
+
+	//Keys further apart towards the end of the clip, so a binary search and a stepping cursor visit different keys
+	AnimationData MakeUnevenAnimationData(unsigned int nrOfBones, unsigned int nrOfKeys)
+	{
+		AnimationData data = MakeAnimationData(nrOfBones, nrOfKeys);
+		auto& keys = data.Clips[0].Keys;
+		for(unsigned int k = 0; k < nrOfKeys; ++k)
+			keys[k].KeyTime = k + 0.05f * k * k;
+
+		AlignHemispheres(data.Clips[0]);
+		return data;
+	}
+
+	//Adds a clip with the key times of the first one and its poses shifted by a number of keys
+	void AddShiftedClip(AnimationData& data, const tstring& name, unsigned int shift)
+	{
+		AnimationClip clip = data.Clips[0];
+		clip.Name = name;
+		for(unsigned int k = 0; k < clip.Keys.size(); ++k)
+			clip.Keys[k].BoneTransforms = data.Clips[0].Keys[(k + shift) % clip.Keys.size()].BoneTransforms;
+
+		AlignHemispheres(clip);
+		data.Clips.push_back(clip);
+	}
+
+	//DLB between the keys around a tick, with the keys found by a binary search over the whole clip
+	DualQuaternion SampleBone(const AnimationClip& clip, float tick, unsigned int bone)
+	{
+		const auto& keys = clip.Keys;
+		auto itNext = std::upper_bound(keys.begin(), keys.end(), tick, [](float t, const AnimationKey& key){
+			return t < key.KeyTime;
+		});
+
+		unsigned int nextKey = itNext - keys.begin();
+		unsigned int prevKey = nextKey == 0 ? keys.size() - 1 : nextKey - 1;
+		float blendFactor = (tick - keys[prevKey].KeyTime) / (keys[nextKey].KeyTime - keys[prevKey].KeyTime);
+		return DualQuaternion::DLB(keys[prevKey].BoneTransforms[bone], keys[nextKey].BoneTransforms[bone], blendFactor);
+	}
+
+	//The palette of layers of clips without hierarchy blended at a tick, in the order the animator holds the layers
+	void CheckBlendAt(const AnimationData& data, const MeshAnimator& animator, const std::vector<unsigned int>& clips
+					 ,const std::vector<float>& weights, float tick)
+	{
+		const auto& palette = animator.GetDualQuats();
+		TT_CHECK(palette.size() == data.Skeleton.size() );
+		for(unsigned int b = 0; b < palette.size(); ++b){
+			std::vector<DualQuaternion> poses;
+			for(auto clip : clips)
+				poses.push_back(SampleBone(data.Clips[clip], tick, b) );
+
+			DualQuaternion pose = BlendPoseEntry(poses.data(), weights.data(), poses.size() );
+			DualQuaternion expected = BlendPaletteEntry(pose, pose, 0, data.Skeleton[b].BindPose);
+			TT_CHECK(GetPaletteError(palette[b], expected) < 1e-4f);
+		}
+	}
+
+	//The palette of a clip without hierarchy at a tick, with the keys found by a binary search over the whole clip
+	void CheckPoseAt(const AnimationData& data, const MeshAnimator& animator, float tick)
+	{
+		const auto& keys = data.Clips[0].Keys;
+		auto itNext = std::upper_bound(keys.begin(), keys.end(), tick, [](float t, const AnimationKey& key){
+			return t < key.KeyTime;
+		});
+
+		unsigned int nextKey = itNext - keys.begin();
+		unsigned int prevKey = nextKey == 0 ? keys.size() - 1 : nextKey - 1;
+		float blendFactor = (tick - keys[prevKey].KeyTime) / (keys[nextKey].KeyTime - keys[prevKey].KeyTime);
+
+		const auto& palette = animator.GetDualQuats();
+		TT_CHECK(palette.size() == data.Skeleton.size() );
+		for(unsigned int b = 0; b < palette.size(); ++b){
+			DualQuaternion expected = BlendPaletteEntry(keys[prevKey].BoneTransforms[b], keys[nextKey].BoneTransforms[b], blendFactor
+													   ,data.Skeleton[b].BindPose);
+			TT_CHECK(GetPaletteError(palette[b], expected) < 1e-4f);
+		}
+	}
+}
+
+TT_TEST(Animator, CursorFollowsPlayback)
+{
+	AnimationData data = MakeUnevenAnimationData(9, 40);
+	MeshAnimator animator;
+	animator.SetAnimationData(&data);
+	TT_CHECK(animator.SetAnimationClip(_T("Walk") ) );
+
+	//Small steps keep the cursor within a key or two of where it was
+	float lastTick = data.Clips[0].Keys.back().KeyTime;
+	for(float tick = 0; tick < lastTick; tick += 0.7f){
+		TT_CHECK(animator.Evaluate(tick) );
+		CheckPoseAt(data, animator, tick);
+	}
+}
+
+TT_TEST(Animator, CursorFallsBackToSearchOnLongSteps)
+{
+	AnimationData data = MakeUnevenAnimationData(9, 40);
+	MeshAnimator animator;
+	animator.SetAnimationData(&data);
+	animator.SetAnimationClip(_T("Walk") );
+
+	//Jumps past more keys than the cursor steps over, forwards and backwards
+	const auto& keys = data.Clips[0].Keys;
+	const float ticks[] = {0.5f, keys[20].KeyTime + 0.25f, keys[21].KeyTime, keys[3].KeyTime + 0.1f, keys[38].KeyTime + 0.5f
+						  ,keys[2].KeyTime, 0.0f, keys[10].KeyTime - 0.01f, keys[9].KeyTime + 0.01f};
+	for(auto tick : ticks){
+		TT_CHECK(animator.Evaluate(tick) );
+		CheckPoseAt(data, animator, tick);
+	}
+}
+
+TT_TEST(Animator, CursorMatchesBinarySearchOnRandomSeeks)
+{
+	AnimationData data = MakeUnevenAnimationData(5, 60);
+	MeshAnimator animator;
+	animator.SetAnimationData(&data);
+	animator.SetAnimationClip(_T("Walk") );
+
+	//Mix of short steps in both directions and long seeks, also landing on key times exactly
+	const auto& keys = data.Clips[0].Keys;
+	std::uniform_real_distribution<float> step(-3.0f, 4.0f), seek(0.0f, keys.back().KeyTime);
+	std::uniform_int_distribution<unsigned int> kind(0, 3), key(0, keys.size() - 2);
+	float tick = 0;
+	for(unsigned int i = 0; i < 500; ++i){
+		switch(kind(g_Random) ){
+		case 0: tick = seek(g_Random); break;
+		case 1: tick = keys[key(g_Random)].KeyTime; break;
+		default: tick = std::min(std::max(tick + step(g_Random), 0.0f), keys.back().KeyTime - 0.01f); break;
+		}
+
+		TT_CHECK(animator.Evaluate(tick) );
+		CheckPoseAt(data, animator, tick);
+	}
+}
+
+TT_TEST(Animator, PlaybackWrapsAroundTheClip)
+{
+	AnimationData data = MakeUnevenAnimationData(9, 40);
+	MeshAnimator animator;
+	animator.SetAnimationData(&data);
+	animator.SetAnimationClip(_T("Walk") );
+
+	//Frames crossing the end of the clip several times, the cursor has to seek back to the start each time
+	const AnimationClip& clip = data.Clips[0];
+	float duration = clip.Keys.back().KeyTime - clip.Keys.front().KeyTime;
+	float elapsedSeconds = 1 / 24.0f;
+	for(float totalSeconds = 0; totalSeconds < 3.5f * duration / clip.KeysPerSecond; totalSeconds += elapsedSeconds){
+		TT_CHECK(animator.Update(totalSeconds, elapsedSeconds) );
+
+		float tick = fmodf(totalSeconds * clip.KeysPerSecond, duration);
+		TT_CHECK_NEAR(animator.GetClipTick(totalSeconds), tick, 1e-3);
+		CheckPoseAt(data, animator, animator.GetClipTick(totalSeconds) );
+	}
+
+	//Negative offsets wrap to the end of the clip
+	animator.SetTimeOffset(-0.5f / clip.KeysPerSecond);
+	TT_CHECK_NEAR(animator.GetClipTick(0), duration - 0.5f, 1e-3);
+}
+
+TT_TEST(Animator, TickPastTheLastKeyFails)
+{
+	AnimationData data = MakeAnimationData(4, 10);
+	MeshAnimator animator;
+	animator.SetAnimationData(&data);
+	animator.SetAnimationClip(_T("Walk") );
+
+	TT_CHECK(animator.Evaluate(2.5f) );
+	std::vector<DualQuaternion> pose = animator.GetDualQuats();
+
+	//No key follows, the pose is left as it was
+	TT_CHECK(!animator.Evaluate(data.Clips[0].Keys.back().KeyTime) );
+	for(unsigned int b = 0; b < pose.size(); ++b)
+		TT_CHECK(GetPaletteError(animator.GetDualQuats()[b], pose[b]) == 0);
+
+	//The cursor recovers on the next tick in range
+	TT_CHECK(animator.Evaluate(2.5f) );
+	CheckPoseAt(data, animator, 2.5f);
+}
+
+TT_TEST(Animator, PoseCacheSnapsTicks)
+{
+	AnimationData data = MakeUnevenAnimationData(6, 40);
+	const float offsets[] = {0.0f, 0.02f, 0.05f, 0.12f};
+	const unsigned int nrOfAnimators = sizeof(offsets) / sizeof(offsets[0]);
+	MeshAnimator animators[nrOfAnimators];
+	for(unsigned int i = 0; i < nrOfAnimators; ++i){
+		animators[i].SetAnimationData(&data);
+		animators[i].SetAnimationClip(_T("Walk") );
+		animators[i].SetTimeOffset(offsets[i]);
+	}
+
+	//Without a resolution every animator is evaluated at its own tick
+	const float totalSeconds = 0.5f, elapsedSeconds = 1 / 30.0f;
+	for(auto& animator : animators)
+		AnimationSystem::Submit(&animator);
+	TT_CHECK(AnimationSystem::Evaluate(totalSeconds, elapsedSeconds) == 0);
+	for(auto& animator : animators)
+		CheckPoseAt(data, animator, animator.GetClipTick(totalSeconds) );
+
+	//At 30 keys per second, 0.1 seconds snaps to multiples of 3 ticks: the first three (ticks 15 to 16.5) share a pose
+	AnimationSystem::SetPoseCacheResolution(0.1f);
+	for(auto& animator : animators)
+		AnimationSystem::Submit(&animator);
+	TT_CHECK(AnimationSystem::Evaluate(totalSeconds, elapsedSeconds) == 0);
+	AnimationSystem::SetPoseCacheResolution(0);
+
+	for(unsigned int i = 0; i < nrOfAnimators; ++i){
+		float step = 0.1f * data.Clips[0].KeysPerSecond;
+		float tick = animators[i].GetClipTick(totalSeconds);
+		CheckPoseAt(data, animators[i], floorf(tick / step) * step);
+	}
+
+	for(unsigned int i = 1; i < 3; ++i)
+		for(unsigned int b = 0; b < data.Skeleton.size(); ++b)
+			TT_CHECK(GetPaletteError(animators[i].GetDualQuats()[b], animators[0].GetDualQuats()[b]) == 0);
+	TT_CHECK(GetPaletteError(animators[3].GetDualQuats()[1], animators[0].GetDualQuats()[1]) > 0);
+}
+
+TT_TEST(Animator, IntervalLODInterpolatesBetweenEvaluations)
+{
+	AnimationData data = MakeUnevenAnimationData(6, 40);
+	MeshAnimator animator, reference;
+	for(auto pAnimator : {&animator, &reference}){
+		pAnimator->SetAnimationData(&data);
+		pAnimator->SetAnimationClip(_T("Walk") );
+	}
+
+	//Every third frame evaluates the pose three frames ahead, the two frames in between blend towards it
+	const unsigned int interval = 3;
+	const float startSeconds = 0.1f, elapsedSeconds = 1 / 30.0f;
+	animator.SetLOD(interval, false);
+	std::vector<DualQuaternion> from, to, expected(data.Skeleton.size() );
+	for(unsigned int frame = 0; frame < 8 * interval; ++frame){
+		float totalSeconds = startSeconds + frame * elapsedSeconds;
+		TT_CHECK(animator.Update(totalSeconds, elapsedSeconds) );
+
+		//Entering the LOD, the first evaluation is shown until the next interval starts
+		if(frame < interval){
+			TT_CHECK(reference.Evaluate(reference.GetClipTick(startSeconds, interval * elapsedSeconds) ) );
+			expected = reference.GetDualQuats();
+		}
+		else{
+			unsigned int intervalStart = frame - frame % interval;
+			TT_CHECK(reference.Evaluate(reference.GetClipTick(startSeconds + intervalStart * elapsedSeconds) ) );
+			from = reference.GetDualQuats();
+			TT_CHECK(reference.Evaluate(reference.GetClipTick(startSeconds + (intervalStart + interval) * elapsedSeconds) ) );
+			to = reference.GetDualQuats();
+			InterpolatePalettes(from.data(), to.data(), static_cast<float>(frame % interval) / interval, expected.data(), expected.size() );
+		}
+
+		const auto& palette = animator.GetDualQuats();
+		TT_CHECK(palette.size() == expected.size() );
+		for(unsigned int b = 0; b < palette.size(); ++b)
+			TT_CHECK(GetPaletteError(palette[b], expected[b]) < 1e-4f);
+	}
+}
+
+TT_TEST(Animator, FrozenLODKeepsItsPose)
+{
+	AnimationData data = MakeUnevenAnimationData(6, 40);
+	MeshAnimator animator;
+	animator.SetAnimationData(&data);
+	animator.SetAnimationClip(_T("Walk") );
+
+	//The first frame still evaluates, there has to be a pose to draw
+	animator.SetLOD(0, false);
+	TT_CHECK(animator.Update(0.2f, 1 / 30.0f) );
+	CheckPoseAt(data, animator, animator.GetClipTick(0.2f) );
+
+	std::vector<DualQuaternion> pose = animator.GetDualQuats();
+	unsigned int serial = animator.GetPoseSerial();
+	for(float totalSeconds = 0.3f; totalSeconds < 1; totalSeconds += 0.1f){
+		float targetTick;
+		TT_CHECK(!animator.BeginFrame(totalSeconds, 0.1f, targetTick) );
+		animator.EndFrame();
+	}
+
+	TT_CHECK(animator.GetPoseSerial() == serial);
+	for(unsigned int b = 0; b < pose.size(); ++b)
+		TT_CHECK(GetPaletteError(animator.GetDualQuats()[b], pose[b]) == 0);
+
+	//Thawing picks up the playback where it is now
+	animator.SetLOD(1, false);
+	TT_CHECK(animator.Update(1.0f, 0.1f) );
+	CheckPoseAt(data, animator, animator.GetClipTick(1.0f) );
+}
+
+TT_TEST(Animator, ReducedSkeletonFollowsNearestBone)
+{
+	//A chain, every bone the child of the one before it
+	AnimationData data = MakeUnevenAnimationData(9, 40);
+	for(unsigned int b = 0; b < data.Skeleton.size(); ++b){
+		data.Skeleton[b].Parent = b == 0 ? Bone::NO_PARENT : b - 1;
+		data.BoneParents.push_back(data.Skeleton[b].Parent);
+	}
+
+	//The ancestors of the kept bone are pulled in, the bones past it follow it
+	data.SetReducedSkeleton(std::vector<unsigned int>(1, 4) );
+	TT_CHECK(data.HasReducedSkeleton() );
+	TT_CHECK(data.ReducedBones.size() == 5);
+	TT_CHECK(data.ReducedBindPoses.Size() == 5);
+	for(unsigned int i = 0; i < data.ReducedBones.size(); ++i){
+		TT_CHECK(data.ReducedBones[i] == i);
+		TT_CHECK(data.ReducedParents[i] == data.BoneParents[i]);
+	}
+
+	TT_CHECK(data.ReducedBoneMap.size() == data.Skeleton.size() );
+	for(unsigned int b = 0; b < data.Skeleton.size(); ++b)
+		TT_CHECK(data.ReducedBoneMap[b] == std::min(b, 4u) );
+
+	MeshAnimator animator, reference;
+	for(auto pAnimator : {&animator, &reference}){
+		pAnimator->SetAnimationData(&data);
+		pAnimator->SetAnimationClip(_T("Walk") );
+	}
+
+	animator.SetLOD(1, true);
+	TT_CHECK(animator.UsesReducedSkeleton() );
+	TT_CHECK(!reference.UsesReducedSkeleton() );
+
+	//The evaluated bones match the full skeleton, the others copy the bone they follow
+	for(float tick = 0.5f; tick < 60; tick += 7.3f){
+		TT_CHECK(animator.Evaluate(tick) );
+		TT_CHECK(reference.Evaluate(tick) );
+
+		const auto& palette = animator.GetDualQuats();
+		const auto& full = reference.GetDualQuats();
+		TT_CHECK(palette.size() == full.size() );
+		for(unsigned int b = 0; b < palette.size(); ++b)
+			TT_CHECK(GetPaletteError(palette[b], full[std::min(b, 4u)]) < 1e-5f);
+	}
+
+	//Clearing the reduced skeleton goes back to evaluating every bone
+	data.SetReducedSkeleton(std::vector<unsigned int>() );
+	TT_CHECK(!animator.UsesReducedSkeleton() );
+}
+
+TT_TEST(Animator, CrossFadeMovesWeightsOverTime)
+{
+	AnimationData data = MakeUnevenAnimationData(7, 40);
+	AddShiftedClip(data, _T("Run"), 9);
+	MeshAnimator animator;
+	animator.SetAnimationData(&data);
+	animator.SetAnimationClip(_T("Walk") );
+	TT_CHECK(animator.GetNrOfLayers() == 1);
+
+	//Over a second, Walk fades out while Run fades in. Run becomes the current clip right away.
+	TT_CHECK(animator.CrossFade(_T("Run"), 1.0f) );
+	TT_CHECK(animator.GetAnimationClip() == &data.Clips[1]);
+	TT_CHECK(animator.GetNrOfLayers() == 2);
+
+	const float elapsedSeconds = 0.25f;
+	std::vector<unsigned int> clips;
+	clips.push_back(0);
+	clips.push_back(1);
+	for(unsigned int frame = 1; frame < 4; ++frame){
+		float totalSeconds = 0.1f + frame * elapsedSeconds;
+		TT_CHECK(animator.Update(totalSeconds, elapsedSeconds) );
+		TT_CHECK(animator.IsBlending() );
+
+		std::vector<float> weights;
+		weights.push_back(1 - frame * elapsedSeconds);
+		weights.push_back(frame * elapsedSeconds);
+		CheckBlendAt(data, animator, clips, weights, animator.GetClipTick(totalSeconds) );
+	}
+
+	//Walk faded out completely and its layer is gone
+	TT_CHECK(animator.Update(1.1f, elapsedSeconds) );
+	TT_CHECK(animator.GetNrOfLayers() == 1);
+	TT_CHECK(!animator.IsBlending() );
+	CheckBlendAt(data, animator, std::vector<unsigned int>(1, 1), std::vector<float>(1, 1.0f), animator.GetClipTick(1.1f) );
+}
+
+TT_TEST(Animator, LayerWeightReusesFadedSlots)
+{
+	AnimationData data = MakeUnevenAnimationData(7, 40);
+	AddShiftedClip(data, _T("Run"), 9);
+	AddShiftedClip(data, _T("Idle"), 13);
+	MeshAnimator animator;
+	animator.SetAnimationData(&data);
+	animator.SetAnimationClip(_T("Walk") );
+
+	//Run plays on top of Walk at half weight, then is removed
+	TT_CHECK(animator.SetLayerWeight(_T("Run"), 0.5f) );
+	TT_CHECK(animator.GetNrOfLayers() == 2);
+	TT_CHECK(animator.Update(0.5f, 0.1f) );
+	TT_CHECK(animator.Update(0.6f, 0.1f) );
+	TT_CHECK(animator.SetLayerWeight(_T("Run"), 0) );
+	TT_CHECK(animator.Update(0.7f, 0.1f) );
+	TT_CHECK(animator.GetNrOfLayers() == 1);
+	TT_CHECK(!animator.IsBlending() );
+	TT_CHECK(animator.GetAnimationClip() == &data.Clips[0]);
+
+	//Idle takes the slot Run left and starts over from weight 0, fading to 0.8 over half a second
+	TT_CHECK(animator.SetLayerWeight(_T("Idle"), 0.8f, 0.5f) );
+	TT_CHECK(animator.GetNrOfLayers() == 2);
+
+	std::vector<unsigned int> clips;
+	clips.push_back(0);
+	clips.push_back(2);
+	for(unsigned int frame = 1; frame <= 7; ++frame){
+		float totalSeconds = 0.7f + frame * 0.1f;
+		TT_CHECK(animator.Update(totalSeconds, 0.1f) );
+
+		std::vector<float> weights;
+		weights.push_back(1);
+		weights.push_back(std::min(frame * 0.16f, 0.8f) );
+		CheckBlendAt(data, animator, clips, weights, animator.GetClipTick(totalSeconds) );
+	}
+
+	//A layer for a clip that's already playing is updated, not added
+	TT_CHECK(animator.SetLayerWeight(_T("Idle"), 0.3f) );
+	TT_CHECK(animator.GetNrOfLayers() == 2);
+	TT_CHECK(!animator.SetLayerWeight(_T("Jump"), 1) );
+	TT_CHECK(animator.GetNrOfLayers() == 2);
+}
+
+TT_TEST(Animator, SystemSharesOnlyIdenticalPoses)
+{
+	AnimationData data = MakeUnevenAnimationData(7, 40);
+	AddShiftedClip(data, _T("Run"), 9);
+	data.SetReducedSkeleton(std::vector<unsigned int>(1, 3) );
+	AnimationData otherData = data;
+
+	//Same clip and time: shared. Reduced skeleton, blend, other animation data: evaluated on their own.
+	MeshAnimator shared[3], reduced, blending, other;
+	for(auto& animator : shared){
+		animator.SetAnimationData(&data);
+		animator.SetAnimationClip(_T("Walk") );
+	}
+	reduced.SetAnimationData(&data);
+	reduced.SetAnimationClip(_T("Walk") );
+	reduced.SetLOD(1, true);
+	blending.SetAnimationData(&data);
+	blending.SetAnimationClip(_T("Walk") );
+	blending.SetLayerWeight(_T("Run"), 0.5f);
+	other.SetAnimationData(&otherData);
+	other.SetAnimationClip(_T("Walk") );
+
+	MeshAnimator removed;
+	removed.SetAnimationData(&data);
+	removed.SetAnimationClip(_T("Walk") );
+	{
+		MeshAnimator destroyed;
+		destroyed.SetAnimationData(&data);
+		destroyed.SetAnimationClip(_T("Walk") );
+		AnimationSystem::Submit(&destroyed);
+	}
+
+	for(auto pAnimator : {&shared[0], &reduced, &shared[1], &blending, &other, &removed, &shared[2]})
+		AnimationSystem::Submit(pAnimator);
+	AnimationSystem::Remove(&removed);
+
+	const float totalSeconds = 0.7f, elapsedSeconds = 1 / 30.0f;
+	TT_CHECK(AnimationSystem::Evaluate(totalSeconds, elapsedSeconds) == 0);
+
+	float tick = shared[0].GetClipTick(totalSeconds);
+	for(auto& animator : shared)
+		CheckPoseAt(data, animator, tick);
+	CheckPoseAt(otherData, other, tick);
+	TT_CHECK(removed.GetDualQuats().empty() );
+
+	std::vector<unsigned int> clips;
+	clips.push_back(0);
+	clips.push_back(1);
+	std::vector<float> weights;
+	weights.push_back(1);
+	weights.push_back(0.5f);
+	CheckBlendAt(data, blending, clips, weights, tick);
+
+	const auto& full = shared[0].GetDualQuats();
+	const auto& palette = reduced.GetDualQuats();
+	TT_CHECK(palette.size() == full.size() );
+	for(unsigned int b = 0; b < palette.size(); ++b)
+		TT_CHECK(GetPaletteError(palette[b], full[data.ReducedBones[data.ReducedBoneMap[b]]]) < 1e-5f);
+
+	//The queue is empty after an evaluation
+	unsigned int serial = shared[0].GetPoseSerial();
+	TT_CHECK(AnimationSystem::Evaluate(totalSeconds + elapsedSeconds, elapsedSeconds) == 0);
+	TT_CHECK(shared[0].GetPoseSerial() == serial);
+}
+
+TT_TEST(Animator, SystemDoesNotShareFailedPoses)
+{
+	//Keys from tick -20 on, the clip tick wraps to [0, duration) so its last 20 ticks are past the last key
+	AnimationData data = MakeUnevenAnimationData(5, 40);
+	for(auto& key : data.Clips[0].Keys)
+		key.KeyTime -= 20;
+
+	MeshAnimator animators[3];
+	for(unsigned int i = 0; i < 3; ++i){
+		animators[i].SetAnimationData(&data);
+		animators[i].SetAnimationClip(_T("Walk") );
+		TT_CHECK(animators[i].Evaluate(i * 10.0f) );
+	}
+
+	std::vector<DualQuaternion> poses[3];
+	for(unsigned int i = 0; i < 3; ++i){
+		poses[i] = animators[i].GetDualQuats();
+		AnimationSystem::Submit(&animators[i]);
+	}
+
+	//All three request the same pose, which fails once for all of them
+	const AnimationClip& clip = data.Clips[0];
+	float duration = clip.Keys.back().KeyTime - clip.Keys.front().KeyTime;
+	float totalSeconds = (duration - 5) / clip.KeysPerSecond;
+	TT_CHECK(animators[0].GetClipTick(totalSeconds) > clip.Keys.back().KeyTime);
+	TT_CHECK(AnimationSystem::Evaluate(totalSeconds, 1 / 30.0f) == 1);
+
+	//Nobody copies the pose that wasn't updated, every animator keeps the one it had
+	for(unsigned int i = 0; i < 3; ++i)
+		for(unsigned int b = 0; b < poses[i].size(); ++b)
+			TT_CHECK(GetPaletteError(animators[i].GetDualQuats()[b], poses[i][b]) == 0);
+}
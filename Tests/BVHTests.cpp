@@ -0,0 +1,289 @@
+#include "TestFramework.h"
+#include "../Graphics/MeshBVH.h"
+#include "../Graphics/SkinnedBVH.h"
+#include "../Graphics/BoundingVolumes.h"
+#include "MeshFixtures.h"
+
+namespace
+{
+	//Closest hit over all triangles in double precision (Moller & Trumbore), double sided like MeshBVH
+	bool IntersectBruteForce(const TestMesh& mesh, const Ray& ray, float maxDistance, double& distance, unsigned int& triangle)
+	{
+		bool bHit = false;
+		distance = maxDistance;
+		double origin[3] = {ray.Origin.x, ray.Origin.y, ray.Origin.z}, direction[3] = {ray.Direction.x, ray.Direction.y, ray.Direction.z};
+		for(unsigned int i = 0; i < mesh.Indices.size(); i += 3){
+			tt::Vector3 a = mesh.GetPosition(mesh.Indices[i]), b = mesh.GetPosition(mesh.Indices[i + 1]), c = mesh.GetPosition(mesh.Indices[i + 2]);
+			double edge1[3] = {b.x - a.x, b.y - a.y, b.z - a.z}, edge2[3] = {c.x - a.x, c.y - a.y, c.z - a.z};
+			double p[3] = {direction[1] * edge2[2] - direction[2] * edge2[1], direction[2] * edge2[0] - direction[0] * edge2[2], direction[0] * edge2[1] - direction[1] * edge2[0]};
+			double determinant = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+			if(determinant == 0.0)
+				continue;
+
+			double toOrigin[3] = {origin[0] - a.x, origin[1] - a.y, origin[2] - a.z};
+			double u = (toOrigin[0] * p[0] + toOrigin[1] * p[1] + toOrigin[2] * p[2]) / determinant;
+			if(u < 0.0 || u > 1.0)
+				continue;
+
+			double q[3] = {toOrigin[1] * edge1[2] - toOrigin[2] * edge1[1], toOrigin[2] * edge1[0] - toOrigin[0] * edge1[2], toOrigin[0] * edge1[1] - toOrigin[1] * edge1[0]};
+			double v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) / determinant;
+			if(v < 0.0 || u + v > 1.0)
+				continue;
+
+			double t = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) / determinant;
+			if(t >= 0.0 && t < distance){
+				distance = t;
+				triangle = i / 3;
+				bHit = true;
+			}
+		}
+
+		return bHit;
+	}
+
+	void GetBounds(const TestMesh& mesh, tt::Vector3& center, float& radius)
+	{
+		AABBox box;
+		box.Bounds[0] = box.Bounds[1] = mesh.GetPosition(0);
+		for(unsigned int i = 1; i < mesh.NrOfVertices; ++i)
+			box.Include(mesh.GetPosition(i) );
+
+		center = (box.Bounds[0] + box.Bounds[1]) * 0.5f;
+		radius = (box.Bounds[1] - box.Bounds[0]).Length() * 0.5f;
+	}
+
+	//Rays from around the mesh towards its middle, every 7th one along the z axis. Rays grazing an edge can go either way,
+	//one mismatch in 2000 is allowed for those.
+	void CheckAgainstBruteForce(const MeshBVH& bvh, const TestMesh& mesh, unsigned int nrOfRays, std::mt19937& random)
+	{
+		tt::Vector3 center;
+		float radius;
+		GetBounds(mesh, center, radius);
+
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		unsigned int nrOfHits = 0, nrOfMismatches = 0;
+		for(unsigned int i = 0; i < nrOfRays; ++i){
+			tt::Vector3 origin = center + tt::Vector3::Normalize(tt::Vector3(unit(random), unit(random), unit(random) ) ) * radius * 2.0f;
+			tt::Vector3 target = center + tt::Vector3(unit(random), unit(random), unit(random) ) * radius * 0.5f;
+			Ray ray(origin, tt::Vector3::Normalize(target - origin) );
+			if(i % 7 == 0)
+				ray = Ray(origin, tt::Vector3(0.0f, 0.0f, origin.z > center.z ? -1.0f : 1.0f) );
+
+			RayHit hit;
+			double distance;
+			unsigned int triangle = 0;
+			bool bHit = bvh.Intersect(ray, FLT_MAX, hit);
+			bool bExpected = IntersectBruteForce(mesh, ray, FLT_MAX, distance, triangle);
+			if(bHit != bExpected || (bHit && fabs(hit.Distance - distance) > 1e-4 * max(1.0, distance) ) ){
+				++nrOfMismatches;
+				continue;
+			}
+			if(!bHit)
+				continue;
+			++nrOfHits;
+
+			//The barycentric coordinates lead to the same point on the triangle it reports
+			const unsigned int* pTriangle = &mesh.Indices[hit.Triangle * 3];
+			tt::Vector3 a = mesh.GetPosition(pTriangle[0]), b = mesh.GetPosition(pTriangle[1]), c = mesh.GetPosition(pTriangle[2]);
+			tt::Vector3 onTriangle = a + (b - a) * hit.U + (c - a) * hit.V;
+			TT_CHECK( (onTriangle - (ray.Origin + ray.Direction * hit.Distance) ).Length() < 1e-3f * max(1.0f, radius) );
+			TT_CHECK(hit.U >= -1e-5f && hit.V >= -1e-5f && hit.U + hit.V <= 1.0f + 1e-5f);
+
+			//Nothing is hit before the closest hit
+			RayHit nearer;
+			TT_CHECK(!bvh.Intersect(ray, hit.Distance * 0.999f, nearer) );
+		}
+
+		TT_CHECK(nrOfHits > nrOfRays / 4);
+		TT_CHECK(nrOfMismatches <= nrOfRays / 2000);
+	}
+
+	//The goblin the way a Model3D holds it for picking: a BVH over its unwelded vertices, the same ones the skinning streams have
+	struct SkinnedGoblin
+	{
+		SkinningStreams Streams;
+		TestMesh BindMesh;
+		MeshBVH BindBVH;
+		InverseBindPoses BindPoses;
+		std::vector<AnimationClip> Clips;
+
+		SkinnedGoblin(void)
+		{
+			SourceMesh source;
+			ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+			MakeSkinningStreams(source, Streams);
+			BindPoses.Initialize(source.Skeleton);
+			Clips.swap(source.AnimClips);
+
+			BindMesh.Indices = source.Indices;
+			BindMesh.Stride = sizeof(float) * 3;
+			BindMesh.NrOfVertices = Streams.Size();
+			for(unsigned int v = 0; v < BindMesh.NrOfVertices; ++v){
+				BindMesh.Vertices.push_back(Streams.PosX[v]);
+				BindMesh.Vertices.push_back(Streams.PosY[v]);
+				BindMesh.Vertices.push_back(Streams.PosZ[v]);
+			}
+			BindBVH.Build(BindMesh.Indices.data(), BindMesh.Indices.size(), BindMesh.GetPositions(), BindMesh.Stride);
+		}
+
+		//Palette of a key of the first clip, and the mesh skinned with it
+		void GetPose(unsigned int key, std::vector<tt::DualQuaternion>& palette, TestMesh& mesh) const
+		{
+			const AnimationKey& pose = Clips[0].Keys[key];
+			palette.resize(BindPoses.Size() );
+			BlendSkinningPalette(pose.BoneTransforms.data(), pose.BoneTransforms.data(), 0, BindPoses, palette.data(), BindPoses.Size() );
+
+			std::vector<tt::Vector3> positions;
+			SkinVertices(Streams, palette, positions);
+			mesh = BindMesh;
+			memcpy(mesh.Vertices.data(), &positions[0].x, positions.size() * sizeof(tt::Vector3) );
+		}
+	};
+
+	//Random rays towards the middle of the mesh
+	std::vector<Ray> MakeRays(const TestMesh& mesh, unsigned int nrOfRays, std::mt19937& random)
+	{
+		tt::Vector3 center;
+		float radius;
+		GetBounds(mesh, center, radius);
+
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::vector<Ray> rays;
+		for(unsigned int i = 0; i < nrOfRays; ++i){
+			tt::Vector3 origin = center + tt::Vector3::Normalize(tt::Vector3(unit(random), unit(random), unit(random) ) ) * radius * 2.0f;
+			tt::Vector3 target = center + tt::Vector3(unit(random), unit(random), unit(random) ) * radius * 0.5f;
+			rays.push_back(Ray(origin, tt::Vector3::Normalize(target - origin) ) );
+		}
+
+		return rays;
+	}
+
+	//True if the hit is the closest one of the ray with the mesh, or both missed it
+	bool IsClosestHit(const TestMesh& mesh, const Ray& ray, bool bHit, const RayHit& hit)
+	{
+		double distance;
+		unsigned int triangle = 0;
+		bool bExpected = IntersectBruteForce(mesh, ray, FLT_MAX, distance, triangle);
+		return bHit == bExpected && (!bHit || fabs(hit.Distance - distance) <= 1e-4 * max(1.0, distance) );
+	}
+}
+
+TT_TEST(BVH, GoblinMatchesBruteForce)
+{
+	SourceMesh source;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+	TestMesh mesh;
+	WeldSourceMesh(source, mesh);
+
+	MeshBVH bvh;
+	TT_CHECK(bvh.IsEmpty() );
+	bvh.Build(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride);
+	TT_CHECK(!bvh.IsEmpty() && bvh.GetNrOfNodes() > 1);
+
+	std::mt19937 random(3);
+	CheckAgainstBruteForce(bvh, mesh, 3000, random);
+}
+
+TT_TEST(BVH, RefitMatchesBruteForce)
+{
+	SourceMesh source;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+	TestMesh mesh;
+	WeldSourceMesh(source, mesh);
+
+	MeshBVH bvh;
+	bvh.Build(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride);
+
+	//Bend and stretch the goblin, then refit the tree built for its bind pose
+	for(unsigned int i = 0; i < mesh.NrOfVertices; ++i){
+		float* pPosition = &mesh.Vertices[i * mesh.Stride / sizeof(float)];
+		pPosition[0] += sinf(pPosition[1] * 0.1f) * 5.0f;
+		pPosition[2] *= 1.3f;
+	}
+	bvh.Refit(mesh.GetPositions(), mesh.Stride);
+
+	std::mt19937 random(4);
+	CheckAgainstBruteForce(bvh, mesh, 3000, random);
+}
+
+TT_TEST(BVH, TerrainMatchesBruteForce)
+{
+	std::mt19937 random(5);
+	TestMesh mesh;
+	MakeTerrain(200, mesh, random);
+
+	MeshBVH bvh;
+	bvh.Build(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride);
+	TT_CHECK(bvh.GetDepth() < 64);
+	CheckAgainstBruteForce(bvh, mesh, 300, random);
+}
+
+TT_TEST(BVH, EmptyMesh)
+{
+	MeshBVH bvh;
+	bvh.Build(nullptr, 0, nullptr, sizeof(float) * 3);
+	TT_CHECK(bvh.IsEmpty() );
+
+	RayHit hit;
+	TT_CHECK(!bvh.Intersect(Ray(tt::Vector3(0, 0, -1), tt::Vector3(0, 0, 1) ), FLT_MAX, hit) );
+}
+
+TT_TEST(BVH, SkinnedBVHFollowsPose)
+{
+	SkinnedGoblin goblin;
+	SkinnedBVH skinnedBVH;
+	std::mt19937 random(6);
+
+	//Every pose is hit where the skinned mesh is, queries of the same pose reuse its tree
+	std::vector<tt::DualQuaternion> palette;
+	TestMesh mesh;
+	for(unsigned int pose = 0; pose < 3; ++pose){
+		goblin.GetPose(pose * 20, palette, mesh);
+		std::vector<Ray> rays = MakeRays(mesh, 1000, random);
+		unsigned int nrOfHits = 0, nrOfMismatches = 0;
+		for(auto& ray : rays){
+			RayHit hit;
+			bool bHit = skinnedBVH.Intersect(goblin.BindBVH, goblin.Streams, palette, pose, ray, FLT_MAX, hit);
+			nrOfHits += bHit;
+			nrOfMismatches += !IsClosestHit(mesh, ray, bHit, hit);
+		}
+
+		TT_CHECK(nrOfHits > rays.size() / 4);
+		TT_CHECK(nrOfMismatches <= 1);
+	}
+}
+
+TT_TEST(BVH, SkinnedBVHSkinsFailedPoseOnce)
+{
+	SkinnedGoblin goblin;
+	SkinnedBVH skinnedBVH;
+	std::mt19937 random(7);
+
+	std::vector<tt::DualQuaternion> palette;
+	TestMesh mesh;
+	goblin.GetPose(40, palette, mesh);
+	std::vector<Ray> rays = MakeRays(mesh, 300, random);
+
+	//A palette that lacks bones can't be skinned, queries of that pose use the bind pose
+	std::vector<tt::DualQuaternion> shortPalette(1, tt::DualQuaternion::Identity);
+	RayHit hit;
+	for(auto& ray : rays)
+		TT_CHECK(IsClosestHit(goblin.BindMesh, ray, skinnedBVH.Intersect(goblin.BindBVH, goblin.Streams, shortPalette, 1, ray, FLT_MAX, hit), hit) );
+
+	//The failed pose isn't skinned again, whatever the palette, until the serial changes
+	unsigned int nrOfBindHits = 0, nrOfPoseHits = 0;
+	for(auto& ray : rays)
+		nrOfBindHits += IsClosestHit(goblin.BindMesh, ray, skinnedBVH.Intersect(goblin.BindBVH, goblin.Streams, palette, 1, ray, FLT_MAX, hit), hit);
+	for(auto& ray : rays)
+		nrOfPoseHits += IsClosestHit(mesh, ray, skinnedBVH.Intersect(goblin.BindBVH, goblin.Streams, palette, 2, ray, FLT_MAX, hit), hit);
+	TT_CHECK(nrOfBindHits >= rays.size() - 1);
+	TT_CHECK(nrOfPoseHits >= rays.size() - 1);
+
+	//The pose differs from the bind pose, or the above would prove nothing
+	unsigned int nrOfDifferences = 0;
+	for(auto& ray : rays){
+		bool bHit = goblin.BindBVH.Intersect(ray, FLT_MAX, hit);
+		nrOfDifferences += !IsClosestHit(mesh, ray, bHit, hit);
+	}
+	TT_CHECK(nrOfDifferences > rays.size() / 10);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+//Benchmark registry for the headless build, the counterpart of TestFramework.h. BenchmarkMain.cpp runs the benchmarks of
+//the suites named on the command line (all of them without arguments), each prints its own timings through ReportTiming.
+//Benchmarks are built but not run by ctest, timings only mean something on a quiet machine.
+
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+struct BenchmarkCase
+{
+	const char* Suite;
+	const char* Name;
+	void (*Run)(void);
+};
+
+std::vector<BenchmarkCase>& GetBenchmarkCases(void);
+
+struct BenchmarkRegistrar
+{
+	BenchmarkRegistrar(const char* suite, const char* name, void (*run)(void));
+};
+
+#define TT_BENCHMARK(suite, name) \
+	static void suite##_##name(void); \
+	static BenchmarkRegistrar suite##_##name##_Registrar(#suite, #name, suite##_##name); \
+	static void suite##_##name(void)
+
+//Best time out of nrOfRuns calls to function, in milliseconds
+template<typename Function>
+double MeasureMilliseconds(Function function, unsigned int nrOfRuns = 5)
+{
+	double best = 0.0;
+	for(unsigned int i = 0; i < nrOfRuns; ++i){
+		auto start = std::chrono::high_resolution_clock::now();
+		function();
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		if(i == 0 || elapsed < best)
+			best = elapsed;
+	}
+
+	return best;
+}
+
+//Prints one line: the label, the time and the time per item if nrOfItems is not 0
+void ReportTiming(const char* label, double milliseconds, unsigned int nrOfItems = 0, const char* itemName = "item");
+
+//Keeps the optimizer from dropping work whose result is otherwise unused
+void DoNotOptimize(const void* p);
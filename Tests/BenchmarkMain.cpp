@@ -0,0 +1,69 @@
+#include "BenchmarkFramework.h"
+#include <cstring>
+
+namespace
+{
+	volatile const void* g_pSink = nullptr;
+
+	bool IsSelected(const BenchmarkCase& benchmark, int argc, char** argv)
+	{
+		if(argc < 2)
+			return true;
+
+		for(int i = 1; i < argc; ++i)
+			if(strcmp(argv[i], benchmark.Suite) == 0)
+				return true;
+
+		return false;
+	}
+}
+
+std::vector<BenchmarkCase>& GetBenchmarkCases(void)
+{
+	static std::vector<BenchmarkCase> benchmarks;
+	return benchmarks;
+}
+
+BenchmarkRegistrar::BenchmarkRegistrar(const char* suite, const char* name, void (*run)(void))
+{
+	BenchmarkCase benchmark = {suite, name, run};
+	GetBenchmarkCases().push_back(benchmark);
+}
+
+void ReportTiming(const char* label, double milliseconds, unsigned int nrOfItems, const char* itemName)
+{
+	if(nrOfItems == 0)
+		printf("  %-40s %10.3f ms\n", label, milliseconds);
+	else
+		printf("  %-40s %10.3f ms %10.1f ns/%s\n", label, milliseconds, milliseconds * 1e6 / nrOfItems, itemName);
+}
+
+void DoNotOptimize(const void* p)
+{
+	g_pSink = p;
+}
+
+int main(int argc, char** argv)
+{
+#ifdef TT_NO_SIMD
+	printf("Scalar build (TT_NO_SIMD)\n");
+#else
+	printf("SIMD build\n");
+#endif
+
+	for(auto& benchmark : GetBenchmarkCases() ){
+		if(!IsSelected(benchmark, argc, argv) )
+			continue;
+
+		printf("%s.%s\n", benchmark.Suite, benchmark.Name);
+		try{
+			benchmark.Run();
+		}
+		catch(std::exception& e){
+			printf("  failed: %s\n", e.what() );
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,272 @@
+#include "TestFramework.h"
+#include "../Graphics/ClipBounds.h"
+#include "AnimationFixtures.h"
+#include "MeshFixtures.h"
+
+using namespace tt;
+
+//ClipBounds has to contain every pose playback can produce: the tests sample each clip far more densely than it has keys,
+//the way MeshAnimator plays it, uncompressed and compressed.
+
+namespace
+{
+	const unsigned int NR_OF_BONES = 30;
+	const unsigned int SEGMENT_KEYS = 8;
+
+	std::mt19937 g_Random(13);
+
+	//A column of vertices along the y axis, each weighted half to the bone at its height and half to the next
+	SkinningStreams MakeColumn(unsigned int nrOfVertices)
+	{
+		std::uniform_real_distribution<float> side(-0.2f, 0.2f), height(0.0f, 3.0f);
+		SkinningStreams streams;
+		streams.Resize(nrOfVertices, false);
+		streams.NrOfBones = NR_OF_BONES;
+		for(unsigned int v = 0; v < nrOfVertices; ++v){
+			streams.PosX[v] = side(g_Random);
+			streams.PosY[v] = height(g_Random);
+			streams.PosZ[v] = side(g_Random);
+
+			unsigned int bone = std::min(NR_OF_BONES - 1, (unsigned int)(streams.PosY[v] * 10) );
+			for(unsigned int i = 0; i < SkinningStreams::MAX_INFLUENCES; ++i){
+				streams.BoneIndices[i][v] = (unsigned short)std::min(NR_OF_BONES - 1, bone + i);
+				streams.Weights[i][v] = i < 2 ? 0.5f : 0.0f;
+			}
+		}
+
+		return streams;
+	}
+
+	std::vector<Bone> MakeChain(bool bHierarchy)
+	{
+		std::vector<Bone> skeleton(NR_OF_BONES);
+		for(unsigned int b = 0; b < NR_OF_BONES; ++b){
+			skeleton[b].BindPose = DualQuaternion(Quaternion::Identity, Vector3(0, b * 0.1f, 0) );
+			skeleton[b].Parent = bHierarchy && b > 0 ? b - 1 : Bone::NO_PARENT;
+		}
+
+		return skeleton;
+	}
+
+	//Every bone swings around the x axis, ten ticks per key. With a hierarchy the keys are relative to the parent bone.
+	AnimationClip MakeSwingClip(unsigned int nrOfKeys, bool bHierarchy)
+	{
+		std::uniform_real_distribution<float> tilt(-0.3f, 0.3f);
+		AnimationClip clip;
+		clip.KeysPerSecond = 30;
+		clip.Keys.resize(nrOfKeys);
+		for(unsigned int k = 0; k < nrOfKeys; ++k){
+			clip.Keys[k].KeyTime = k * 10.0f;
+			for(unsigned int b = 0; b < NR_OF_BONES; ++b){
+				float angle = sinf(k * 0.4f + b * 0.2f) * (bHierarchy ? 0.1f : 1.2f);
+				Quaternion rotation(Vector3(1, 0, tilt(g_Random) ).Normalize(), angle);
+				Vector3 position = bHierarchy ? Vector3(0, b > 0 ? 0.1f : 0.0f, 0) : Vector3(sinf(k * 0.3f), b * 0.1f, 0);
+				clip.Keys[k].BoneTransforms.push_back(DualQuaternion(rotation, position) );
+			}
+		}
+
+		return clip;
+	}
+
+	//Largest distance of a vertex outside the box
+	float GetExcess(const AABBox& box, const std::vector<Vector3>& positions)
+	{
+		float excess = 0.0f;
+		for(auto& p : positions){
+			excess = std::max(excess, std::max(box.Bounds[0].x - p.x, p.x - box.Bounds[1].x) );
+			excess = std::max(excess, std::max(box.Bounds[0].y - p.y, p.y - box.Bounds[1].y) );
+			excess = std::max(excess, std::max(box.Bounds[0].z - p.z, p.z - box.Bounds[1].z) );
+		}
+
+		return excess;
+	}
+
+	float GetVolume(const AABBox& box)
+	{
+		Vector3 size = box.Bounds[1] - box.Bounds[0];
+		return size.x * size.y * size.z;
+	}
+
+	//Plays the clip the way MeshAnimator does and checks every pose against the bounds at its tick
+	void CheckPlayback(bool bHierarchy)
+	{
+		const unsigned int nrOfKeys = 37;
+
+		std::vector<Bone> skeleton = MakeChain(bHierarchy);
+		std::vector<unsigned int> parents;
+		if(bHierarchy)
+			for(auto& bone : skeleton)
+				parents.push_back(bone.Parent);
+
+		InverseBindPoses bindPoses;
+		bindPoses.Initialize(skeleton);
+
+		SkinningStreams streams = MakeColumn(3000);
+		AnimationClip clip = MakeSwingClip(nrOfKeys, bHierarchy);
+
+		ClipBounds clipBounds;
+		clipBounds.Build(clip, streams, bindPoses, parents, SEGMENT_KEYS);
+		TT_CHECK(!clipBounds.IsEmpty() );
+		TT_CHECK(clipBounds.Segments.size() == (nrOfKeys - 1 + SEGMENT_KEYS - 1) / SEGMENT_KEYS);
+
+		std::vector<DualQuaternion> localPose(NR_OF_BONES), modelPose(NR_OF_BONES), palette(NR_OF_BONES);
+		std::vector<Vector3> positions;
+		float maxExcess = 0.0f, segmentVolume = 0.0f;
+		unsigned int nrOfSamples = 0;
+		for(float tick = 0.0f; tick < (nrOfKeys - 1) * 10.0f; tick += 0.37f, ++nrOfSamples){
+			unsigned int prevKey = (unsigned int)(tick / 10.0f);
+			float blendFactor = tick / 10.0f - prevKey;
+			const AnimationKey& prev = clip.Keys[prevKey];
+			const AnimationKey& next = clip.Keys[prevKey + 1];
+			if(bHierarchy){
+				InterpolatePalettes(prev.BoneTransforms.data(), next.BoneTransforms.data(), blendFactor, localPose.data(), NR_OF_BONES);
+				LocalToModel(localPose.data(), parents.data(), modelPose.data(), NR_OF_BONES);
+				BuildSkinningPalette(modelPose.data(), bindPoses, palette.data(), NR_OF_BONES);
+			}
+			else
+				BlendSkinningPalette(prev.BoneTransforms.data(), next.BoneTransforms.data(), blendFactor, bindPoses, palette.data(), NR_OF_BONES);
+
+			TT_CHECK(SkinVertices(streams, palette, positions) );
+			const AABBox& box = clipBounds.GetBounds(clip, tick);
+			maxExcess = std::max(maxExcess, GetExcess(box, positions) );
+			maxExcess = std::max(maxExcess, GetExcess(clipBounds.Bounds, positions) );
+			segmentVolume += GetVolume(box);
+		}
+
+		TT_CHECK(maxExcess < 1e-4f);
+
+		//Segments are what culling uses while the clip plays, they have to be tighter than the whole clip
+		TT_CHECK(segmentVolume / nrOfSamples < 0.9f * GetVolume(clipBounds.Bounds) );
+	}
+
+	//Skins the goblin over every clip, sampling a few times between keys, and checks the poses against the bounds
+	void CheckGoblinPlayback(bool bCompressed)
+	{
+		SourceMesh source;
+		ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+		TT_CHECK(!source.AnimClips.empty() );
+
+		SkinningStreams streams;
+		MakeSkinningStreams(source, streams);
+
+		unsigned int nrOfBones = source.Skeleton.size();
+		std::vector<unsigned int> parents;
+		if(source.HasBoneHierarchy() )
+			for(unsigned int b = 0; b < nrOfBones; ++b){
+				parents.push_back(source.Skeleton[b].Parent);
+				TT_CHECK(parents[b] == Bone::NO_PARENT || parents[b] < b);
+			}
+
+		InverseBindPoses bindPoses;
+		bindPoses.Initialize(source.Skeleton);
+
+		std::vector<DualQuaternion> localPose(nrOfBones), modelPose(nrOfBones), palette(nrOfBones);
+		std::vector<Vector3> positions;
+		for(auto& clip : source.AnimClips){
+			if(bCompressed)
+				TT_CHECK(clip.Compressed.Compress(clip, 0.01f, 0.01f) );
+			std::vector<unsigned int> trackCursors(clip.Compressed.GetNrOfTracks(), 0);
+
+			ClipBounds clipBounds;
+			clipBounds.Build(clip, streams, bindPoses, parents, SEGMENT_KEYS);
+			TT_CHECK(!clipBounds.IsEmpty() );
+			if(clipBounds.IsEmpty() )
+				continue;
+
+			float size = (clipBounds.Bounds.Bounds[1] - clipBounds.Bounds.Bounds[0]).Length();
+			AABBox played;
+			float maxExcess = 0.0f;
+			for(unsigned int k = 0; k + 1 < clip.Keys.size(); ++k){
+				const AnimationKey& prev = clip.Keys[k];
+				const AnimationKey& next = clip.Keys[k + 1];
+				for(unsigned int step = 0; step < 7; ++step){
+					float blendFactor = step / 7.0f;
+					float tick = prev.KeyTime + (next.KeyTime - prev.KeyTime) * blendFactor;
+					if(bCompressed)
+						clip.Compressed.Sample(tick, k, trackCursors.data(), localPose.data() );
+					else
+						InterpolatePalettes(prev.BoneTransforms.data(), next.BoneTransforms.data(), blendFactor, localPose.data(), nrOfBones);
+
+					if(parents.empty() && !bCompressed)
+						BlendSkinningPalette(prev.BoneTransforms.data(), next.BoneTransforms.data(), blendFactor, bindPoses, palette.data(), nrOfBones);
+					else{
+						if(parents.empty() )
+							modelPose = localPose;
+						else
+							LocalToModel(localPose.data(), parents.data(), modelPose.data(), nrOfBones);
+						BuildSkinningPalette(modelPose.data(), bindPoses, palette.data(), nrOfBones);
+					}
+
+					TT_CHECK(SkinVertices(streams, palette, positions) );
+					maxExcess = std::max(maxExcess, GetExcess(clipBounds.GetBounds(clip, tick), positions) );
+					maxExcess = std::max(maxExcess, GetExcess(clipBounds.Bounds, positions) );
+					for(auto& position : positions)
+						played.Include(position);
+				}
+			}
+
+			TT_CHECK(maxExcess < 1e-5f * size);
+
+			//Conservative, but not so loose that culling gains nothing. The uncompressed keys of some bones cross hemispheres
+			//every few keys, where DLB turns them all the way around and the bounds only have to stay finite.
+			float playedSize = (played.Bounds[1] - played.Bounds[0]).Length();
+			if(bCompressed)
+				TT_CHECK(size < 2.0f * playedSize);
+			else
+				TT_CHECK(size < FLT_MAX);
+		}
+	}
+}
+
+TT_TEST(Bounds, ClipBoundsContainSampledPoses)
+{
+	CheckPlayback(false);
+}
+
+TT_TEST(Bounds, ClipBoundsContainSampledPosesWithHierarchy)
+{
+	CheckPlayback(true);
+}
+
+TT_TEST(Bounds, ClipBoundsBeforeFirstKey)
+{
+	InverseBindPoses bindPoses;
+	bindPoses.Initialize(MakeChain(false) );
+	AnimationClip clip = MakeSwingClip(20, false);
+	for(auto& key : clip.Keys)
+		key.KeyTime += 5.0f;
+
+	ClipBounds clipBounds;
+	clipBounds.Build(clip, MakeColumn(100), bindPoses, std::vector<unsigned int>(), SEGMENT_KEYS);
+	TT_CHECK(&clipBounds.GetBounds(clip, 0.0f) == &clipBounds.Bounds);
+	TT_CHECK(&clipBounds.GetBounds(clip, 5.0f) == &clipBounds.Segments[0]);
+	TT_CHECK(&clipBounds.GetBounds(clip, 1000.0f) == &clipBounds.Segments.back() );
+}
+
+TT_TEST(Bounds, ClipBoundsEmptyWithoutEveryBone)
+{
+	InverseBindPoses bindPoses;
+	bindPoses.Initialize(MakeChain(false) );
+	SkinningStreams streams = MakeColumn(100);
+
+	AnimationClip clip = MakeSwingClip(10, false);
+	clip.Keys[4].BoneTransforms.pop_back();
+
+	ClipBounds clipBounds;
+	clipBounds.Build(clip, streams, bindPoses, std::vector<unsigned int>(), SEGMENT_KEYS);
+	TT_CHECK(clipBounds.IsEmpty() );
+
+	clip.Keys.clear();
+	clipBounds.Build(clip, streams, bindPoses, std::vector<unsigned int>(), SEGMENT_KEYS);
+	TT_CHECK(clipBounds.IsEmpty() );
+}
+
+TT_TEST(Bounds, GoblinClipBoundsContainSampledPoses)
+{
+	CheckGoblinPlayback(false);
+}
+
+TT_TEST(Bounds, GoblinCompressedClipBoundsContainSampledPoses)
+{
+	CheckGoblinPlayback(true);
+}
@@ -0,0 +1,56 @@
+#include "CameraFixtures.h"
+
+tt::Matrix4x4 MakeLookAt(const tt::Vector3& eye, const tt::Vector3& target)
+{
+	tt::Vector3 zAxis = tt::Vector3::Normalize(target - eye);
+	tt::Vector3 xAxis = tt::Vector3::Normalize(tt::Vector3(0, 1, 0).Cross(zAxis) );
+	tt::Vector3 yAxis = zAxis.Cross(xAxis);
+
+	return tt::Matrix4x4(xAxis.x, yAxis.x, zAxis.x, 0,
+						 xAxis.y, yAxis.y, zAxis.y, 0,
+						 xAxis.z, yAxis.z, zAxis.z, 0,
+						 -xAxis.Dot(eye), -yAxis.Dot(eye), -zAxis.Dot(eye), 1);
+}
+
+tt::Matrix4x4 MakePerspective(float fieldOfView, float aspectRatio, float nearPlane, float farPlane)
+{
+	float yScale = 1.0f / tanf(fieldOfView * 0.5f);
+	float xScale = yScale / aspectRatio;
+	float depth = farPlane / (farPlane - nearPlane);
+
+	return tt::Matrix4x4(xScale, 0, 0, 0,
+						 0, yScale, 0, 0,
+						 0, 0, depth, 1,
+						 0, 0, -nearPlane * depth, 0);
+}
+
+tt::Matrix4x4 MakeOrthographic(float width, float height, float nearPlane, float farPlane)
+{
+	return tt::Matrix4x4(2 / width, 0, 0, 0,
+						 0, 2 / height, 0, 0,
+						 0, 0, 1 / (farPlane - nearPlane), 0,
+						 0, 0, nearPlane / (nearPlane - farPlane), 1);
+}
+
+bool AreOutsideClipVolume(const tt::Matrix4x4& worldViewProjection, const tt::Vector3* pPoints, unsigned int nrOfPoints)
+{
+	const tt::Matrix4x4& m = worldViewProjection;
+	for(unsigned int plane = 0; plane < 6; ++plane){
+		bool bAllOutside = true;
+		for(unsigned int i = 0; i < nrOfPoints && bAllOutside; ++i){
+			const tt::Vector3& p = pPoints[i];
+			float x = p.x * m._11 + p.y * m._21 + p.z * m._31 + m._41;
+			float y = p.x * m._12 + p.y * m._22 + p.z * m._32 + m._42;
+			float z = p.x * m._13 + p.y * m._23 + p.z * m._33 + m._43;
+			float w = p.x * m._14 + p.y * m._24 + p.z * m._34 + m._44;
+
+			float distances[6] = {w + x, w - x, w + y, w - y, z, w - z};
+			bAllOutside = distances[plane] < -1e-4f * fabs(w) - 1e-5f;
+		}
+
+		if(bAllOutside)
+			return true;
+	}
+
+	return false;
+}
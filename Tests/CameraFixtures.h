@@ -0,0 +1,13 @@
+#pragma once
+
+//Left handed D3D cameras for the culling tests and benchmarks, and the brute force clip test they are checked against
+
+#include "../Helpers/Namespace.h"
+
+tt::Matrix4x4 MakeLookAt(const tt::Vector3& eye, const tt::Vector3& target);
+tt::Matrix4x4 MakePerspective(float fieldOfView, float aspectRatio, float nearPlane, float farPlane);
+tt::Matrix4x4 MakeOrthographic(float width, float height, float nearPlane, float farPlane);
+
+//True if all points are outside of the same plane of the clip volume of the matrix, -w <= x, y <= w and 0 <= z <= w.
+//Points on a plane count as inside, give or take a relative tolerance.
+bool AreOutsideClipVolume(const tt::Matrix4x4& worldViewProjection, const tt::Vector3* pPoints, unsigned int nrOfPoints);
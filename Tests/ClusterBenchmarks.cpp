@@ -0,0 +1,50 @@
+#include "BenchmarkFramework.h"
+#include "../Graphics/MeshClusters.h"
+#include "MeshFixtures.h"
+#include "CameraFixtures.h"
+
+TT_BENCHMARK(Clusters, CullClusters)
+{
+	//The goblin's clusters copied around a field until there are 64k of them, seen from above at an angle so about half
+	//pass the frustum. Compare TTengineBenchmarksSimd with TTengineBenchmarksNoSimd for the SSE and scalar paths.
+	const unsigned int nrOfClusters = 65536, nrOfCulls = 100;
+
+	SourceMesh source;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+	TestMesh mesh;
+	WeldSourceMesh(source, mesh);
+	ClusterStreams goblin;
+	CookTestMesh(mesh, goblin);
+
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> field(-50.0f, 50.0f);
+	ClusterStreams clusters;
+	clusters.Resize(nrOfClusters);
+	for(unsigned int i = 0; i < nrOfClusters; ++i){
+		unsigned int c = i % goblin.Size();
+		clusters.CenterX[i] = goblin.CenterX[c] + field(random);
+		clusters.CenterY[i] = goblin.CenterY[c];
+		clusters.CenterZ[i] = goblin.CenterZ[c] + field(random);
+		clusters.Radius[i] = goblin.Radius[c];
+		clusters.AxisX[i] = goblin.AxisX[c];
+		clusters.AxisY[i] = goblin.AxisY[c];
+		clusters.AxisZ[i] = goblin.AxisZ[c];
+		clusters.Cutoff[i] = goblin.Cutoff[c];
+		clusters.StartIndex[i] = i * CLUSTER_MAX_TRIANGLES * 3;
+		clusters.NrOfIndices[i] = CLUSTER_MAX_TRIANGLES * 3;
+	}
+
+	tt::Matrix4x4 view = MakeLookAt(tt::Vector3(0.0f, 30.0f, -60.0f), tt::Vector3(0.0f, 0.0f, 0.0f) );
+	ClusterCamera camera(tt::Matrix4x4::Identity, view, MakePerspective(0.8f, 1.3f, 0.1f, 200.0f), true);
+
+	std::vector<IndexRange> ranges;
+	unsigned int nrOfVisible = 0;
+	double time = MeasureMilliseconds([&]{
+		for(unsigned int i = 0; i < nrOfCulls; ++i)
+			nrOfVisible = CullClusters(clusters, camera, ranges);
+		DoNotOptimize(ranges.data() );
+	});
+
+	printf("  %u of %u clusters visible in %u ranges\n", nrOfVisible, nrOfClusters, (unsigned int)ranges.size() );
+	ReportTiming("CullClusters, 64k clusters", time, nrOfCulls, "cull");
+}
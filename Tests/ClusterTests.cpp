@@ -0,0 +1,133 @@
+#include "TestFramework.h"
+#include "../Graphics/MeshClusters.h"
+#include "MeshFixtures.h"
+#include "CameraFixtures.h"
+#include <set>
+#include <cfloat>
+
+namespace
+{
+	void LoadClusteredGoblin(TestMesh& mesh, ClusterStreams& clusters)
+	{
+		SourceMesh source;
+		ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+		WeldSourceMesh(source, mesh);
+		CookTestMesh(mesh, clusters);
+	}
+
+	//The same check CullClusters makes for back facing clusters, per triangle
+	bool IsBackFacing(const tt::Vector3* pCorners, const ClusterCamera& camera)
+	{
+		tt::Vector3 normal = (pCorners[1] - pCorners[0]).Cross(pCorners[2] - pCorners[0]);
+		if(normal.LengthSq() == 0.0f)
+			return true;
+
+		for(unsigned int i = 0; i < 3; ++i){
+			float facing = camera.bOrthographic ? camera.Position.Dot(normal) : (pCorners[i] - camera.Position).Dot(normal);
+			if(facing <= 0.0f)
+				return false;
+		}
+
+		return true;
+	}
+}
+
+TT_TEST(Clusters, GoblinClustersCoverTheMesh)
+{
+	TestMesh mesh;
+	ClusterStreams clusters;
+	LoadClusteredGoblin(mesh, clusters);
+	TT_CHECK(clusters.Size() >= mesh.GetNrOfTriangles() / CLUSTER_MAX_TRIANGLES);
+
+	//Consecutive index ranges within the size limits, each inside its bounding sphere
+	unsigned int nextIndex = 0;
+	for(unsigned int c = 0; c < clusters.Size(); ++c){
+		TT_CHECK(clusters.StartIndex[c] == nextIndex);
+		TT_CHECK(clusters.NrOfIndices[c] > 0 && clusters.NrOfIndices[c] / 3 <= CLUSTER_MAX_TRIANGLES);
+		nextIndex += clusters.NrOfIndices[c];
+
+		auto pFirst = mesh.Indices.begin() + clusters.StartIndex[c];
+		std::set<unsigned int> vertices(pFirst, pFirst + clusters.NrOfIndices[c]);
+		TT_CHECK(vertices.size() <= CLUSTER_MAX_VERTICES);
+
+		tt::Vector3 center(clusters.CenterX[c], clusters.CenterY[c], clusters.CenterZ[c]);
+		for(auto vertex : vertices)
+			TT_CHECK( (mesh.GetPosition(vertex) - center).Length() <= clusters.Radius[c] * 1.0001f + 1e-6f);
+
+		//Triangle normals are within the cone
+		tt::Vector3 axis(clusters.AxisX[c], clusters.AxisY[c], clusters.AxisZ[c]);
+		for(unsigned int i = clusters.StartIndex[c]; clusters.Cutoff[c] <= 1.0f && i < nextIndex; i += 3){
+			tt::Vector3 normal = (mesh.GetPosition(mesh.Indices[i + 1]) - mesh.GetPosition(mesh.Indices[i]) ).Cross(
+								  mesh.GetPosition(mesh.Indices[i + 2]) - mesh.GetPosition(mesh.Indices[i]) );
+			if(normal.LengthSq() > 0.0f)
+				TT_CHECK(tt::Vector3::Normalize(normal).Dot(axis) >= sqrtf(1.0f - clusters.Cutoff[c] * clusters.Cutoff[c]) - 1e-4f);
+		}
+	}
+	TT_CHECK(nextIndex == mesh.Indices.size() );
+}
+
+TT_TEST(Clusters, CullingIsConservative)
+{
+	//No cluster with a triangle in view is culled, from cameras inside, around and far from the goblin. Every other camera
+	//culls back faces, every third one is orthographic.
+	TestMesh mesh;
+	ClusterStreams clusters;
+	LoadClusteredGoblin(mesh, clusters);
+
+	tt::Vector3 minimum(FLT_MAX, FLT_MAX, FLT_MAX), maximum(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for(unsigned int i = 0; i < mesh.NrOfVertices; ++i){
+		tt::Vector3 position = mesh.GetPosition(i);
+		minimum = tt::Vector3(min(minimum.x, position.x), min(minimum.y, position.y), min(minimum.z, position.z) );
+		maximum = tt::Vector3(max(maximum.x, position.x), max(maximum.y, position.y), max(maximum.z, position.z) );
+	}
+	tt::Vector3 center = (minimum + maximum) * 0.5f;
+	float radius = (maximum - minimum).Length() * 0.5f;
+
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<IndexRange> ranges;
+	unsigned int nrOfVisibleClusters = 0, nrOfCameras = 300;
+	for(unsigned int camera = 0; camera < nrOfCameras; ++camera){
+		bool bOrthographic = camera % 3 == 2, bCullBackfaces = camera % 2 == 1;
+		tt::Vector3 direction = tt::Vector3::Normalize(tt::Vector3(unit(random), unit(random), unit(random) ) );
+		tt::Vector3 eye = center + direction * radius * (0.6f + 2.0f * fabs(unit(random) ) );
+		tt::Vector3 target = center + tt::Vector3(unit(random), unit(random), unit(random) ) * radius * 0.8f;
+
+		float scale = 1.0f + fabs(unit(random) );
+		tt::Matrix4x4 world = tt::Matrix4x4::Scale(scale) * tt::Matrix4x4::Translation(tt::Vector3(unit(random), unit(random), unit(random) ) );
+		tt::Matrix4x4 view = MakeLookAt(eye.TransformPoint(world), target.TransformPoint(world) );
+		tt::Matrix4x4 projection = bOrthographic ? MakeOrthographic(radius * scale, radius * scale, 0.1f, radius * scale * 10)
+												 : MakePerspective(0.6f, 1.3f, 0.1f * radius, radius * 10);
+		ClusterCamera clusterCamera(world, view, projection, bCullBackfaces);
+
+		unsigned int nrOfVisible = CullClusters(clusters, clusterCamera, ranges);
+		nrOfVisibleClusters += nrOfVisible;
+
+		//Ranges are sorted, apart and hold exactly the visible clusters
+		std::vector<bool> visible(clusters.Size(), false);
+		unsigned int nrInRanges = 0;
+		for(unsigned int r = 0; r < ranges.size(); ++r){
+			TT_CHECK(r == 0 || ranges[r - 1].StartIndex + ranges[r - 1].NrOfIndices < ranges[r].StartIndex);
+			for(unsigned int c = 0; c < clusters.Size(); ++c)
+				if(clusters.StartIndex[c] >= ranges[r].StartIndex && clusters.StartIndex[c] < ranges[r].StartIndex + ranges[r].NrOfIndices){
+					visible[c] = true;
+					++nrInRanges;
+				}
+		}
+		TT_CHECK(nrInRanges == nrOfVisible);
+
+		tt::Matrix4x4 worldViewProjection = world * view * projection;
+		for(unsigned int c = 0; c < clusters.Size(); ++c){
+			if(visible[c])
+				continue;
+
+			for(unsigned int i = clusters.StartIndex[c]; i < clusters.StartIndex[c] + clusters.NrOfIndices[c]; i += 3){
+				tt::Vector3 corners[3] = {mesh.GetPosition(mesh.Indices[i]), mesh.GetPosition(mesh.Indices[i + 1]), mesh.GetPosition(mesh.Indices[i + 2])};
+				TT_CHECK(AreOutsideClipVolume(worldViewProjection, corners, 3) || (bCullBackfaces && IsBackFacing(corners, clusterCamera) ) );
+			}
+		}
+	}
+
+	//Some cameras have to see part of the goblin only, or nothing is tested
+	TT_CHECK(nrOfVisibleClusters > 0 && nrOfVisibleClusters < nrOfCameras * clusters.Size() );
+}
@@ -0,0 +1,269 @@
+#include "TestFramework.h"
+#include "MeshFixtures.h"
+#include "../Graphics/MeshCooker.h"
+#include "../Graphics/MeshOptimizer.h"
+#include "../Graphics/VertexFormat.h"
+#include "../Helpers/MappedFileReader.h"
+#include <fstream>
+#include <map>
+
+namespace
+{
+	InputLayoutElement MakeElement(InputLayoutSemantic semantic, DXGI_FORMAT format)
+	{
+		InputLayoutElement element = {};
+		element.Semantic = semantic;
+		element.Format = format;
+		return element;
+	}
+
+	//Terrain with every vertex stored twice and the triangles using either copy, so cooking has vertices to weld.
+	//Two streams: float positions with texture coordinates, and quantized positions alone. One LOD at half the triangles.
+	void MakeCookSource(const TestMesh& terrain, CookSource& source)
+	{
+		source = CookSource();
+		source.Layouts.push_back(vector<InputLayoutElement>() );
+		source.Layouts[0].push_back(MakeElement(InputLayoutSemantic::Position, DXGI_FORMAT_R32G32B32_FLOAT) );
+		source.Layouts[0].push_back(MakeElement(InputLayoutSemantic::TexCoord, DXGI_FORMAT_R32G32_FLOAT) );
+		source.Layouts.push_back(vector<InputLayoutElement>(1, MakeElement(InputLayoutSemantic::Position, DXGI_FORMAT_R16G16B16A16_FLOAT) ) );
+
+		source.NrOfVertices = terrain.NrOfVertices * 2;
+		source.Vertices.resize(2);
+		for(unsigned int copy = 0; copy < 2; ++copy){
+			for(unsigned int i = 0; i < terrain.NrOfVertices; ++i){
+				const float* pPosition = &terrain.Vertices[i * 3];
+				float vertex[5] = {pPosition[0], pPosition[1], pPosition[2], pPosition[0] * 0.1f, pPosition[2] * 0.1f};
+				auto pBytes = reinterpret_cast<const char*>(vertex);
+				source.Vertices[0].insert(source.Vertices[0].end(), pBytes, pBytes + sizeof(vertex) );
+
+				char quantized[8];
+				ConvertVertexElement(InputLayoutSemantic::Position, DXGI_FORMAT_R32G32B32_FLOAT, pPosition, DXGI_FORMAT_R16G16B16A16_FLOAT, quantized);
+				source.Vertices[1].insert(source.Vertices[1].end(), quantized, quantized + sizeof(quantized) );
+
+				source.Positions.insert(source.Positions.end(), pPosition, pPosition + 3);
+			}
+		}
+
+		source.Indices = terrain.Indices;
+		for(unsigned int i = 0; i < source.Indices.size(); ++i)
+			source.Indices[i] += (i % 7 == 0) ? terrain.NrOfVertices : 0;
+
+		float lodError = SimplifyMesh(terrain.Indices.data(), terrain.Indices.size(), terrain.GetPositions(), terrain.Stride, terrain.NrOfVertices
+									 ,terrain.Indices.size() / 2, 1e10f, source.LODIndices);
+		for(unsigned int i = 0; i < source.LODIndices.size(); ++i)
+			source.LODIndices[i] += (i % 5 == 0) ? terrain.NrOfVertices : 0;
+
+		CookedMeshLOD lod = {static_cast<unsigned int>(source.Indices.size() ), static_cast<unsigned int>(source.LODIndices.size() ), 0, lodError};
+		source.LODs.push_back(lod);
+
+		source.Bounds[0] = tt::Vector3(-1, -2, -3);
+		source.Bounds[1] = tt::Vector3(4, 5, 6);
+	}
+
+	//Terrain vertex each cooked vertex holds, found by its position
+	vector<unsigned int> MapCookedVertices(const TestMesh& terrain, const CookedMesh& mesh)
+	{
+		std::map<std::array<float, 3>, unsigned int> terrainVertices;
+		for(unsigned int i = 0; i < terrain.NrOfVertices; ++i){
+			std::array<float, 3> position = {{terrain.Vertices[i * 3], terrain.Vertices[i * 3 + 1], terrain.Vertices[i * 3 + 2]}};
+			terrainVertices[position] = i;
+		}
+
+		vector<unsigned int> map(mesh.NrOfVertices, UNUSED_VERTEX);
+		const CookedStream& stream = mesh.Streams[0];
+		for(unsigned int i = 0; i < mesh.NrOfVertices; ++i){
+			std::array<float, 3> position;
+			memcpy(position.data(), &stream.Data[i * stream.Stride], sizeof(float) * 3);
+			auto it = terrainVertices.find(position);
+			if(it != terrainVertices.end() )
+				map[i] = it->second;
+		}
+
+		return map;
+	}
+
+	//Triangles of cooked indices in terms of the terrain's vertices, sorted to compare them regardless of order
+	std::vector<std::array<unsigned int, 3> > GetTerrainTriangles(const unsigned int* pIndices, unsigned int nrOfIndices, const vector<unsigned int>& map)
+	{
+		vector<unsigned int> indices(pIndices, pIndices + nrOfIndices);
+		for(auto& index : indices)
+			index = map[index];
+
+		return GetSortedTriangles(indices.data(), indices.size() );
+	}
+}
+
+TT_TEST(Cooker, CookingKeepsTheTrianglesAndVertexData)
+{
+	std::mt19937 random(41);
+	TestMesh terrain;
+	MakeTerrain(40, terrain, random);
+	ShuffleTriangles(terrain, 7);
+
+	CookSource source;
+	MakeCookSource(terrain, source);
+	CookedMesh mesh;
+	CookReport report;
+	CookMesh(source, mesh, report);
+
+	//The copies are welded back together, every terrain vertex is used
+	TT_CHECK(mesh.NrOfVertices == terrain.NrOfVertices);
+	TT_CHECK(report.NrOfSourceVertices == source.NrOfVertices && report.NrOfVertices == mesh.NrOfVertices);
+	TT_CHECK(report.CookedACMR < report.SourceACMR);
+	TT_CHECK(report.NrOfClusters > 0 && report.NrOfClusters == mesh.Clusters.Size() );
+	TT_CHECK(mesh.Bounds[0].x == -1 && mesh.Bounds[1].z == 6);
+
+	TT_CHECK(mesh.Streams.size() == 2);
+	TT_CHECK(mesh.Streams[0].Stride == 20 && mesh.Streams[1].Stride == 8);
+	TT_CHECK(mesh.Streams[0].Elements.size() == 2 && mesh.Streams[0].Elements[1].Offset == 12);
+	TT_CHECK(mesh.Streams[1].Elements[0].Format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+
+	//Every cooked vertex holds the data of one terrain vertex in both streams
+	vector<unsigned int> map = MapCookedVertices(terrain, mesh);
+	for(unsigned int i = 0; i < mesh.NrOfVertices; ++i){
+		TT_CHECK(map[i] != UNUSED_VERTEX);
+		if(map[i] == UNUSED_VERTEX)
+			continue;
+
+		for(unsigned int stream = 0; stream < 2; ++stream){
+			unsigned int stride = mesh.Streams[stream].Stride;
+			TT_CHECK(memcmp(&mesh.Streams[stream].Data[i * stride], &source.Vertices[stream][map[i] * stride], stride) == 0);
+		}
+	}
+
+	//Same triangles, in another order, for the full mesh and the LOD
+	TT_CHECK(mesh.Indices.size() == terrain.Indices.size() );
+	TT_CHECK(GetTerrainTriangles(mesh.Indices.data(), mesh.Indices.size(), map) == GetSortedTriangles(terrain.Indices.data(), terrain.Indices.size() ) );
+
+	TT_CHECK(mesh.LODs.size() == 1);
+	const CookedMeshLOD& lod = mesh.LODs[0];
+	TT_CHECK(lod.StartIndex == mesh.Indices.size() && lod.NrOfIndices == mesh.LODIndices.size() && lod.Error == source.LODs[0].Error);
+	vector<unsigned int> lodIndices(source.LODIndices);
+	for(auto& index : lodIndices)
+		index %= terrain.NrOfVertices;
+	TT_CHECK(lod.NrOfVertices == CountUsedVertices(lodIndices.data(), lodIndices.size(), terrain.NrOfVertices) );
+	TT_CHECK(GetTerrainTriangles(mesh.LODIndices.data(), mesh.LODIndices.size(), map) == GetSortedTriangles(lodIndices.data(), lodIndices.size() ) );
+
+	//Clusters follow each other through the whole index buffer
+	unsigned int nextIndex = 0;
+	for(unsigned int i = 0; i < mesh.Clusters.Size(); ++i){
+		TT_CHECK(mesh.Clusters.StartIndex[i] == nextIndex);
+		nextIndex += mesh.Clusters.NrOfIndices[i];
+	}
+	TT_CHECK(nextIndex == mesh.Indices.size() );
+}
+
+TT_TEST(Cooker, CookedFilesReadBackUnchanged)
+{
+	std::mt19937 random(5);
+	TestMesh terrain;
+	MakeTerrain(40, terrain, random);
+
+	CookSource source;
+	MakeCookSource(terrain, source);
+	CookedMesh mesh;
+	CookReport report;
+	CookMesh(source, mesh, report);
+
+	vector<char> file;
+	WriteCookedMesh(mesh, file);
+	const std::string filePath = "CookerRoundTrip.ttmesh";
+	{
+		std::ofstream outFile(filePath, std::ios::binary);
+		outFile.write(file.data(), file.size() );
+	}
+
+	CookedMesh loaded;
+	{
+		MappedFileReader meshFile(filePath);
+		TT_CHECK(meshFile.IsOpen() );
+		ReadCookedMesh(meshFile, loaded);
+	}
+	remove(filePath.c_str() );
+
+	TT_CHECK(memcmp(loaded.Bounds, mesh.Bounds, sizeof(mesh.Bounds) ) == 0);
+	TT_CHECK(loaded.NrOfVertices == mesh.NrOfVertices);
+	TT_CHECK(loaded.Indices == mesh.Indices);
+	TT_CHECK(loaded.LODIndices == mesh.LODIndices);
+
+	TT_CHECK(loaded.Streams.size() == mesh.Streams.size() );
+	for(unsigned int i = 0; i < loaded.Streams.size() && i < mesh.Streams.size(); ++i){
+		const CookedStream& stream = loaded.Streams[i];
+		TT_CHECK(stream.Stride == mesh.Streams[i].Stride);
+		TT_CHECK(stream.Data == mesh.Streams[i].Data);
+		TT_CHECK(stream.Elements.size() == mesh.Streams[i].Elements.size() );
+		if(stream.Elements.size() == mesh.Streams[i].Elements.size() )
+			TT_CHECK(memcmp(stream.Elements.data(), mesh.Streams[i].Elements.data(), stream.Elements.size() * sizeof(CookedStreamElement) ) == 0);
+	}
+
+	TT_CHECK(loaded.LODs.size() == mesh.LODs.size() );
+	if(loaded.LODs.size() == mesh.LODs.size() )
+		TT_CHECK(memcmp(loaded.LODs.data(), mesh.LODs.data(), mesh.LODs.size() * sizeof(CookedMeshLOD) ) == 0);
+
+	const ClusterStreams& clusters = loaded.Clusters;
+	TT_CHECK(clusters.Size() > 0);
+	TT_CHECK(clusters.CenterX == mesh.Clusters.CenterX && clusters.CenterY == mesh.Clusters.CenterY && clusters.CenterZ == mesh.Clusters.CenterZ);
+	TT_CHECK(clusters.Radius == mesh.Clusters.Radius && clusters.Cutoff == mesh.Clusters.Cutoff);
+	TT_CHECK(clusters.AxisX == mesh.Clusters.AxisX && clusters.AxisY == mesh.Clusters.AxisY && clusters.AxisZ == mesh.Clusters.AxisZ);
+	TT_CHECK(clusters.StartIndex == mesh.Clusters.StartIndex && clusters.NrOfIndices == mesh.Clusters.NrOfIndices);
+}
+
+TT_TEST(Cooker, TruncatedFilesThrow)
+{
+	TestMesh grid;
+	MakeGrid(8, grid);
+
+	CookSource source;
+	MakeCookSource(grid, source);
+	CookedMesh mesh;
+	CookReport report;
+	CookMesh(source, mesh, report);
+
+	vector<char> file;
+	WriteCookedMesh(mesh, file);
+	const std::string filePath = "CookerTruncated.ttmesh";
+	{
+		std::ofstream outFile(filePath, std::ios::binary);
+		outFile.write(file.data(), file.size() - COOKED_MESH_ALIGNMENT);
+	}
+
+	bool bThrown = false;
+	try{
+		MappedFileReader meshFile(filePath);
+		CookedMesh loaded;
+		ReadCookedMesh(meshFile, loaded);
+	}
+	catch(const std::exception&){
+		bThrown = true;
+	}
+	remove(filePath.c_str() );
+	TT_CHECK(bThrown);
+}
+
+TT_TEST(Cooker, GatherRefusesAnimationData)
+{
+	SourceMesh mesh;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), mesh);
+
+	CookSource source;
+	TT_CHECK(!GatherCookSource(mesh, source) );
+
+	mesh.Skeleton.clear();
+	mesh.AnimClips.clear();
+	mesh.BlendIndices = SourceAttribute<D3DXVECTOR4>();
+	mesh.BlendWeights = SourceAttribute<D3DXVECTOR4>();
+	TT_CHECK(GatherCookSource(mesh, source) );
+
+	//One stream with position, texture coordinates and normals in their source formats
+	TT_CHECK(source.Layouts.size() == 1 && source.Vertices.size() == 1);
+	TT_CHECK(source.Layouts[0].size() >= 3 && source.Layouts[0][0].Semantic == InputLayoutSemantic::Position);
+	unsigned int stride = GetLayoutStride(source.Layouts[0]);
+	TT_CHECK(source.NrOfVertices == mesh.GetNrOfVertices() && source.Vertices[0].size() == source.NrOfVertices * stride);
+	TT_CHECK(source.Positions.size() == source.NrOfVertices * 3 && source.Indices == mesh.Indices);
+
+	for(unsigned int i = 0; i < source.NrOfVertices; ++i){
+		const D3DXVECTOR3& position = mesh.Positions.Data[mesh.Positions.Indices[i] ];
+		TT_CHECK(memcmp(&source.Vertices[0][i * stride], &position, sizeof(float) * 3) == 0);
+		TT_CHECK(memcmp(&source.Positions[i * 3], &position, sizeof(float) * 3) == 0);
+	}
+}
@@ -0,0 +1,77 @@
+#include "BenchmarkFramework.h"
+#include "../Graphics/Frustum.h"
+#include "../Graphics/BoundingVolumes.h"
+#include "CameraFixtures.h"
+#include <random>
+
+namespace
+{
+	//The per model test ModelComponent::Cull made before the scene culled all models at once: 8 transformed corners, then
+	//the 4 frustum edges traced through the box. True if culled.
+	bool CullPerModel(const AABBox& box, const tt::Matrix4x4& worldViewProjection)
+	{
+		tt::Vector3 vertices[8];
+		box.GetVertices(vertices, worldViewProjection);
+		for(unsigned int i = 0; i < 8; ++i)
+			if(vertices[i].x >= -1 && vertices[i].x <= 1 && vertices[i].y >= -1 && vertices[i].y <= 1 && vertices[i].z >= 0 && vertices[i].z <= 1)
+				return false;
+
+		tt::Matrix4x4 inverse = worldViewProjection.Inverse();
+		tt::Vector3 edges[] = {	tt::Vector3(-1, -1, 0), tt::Vector3(-1, 1, 0), tt::Vector3(1, -1, 0), tt::Vector3(1, 1, 0),
+								tt::Vector3(-1, -1, 1), tt::Vector3(-1, 1, 1), tt::Vector3(1, -1, 1), tt::Vector3(1, 1, 1) };
+		tt::Vector3::TransformPoints(inverse, edges, edges, 8);
+
+		Ray edgeRays[] = {	Ray(edges[0], edges[4] - edges[0]), Ray(edges[1], edges[5] - edges[1]),
+							Ray(edges[2], edges[6] - edges[2]), Ray(edges[3], edges[7] - edges[3]) };
+		return IntersectRayPacket(RayPacket(edgeRays, 4, 0, 1), box) == 0;
+	}
+}
+
+TT_BENCHMARK(Frustum, CullModels)
+{
+	//10k models scattered over a field, seen from one side
+	const unsigned int nrOfModels = 10000, nrOfFrames = 100;
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	AABBox localBox;
+	localBox.Bounds[0] = tt::Vector3(-1.0f, -2.0f, -1.0f);
+	localBox.Bounds[1] = tt::Vector3(1.0f, 2.0f, 1.0f);
+	std::vector<tt::Matrix4x4> worlds(nrOfModels);
+	AABBoxStreams worldBoxes;
+	worldBoxes.Resize(nrOfModels);
+	for(unsigned int i = 0; i < nrOfModels; ++i){
+		tt::Vector3 position(unit(random) * 200.0f, unit(random) * 5.0f, unit(random) * 200.0f);
+		worlds[i] = tt::Matrix4x4::Translation(position);
+
+		AABBox worldBox;
+		worldBox.Bounds[0] = localBox.Bounds[0] + position;
+		worldBox.Bounds[1] = localBox.Bounds[1] + position;
+		worldBoxes.Set(i, worldBox);
+	}
+
+	tt::Matrix4x4 viewProjection = MakeLookAt(tt::Vector3(0.0f, 10.0f, -150.0f), tt::Vector3(0.0f, 0.0f, 0.0f) ) * MakePerspective(0.9f, 1.6f, 0.5f, 400.0f);
+
+	unsigned int nrOfVisible = 0;
+	double perModel = MeasureMilliseconds([&]{
+		nrOfVisible = 0;
+		for(unsigned int i = 0; i < nrOfModels; ++i)
+			nrOfVisible += !CullPerModel(localBox, worlds[i] * viewProjection);
+	});
+
+	VisibilityBits visibility;
+	double batched = MeasureMilliseconds([&]{
+		for(unsigned int frame = 0; frame < nrOfFrames; ++frame){
+			Frustum frustum(viewProjection);
+			frustum.Cull(worldBoxes, visibility);
+		}
+	});
+
+	unsigned int nrOfBatchedVisible = 0;
+	for(unsigned int i = 0; i < nrOfModels; ++i)
+		nrOfBatchedVisible += visibility.IsSet(i);
+
+	printf("  %u models visible per model, %u with Frustum::Cull\n", nrOfVisible, nrOfBatchedVisible);
+	ReportTiming("Per model Cull", perModel, nrOfModels, "model");
+	ReportTiming("Frustum::Cull", batched, nrOfModels * nrOfFrames, "model");
+}
@@ -0,0 +1,146 @@
+#include "TestFramework.h"
+#include "../Graphics/Frustum.h"
+#include "../Graphics/BoundingVolumes.h"
+#include "CameraFixtures.h"
+
+namespace
+{
+	const unsigned int NR_OF_BOXES = 3001; //Not a multiple of the packet size or of 32
+
+	struct CullingScene
+	{
+		tt::Matrix4x4 ViewProjection;
+		std::vector<AABBox> Boxes;
+		AABBoxStreams Streams;
+		std::vector<float> CenterX, CenterY, CenterZ, Radius;
+	};
+
+	//A random camera over boxes of all sizes, every 10th one large and every 37th one around the camera, covering the whole
+	//frustum without a corner inside. Every 4th camera is orthographic.
+	void MakeScene(unsigned int camera, std::mt19937& random, CullingScene& scene)
+	{
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		tt::Vector3 eye(unit(random) * 50.0f, unit(random) * 20.0f, unit(random) * 50.0f);
+		tt::Vector3 target(unit(random) * 10.0f, unit(random) * 5.0f, unit(random) * 10.0f);
+		tt::Matrix4x4 projection = camera % 4 == 3 ? MakeOrthographic(60.0f, 40.0f, 0.5f, 150.0f) : MakePerspective(0.9f, 1.6f, 0.5f, 150.0f);
+		scene.ViewProjection = MakeLookAt(eye, target) * projection;
+
+		scene.Boxes.resize(NR_OF_BOXES);
+		scene.Streams.Resize(NR_OF_BOXES);
+		scene.CenterX.resize(NR_OF_BOXES);
+		scene.CenterY.resize(NR_OF_BOXES);
+		scene.CenterZ.resize(NR_OF_BOXES);
+		scene.Radius.resize(NR_OF_BOXES);
+		for(unsigned int i = 0; i < NR_OF_BOXES; ++i){
+			tt::Vector3 center(unit(random) * 120.0f, unit(random) * 60.0f, unit(random) * 120.0f);
+			tt::Vector3 extent(fabs(unit(random) ) * 4.0f, fabs(unit(random) ) * 4.0f, fabs(unit(random) ) * 4.0f);
+			if(i % 10 == 0)
+				extent = extent * 40.0f;
+			if(i % 37 == 0){
+				center = eye + tt::Vector3::Normalize(target - eye) * 20.0f;
+				extent = tt::Vector3(300.0f, 300.0f, 300.0f) + extent;
+			}
+
+			scene.Boxes[i].Bounds[0] = center - extent;
+			scene.Boxes[i].Bounds[1] = center + extent;
+			scene.Streams.Set(i, scene.Boxes[i]);
+			scene.CenterX[i] = center.x;
+			scene.CenterY[i] = center.y;
+			scene.CenterZ[i] = center.z;
+			scene.Radius[i] = extent.Length();
+		}
+	}
+
+	//Clip space test in double precision and without tolerance. AreOutsideClipVolume allows a margin relative to w, which is
+	//several units wide at the far plane of a perspective projection and would count points beyond it as inside.
+	bool IsInClipVolume(const tt::Matrix4x4& m, const tt::Vector3& p)
+	{
+		double x = (double)p.x * m._11 + (double)p.y * m._21 + (double)p.z * m._31 + m._41;
+		double y = (double)p.x * m._12 + (double)p.y * m._22 + (double)p.z * m._32 + m._42;
+		double z = (double)p.x * m._13 + (double)p.y * m._23 + (double)p.z * m._33 + m._43;
+		double w = (double)p.x * m._14 + (double)p.y * m._24 + (double)p.z * m._34 + m._44;
+		return w + x >= 0.0 && w - x >= 0.0 && w + y >= 0.0 && w - y >= 0.0 && z >= 0.0 && w - z >= 0.0;
+	}
+
+	//True if one of the points sampled in the box, or its center, is inside the clip volume
+	bool HasPointInView(const AABBox& box, const tt::Matrix4x4& viewProjection, std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		for(unsigned int i = 0; i <= 200; ++i){
+			tt::Vector3 point = (box.Bounds[0] + box.Bounds[1]) * 0.5f;
+			if(i > 0)
+				point = tt::Vector3(box.Bounds[0].x + unit(random) * (box.Bounds[1].x - box.Bounds[0].x),
+									box.Bounds[0].y + unit(random) * (box.Bounds[1].y - box.Bounds[0].y),
+									box.Bounds[0].z + unit(random) * (box.Bounds[1].z - box.Bounds[0].z) );
+			if(IsInClipVolume(viewProjection, point) )
+				return true;
+		}
+
+		return false;
+	}
+}
+
+TT_TEST(Frustum, StreamsMatchScalar)
+{
+	std::mt19937 random(11);
+	CullingScene scene;
+	unsigned int nrOfVisible = 0;
+	for(unsigned int camera = 0; camera < 60; ++camera){
+		MakeScene(camera, random, scene);
+		Frustum frustum(scene.ViewProjection);
+
+		VisibilityBits boxBits, sphereBits;
+		frustum.Cull(scene.Streams, boxBits);
+		frustum.Cull(scene.CenterX.data(), scene.CenterY.data(), scene.CenterZ.data(), scene.Radius.data(), NR_OF_BOXES, sphereBits);
+		for(unsigned int i = 0; i < NR_OF_BOXES; ++i){
+			TT_CHECK(boxBits.IsSet(i) == frustum.IsVisible(scene.Boxes[i]) );
+			TT_CHECK(sphereBits.IsSet(i) == frustum.IsVisible(tt::Vector3(scene.CenterX[i], scene.CenterY[i], scene.CenterZ[i]), scene.Radius[i]) );
+			nrOfVisible += boxBits.IsSet(i);
+		}
+
+		//No bits past the last box
+		for(auto pBits : {&boxBits, &sphereBits}){
+			TT_CHECK(pBits->Words.size() == (NR_OF_BOXES + 31) / 32);
+			TT_CHECK( (pBits->Words.back() >> (NR_OF_BOXES % 32) ) == 0);
+		}
+	}
+	TT_CHECK(nrOfVisible > 0 && nrOfVisible < 60 * NR_OF_BOXES);
+}
+
+TT_TEST(Frustum, NothingInViewIsCulled)
+{
+	std::mt19937 random(12);
+	CullingScene scene;
+	unsigned int nrOfInView = 0;
+	for(unsigned int camera = 0; camera < 60; ++camera){
+		MakeScene(camera, random, scene);
+		Frustum frustum(scene.ViewProjection);
+		for(unsigned int i = 0; i < NR_OF_BOXES; ++i){
+			if(!HasPointInView(scene.Boxes[i], scene.ViewProjection, random) )
+				continue;
+
+			++nrOfInView;
+			TT_CHECK(frustum.IsVisible(scene.Boxes[i]) );
+			TT_CHECK(frustum.IsVisible(tt::Vector3(scene.CenterX[i], scene.CenterY[i], scene.CenterZ[i]), scene.Radius[i]) );
+		}
+	}
+	TT_CHECK(nrOfInView > 0);
+}
+
+TT_TEST(Frustum, Planes)
+{
+	//Unit normals pointing inward: the middle of the view volume is in front of every plane, points behind the camera or past
+	//the far plane are not
+	tt::Matrix4x4 view = MakeLookAt(tt::Vector3(0.0f, 0.0f, -10.0f), tt::Vector3(0.0f, 0.0f, 0.0f) );
+	Frustum frustum(view * MakePerspective(0.9f, 1.6f, 1.0f, 100.0f) );
+	for(unsigned int i = 0; i < Frustum::NR_OF_PLANES; ++i){
+		const tt::Vector4& plane = frustum.GetPlane(i);
+		TT_CHECK_NEAR(tt::Vector3(plane.x, plane.y, plane.z).Length(), 1.0f, 1e-5);
+		TT_CHECK(plane.z * 10.0f + plane.w > 0.0f);
+	}
+
+	TT_CHECK(frustum.IsVisible(tt::Vector3(0.0f, 0.0f, 10.0f), 0.0f) );
+	TT_CHECK(!frustum.IsVisible(tt::Vector3(0.0f, 0.0f, -12.0f), 0.5f) );
+	TT_CHECK(!frustum.IsVisible(tt::Vector3(0.0f, 0.0f, 95.0f), 4.0f) );
+	TT_CHECK(frustum.IsVisible(tt::Vector3(0.0f, 0.0f, 95.0f), 6.0f) );
+}
@@ -0,0 +1,138 @@
+#include "TestFramework.h"
+#include "../Graphics/MeshOptimizer.h"
+#include "MeshFixtures.h"
+#include <set>
+
+namespace
+{
+	//Indices in range and no triangle with a repeated vertex
+	bool IsValidTriangleList(const std::vector<unsigned int>& indices, unsigned int nrOfVertices)
+	{
+		if(indices.size() % 3 != 0)
+			return false;
+
+		for(unsigned int i = 0; i < indices.size(); i += 3){
+			unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+			if(a >= nrOfVertices || b >= nrOfVertices || c >= nrOfVertices || a == b || b == c || a == c)
+				return false;
+		}
+
+		return true;
+	}
+
+	//Twice the signed area of a triangle of the xy plane, positive for counterclockwise
+	float GetSignedArea(const TestMesh& mesh, const unsigned int* pTriangle)
+	{
+		tt::Vector3 a = mesh.GetPosition(pTriangle[0]), b = mesh.GetPosition(pTriangle[1]), c = mesh.GetPosition(pTriangle[2]);
+		return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	}
+
+	float GetRadius(const TestMesh& mesh)
+	{
+		tt::Vector3 minimum = mesh.GetPosition(0), maximum = minimum;
+		for(unsigned int i = 1; i < mesh.NrOfVertices; ++i){
+			tt::Vector3 position = mesh.GetPosition(i);
+			minimum = tt::Vector3(min(minimum.x, position.x), min(minimum.y, position.y), min(minimum.z, position.z) );
+			maximum = tt::Vector3(max(maximum.x, position.x), max(maximum.y, position.y), max(maximum.z, position.z) );
+		}
+
+		return (maximum - minimum).Length() * 0.5f;
+	}
+}
+
+TT_TEST(LOD, GoblinLevels)
+{
+	//The levels Model3D::BuildLODs generates by default: each from the full model with half the triangles of the one before,
+	//collapses limited to 5% of the radius and to vertices following the same dominant bone
+	SourceMesh source;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+	TestMesh mesh;
+	WeldSourceMesh(source, mesh);
+
+	std::vector<unsigned int> weldRemap(source.GetNrOfVertices() ), vertexGroups(mesh.NrOfVertices);
+	for(unsigned int i = 0; i < source.Indices.size(); ++i)
+		weldRemap[source.Indices[i] ] = mesh.Indices[i];
+	for(unsigned int i = 0; i < source.GetNrOfVertices(); ++i){
+		const float* pWeights = &source.BlendWeights.Data[source.BlendWeights.Indices[i] ].x;
+		const float* pBoneIndices = &source.BlendIndices.Data[source.BlendIndices.Indices[i] ].x;
+		vertexGroups[weldRemap[i] ] = static_cast<unsigned int>(pBoneIndices[std::max_element(pWeights, pWeights + 4) - pWeights]);
+	}
+
+	float radius = GetRadius(mesh);
+	std::set<unsigned int> fullVertices(mesh.Indices.begin(), mesh.Indices.end() );
+	std::vector<unsigned int> simplified;
+	unsigned int previousNrOfIndices = mesh.Indices.size();
+	float previousError = 0.0f, reduction = 1.0f;
+
+	for(unsigned int level = 1; level <= 3; ++level){
+		reduction *= 0.5f;
+		unsigned int targetNrOfIndices = static_cast<unsigned int>(mesh.Indices.size() / 3 * reduction) * 3;
+		float error = SimplifyMesh(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride, mesh.NrOfVertices
+								  ,targetNrOfIndices, 0.05f * radius, simplified, vertexGroups.data() );
+
+		TT_CHECK(IsValidTriangleList(simplified, mesh.NrOfVertices) );
+		TT_CHECK(simplified.size() < previousNrOfIndices);
+		TT_CHECK(error <= 0.05f * radius && error >= previousError);
+		for(auto index : simplified)
+			TT_CHECK(fullVertices.count(index) == 1);
+
+		previousNrOfIndices = simplified.size();
+		previousError = error;
+	}
+}
+
+TT_TEST(LOD, FlatGridKeepsItsOutline)
+{
+	//A flat interior collapses without error, the border vertices only slide along the border
+	const unsigned int size = 20;
+	TestMesh mesh;
+	MakeGrid(size, mesh);
+
+	std::vector<unsigned int> simplified;
+	float error = SimplifyMesh(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride, mesh.NrOfVertices, 0, 0.001f, simplified);
+	TT_CHECK(error < 1e-4f);
+	TT_CHECK(IsValidTriangleList(simplified, mesh.NrOfVertices) );
+	TT_CHECK(simplified.size() / 3 <= 4 * size);
+
+	float area = 0.0f;
+	for(unsigned int i = 0; i < simplified.size(); i += 3){
+		float triangleArea = GetSignedArea(mesh, &simplified[i]);
+		TT_CHECK(triangleArea > 0.0f);
+		area += triangleArea * 0.5f;
+	}
+	TT_CHECK_NEAR(area, size * size, 1e-4);
+
+	//The corners can't go anywhere
+	std::set<unsigned int> used(simplified.begin(), simplified.end() );
+	TT_CHECK(used.count(0) && used.count(size) && used.count(size * (size + 1) ) && used.count( (size + 1) * (size + 1) - 1) );
+}
+
+TT_TEST(LOD, VertexGroupsLimitCollapses)
+{
+	//Every vertex in a group of its own, nothing can collapse
+	TestMesh mesh;
+	MakeGrid(20, mesh);
+	std::vector<unsigned int> vertexGroups(mesh.NrOfVertices), simplified;
+	for(unsigned int i = 0; i < mesh.NrOfVertices; ++i)
+		vertexGroups[i] = i;
+
+	SimplifyMesh(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride, mesh.NrOfVertices, 0, 1.0f, simplified, vertexGroups.data() );
+	TT_CHECK(GetSortedTriangles(simplified.data(), simplified.size() ) == GetSortedTriangles(mesh.Indices.data(), mesh.Indices.size() ) );
+}
+
+TT_TEST(LOD, SeamsStayInPlace)
+{
+	//The poles and the meridian where the sphere's texture wraps have several vertices at one position
+	TestMesh mesh;
+	MakeUVSphere(16, 32, mesh);
+	std::vector<unsigned int> simplified;
+	SimplifyMesh(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride, mesh.NrOfVertices, 0, 1.0f, simplified);
+	TT_CHECK(IsValidTriangleList(simplified, mesh.NrOfVertices) );
+	TT_CHECK(simplified.size() < mesh.Indices.size() / 2);
+
+	std::set<unsigned int> used(simplified.begin(), simplified.end() );
+	for(unsigned int ring = 1; ring < 16; ++ring){
+		TT_CHECK(used.count(ring * 33) == 1);
+		TT_CHECK(used.count(ring * 33 + 32) == 1);
+	}
+}
@@ -0,0 +1,174 @@
+#include "BenchmarkFramework.h"
+#include "MeshFixtures.h"
+#include "../Helpers/BinaryReader.h"
+
+//Times the file reading part of a .ttmesh load. Model3DLoader itself needs the graphics and resource services, so the
+//work it does after reading (sorting the skeleton, clip bounds, compression, LODs) isn't part of these timings.
+
+namespace
+{
+	//How Model3DLoader read source files before it mapped them, timed against ReadSourceMesh which it uses now: BinaryReader::Read per component and push_back per element
+	void ReadSourceMeshPerElement(const std::string& path, SourceMesh& mesh)
+	{
+		BinaryReader meshFile(path);
+		mesh = SourceMesh();
+
+		mesh.Version = meshFile.Read<unsigned short>();
+		auto vertexFormat = meshFile.Read<unsigned char>();
+		auto nrOfTexCoordChannels = meshFile.Read<unsigned char>();
+
+		std::vector<unsigned int> nrOfTexCoordsArr(nrOfTexCoordChannels);
+		unsigned int nrOfNormals = 0, nrOfTangents = 0, nrOfBinormals = 0, nrOfVertexColors = 0, nrOfAnimData = 0;
+		unsigned int nrOfPositions = meshFile.Read<unsigned int>();
+		meshFile.ReadArray(nrOfTexCoordsArr.data(), nrOfTexCoordChannels);
+		if(vertexFormat & 1)
+			nrOfNormals = meshFile.Read<unsigned int>();
+		if(vertexFormat & 2)
+			nrOfTangents = meshFile.Read<unsigned int>();
+		if(vertexFormat & 4)
+			nrOfBinormals = meshFile.Read<unsigned int>();
+		if(vertexFormat & 8)
+			nrOfVertexColors = meshFile.Read<unsigned int>();
+		if(vertexFormat & 16)
+			nrOfAnimData = meshFile.Read<unsigned int>();
+
+		auto nrOfVertices = meshFile.Read<unsigned int>();
+		auto nrOfIndices = meshFile.Read<unsigned int>();
+
+		auto readVector3s = [&](std::vector<D3DXVECTOR3>& data, unsigned int count){
+			for(unsigned int i = 0; i < count; ++i){
+				auto x = meshFile.Read<float>();
+				auto y = meshFile.Read<float>();
+				auto z = meshFile.Read<float>();
+				data.push_back(D3DXVECTOR3(x, y, z) );
+			}
+		};
+
+		readVector3s(mesh.Positions.Data, nrOfPositions);
+		mesh.TexCoords.resize(nrOfTexCoordChannels);
+		for(unsigned int channel = 0; channel < nrOfTexCoordChannels; ++channel)
+			for(unsigned int i = 0; i < nrOfTexCoordsArr[channel]; ++i){
+				auto u = meshFile.Read<float>();
+				auto v = meshFile.Read<float>();
+				mesh.TexCoords[channel].Data.push_back(D3DXVECTOR2(u, v) );
+			}
+
+		readVector3s(mesh.Normals.Data, nrOfNormals);
+		readVector3s(mesh.Tangents.Data, nrOfTangents);
+		readVector3s(mesh.Binormals.Data, nrOfBinormals);
+		for(unsigned int i = 0; i < nrOfVertexColors; ++i){
+			auto r = meshFile.Read<float>();
+			auto g = meshFile.Read<float>();
+			auto b = meshFile.Read<float>();
+			auto a = meshFile.Read<float>();
+			mesh.Colors.Data.push_back(D3DXCOLOR(r, g, b, a) );
+		}
+
+		for(unsigned int i = 0; i < nrOfAnimData; ++i){
+			auto nrOfInfluences = meshFile.Read<unsigned int>();
+
+			auto x = nrOfInfluences > 0 ? static_cast<float>(meshFile.Read<unsigned int>() ) : -1.0f;
+			auto y = nrOfInfluences > 1 ? static_cast<float>(meshFile.Read<unsigned int>() ) : -1.0f;
+			auto z = nrOfInfluences > 2 ? static_cast<float>(meshFile.Read<unsigned int>() ) : -1.0f;
+			auto w = nrOfInfluences > 3 ? static_cast<float>(meshFile.Read<unsigned int>() ) : -1.0f;
+			mesh.BlendIndices.Data.push_back(D3DXVECTOR4(x, y, z, w) );
+
+			x = nrOfInfluences > 0 ? meshFile.Read<float>() : 0.0f;
+			y = nrOfInfluences > 1 ? meshFile.Read<float>() : 0.0f;
+			z = nrOfInfluences > 2 ? meshFile.Read<float>() : 0.0f;
+			w = nrOfInfluences > 3 ? meshFile.Read<float>() : 0.0f;
+			mesh.BlendWeights.Data.push_back(D3DXVECTOR4(x, y, z, w) );
+		}
+
+		for(unsigned int i = 0; i < nrOfVertices; ++i){
+			mesh.Positions.Indices.push_back(meshFile.Read<unsigned int>() );
+			for(unsigned int channel = 0; channel < nrOfTexCoordChannels; ++channel)
+				mesh.TexCoords[channel].Indices.push_back(meshFile.Read<unsigned int>() );
+			if(nrOfNormals > 0)
+				mesh.Normals.Indices.push_back(meshFile.Read<unsigned int>() );
+			if(nrOfTangents > 0)
+				mesh.Tangents.Indices.push_back(meshFile.Read<unsigned int>() );
+			if(nrOfBinormals > 0)
+				mesh.Binormals.Indices.push_back(meshFile.Read<unsigned int>() );
+			if(nrOfVertexColors > 0)
+				mesh.Colors.Indices.push_back(meshFile.Read<unsigned int>() );
+			if(nrOfAnimData > 0){
+				auto iAnimData = meshFile.Read<unsigned int>();
+				mesh.BlendIndices.Indices.push_back(iAnimData);
+				mesh.BlendWeights.Indices.push_back(iAnimData);
+			}
+		}
+
+		for(unsigned int i = 0; i < nrOfIndices; ++i)
+			mesh.Indices.push_back(meshFile.Read<unsigned int>() );
+
+		if(nrOfAnimData == 0)
+			return;
+
+		bool bHierarchy = mesh.Version >= 2;
+		auto nrOfBones = meshFile.Read<unsigned int>();
+		for(unsigned int i = 0; i < nrOfBones; ++i){
+			Bone bone;
+			bone.Name = meshFile.ReadString();
+			bone.Parent = bHierarchy ? meshFile.Read<unsigned int>() : Bone::NO_PARENT;
+			for(unsigned int part = 0; part < 2; ++part){
+				bone.BindPose.Data[part].x = meshFile.Read<float>();
+				bone.BindPose.Data[part].y = meshFile.Read<float>();
+				bone.BindPose.Data[part].z = meshFile.Read<float>();
+				bone.BindPose.Data[part].w = meshFile.Read<float>();
+			}
+			mesh.Skeleton.push_back(bone);
+		}
+
+		auto nrOfAnimClips = meshFile.Read<unsigned int>();
+		for(unsigned int i = 0; i < nrOfAnimClips; ++i){
+			AnimationClip clip;
+			clip.Name = meshFile.ReadString();
+			clip.KeysPerSecond = meshFile.Read<float>();
+
+			auto nrOfKeys = meshFile.Read<unsigned int>();
+			for(unsigned int iKey = 0; iKey < nrOfKeys; ++iKey){
+				AnimationKey key;
+				key.KeyTime = meshFile.Read<float>();
+				key.BoneTransforms.resize(nrOfBones);
+				for(auto& transform : key.BoneTransforms)
+					for(unsigned int part = 0; part < 2; ++part){
+						transform.Data[part].x = meshFile.Read<float>();
+						transform.Data[part].y = meshFile.Read<float>();
+						transform.Data[part].z = meshFile.Read<float>();
+						transform.Data[part].w = meshFile.Read<float>();
+					}
+				clip.Keys.push_back(key);
+			}
+			mesh.AnimClips.push_back(clip);
+		}
+	}
+}
+
+TT_BENCHMARK(Loader, GoblinSourceMesh)
+{
+	const unsigned int nrOfLoads = 20;
+	std::string path = GetResourcePath("goblin.ttmesh");
+
+	SourceMesh perElement, mapped;
+	ReadSourceMeshPerElement(path, perElement);
+	ReadSourceMesh(path, mapped);
+	if(perElement.GetNrOfVertices() != mapped.GetNrOfVertices() || perElement.Indices != mapped.Indices || perElement.AnimClips.size() != mapped.AnimClips.size() )
+		throw exception("Both readers have to produce the same mesh");
+
+	printf("  %u vertices, %u triangles, %u bones, %u clips\n", mapped.GetNrOfVertices(), (unsigned int)mapped.Indices.size() / 3
+		  ,(unsigned int)mapped.Skeleton.size(), (unsigned int)mapped.AnimClips.size() );
+
+	double perElementTime = MeasureMilliseconds([&]{
+		for(unsigned int i = 0; i < nrOfLoads; ++i)
+			ReadSourceMeshPerElement(path, perElement);
+	});
+
+	double mappedTime = MeasureMilliseconds([&]{
+		for(unsigned int i = 0; i < nrOfLoads; ++i)
+			ReadSourceMesh(path, mapped);
+	});
+
+	ReportTiming("BinaryReader, per element", perElementTime, nrOfLoads, "load");
+	ReportTiming("MappedFileReader, bulk", mappedTime, nrOfLoads, "load");
+}
@@ -0,0 +1,75 @@
+#include "TestFramework.h"
+#include "MeshFixtures.h"
+
+namespace
+{
+	template<typename T>
+	bool AreIndicesInRange(const SourceAttribute<T>& attribute, unsigned int nrOfVertices)
+	{
+		if(attribute.Data.empty() )
+			return attribute.Indices.empty();
+		if(attribute.Indices.size() != nrOfVertices)
+			return false;
+
+		for(auto index : attribute.Indices)
+			if(index >= attribute.Data.size() )
+				return false;
+
+		return true;
+	}
+}
+
+TT_TEST(Loader, GoblinSourceMeshIsConsistent)
+{
+	SourceMesh mesh;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), mesh);
+
+	unsigned int nrOfVertices = mesh.GetNrOfVertices();
+	TT_CHECK(nrOfVertices > 0);
+	TT_CHECK(mesh.Indices.size() > 0 && mesh.Indices.size() % 3 == 0);
+	for(auto index : mesh.Indices)
+		TT_CHECK(index < nrOfVertices);
+
+	TT_CHECK(AreIndicesInRange(mesh.Positions, nrOfVertices) );
+	TT_CHECK(AreIndicesInRange(mesh.Normals, nrOfVertices) );
+	TT_CHECK(AreIndicesInRange(mesh.BlendIndices, nrOfVertices) );
+	TT_CHECK(mesh.TexCoords.size() == 1);
+	for(auto& texCoords : mesh.TexCoords)
+		TT_CHECK(AreIndicesInRange(texCoords, nrOfVertices) );
+
+	//Every influence names a bone of the skeleton. The exporter drops influences past the 4th without renormalizing, so a few
+	//goblin vertices have weights adding up to less than 1.
+	TT_CHECK(!mesh.Skeleton.empty() );
+	for(unsigned int i = 0; i < mesh.BlendIndices.Data.size(); ++i){
+		const D3DXVECTOR4& indices = mesh.BlendIndices.Data[i];
+		const D3DXVECTOR4& weights = mesh.BlendWeights.Data[i];
+		for(float index : {indices.x, indices.y, indices.z, indices.w})
+			TT_CHECK(index == -1.0f || (index >= 0.0f && index < mesh.Skeleton.size() ) );
+		float totalWeight = weights.x + weights.y + weights.z + weights.w;
+		TT_CHECK(totalWeight > 0.0f && totalWeight < 1.001f);
+	}
+
+	TT_CHECK(!mesh.AnimClips.empty() );
+	for(auto& clip : mesh.AnimClips){
+		TT_CHECK(clip.KeysPerSecond > 0.0f);
+		TT_CHECK(!clip.Keys.empty() );
+		for(unsigned int i = 0; i < clip.Keys.size(); ++i){
+			TT_CHECK(clip.Keys[i].BoneTransforms.size() == mesh.Skeleton.size() );
+			if(i > 0)
+				TT_CHECK(clip.Keys[i].KeyTime >= clip.Keys[i - 1].KeyTime);
+		}
+	}
+}
+
+TT_TEST(Loader, MissingFileThrows)
+{
+	SourceMesh mesh;
+	bool bThrown = false;
+	try{
+		ReadSourceMesh(GetResourcePath("missing.ttmesh"), mesh);
+	}
+	catch(const std::exception&){
+		bThrown = true;
+	}
+	TT_CHECK(bThrown);
+}
@@ -0,0 +1,391 @@
+#include "TestFramework.h"
+#include "ReferenceMath.h"
+#include "../Helpers/Namespace.h"
+#include <random>
+
+using namespace tt;
+
+//Every check runs on random inputs and compares against Tests/ReferenceMath.h, the same in the SIMD and the TT_NO_SIMD build
+
+namespace
+{
+	const unsigned int NR_OF_SAMPLES = 2000;
+
+	std::mt19937 g_Random(42);
+
+	float RandomFloat(float min = -2.0f, float max = 2.0f)
+	{
+		return std::uniform_real_distribution<float>(min, max)(g_Random);
+	}
+
+	Vector3 RandomVector3(float min = -2.0f, float max = 2.0f)
+	{
+		return Vector3(RandomFloat(min, max), RandomFloat(min, max), RandomFloat(min, max) );
+	}
+
+	Matrix4x4 RandomMatrix(void)
+	{
+		Matrix4x4 mat;
+		float* pElements = &mat._11;
+		for(unsigned int i = 0; i < 16; ++i)
+			pElements[i] = RandomFloat();
+
+		return mat;
+	}
+
+	Quaternion RandomRotation(void)
+	{
+		Quaternion quat(RandomFloat(), RandomFloat(), RandomFloat(), RandomFloat() );
+		return quat.Normalize();
+	}
+
+	Matrix4x4 RandomTRS(void)
+	{
+		return Matrix4x4::Scale(RandomVector3(0.5f, 2.0f) ) * Matrix4x4::Rotation(RandomRotation() ) * Matrix4x4::Translation(RandomVector3() );
+	}
+
+	//Random 3x3 part and translation, the last column of an affine transform is always (0, 0, 0, 1)
+	Matrix4x4 RandomAffine(void)
+	{
+		Matrix4x4 mat = RandomMatrix();
+		mat._14 = mat._24 = mat._34 = 0.0f;
+		mat._44 = 1.0f;
+		return mat;
+	}
+
+	//q and -q are the same rotation
+	void AlignSign(Quaternion& quat, const D3DXQUATERNION& reference)
+	{
+		if(quat.x * reference.x + quat.y * reference.y + quat.z * reference.z + quat.w * reference.w < 0.0f)
+			quat = quat * -1.0f;
+	}
+}
+
+TT_TEST(Math, Matrix4x4Multiply)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Matrix4x4 a = RandomMatrix(), b = RandomMatrix();
+		D3DXMATRIX expected = Reference::Multiply(a, b);
+
+		Matrix4x4 product = a * b;
+		TT_CHECK_NEAR_N(&product._11, &expected._11, 16, 1e-5);
+
+		a *= b;
+		TT_CHECK_NEAR_N(&a._11, &expected._11, 16, 1e-5);
+	}
+}
+
+TT_TEST(Math, Matrix4x4Inverse)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Matrix4x4 mat = RandomMatrix();
+		D3DXMATRIX expected;
+		if(!Reference::Inverse(mat, expected) )
+			continue;
+
+		Matrix4x4 inverse = mat.Inverse();
+		TT_CHECK_NEAR_N(&inverse._11, &expected._11, 16, 2e-3);
+	}
+
+	//Affine transforms are what the engine inverts, those have to be close to exact
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Matrix4x4 trs = RandomTRS();
+		Matrix4x4 identity = trs * trs.Inverse();
+		TT_CHECK_NEAR_N(&identity._11, &Matrix4x4::Identity._11, 16, 1e-4);
+	}
+}
+
+TT_TEST(Math, Matrix4x4Decompose)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Matrix4x4 trs = RandomTRS();
+		D3DXVECTOR3 expectedScale, expectedPos;
+		D3DXQUATERNION expectedRot(0, 0, 0, 1);
+		TT_CHECK(Reference::Decompose(trs, expectedScale, expectedRot, expectedPos) );
+
+		Vector3 pos, scale;
+		Quaternion rot;
+		trs.Decompose(pos, rot, scale);
+		AlignSign(rot, expectedRot);
+		TT_CHECK_NEAR_N(&pos.x, &expectedPos.x, 3, 1e-4);
+		TT_CHECK_NEAR_N(&scale.x, &expectedScale.x, 3, 1e-4);
+		TT_CHECK_NEAR_N(&rot.x, &expectedRot.x, 4, 1e-3);
+	}
+}
+
+TT_TEST(Math, Matrix4x4Rotation)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Quaternion quat = RandomRotation();
+		Matrix4x4 fromQuat = Matrix4x4::Rotation(quat);
+		D3DXMATRIX expected = Reference::RotationQuaternion(quat);
+		TT_CHECK_NEAR_N(&fromQuat._11, &expected._11, 16, 1e-4);
+
+		Vector3 yawPitchRoll = RandomVector3(-3.0f, 3.0f);
+		Matrix4x4 fromEuler = Matrix4x4::Rotation(yawPitchRoll);
+		expected = Reference::RotationYawPitchRoll(yawPitchRoll.x, yawPitchRoll.y, yawPitchRoll.z);
+		TT_CHECK_NEAR_N(&fromEuler._11, &expected._11, 16, 1e-4);
+
+		Vector3 axis = RandomVector3();
+		float angle = RandomFloat(-3.0f, 3.0f);
+		Matrix4x4 fromAxis = Matrix4x4::Rotation(axis, angle);
+		expected = Reference::RotationAxis(axis, angle);
+		TT_CHECK_NEAR_N(&fromAxis._11, &expected._11, 16, 1e-4);
+	}
+}
+
+TT_TEST(Math, Transform3x4FromTRS)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Vector3 position = RandomVector3(), scale = RandomVector3(0.5f, 2.0f);
+		Quaternion rotation = RandomRotation();
+
+		D3DXMATRIX scaling = Reference::Identity(), translation = Reference::Identity();
+		scaling._11 = scale.x;
+		scaling._22 = scale.y;
+		scaling._33 = scale.z;
+		translation._41 = position.x;
+		translation._42 = position.y;
+		translation._43 = position.z;
+		D3DXMATRIX expected = Reference::Multiply(Reference::Multiply(scaling, Reference::RotationQuaternion(rotation) ), translation);
+
+		Matrix4x4 trs = Transform3x4::FromTRS(position, rotation, scale).ToMatrix4x4();
+		TT_CHECK_NEAR_N(&trs._11, &expected._11, 16, 1e-5);
+	}
+}
+
+TT_TEST(Math, Transform3x4Multiply)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Matrix4x4 a = i % 2 ? RandomTRS() : RandomAffine(), b = i % 2 ? RandomTRS() : RandomAffine();
+		D3DXMATRIX expected = Reference::Multiply(a, b);
+
+		Transform3x4 product = Transform3x4(a) * Transform3x4(b);
+		Matrix4x4 productMat = product.ToMatrix4x4();
+		TT_CHECK_NEAR_N(&productMat._11, &expected._11, 16, 1e-5);
+
+		Transform3x4 accumulated(a);
+		accumulated *= Transform3x4(b);
+		Matrix4x4 accumulatedMat = accumulated.ToMatrix4x4();
+		TT_CHECK_NEAR_N(&accumulatedMat._11, &expected._11, 16, 1e-5);
+
+		Vector3 vec = RandomVector3();
+		Vector3 point = product.TransformPoint(vec);
+		D3DXVECTOR3 expectedVec = Reference::TransformCoord(vec, expected);
+		TT_CHECK_NEAR_N(&point.x, &expectedVec.x, 3, 1e-4);
+
+		Vector3 direction = product.TransformVector(vec);
+		expectedVec = Reference::TransformNormal(vec, expected);
+		TT_CHECK_NEAR_N(&direction.x, &expectedVec.x, 3, 1e-4);
+	}
+}
+
+TT_TEST(Math, Transform3x4Inverse)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Matrix4x4 mat = RandomAffine();
+		D3DXMATRIX expected;
+		if(!Reference::Inverse(mat, expected) )
+			continue;
+
+		Matrix4x4 inverse = Transform3x4(mat).Inverse().ToMatrix4x4();
+		TT_CHECK_NEAR_N(&inverse._11, &expected._11, 16, 2e-3);
+	}
+
+	//World transforms with non-uniform scale, those have to be close to exact
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Matrix4x4 trs = RandomTRS();
+		D3DXMATRIX expected;
+		TT_CHECK(Reference::Inverse(trs, expected) );
+
+		Transform3x4 transform(trs);
+		Matrix4x4 inverse = transform.Inverse().ToMatrix4x4();
+		TT_CHECK_NEAR_N(&inverse._11, &expected._11, 16, 1e-4);
+
+		Matrix4x4 identity = (transform * transform.Inverse() ).ToMatrix4x4();
+		TT_CHECK_NEAR_N(&identity._11, &Matrix4x4::Identity._11, 16, 1e-4);
+	}
+
+	//Singular transforms invert to the identity, like Matrix4x4::Inverse
+	Transform3x4 flat = Transform3x4::FromTRS(Vector3(1.0f, 2.0f, 3.0f), Quaternion::Identity, Vector3(1.0f, 0.0f, 1.0f) );
+	Matrix4x4 inverse = flat.Inverse().ToMatrix4x4();
+	TT_CHECK_NEAR_N(&inverse._11, &Matrix4x4::Identity._11, 16, 0.0);
+}
+
+TT_TEST(Math, QuaternionMultiply)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Quaternion q1 = RandomRotation(), q2(RandomFloat(), RandomFloat(), RandomFloat(), RandomFloat() );
+		D3DXQUATERNION expected = Reference::Multiply(q1, q2);
+
+		Quaternion product = q1 * q2;
+		TT_CHECK_NEAR_N(&product.x, &expected.x, 4, 1e-5);
+
+		q1 *= q2;
+		TT_CHECK_NEAR_N(&q1.x, &expected.x, 4, 1e-5);
+	}
+}
+
+TT_TEST(Math, QuaternionConstruction)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Vector3 axis = RandomVector3();
+		float angle = RandomFloat(-3.0f, 3.0f);
+		Quaternion fromAxis(axis, angle);
+		D3DXQUATERNION expected = Reference::QuaternionRotationAxis(axis, angle);
+		TT_CHECK_NEAR_N(&fromAxis.x, &expected.x, 4, 1e-4);
+
+		Vector3 yawPitchRoll = RandomVector3(-3.0f, 3.0f);
+		Quaternion fromEuler = Quaternion::FromEuler(yawPitchRoll);
+		expected = Reference::QuaternionYawPitchRoll(yawPitchRoll.x, yawPitchRoll.y, yawPitchRoll.z);
+		TT_CHECK_NEAR_N(&fromEuler.x, &expected.x, 4, 1e-4);
+
+		fromEuler = Quaternion::FromEuler(yawPitchRoll.x, yawPitchRoll.y, yawPitchRoll.z);
+		TT_CHECK_NEAR_N(&fromEuler.x, &expected.x, 4, 1e-4);
+
+		Matrix4x4 rotation = Matrix4x4::Rotation(RandomRotation() );
+		Quaternion fromMatrix = Quaternion::FromRotationMatrix(rotation);
+		expected = Reference::QuaternionRotationMatrix(rotation);
+		TT_CHECK_NEAR_N(&fromMatrix.x, &expected.x, 4, 1e-3);
+	}
+}
+
+TT_TEST(Math, QuaternionNormalizeAndInverse)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Quaternion quat(RandomFloat(), RandomFloat(), RandomFloat(), RandomFloat() );
+		D3DXQUATERNION expected = Reference::Normalize(D3DXQUATERNION(quat) );
+		quat.Normalize();
+		TT_CHECK_NEAR_N(&quat.x, &expected.x, 4, 1e-5);
+
+		Quaternion identity = quat * Quaternion::Inverse(quat);
+		TT_CHECK_NEAR_N(&identity.x, &Quaternion::Identity.x, 4, 1e-5);
+
+		Quaternion conjugate = Quaternion::Conjugate(quat);
+		TT_CHECK(conjugate.x == -quat.x && conjugate.y == -quat.y && conjugate.z == -quat.z && conjugate.w == quat.w);
+	}
+}
+
+TT_TEST(Math, VectorTransform)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Matrix4x4 mat = RandomMatrix();
+		Vector3 vec = RandomVector3();
+
+		Vector3 point = vec.TransformPoint(mat);
+		D3DXVECTOR3 expected = Reference::TransformCoord(vec, mat);
+		TT_CHECK_NEAR_N(&point.x, &expected.x, 3, 1e-3);
+
+		Vector3 direction = vec.TransformVector(mat);
+		expected = Reference::TransformNormal(vec, mat);
+		TT_CHECK_NEAR_N(&direction.x, &expected.x, 3, 1e-4);
+
+		Quaternion rotation = RandomRotation();
+		Vector3 rotated = vec.TransformPoint(rotation);
+		Vector3 rotatedByMatrix = vec.TransformPoint(Matrix4x4::Rotation(rotation) );
+		TT_CHECK_NEAR_N(&rotated.x, &rotatedByMatrix.x, 3, 1e-4);
+	}
+}
+
+TT_TEST(Math, VectorBatchTransform)
+{
+	const unsigned int count = 37;
+	Matrix4x4 trs = RandomTRS();
+	std::vector<Vector3> points(count), transformed(count);
+	std::vector<float> x(count), y(count), z(count), outX(count), outY(count), outZ(count);
+	for(unsigned int i = 0; i < count; ++i){
+		points[i] = RandomVector3();
+		x[i] = points[i].x;
+		y[i] = points[i].y;
+		z[i] = points[i].z;
+	}
+
+	Vector3::TransformPoints(trs, points.data(), transformed.data(), count);
+	Vector3::TransformPointsSoA(trs, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), count);
+	for(unsigned int i = 0; i < count; ++i){
+		Vector3 expected = points[i].TransformPoint(trs);
+		TT_CHECK_NEAR_N(&transformed[i].x, &expected.x, 3, 1e-5);
+		TT_CHECK_NEAR(outX[i], expected.x, 1e-5);
+		TT_CHECK_NEAR(outY[i], expected.y, 1e-5);
+		TT_CHECK_NEAR(outZ[i], expected.z, 1e-5);
+	}
+
+	Vector3::TransformVectors(trs, points.data(), transformed.data(), count);
+	Vector3::TransformVectorsSoA(trs, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), count);
+	for(unsigned int i = 0; i < count; ++i){
+		Vector3 expected = points[i].TransformVector(trs);
+		TT_CHECK_NEAR_N(&transformed[i].x, &expected.x, 3, 1e-5);
+		TT_CHECK_NEAR(outX[i], expected.x, 1e-5);
+		TT_CHECK_NEAR(outY[i], expected.y, 1e-5);
+		TT_CHECK_NEAR(outZ[i], expected.z, 1e-5);
+	}
+
+	//In place
+	Vector3::TransformPoints(trs, points.data(), points.data(), count);
+	for(unsigned int i = 0; i < count; ++i){
+		Vector3 expected = Vector3(x[i], y[i], z[i]).TransformPoint(trs);
+		TT_CHECK_NEAR_N(&points[i].x, &expected.x, 3, 1e-5);
+	}
+}
+
+TT_TEST(Math, VectorProducts)
+{
+	for(unsigned int i = 0; i < NR_OF_SAMPLES; ++i){
+		Vector3 a = RandomVector3(), b = RandomVector3();
+
+		Vector3 cross = a.Cross(b);
+		D3DXVECTOR3 expected = Reference::Cross(a, b);
+		TT_CHECK_NEAR_N(&cross.x, &expected.x, 3, 1e-5);
+		TT_CHECK_NEAR(a.Dot(b), Reference::Dot(a, b), 1e-5);
+		TT_CHECK_NEAR(a.LengthSq(), Reference::Dot(a, a), 1e-5);
+		TT_CHECK_NEAR(a.Length(), sqrtf(Reference::Dot(a, a) ), 1e-5);
+
+		expected = Reference::Normalize(D3DXVECTOR3(a) );
+		Vector3 normalized = Vector3::Normalize(a);
+		TT_CHECK_NEAR_N(&normalized.x, &expected.x, 3, 1e-5);
+		a.Normalize();
+		TT_CHECK_NEAR_N(&a.x, &expected.x, 3, 1e-5);
+
+		Vector4 v4(RandomFloat(), RandomFloat(), RandomFloat(), RandomFloat() );
+		D3DXVECTOR4 expected4 = Reference::Normalize(D3DXVECTOR4(v4) );
+		v4.Normalize();
+		TT_CHECK_NEAR_N(&v4.x, &expected4.x, 4, 1e-5);
+	}
+}
+
+TT_TEST(Math, VectorOperators)
+{
+	Vector2 a2(1.0f, 2.0f), b2(3.0f, 5.0f);
+	Vector2 r2 = a2 + b2;
+	TT_CHECK(r2.x == 4.0f && r2.y == 7.0f);
+	r2 = b2 - a2;
+	TT_CHECK(r2.x == 2.0f && r2.y == 3.0f);
+	r2 = a2 * 2.0f;
+	TT_CHECK(r2.x == 2.0f && r2.y == 4.0f && a2.x == 1.0f);
+	r2 = b2 / 2.0f;
+	TT_CHECK(r2.x == 1.5f && r2.y == 2.5f && b2.x == 3.0f);
+
+	Vector3 a3(1.0f, 2.0f, 3.0f), b3(4.0f, 6.0f, 8.0f);
+	Vector3 r3 = a3 * b3;
+	TT_CHECK(r3.x == 4.0f && r3.y == 12.0f && r3.z == 24.0f);
+	r3 = -a3;
+	TT_CHECK(r3 == Vector3(-1.0f, -2.0f, -3.0f) );
+	r3 = b3 / 2.0f;
+	TT_CHECK(r3 == Vector3(2.0f, 3.0f, 4.0f) && b3 != r3);
+
+	//The binary operators return a new vector and leave the left operand alone
+	Vector4 a4(1.0f, 2.0f, 3.0f, 4.0f), b4(2.0f, 2.0f, 2.0f, 2.0f);
+	Vector4 r4 = a4 + b4;
+	TT_CHECK(r4.x == 3.0f && r4.w == 6.0f && a4.x == 1.0f);
+	r4 = a4 - b4;
+	TT_CHECK(r4.x == -1.0f && r4.w == 2.0f && a4.x == 1.0f);
+	r4 = a4 * 3.0f;
+	TT_CHECK(r4.y == 6.0f && r4.z == 9.0f && a4.y == 2.0f);
+	r4 = a4 / 2.0f;
+	TT_CHECK(r4.x == 0.5f && r4.w == 2.0f && a4.w == 4.0f);
+
+	a4 += b4;
+	TT_CHECK(a4.x == 3.0f && a4.w == 6.0f);
+	a4 *= 2.0f;
+	TT_CHECK(a4.x == 6.0f && a4.w == 12.0f);
+}
@@ -0,0 +1,171 @@
+#include "MeshFixtures.h"
+#include "../Graphics/MeshOptimizer.h"
+#include "../Graphics/MeshClusters.h"
+#include "../Graphics/CpuSkinning.h"
+#include <algorithm>
+
+TestMesh::TestMesh(void):
+	Stride(sizeof(float) * 3),
+	NrOfVertices(0)
+{
+}
+
+const float* TestMesh::GetPositions(void) const
+{
+	return Vertices.data();
+}
+
+tt::Vector3 TestMesh::GetPosition(unsigned int vertex) const
+{
+	const float* pPosition = &Vertices[vertex * Stride / sizeof(float)];
+	return tt::Vector3(pPosition[0], pPosition[1], pPosition[2]);
+}
+
+unsigned int TestMesh::GetNrOfTriangles(void) const
+{
+	return Indices.size() / 3;
+}
+
+void MakeGrid(unsigned int size, TestMesh& mesh)
+{
+	mesh = TestMesh();
+	mesh.NrOfVertices = (size + 1) * (size + 1);
+	for(unsigned int y = 0; y <= size; ++y)
+		for(unsigned int x = 0; x <= size; ++x){
+			mesh.Vertices.push_back(static_cast<float>(x) );
+			mesh.Vertices.push_back(static_cast<float>(y) );
+			mesh.Vertices.push_back(0.0f);
+		}
+
+	for(unsigned int y = 0; y < size; ++y)
+		for(unsigned int x = 0; x < size; ++x){
+			unsigned int v = y * (size + 1) + x;
+			unsigned int quad[6] = {v, v + 1, v + size + 1, v + 1, v + size + 2, v + size + 1};
+			mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+		}
+}
+
+void MakeUVSphere(unsigned int nrOfRings, unsigned int nrOfSegments, TestMesh& mesh)
+{
+	mesh = TestMesh();
+	mesh.NrOfVertices = (nrOfRings + 1) * (nrOfSegments + 1);
+	for(unsigned int ring = 0; ring <= nrOfRings; ++ring)
+		for(unsigned int segment = 0; segment <= nrOfSegments; ++segment){
+			//Vertices on a seam have exactly the same position
+			float theta = static_cast<float>(D3DX_PI) * ring / nrOfRings;
+			float phi = 2.0f * static_cast<float>(D3DX_PI) * (segment % nrOfSegments) / nrOfSegments;
+			float ringRadius = ring == 0 || ring == nrOfRings ? 0.0f : sinf(theta);
+			mesh.Vertices.push_back(ringRadius * cosf(phi) );
+			mesh.Vertices.push_back(ring == nrOfRings ? -1.0f : cosf(theta) );
+			mesh.Vertices.push_back(ringRadius * sinf(phi) );
+		}
+
+	for(unsigned int ring = 0; ring < nrOfRings; ++ring)
+		for(unsigned int segment = 0; segment < nrOfSegments; ++segment){
+			unsigned int v = ring * (nrOfSegments + 1) + segment;
+			unsigned int quad[6] = {v, v + nrOfSegments + 1, v + 1, v + 1, v + nrOfSegments + 1, v + nrOfSegments + 2};
+			mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+		}
+}
+
+void MakeTerrain(unsigned int size, TestMesh& mesh, std::mt19937& random)
+{
+	MakeGrid(size, mesh);
+	std::uniform_real_distribution<float> noise(0.0f, 1.0f);
+	for(unsigned int i = 0; i < mesh.NrOfVertices; ++i){
+		float* pPosition = &mesh.Vertices[i * 3];
+		float x = pPosition[0], z = pPosition[1];
+		pPosition[1] = sinf(x * 0.05f) * cosf(z * 0.07f) * 20.0f + noise(random);
+		pPosition[2] = z;
+	}
+}
+
+void ShuffleTriangles(TestMesh& mesh, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	for(unsigned int i = mesh.GetNrOfTriangles() - 1; i > 0; --i){
+		unsigned int j = std::uniform_int_distribution<unsigned int>(0, i)(random);
+		std::swap_ranges(mesh.Indices.begin() + i * 3, mesh.Indices.begin() + i * 3 + 3, mesh.Indices.begin() + j * 3);
+	}
+}
+
+unsigned int WeldSourceMesh(const SourceMesh& source, TestMesh& mesh)
+{
+	if(source.TexCoords.empty() || source.Normals.Data.empty() )
+		throw exception("The mesh needs texture coordinates and normals");
+
+	mesh = TestMesh();
+	unsigned int nrOfSourceVertices = source.GetNrOfVertices();
+	for(unsigned int i = 0; i < nrOfSourceVertices; ++i){
+		const D3DXVECTOR3& position = source.Positions.Data[source.Positions.Indices[i] ];
+		const D3DXVECTOR2& texCoord = source.TexCoords[0].Data[source.TexCoords[0].Indices[i] ];
+		const D3DXVECTOR3& normal = source.Normals.Data[source.Normals.Indices[i] ];
+		float vertex[8] = {position.x, position.y, position.z, texCoord.x, texCoord.y, normal.x, normal.y, normal.z};
+		mesh.Vertices.insert(mesh.Vertices.end(), vertex, vertex + 8);
+	}
+	mesh.Stride = sizeof(float) * 8;
+
+	std::vector<unsigned int> remap;
+	mesh.NrOfVertices = WeldVertices(reinterpret_cast<char*>(mesh.Vertices.data() ), nrOfSourceVertices, mesh.Stride, remap);
+	mesh.Vertices.resize(mesh.NrOfVertices * 8);
+
+	mesh.Indices = source.Indices;
+	for(auto& index : mesh.Indices)
+		index = remap[index];
+
+	return nrOfSourceVertices;
+}
+
+void CookTestMesh(TestMesh& mesh, ClusterStreams& clusters)
+{
+	OptimizeVertexCache(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices);
+	OptimizeOverdraw(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride, mesh.NrOfVertices);
+
+	std::vector<unsigned int> clusterStarts;
+	BuildClusters(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride, mesh.NrOfVertices, clusterStarts
+				 ,CLUSTER_MAX_VERTICES, CLUSTER_MAX_TRIANGLES);
+	BuildClusterStreams(mesh.Indices.data(), clusterStarts, mesh.GetPositions(), mesh.Stride, clusters);
+}
+
+std::vector<std::array<unsigned int, 3> > GetSortedTriangles(const unsigned int* pIndices, unsigned int nrOfIndices)
+{
+	std::vector<std::array<unsigned int, 3> > triangles;
+	for(unsigned int i = 0; i + 2 < nrOfIndices; i += 3){
+		std::array<unsigned int, 3> triangle = {{pIndices[i], pIndices[i + 1], pIndices[i + 2]}};
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end() ), triangle.end() );
+		triangles.push_back(triangle);
+	}
+
+	std::sort(triangles.begin(), triangles.end() );
+	return triangles;
+}
+
+void MakeSkinningStreams(const SourceMesh& source, SkinningStreams& streams)
+{
+	unsigned int nrOfVertices = source.GetNrOfVertices();
+	bool bNormals = !source.Normals.Data.empty();
+	streams.Resize(nrOfVertices, bNormals);
+	streams.NrOfBones = 0;
+
+	for(unsigned int v = 0; v < nrOfVertices; ++v){
+		const D3DXVECTOR3& pos = source.Positions.Data[source.Positions.Indices[v] ];
+		streams.PosX[v] = pos.x;
+		streams.PosY[v] = pos.y;
+		streams.PosZ[v] = pos.z;
+
+		if(bNormals){
+			const D3DXVECTOR3& norm = source.Normals.Data[source.Normals.Indices[v] ];
+			streams.NormX[v] = norm.x;
+			streams.NormY[v] = norm.y;
+			streams.NormZ[v] = norm.z;
+		}
+
+		unsigned int blendData = source.BlendIndices.Indices[v];
+		streams.SetInfluences(v, source.BlendIndices.Data[blendData], source.BlendWeights.Data[blendData]);
+	}
+}
+
+std::string GetResourcePath(const std::string& fileName)
+{
+	return std::string(TT_RESOURCE_DIR) + "/" + fileName;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+//Indexed triangle lists for the mesh tests, benchmarks and tools, in the form the MeshOptimizer functions take them
+
+#include "../Graphics/SourceMesh.h"
+#include <array>
+#include <random>
+
+struct ClusterStreams;
+struct SkinningStreams;
+
+//Interleaved float vertices with the position first
+struct TestMesh
+{
+	std::vector<float> Vertices;
+	std::vector<unsigned int> Indices;
+	unsigned int Stride; //In bytes
+	unsigned int NrOfVertices;
+
+	TestMesh(void);
+
+	const float* GetPositions(void) const;
+	tt::Vector3 GetPosition(unsigned int vertex) const;
+	unsigned int GetNrOfTriangles(void) const;
+};
+
+//size x size unit quads in the xy plane, facing -z, rows of vertices along x
+void MakeGrid(unsigned int size, TestMesh& mesh);
+
+//Unit sphere around the origin with seams at the poles and along one meridian, facing outward
+void MakeUVSphere(unsigned int nrOfRings, unsigned int nrOfSegments, TestMesh& mesh);
+
+//Rolling hills of size x size quads with up to 1 unit of noise, in the xz plane, rows of vertices along x
+void MakeTerrain(unsigned int size, TestMesh& mesh, std::mt19937& random);
+
+//Puts the triangles in random order, each keeping its winding
+void ShuffleTriangles(TestMesh& mesh, unsigned int seed);
+
+//Position, first texture coordinate and normal of every vertex, welded the way Model3D::SaveCooked welds them.
+//Returns the number of vertices before welding.
+unsigned int WeldSourceMesh(const SourceMesh& source, TestMesh& mesh);
+
+//Skinning data of a source mesh with animation data, flattened the way Model3D::BuildSkinningStreams flattens it
+void MakeSkinningStreams(const SourceMesh& source, SkinningStreams& streams);
+
+//Reorders the triangles the way Model3D::SaveCooked does (vertex cache, overdraw) and splits them into clusters of the
+//size it uses, whatever the size of the mesh
+void CookTestMesh(TestMesh& mesh, ClusterStreams& clusters);
+
+//Triangles rotated to start at their smallest index and sorted, to compare meshes that differ in triangle order only
+std::vector<std::array<unsigned int, 3> > GetSortedTriangles(const unsigned int* pIndices, unsigned int nrOfIndices);
+
+//Absolute path of a file in the engine's Resources directory
+std::string GetResourcePath(const std::string& fileName);
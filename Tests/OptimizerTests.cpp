@@ -0,0 +1,122 @@
+#include "TestFramework.h"
+#include "../Graphics/MeshOptimizer.h"
+#include "MeshFixtures.h"
+#include <set>
+
+namespace
+{
+	//Same triangles with the same winding, in any order
+	bool HasSameTriangles(const std::vector<unsigned int>& a, const std::vector<unsigned int>& b)
+	{
+		return GetSortedTriangles(a.data(), a.size() ) == GetSortedTriangles(b.data(), b.size() );
+	}
+
+	//Indices renumbered through remap
+	std::vector<unsigned int> Remap(std::vector<unsigned int> indices, const std::vector<unsigned int>& remap)
+	{
+		for(auto& index : indices)
+			index = remap[index];
+		return indices;
+	}
+}
+
+TT_TEST(Optimizer, GoblinACMR)
+{
+	SourceMesh source;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+	TestMesh mesh;
+	unsigned int nrOfSourceVertices = WeldSourceMesh(source, mesh);
+	std::vector<unsigned int> welded(mesh.Indices);
+
+	//The passes SaveCooked runs and the ACMR it logs, measured on the source indices and vertices before
+	float acmrBefore = CalculateACMR(source.Indices.data(), source.Indices.size(), nrOfSourceVertices);
+	OptimizeVertexCache(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices);
+	OptimizeOverdraw(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride, mesh.NrOfVertices);
+	std::vector<unsigned int> remap;
+	unsigned int nrOfVertices = OptimizeVertexFetch(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices, remap);
+	float acmrAfter = CalculateACMR(mesh.Indices.data(), mesh.Indices.size(), nrOfVertices);
+
+	TT_CHECK_NEAR(acmrBefore, 1.088f, 1e-3);
+	TT_CHECK_NEAR(acmrAfter, 0.774f, 1e-3);
+	TT_CHECK(nrOfVertices == mesh.NrOfVertices);
+	TT_CHECK(HasSameTriangles(mesh.Indices, Remap(welded, remap) ) );
+
+	//Vertices are numbered in the order the triangles first use them
+	unsigned int nextVertex = 0;
+	for(auto index : mesh.Indices){
+		TT_CHECK(index <= nextVertex);
+		if(index == nextVertex)
+			++nextVertex;
+	}
+}
+
+TT_TEST(Optimizer, ShuffledGrid)
+{
+	TestMesh mesh;
+	MakeGrid(100, mesh);
+	ShuffleTriangles(mesh, 3);
+	std::vector<unsigned int> shuffled(mesh.Indices);
+
+	float acmrBefore = CalculateACMR(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices);
+	OptimizeVertexCache(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices);
+	float acmrCache = CalculateACMR(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices);
+	OptimizeOverdraw(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride, mesh.NrOfVertices);
+	float acmrOverdraw = CalculateACMR(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices);
+
+	TT_CHECK(acmrBefore > 2.9f);
+	TT_CHECK(acmrCache < 0.7f);
+	TT_CHECK(acmrOverdraw <= acmrCache * 1.06f);
+	TT_CHECK(HasSameTriangles(mesh.Indices, shuffled) );
+}
+
+TT_TEST(Optimizer, UVSphere)
+{
+	TestMesh mesh;
+	MakeUVSphere(60, 120, mesh);
+	std::vector<unsigned int> original(mesh.Indices);
+
+	OptimizeVertexCache(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices);
+	float acmrCache = CalculateACMR(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices);
+	OptimizeOverdraw(mesh.Indices.data(), mesh.Indices.size(), mesh.GetPositions(), mesh.Stride, mesh.NrOfVertices);
+	float acmrOverdraw = CalculateACMR(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices);
+
+	TT_CHECK(acmrCache < 0.68f);
+	TT_CHECK(acmrOverdraw <= acmrCache * 1.05f);
+	TT_CHECK(HasSameTriangles(mesh.Indices, original) );
+
+	//Every vertex of a closed sphere is used
+	std::vector<unsigned int> remap;
+	TT_CHECK(OptimizeVertexFetch(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices, remap) == mesh.NrOfVertices);
+	TT_CHECK(HasSameTriangles(mesh.Indices, Remap(original, remap) ) );
+}
+
+TT_TEST(Optimizer, WeldVertices)
+{
+	//Every vertex twice, the copies after all originals
+	TestMesh mesh;
+	MakeGrid(10, mesh);
+	unsigned int nrOfVertices = mesh.NrOfVertices;
+	std::vector<float> vertices(mesh.Vertices);
+	vertices.insert(vertices.end(), mesh.Vertices.begin(), mesh.Vertices.end() );
+
+	std::vector<unsigned int> remap;
+	TT_CHECK(WeldVertices(reinterpret_cast<char*>(vertices.data() ), nrOfVertices * 2, mesh.Stride, remap) == nrOfVertices);
+	TT_CHECK(remap.size() == nrOfVertices * 2);
+	for(unsigned int i = 0; i < nrOfVertices * 2; ++i)
+		TT_CHECK(remap[i] == i % nrOfVertices);
+	TT_CHECK(std::equal(mesh.Vertices.begin(), mesh.Vertices.end(), vertices.begin() ) );
+}
+
+TT_TEST(Optimizer, UnusedVertices)
+{
+	//Only the triangles of the top half of the grid
+	TestMesh mesh;
+	MakeGrid(10, mesh);
+	mesh.Indices.erase(mesh.Indices.begin(), mesh.Indices.begin() + mesh.Indices.size() / 2);
+
+	std::set<unsigned int> used(mesh.Indices.begin(), mesh.Indices.end() );
+	std::vector<unsigned int> remap;
+	TT_CHECK(OptimizeVertexFetch(mesh.Indices.data(), mesh.Indices.size(), mesh.NrOfVertices, remap) == used.size() );
+	for(unsigned int i = 0; i < mesh.NrOfVertices; ++i)
+		TT_CHECK( (remap[i] == UNUSED_VERTEX) == (used.count(i) == 0) );
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+//Included ahead of every source file of the headless build, the way the Visual Studio project precompiles Helpers/stdafx.h.
+//The engine throws exception("message") through the Microsoft std::exception constructor that takes a message, which other
+//standard libraries lack; the macro turns those into std::runtime_error. It is defined after every standard header is in,
+//so their own declarations of exception are left alone.
+
+#include <cstdint>
+#include <cmath>
+#include <cfloat>
+#include <climits>
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <set>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <future>
+#include <exception>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+
+#include "../../Helpers/stdafx.h"
+
+#define exception(...) std::runtime_error(__VA_ARGS__ "")
@@ -0,0 +1,18 @@
+#pragma once
+
+//The PhysX value types the math conversions refer to
+
+struct NxVec3
+{
+	float x, y, z;
+
+	NxVec3(void){}
+	NxVec3(float a, float b, float c) : x(a), y(b), z(c){}
+};
+
+struct NxQuat
+{
+	float x, y, z, w;
+
+	void setXYZW(float a, float b, float c, float d){ x = a; y = b; z = c; w = d; }
+};
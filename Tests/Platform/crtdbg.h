@@ -0,0 +1,3 @@
+#pragma once
+
+//Intentionally empty, nothing from this header is used by the modules built headless
@@ -0,0 +1,16 @@
+#pragma once
+
+//Opaque D3D10 interfaces, the headless build never creates any of them
+
+struct ID3D10Effect { void Release(void){} };
+struct ID3D10ShaderResourceView { void Release(void){} };
+struct ID3D10Buffer;
+struct ID3D10Device;
+struct ID3D10EffectPass;
+struct ID3D10EffectTechnique;
+struct ID3D10EffectVariable;
+struct ID3D10InputLayout;
+struct ID3D10Texture2D;
+struct ID3D10RenderTargetView;
+struct ID3D10DepthStencilView;
+struct D3D10_SIGNATURE_PARAMETER_DESC;
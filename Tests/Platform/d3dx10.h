@@ -0,0 +1,95 @@
+#pragma once
+
+//The D3DX value types the engine's math converts to and from, without the D3DX library. Only the members and the few
+//functions the engine headers use inline are provided, the tests check the math against Tests/ReferenceMath.h instead.
+
+#include <cmath>
+#include <cfloat>
+
+#undef INFINITY
+
+#define D3DX10INLINE inline
+#define D3DX_PI 3.14159265358979323846
+
+struct D3DXVECTOR2
+{
+	float x, y;
+
+	D3DXVECTOR2(void){}
+	D3DXVECTOR2(float a, float b) : x(a), y(b){}
+};
+
+struct D3DXVECTOR3
+{
+	float x, y, z;
+
+	D3DXVECTOR3(void){}
+	D3DXVECTOR3(float a, float b, float c) : x(a), y(b), z(c){}
+
+	D3DXVECTOR3 operator+(const D3DXVECTOR3& v) const { return D3DXVECTOR3(x + v.x, y + v.y, z + v.z); }
+	D3DXVECTOR3 operator-(const D3DXVECTOR3& v) const { return D3DXVECTOR3(x - v.x, y - v.y, z - v.z); }
+	D3DXVECTOR3 operator*(float f) const { return D3DXVECTOR3(x * f, y * f, z * f); }
+};
+
+inline D3DXVECTOR3 operator*(float f, const D3DXVECTOR3& v){ return v * f; }
+
+struct D3DXVECTOR4
+{
+	float x, y, z, w;
+
+	D3DXVECTOR4(void){}
+	D3DXVECTOR4(float a, float b, float c, float d) : x(a), y(b), z(c), w(d){}
+
+	operator float*(void){ return &x; }
+	operator const float*(void) const { return &x; }
+};
+
+struct D3DXCOLOR
+{
+	float r, g, b, a;
+
+	D3DXCOLOR(void){}
+	D3DXCOLOR(float red, float green, float blue, float alpha) : r(red), g(green), b(blue), a(alpha){}
+};
+
+struct D3DXQUATERNION
+{
+	float x, y, z, w;
+
+	D3DXQUATERNION(void){}
+	D3DXQUATERNION(float a, float b, float c, float d) : x(a), y(b), z(c), w(d){}
+};
+
+struct D3DXMATRIX
+{
+	union
+	{
+		struct
+		{
+			float _11, _12, _13, _14;
+			float _21, _22, _23, _24;
+			float _31, _32, _33, _34;
+			float _41, _42, _43, _44;
+		};
+		float m[4][4];
+	};
+
+	D3DXMATRIX(void){}
+	D3DXMATRIX(float m11, float m12, float m13, float m14,
+			   float m21, float m22, float m23, float m24,
+			   float m31, float m32, float m33, float m34,
+			   float m41, float m42, float m43, float m44)
+	{
+		_11 = m11; _12 = m12; _13 = m13; _14 = m14;
+		_21 = m21; _22 = m22; _23 = m23; _24 = m24;
+		_31 = m31; _32 = m32; _33 = m33; _34 = m34;
+		_41 = m41; _42 = m42; _43 = m43; _44 = m44;
+	}
+};
+
+inline D3DXVECTOR3* D3DXVec3Normalize(D3DXVECTOR3* pOut, const D3DXVECTOR3* pV)
+{
+	float length = sqrtf(pV->x * pV->x + pV->y * pV->y + pV->z * pV->z);
+	*pOut = length == 0.0f ? D3DXVECTOR3(0, 0, 0) : D3DXVECTOR3(pV->x / length, pV->y / length, pV->z / length);
+	return pOut;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+//The formats the vertex layouts refer to, with their DXGI values
+enum DXGI_FORMAT
+{
+	DXGI_FORMAT_UNKNOWN				= 0,
+	DXGI_FORMAT_R32G32B32A32_FLOAT	= 2,
+	DXGI_FORMAT_R32G32B32A32_UINT	= 3,
+	DXGI_FORMAT_R32G32B32A32_SINT	= 4,
+	DXGI_FORMAT_R32G32B32_FLOAT		= 6,
+	DXGI_FORMAT_R32G32B32_UINT		= 7,
+	DXGI_FORMAT_R32G32B32_SINT		= 8,
+	DXGI_FORMAT_R16G16B16A16_FLOAT	= 10,
+	DXGI_FORMAT_R32G32_FLOAT		= 16,
+	DXGI_FORMAT_R32G32_UINT			= 17,
+	DXGI_FORMAT_R32G32_SINT			= 18,
+	DXGI_FORMAT_R8G8B8A8_UNORM		= 28,
+	DXGI_FORMAT_R8G8B8A8_UINT		= 30,
+	DXGI_FORMAT_R8G8B8A8_SNORM		= 31,
+	DXGI_FORMAT_R16G16_FLOAT		= 34,
+	DXGI_FORMAT_R32_FLOAT			= 41,
+	DXGI_FORMAT_R32_UINT			= 42,
+	DXGI_FORMAT_R32_SINT			= 43,
+	DXGI_FORMAT_R16_UINT			= 57
+};
@@ -0,0 +1,3 @@
+#pragma once
+
+#define _T(x) x
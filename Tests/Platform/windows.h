@@ -0,0 +1,97 @@
+#pragma once
+
+//Stand-in for the parts of windows.h the engine's CPU modules use, so they build and run headless on other platforms.
+//File mapping goes through POSIX mmap, everything else is a typedef or a no-op.
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef unsigned int UINT;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned long DWORD;
+typedef long HRESULT;
+typedef long long LONGLONG;
+typedef char TCHAR;
+typedef int BOOL;
+typedef void* HWND;
+typedef void* HANDLE;
+
+union LARGE_INTEGER
+{
+	struct { DWORD LowPart; long HighPart; };
+	LONGLONG QuadPart;
+};
+
+struct POINT { long x, y; };
+
+#ifndef NULL
+	#define NULL 0
+#endif
+
+#define S_OK 0
+#define FAILED(hr) ( (hr) < 0)
+#define MB_OK 0
+
+#define INVALID_HANDLE_VALUE ( (HANDLE)(intptr_t)-1)
+#define GENERIC_READ 1
+#define FILE_SHARE_READ 1
+#define OPEN_EXISTING 3
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define FILE_FLAG_SEQUENTIAL_SCAN 0x08000000
+#define PAGE_READONLY 2
+#define FILE_MAP_READ 4
+
+inline void OutputDebugString(const char*){}
+inline int MessageBox(void*, const char*, const char*, int){ return 0; }
+
+struct PlatformFileMapping
+{
+	int File;
+	size_t Size;
+};
+
+inline HANDLE CreateFile(const char* pPath, int, int, void*, int, int, void*)
+{
+	int file = open(pPath, O_RDONLY);
+	return file < 0 ? INVALID_HANDLE_VALUE : (HANDLE)(intptr_t)file;
+}
+
+inline BOOL GetFileSizeEx(HANDLE hFile, LARGE_INTEGER* pSize)
+{
+	struct stat info;
+	if(fstat( (int)(intptr_t)hFile, &info) != 0)
+		return 0;
+
+	pSize->QuadPart = info.st_size;
+	return 1;
+}
+
+inline HANDLE CreateFileMapping(HANDLE hFile, void*, int, int, int, void*)
+{
+	struct stat info;
+	if(fstat( (int)(intptr_t)hFile, &info) != 0)
+		return NULL;
+
+	PlatformFileMapping* pMapping = new PlatformFileMapping;
+	pMapping->File = (int)(intptr_t)hFile;
+	pMapping->Size = (size_t)info.st_size;
+	return pMapping;
+}
+
+inline void* MapViewOfFile(HANDLE hMapping, int, int, int, int)
+{
+	PlatformFileMapping* pMapping = (PlatformFileMapping*)hMapping;
+	void* pView = mmap(NULL, pMapping->Size, PROT_READ, MAP_PRIVATE, pMapping->File, 0);
+	return pView == MAP_FAILED ? NULL : pView;
+}
+
+//The view size is only known to the mapping, views are released with the process
+inline BOOL UnmapViewOfFile(const void*){ return 1; }
+
+inline BOOL CloseHandle(HANDLE){ return 1; }
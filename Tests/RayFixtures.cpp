@@ -0,0 +1,42 @@
+#include "RayFixtures.h"
+
+void MakeRandomBoxes(unsigned int nrOfBoxes, std::mt19937& random, std::vector<AABBox>& boxes, AABBoxStreams& streams)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	boxes.resize(nrOfBoxes);
+	streams.Resize(nrOfBoxes);
+	for(unsigned int i = 0; i < nrOfBoxes; ++i){
+		tt::Vector3 center(unit(random) * 50.0f, unit(random) * 50.0f, unit(random) * 50.0f);
+		tt::Vector3 extent(fabs(unit(random) ) * 5.0f + 0.01f, fabs(unit(random) ) * 5.0f + 0.01f, fabs(unit(random) ) * 5.0f + 0.01f);
+		if(i % 17 == 0){
+			center = tt::Vector3(floor(center.x + 0.5f), floor(center.y + 0.5f), floor(center.z + 0.5f) );
+			extent = tt::Vector3(1.0f, 1.0f, 1.0f);
+		}
+
+		boxes[i].Bounds[0] = center - extent;
+		boxes[i].Bounds[1] = center + extent;
+		streams.Set(i, boxes[i]);
+	}
+}
+
+void MakeRandomRays(unsigned int nrOfRays, std::mt19937& random, std::vector<Ray>& rays)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	rays.clear();
+	for(unsigned int i = 0; i < nrOfRays; ++i){
+		tt::Vector3 origin(unit(random) * 80.0f, unit(random) * 80.0f, unit(random) * 80.0f);
+		tt::Vector3 direction(unit(random), unit(random), unit(random) );
+		if(i % 5 == 0)
+			direction = tt::Vector3(0.0f, 0.0f, 1.0f);
+		if(i % 11 == 0)
+			direction = tt::Vector3(-1.0f, 0.0f, 0.0f);
+		if(i % 13 == 0){
+			origin = tt::Vector3(floor(origin.x + 0.5f), floor(origin.y + 0.5f), floor(origin.z + 0.5f) );
+			direction = tt::Vector3(0.0f, 1.0f, 0.0f);
+		}
+		if(i % 9 == 0)
+			direction = tt::Vector3(-0.0f, 0.0f, -1.0f);
+
+		rays.push_back(Ray(origin, direction) );
+	}
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+//Boxes and rays for the ray/box tests and benchmarks, with the awkward cases mixed in: axis aligned rays, rays with a negative
+//zero component, and rays starting on the faces of unit boxes placed on the integer grid
+
+#include "../Graphics/BoundingVolumes.h"
+#include "../Graphics/RayPacket.h"
+#include <random>
+
+//Boxes within 50 units of the origin, up to 5 units wide, set in both forms
+void MakeRandomBoxes(unsigned int nrOfBoxes, std::mt19937& random, std::vector<AABBox>& boxes, AABBoxStreams& streams);
+
+//Rays starting within 80 units of the origin
+void MakeRandomRays(unsigned int nrOfRays, std::mt19937& random, std::vector<Ray>& rays);
@@ -0,0 +1,120 @@
+#include "BenchmarkFramework.h"
+#include "../Graphics/MeshBVH.h"
+#include "RayFixtures.h"
+#include "MeshFixtures.h"
+
+//The packet and stream tests against the one box, one ray AABBox::Intersect they replaced. Compare TTengineBenchmarksSimd,
+//built with TT_TESTS_AVX or without, and TTengineBenchmarksNoSimd for the AVX, SSE and scalar paths.
+
+namespace
+{
+	const unsigned int NR_OF_BOXES = 4096;
+	const unsigned int NR_OF_RAYS = 2000;
+}
+
+TT_BENCHMARK(RayPacket, OneRayManyBoxes)
+{
+	const unsigned int nrOfRays = 200;
+	std::mt19937 random(5);
+	std::vector<AABBox> boxes;
+	AABBoxStreams streams;
+	std::vector<Ray> rays;
+	MakeRandomBoxes(NR_OF_BOXES, random, boxes, streams);
+	MakeRandomRays(nrOfRays, random, rays);
+
+	unsigned int nrOfHits = 0, nrOfStreamHits = 0;
+	double perBox = MeasureMilliseconds([&]{
+		nrOfHits = 0;
+		for(auto& ray : rays)
+			for(auto& box : boxes)
+				nrOfHits += box.Intersect(ray, 0.0f, FLT_MAX);
+	});
+
+	std::vector<BoxHit> hits;
+	double streamed = MeasureMilliseconds([&]{
+		nrOfStreamHits = 0;
+		for(auto& ray : rays){
+			IntersectBoxes(ray, 0.0f, FLT_MAX, streams, hits);
+			nrOfStreamHits += hits.size();
+		}
+	});
+
+	printf("  %u ray x box hits, %u through the streams\n", nrOfHits, nrOfStreamHits);
+	ReportTiming("AABBox::Intersect", perBox, nrOfRays * NR_OF_BOXES, "box");
+	ReportTiming("IntersectBoxes", streamed, nrOfRays * NR_OF_BOXES, "box");
+}
+
+TT_BENCHMARK(RayPacket, ManyRaysOneBox)
+{
+	const unsigned int nrOfBoxes = 512;
+	std::mt19937 random(5);
+	std::vector<AABBox> boxes;
+	AABBoxStreams streams;
+	std::vector<Ray> rays;
+	MakeRandomBoxes(nrOfBoxes, random, boxes, streams);
+	MakeRandomRays(NR_OF_RAYS, random, rays);
+
+	std::vector<RayPacket> packets;
+	for(unsigned int i = 0; i + RAY_PACKET_SIZE <= rays.size(); i += RAY_PACKET_SIZE)
+		packets.push_back(RayPacket(&rays[i], RAY_PACKET_SIZE, 0.0f, FLT_MAX) );
+
+	unsigned int nrOfHits = 0, nrOfPacketHits = 0;
+	double perRay = MeasureMilliseconds([&]{
+		nrOfHits = 0;
+		for(auto& box : boxes)
+			for(auto& ray : rays)
+				nrOfHits += box.Intersect(ray, 0.0f, FLT_MAX);
+	});
+
+	double packeted = MeasureMilliseconds([&]{
+		nrOfPacketHits = 0;
+		for(auto& box : boxes)
+			for(auto& packet : packets)
+				for(int mask = IntersectRayPacket(packet, box); mask != 0; mask &= mask - 1)
+					++nrOfPacketHits;
+	});
+
+	printf("  %u ray x box hits, %u through the packets\n", nrOfHits, nrOfPacketHits);
+	ReportTiming("AABBox::Intersect", perRay, nrOfBoxes * NR_OF_RAYS, "ray");
+	ReportTiming("IntersectRayPacket", packeted, nrOfBoxes * NR_OF_RAYS, "ray");
+}
+
+TT_BENCHMARK(RayPacket, BVHPackets)
+{
+	//Bundles of 8 coherent rays looking down on a 1M triangle terrain
+	const unsigned int size = 708, nrOfBundles = 12500;
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	TestMesh terrain;
+	MakeTerrain(size, terrain, random);
+	MeshBVH bvh;
+	double buildTime = MeasureMilliseconds([&]{
+		bvh.Build(terrain.Indices.data(), terrain.Indices.size(), terrain.GetPositions(), terrain.Stride);
+	}, 1);
+
+	std::vector<Ray> rays;
+	float middle = size * 0.5f;
+	for(unsigned int i = 0; i < nrOfBundles; ++i){
+		tt::Vector3 origin(middle + unit(random) * size * 0.3f, 60.0f, middle + unit(random) * size * 0.3f);
+		tt::Vector3 target(middle + unit(random) * size * 0.5f, 0.0f, middle + unit(random) * size * 0.5f);
+		tt::Vector3 direction = tt::Vector3::Normalize(target - origin);
+		for(unsigned int lane = 0; lane < RAY_PACKET_SIZE; ++lane)
+			rays.push_back(Ray(origin, tt::Vector3::Normalize(direction + tt::Vector3( (lane & 3) * 0.002f, 0.0f, (lane >> 2) * 0.002f) ) ) );
+	}
+
+	std::vector<RayHit> hits(rays.size() );
+	double single = MeasureMilliseconds([&]{
+		for(unsigned int i = 0; i < rays.size(); ++i)
+			bvh.Intersect(rays[i], FLT_MAX, hits[i]);
+	});
+
+	double packeted = MeasureMilliseconds([&]{
+		for(unsigned int i = 0; i < rays.size(); i += RAY_PACKET_SIZE)
+			bvh.Intersect(RayPacket(&rays[i], RAY_PACKET_SIZE, 0.0f, FLT_MAX), &hits[i]);
+	});
+
+	printf("  %u triangles, %u nodes, depth %u\n", terrain.GetNrOfTriangles(), bvh.GetNrOfNodes(), bvh.GetDepth() );
+	ReportTiming("MeshBVH::Build", buildTime);
+	ReportTiming("Single rays", single, rays.size(), "ray");
+	ReportTiming("Packets of 8", packeted, rays.size(), "ray");
+}
@@ -0,0 +1,176 @@
+#include "TestFramework.h"
+#include "../Graphics/MeshBVH.h"
+#include "RayFixtures.h"
+#include "MeshFixtures.h"
+
+//Every packet and stream test has to agree exactly with IntersectRayBox, the scalar slab test, on hits and entry distances
+
+namespace
+{
+	const unsigned int NR_OF_BOXES = 4096;
+	const unsigned int NR_OF_RAYS = 2000;
+
+	//8 coherent rays from one origin, fanned out a little around direction
+	void AddRayBundle(const tt::Vector3& origin, const tt::Vector3& direction, std::vector<Ray>& rays)
+	{
+		for(unsigned int i = 0; i < RAY_PACKET_SIZE; ++i)
+			rays.push_back(Ray(origin, tt::Vector3::Normalize(direction + tt::Vector3( (i & 3) * 0.002f, 0.0f, (i >> 2) * 0.002f) ) ) );
+	}
+
+	bool IsSameHit(const RayHit& a, const RayHit& b)
+	{
+		return a.Distance == b.Distance && a.Triangle == b.Triangle;
+	}
+}
+
+TT_TEST(RayPacket, BoxStreamsMatchScalar)
+{
+	std::mt19937 random(5);
+	std::vector<AABBox> boxes;
+	AABBoxStreams streams;
+	std::vector<Ray> rays;
+	MakeRandomBoxes(NR_OF_BOXES, random, boxes, streams);
+	MakeRandomRays(NR_OF_RAYS, random, rays);
+
+	std::vector<BoxHit> hits;
+	unsigned int nrOfHits = 0;
+	for(unsigned int r = 0; r < rays.size(); ++r){
+		float maxDistance = r % 3 == 0 ? 40.0f : FLT_MAX;
+		IntersectBoxes(rays[r], 0.0f, maxDistance, streams, hits);
+
+		std::vector<bool> expected(NR_OF_BOXES);
+		std::vector<float> entries(NR_OF_BOXES);
+		for(unsigned int b = 0; b < NR_OF_BOXES; ++b)
+			expected[b] = IntersectRayBox(rays[r], &boxes[b].Bounds[0].x, &boxes[b].Bounds[1].x, 0.0f, maxDistance, entries[b]);
+
+		//In box order, each once, and nothing else
+		unsigned int nrOfExpected = std::count(expected.begin(), expected.end(), true);
+		TT_CHECK(hits.size() == nrOfExpected);
+		for(unsigned int i = 0; i < hits.size(); ++i){
+			TT_CHECK(i == 0 || hits[i - 1].Box < hits[i].Box);
+			TT_CHECK(expected[hits[i].Box] && hits[i].Distance == entries[hits[i].Box]);
+		}
+		nrOfHits += nrOfExpected;
+
+		//A single block, with its entry distances
+		float blockEntries[RAY_PACKET_SIZE];
+		unsigned int first = (r % (NR_OF_BOXES / RAY_PACKET_SIZE) ) * RAY_PACKET_SIZE;
+		int mask = IntersectBoxPacket(rays[r], 0.0f, maxDistance, streams, first, blockEntries);
+		for(unsigned int lane = 0; lane < RAY_PACKET_SIZE; ++lane){
+			TT_CHECK( ( (mask >> lane & 1) != 0) == expected[first + lane]);
+			if(expected[first + lane])
+				TT_CHECK(blockEntries[lane] == entries[first + lane]);
+		}
+	}
+	TT_CHECK(nrOfHits > 0);
+}
+
+TT_TEST(RayPacket, RayPacketsMatchScalar)
+{
+	std::mt19937 random(6);
+	std::vector<AABBox> boxes;
+	AABBoxStreams streams;
+	std::vector<Ray> rays;
+	MakeRandomBoxes(NR_OF_BOXES, random, boxes, streams);
+	MakeRandomRays(NR_OF_RAYS, random, rays);
+
+	//Full and partial packets, lanes past the rays never hit
+	const unsigned int packetSizes[] = {8, 5, 4, 1};
+	unsigned int nrOfHits = 0;
+	for(unsigned int r = 0; r + RAY_PACKET_SIZE <= rays.size(); r += RAY_PACKET_SIZE){
+		for(auto nrOfRays : packetSizes){
+			RayPacket packet(&rays[r], nrOfRays, 0.0f, 60.0f);
+			TT_CHECK(packet.GetMask() == (1 << nrOfRays) - 1);
+			for(unsigned int b = 0; b < NR_OF_BOXES; b += 7){
+				float entries[RAY_PACKET_SIZE];
+				int mask = IntersectRayPacket(packet, &boxes[b].Bounds[0].x, &boxes[b].Bounds[1].x, entries);
+				TT_CHECK(mask == IntersectRayPacket(packet, boxes[b]) );
+				for(unsigned int lane = 0; lane < RAY_PACKET_SIZE; ++lane){
+					float entry;
+					bool bExpected = lane < nrOfRays && IntersectRayBox(rays[r + lane], &boxes[b].Bounds[0].x, &boxes[b].Bounds[1].x, 0.0f, 60.0f, entry);
+					TT_CHECK( ( (mask >> lane & 1) != 0) == bExpected);
+					if(bExpected){
+						TT_CHECK(entries[lane] == entry);
+						++nrOfHits;
+					}
+				}
+			}
+		}
+	}
+	TT_CHECK(nrOfHits > 0);
+}
+
+TT_TEST(RayPacket, BVHPacketsMatchSingleRays)
+{
+	//Coherent bundles looking down on a terrain, where packets share most of their traversal
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	const unsigned int size = 200;
+	TestMesh terrain;
+	MakeTerrain(size, terrain, random);
+	MeshBVH bvh;
+	bvh.Build(terrain.Indices.data(), terrain.Indices.size(), terrain.GetPositions(), terrain.Stride);
+
+	std::vector<Ray> rays;
+	float middle = size * 0.5f;
+	for(unsigned int i = 0; i < 500; ++i){
+		tt::Vector3 origin(middle + unit(random) * size * 0.3f, 60.0f, middle + unit(random) * size * 0.3f);
+		tt::Vector3 target(middle + unit(random) * size * 0.5f, 0.0f, middle + unit(random) * size * 0.5f);
+		AddRayBundle(origin, tt::Vector3::Normalize(target - origin), rays);
+	}
+
+	unsigned int nrOfHits = 0;
+	for(unsigned int i = 0; i < rays.size(); i += RAY_PACKET_SIZE){
+		RayHit packetHits[RAY_PACKET_SIZE];
+		int mask = bvh.Intersect(RayPacket(&rays[i], RAY_PACKET_SIZE, 0.0f, FLT_MAX), packetHits);
+		for(unsigned int lane = 0; lane < RAY_PACKET_SIZE; ++lane){
+			RayHit hit;
+			bool bHit = bvh.Intersect(rays[i + lane], FLT_MAX, hit);
+			TT_CHECK( ( (mask >> lane & 1) != 0) == bHit);
+			if(bHit){
+				TT_CHECK(IsSameHit(packetHits[lane], hit) );
+				++nrOfHits;
+			}
+		}
+	}
+	TT_CHECK(nrOfHits > rays.size() / 2);
+
+	//Incoherent partial packets from around the goblin
+	SourceMesh source;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+	TestMesh goblin;
+	WeldSourceMesh(source, goblin);
+	MeshBVH goblinBVH;
+	goblinBVH.Build(goblin.Indices.data(), goblin.Indices.size(), goblin.GetPositions(), goblin.Stride);
+
+	AABBox bounds;
+	bounds.Bounds[0] = bounds.Bounds[1] = goblin.GetPosition(0);
+	for(unsigned int i = 1; i < goblin.NrOfVertices; ++i)
+		bounds.Include(goblin.GetPosition(i) );
+	tt::Vector3 center = (bounds.Bounds[0] + bounds.Bounds[1]) * 0.5f;
+	float radius = (bounds.Bounds[1] - bounds.Bounds[0]).Length() * 0.5f;
+
+	unsigned int nrOfGoblinHits = 0;
+	for(unsigned int i = 0; i < 500; ++i){
+		tt::Vector3 origin = center + tt::Vector3::Normalize(tt::Vector3(unit(random), unit(random), unit(random) ) ) * radius * 2.0f;
+		rays.clear();
+		for(unsigned int lane = 0; lane < RAY_PACKET_SIZE; ++lane){
+			tt::Vector3 target = center + tt::Vector3(unit(random), unit(random), unit(random) ) * radius * 0.5f;
+			rays.push_back(Ray(origin, tt::Vector3::Normalize(target - origin) ) );
+		}
+
+		unsigned int nrOfRays = 1 + i % RAY_PACKET_SIZE;
+		RayHit packetHits[RAY_PACKET_SIZE];
+		int mask = goblinBVH.Intersect(RayPacket(rays.data(), nrOfRays, 0.0f, FLT_MAX), packetHits);
+		for(unsigned int lane = 0; lane < RAY_PACKET_SIZE; ++lane){
+			RayHit hit;
+			bool bHit = lane < nrOfRays && goblinBVH.Intersect(rays[lane], FLT_MAX, hit);
+			TT_CHECK( ( (mask >> lane & 1) != 0) == bHit);
+			if(bHit){
+				TT_CHECK(IsSameHit(packetHits[lane], hit) );
+				++nrOfGoblinHits;
+			}
+		}
+	}
+	TT_CHECK(nrOfGoblinHits > 500);
+}
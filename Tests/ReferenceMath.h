@@ -0,0 +1,229 @@
+#pragma once
+
+//Straightforward versions of the D3DX math functions the engine's math replaced, with the same conventions: row vectors,
+//v * M, and quaternions multiplied q1 * q2 as "q1 then q2". The math tests check tt::Matrix4x4, tt::Quaternion and tt::Vector
+//against these so the rewrite keeps giving what D3DX gave.
+
+#include "../Helpers/D3DUtil.h"
+
+namespace Reference
+{
+	inline float Dot(const D3DXVECTOR3& a, const D3DXVECTOR3& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	inline D3DXVECTOR3 Cross(const D3DXVECTOR3& a, const D3DXVECTOR3& b)
+	{
+		return D3DXVECTOR3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	inline D3DXVECTOR3 Normalize(const D3DXVECTOR3& v)
+	{
+		D3DXVECTOR3 result;
+		D3DXVec3Normalize(&result, &v);
+		return result;
+	}
+
+	inline D3DXVECTOR4 Normalize(const D3DXVECTOR4& v)
+	{
+		float length = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z + v.w * v.w);
+		if(length == 0.0f)
+			return D3DXVECTOR4(0, 0, 0, 0);
+
+		return D3DXVECTOR4(v.x / length, v.y / length, v.z / length, v.w / length);
+	}
+
+	inline D3DXVECTOR3 TransformCoord(const D3DXVECTOR3& v, const D3DXMATRIX& m)
+	{
+		float w = m.m[0][3] * v.x + m.m[1][3] * v.y + m.m[2][3] * v.z + m.m[3][3];
+		return D3DXVECTOR3( (m.m[0][0] * v.x + m.m[1][0] * v.y + m.m[2][0] * v.z + m.m[3][0]) / w,
+							(m.m[0][1] * v.x + m.m[1][1] * v.y + m.m[2][1] * v.z + m.m[3][1]) / w,
+							(m.m[0][2] * v.x + m.m[1][2] * v.y + m.m[2][2] * v.z + m.m[3][2]) / w);
+	}
+
+	inline D3DXVECTOR3 TransformNormal(const D3DXVECTOR3& v, const D3DXMATRIX& m)
+	{
+		return D3DXVECTOR3(m.m[0][0] * v.x + m.m[1][0] * v.y + m.m[2][0] * v.z,
+						   m.m[0][1] * v.x + m.m[1][1] * v.y + m.m[2][1] * v.z,
+						   m.m[0][2] * v.x + m.m[1][2] * v.y + m.m[2][2] * v.z);
+	}
+
+	inline D3DXMATRIX Identity(void)
+	{
+		return D3DXMATRIX(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+	}
+
+	inline D3DXMATRIX Multiply(const D3DXMATRIX& a, const D3DXMATRIX& b)
+	{
+		D3DXMATRIX result;
+		for(int i = 0; i < 4; ++i)
+			for(int j = 0; j < 4; ++j)
+				result.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+
+		return result;
+	}
+
+	//Cofactor expansion in double precision, returns false for singular matrices
+	inline bool Inverse(const D3DXMATRIX& matrix, D3DXMATRIX& result)
+	{
+		double m[16], inv[16];
+		for(int i = 0; i < 16; ++i)
+			m[i] = (&matrix._11)[i];
+
+		inv[0]	=  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+		inv[4]	= -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+		inv[8]	=  m[4] * m[9]  * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+		inv[12]	= -m[4] * m[9]  * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+		inv[1]	= -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+		inv[5]	=  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+		inv[9]	= -m[0] * m[9]  * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+		inv[13]	=  m[0] * m[9]  * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+		inv[2]	=  m[1] * m[6]  * m[15] - m[1] * m[7]  * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7]  - m[13] * m[3] * m[6];
+		inv[6]	= -m[0] * m[6]  * m[15] + m[0] * m[7]  * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7]  + m[12] * m[3] * m[6];
+		inv[10]	=  m[0] * m[5]  * m[15] - m[0] * m[7]  * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7]  - m[12] * m[3] * m[5];
+		inv[14]	= -m[0] * m[5]  * m[14] + m[0] * m[6]  * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6]  + m[12] * m[2] * m[5];
+		inv[3]	= -m[1] * m[6]  * m[11] + m[1] * m[7]  * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9]  * m[2] * m[7]  + m[9]  * m[3] * m[6];
+		inv[7]	=  m[0] * m[6]  * m[11] - m[0] * m[7]  * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8]  * m[2] * m[7]  - m[8]  * m[3] * m[6];
+		inv[11]	= -m[0] * m[5]  * m[11] + m[0] * m[7]  * m[9]  + m[4] * m[1] * m[11] - m[4] * m[3] * m[9]  - m[8]  * m[1] * m[7]  + m[8]  * m[3] * m[5];
+		inv[15]	=  m[0] * m[5]  * m[10] - m[0] * m[6]  * m[9]  - m[4] * m[1] * m[10] + m[4] * m[2] * m[9]  + m[8]  * m[1] * m[6]  - m[8]  * m[2] * m[5];
+
+		double determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+		if(determinant == 0.0)
+			return false;
+
+		for(int i = 0; i < 16; ++i)
+			(&result._11)[i] = (float)(inv[i] / determinant);
+
+		return true;
+	}
+
+	inline D3DXMATRIX RotationQuaternion(const D3DXQUATERNION& q)
+	{
+		D3DXMATRIX result = Identity();
+		result.m[0][0] = 1.0f - 2.0f * (q.y * q.y + q.z * q.z);
+		result.m[0][1] = 2.0f * (q.x * q.y + q.z * q.w);
+		result.m[0][2] = 2.0f * (q.x * q.z - q.y * q.w);
+		result.m[1][0] = 2.0f * (q.x * q.y - q.z * q.w);
+		result.m[1][1] = 1.0f - 2.0f * (q.x * q.x + q.z * q.z);
+		result.m[1][2] = 2.0f * (q.y * q.z + q.x * q.w);
+		result.m[2][0] = 2.0f * (q.x * q.z + q.y * q.w);
+		result.m[2][1] = 2.0f * (q.y * q.z - q.x * q.w);
+		result.m[2][2] = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+		return result;
+	}
+
+	inline D3DXMATRIX RotationAxis(const D3DXVECTOR3& axis, float angle)
+	{
+		D3DXVECTOR3 n = Normalize(axis);
+		float s = sinf(angle), c = cosf(angle), d = 1.0f - c;
+
+		D3DXMATRIX result = Identity();
+		result.m[0][0] = d * n.x * n.x + c;
+		result.m[1][0] = d * n.x * n.y - s * n.z;
+		result.m[2][0] = d * n.x * n.z + s * n.y;
+		result.m[0][1] = d * n.y * n.x + s * n.z;
+		result.m[1][1] = d * n.y * n.y + c;
+		result.m[2][1] = d * n.y * n.z - s * n.x;
+		result.m[0][2] = d * n.z * n.x - s * n.y;
+		result.m[1][2] = d * n.z * n.y + s * n.x;
+		result.m[2][2] = d * n.z * n.z + c;
+		return result;
+	}
+
+	inline D3DXMATRIX RotationYawPitchRoll(float yaw, float pitch, float roll)
+	{
+		float sr = sinf(roll), cr = cosf(roll), sp = sinf(pitch), cp = cosf(pitch), sy = sinf(yaw), cy = cosf(yaw);
+		return D3DXMATRIX(sr * sp * sy + cr * cy,	sr * cp,	sr * sp * cy - cr * sy,	0,
+						  cr * sp * sy - sr * cy,	cr * cp,	cr * sp * cy + sr * sy,	0,
+						  cp * sy,					-sp,		cp * cy,				0,
+						  0,						0,			0,						1);
+	}
+
+	inline D3DXQUATERNION Multiply(const D3DXQUATERNION& q1, const D3DXQUATERNION& q2)
+	{
+		return D3DXQUATERNION(q2.w * q1.x + q2.x * q1.w + q2.y * q1.z - q2.z * q1.y,
+							  q2.w * q1.y - q2.x * q1.z + q2.y * q1.w + q2.z * q1.x,
+							  q2.w * q1.z + q2.x * q1.y - q2.y * q1.x + q2.z * q1.w,
+							  q2.w * q1.w - q2.x * q1.x - q2.y * q1.y - q2.z * q1.z);
+	}
+
+	inline D3DXQUATERNION Normalize(const D3DXQUATERNION& q)
+	{
+		float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		if(length == 0.0f)
+			return D3DXQUATERNION(0, 0, 0, 0);
+
+		return D3DXQUATERNION(q.x / length, q.y / length, q.z / length, q.w / length);
+	}
+
+	inline D3DXQUATERNION QuaternionRotationAxis(const D3DXVECTOR3& axis, float angle)
+	{
+		D3DXVECTOR3 n = Normalize(axis);
+		float s = sinf(angle / 2);
+		return D3DXQUATERNION(s * n.x, s * n.y, s * n.z, cosf(angle / 2) );
+	}
+
+	inline D3DXQUATERNION QuaternionYawPitchRoll(float yaw, float pitch, float roll)
+	{
+		float sy = sinf(yaw / 2), cy = cosf(yaw / 2), sp = sinf(pitch / 2), cp = cosf(pitch / 2), sr = sinf(roll / 2), cr = cosf(roll / 2);
+		return D3DXQUATERNION(sy * cp * sr + cy * sp * cr,
+							  sy * cp * cr - cy * sp * sr,
+							  cy * cp * sr - sy * sp * cr,
+							  cy * cp * cr + sy * sp * sr);
+	}
+
+	inline D3DXQUATERNION QuaternionRotationMatrix(const D3DXMATRIX& m)
+	{
+		D3DXQUATERNION q;
+		float s, trace = m.m[0][0] + m.m[1][1] + m.m[2][2] + 1.0f;
+		if(trace > 1.0f){
+			s = 2.0f * sqrtf(trace);
+			q = D3DXQUATERNION( (m.m[1][2] - m.m[2][1]) / s, (m.m[2][0] - m.m[0][2]) / s, (m.m[0][1] - m.m[1][0]) / s, 0.25f * s);
+			return q;
+		}
+
+		int largest = 0;
+		for(int i = 1; i < 3; ++i)
+			if(m.m[i][i] > m.m[largest][largest])
+				largest = i;
+
+		switch(largest){
+		case 0:
+			s = 2.0f * sqrtf(1.0f + m.m[0][0] - m.m[1][1] - m.m[2][2]);
+			q = D3DXQUATERNION(0.25f * s, (m.m[0][1] + m.m[1][0]) / s, (m.m[0][2] + m.m[2][0]) / s, (m.m[1][2] - m.m[2][1]) / s);
+			break;
+		case 1:
+			s = 2.0f * sqrtf(1.0f + m.m[1][1] - m.m[0][0] - m.m[2][2]);
+			q = D3DXQUATERNION( (m.m[0][1] + m.m[1][0]) / s, 0.25f * s, (m.m[1][2] + m.m[2][1]) / s, (m.m[2][0] - m.m[0][2]) / s);
+			break;
+		default:
+			s = 2.0f * sqrtf(1.0f + m.m[2][2] - m.m[0][0] - m.m[1][1]);
+			q = D3DXQUATERNION( (m.m[0][2] + m.m[2][0]) / s, (m.m[1][2] + m.m[2][1]) / s, 0.25f * s, (m.m[0][1] - m.m[1][0]) / s);
+			break;
+		}
+
+		return q;
+	}
+
+	//Returns false if any axis has no scale
+	inline bool Decompose(const D3DXMATRIX& m, D3DXVECTOR3& scale, D3DXQUATERNION& rotation, D3DXVECTOR3& position)
+	{
+		scale.x = sqrtf(m.m[0][0] * m.m[0][0] + m.m[0][1] * m.m[0][1] + m.m[0][2] * m.m[0][2]);
+		scale.y = sqrtf(m.m[1][0] * m.m[1][0] + m.m[1][1] * m.m[1][1] + m.m[1][2] * m.m[1][2]);
+		scale.z = sqrtf(m.m[2][0] * m.m[2][0] + m.m[2][1] * m.m[2][1] + m.m[2][2] * m.m[2][2]);
+		position = D3DXVECTOR3(m.m[3][0], m.m[3][1], m.m[3][2]);
+		if(scale.x == 0.0f || scale.y == 0.0f || scale.z == 0.0f)
+			return false;
+
+		D3DXMATRIX normalized = Identity();
+		for(int j = 0; j < 3; ++j){
+			normalized.m[0][j] = m.m[0][j] / scale.x;
+			normalized.m[1][j] = m.m[1][j] / scale.y;
+			normalized.m[2][j] = m.m[2][j] / scale.z;
+		}
+
+		rotation = QuaternionRotationMatrix(normalized);
+		return true;
+	}
+}
@@ -0,0 +1,177 @@
+#include "TestFramework.h"
+#include "MeshFixtures.h"
+#include "AnimationFixtures.h"
+#include "../Graphics/CpuSkinning.h"
+
+using namespace tt;
+
+//SkinVertices against a scalar dual quaternion skinner written from the definition, fed the blend data the way a .ttmesh
+//stores it: up to 4 influences per vertex, the unused ones with index -1 and weight 0.
+
+namespace
+{
+	const unsigned int NR_OF_BONES = 12;
+
+	//Hamilton product, the vector part in x, y, z
+	Quaternion Hamilton(const Quaternion& a, const Quaternion& b)
+	{
+		return Quaternion(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+						  a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+						  a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+						  a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+	}
+
+	Quaternion Conjugate(const Quaternion& q)
+	{
+		return Quaternion(-q.x, -q.y, -q.z, q.w);
+	}
+
+	//Blends the influences that have a weight, each flipped to the hemisphere of the first, and normalizes. The rotation is
+	//r v r* and the translation 2 d r*, DualQuaternion(rotation, translation) stores d = t r / 2.
+	void ReferenceSkin(const float* pIndices, const float* pWeights, const std::vector<DualQuaternion>& palette
+					  ,const Vector3& pos, const Vector3& norm, Vector3& skinnedPos, Vector3& skinnedNorm)
+	{
+		Quaternion real(0, 0, 0, 0), dual(0, 0, 0, 0);
+		const Quaternion* pFirst = nullptr;
+		for(unsigned int i = 0; i < 4; ++i){
+			if(pIndices[i] < 0 || pWeights[i] <= 0)
+				continue;
+
+			const DualQuaternion& dq = palette[(unsigned int)pIndices[i] ];
+			if(!pFirst)
+				pFirst = &dq.Data[0];
+
+			float dot = pFirst->x * dq.Data[0].x + pFirst->y * dq.Data[0].y + pFirst->z * dq.Data[0].z + pFirst->w * dq.Data[0].w;
+			float weight = dot < 0 ? -pWeights[i] : pWeights[i];
+			real += dq.Data[0] * weight;
+			dual += dq.Data[1] * weight;
+		}
+
+		//Without a weight the vertex follows its first bone, or bone 0
+		if(!pFirst){
+			const DualQuaternion& dq = palette[pIndices[0] >= 0 ? (unsigned int)pIndices[0] : 0];
+			real = dq.Data[0];
+			dual = dq.Data[1];
+		}
+
+		float length = sqrtf(real.x * real.x + real.y * real.y + real.z * real.z + real.w * real.w);
+		real /= length;
+		dual /= length;
+
+		Quaternion rotatedPos = Hamilton(Hamilton(real, Quaternion(pos.x, pos.y, pos.z, 0) ), Conjugate(real) );
+		Quaternion rotatedNorm = Hamilton(Hamilton(real, Quaternion(norm.x, norm.y, norm.z, 0) ), Conjugate(real) );
+		Quaternion translation = Hamilton(dual, Conjugate(real) ) * 2;
+		skinnedPos = Vector3(rotatedPos.x + translation.x, rotatedPos.y + translation.y, rotatedPos.z + translation.z);
+		skinnedNorm = Vector3(rotatedNorm.x, rotatedNorm.y, rotatedNorm.z);
+	}
+
+	float GetDistance(const Vector3& a, const Vector3& b)
+	{
+		return (a - b).Length();
+	}
+}
+
+TT_TEST(Skinning, UnusedInfluencesMatchReferenceSkinner)
+{
+	//Vertices with 0 to 4 influences, not a multiple of the SIMD width so the scalar tail runs as well. Every third vertex
+	//with 4 influences gives the last one weight 0 and an index past the palette, as some exporters pad influences.
+	const unsigned int nrOfVertices = 53;
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> coordinate(-2.0f, 2.0f), weight(0.1f, 1.0f);
+	std::uniform_int_distribution<int> bone(0, NR_OF_BONES - 1);
+
+	std::vector<D3DXVECTOR4> blendIndices(nrOfVertices), blendWeights(nrOfVertices);
+	std::vector<Vector3> positions(nrOfVertices), normals(nrOfVertices);
+	SkinningStreams streams;
+	streams.Resize(nrOfVertices, true);
+
+	unsigned int highestBone = 0;
+	for(unsigned int v = 0; v < nrOfVertices; ++v){
+		positions[v] = Vector3(coordinate(random), coordinate(random), coordinate(random) );
+		normals[v] = Vector3(coordinate(random), coordinate(random), coordinate(random) ).Normalize();
+		streams.PosX[v] = positions[v].x; streams.PosY[v] = positions[v].y; streams.PosZ[v] = positions[v].z;
+		streams.NormX[v] = normals[v].x; streams.NormY[v] = normals[v].y; streams.NormZ[v] = normals[v].z;
+
+		unsigned int nrOfInfluences = v % 5;
+		float* pIndices = blendIndices[v];
+		float* pWeights = blendWeights[v];
+		float totalWeight = 0;
+		for(unsigned int i = 0; i < 4; ++i){
+			pIndices[i] = i < nrOfInfluences ? (float)bone(random) : -1.0f;
+			pWeights[i] = i < nrOfInfluences ? weight(random) : 0.0f;
+			totalWeight += pWeights[i];
+		}
+		if(nrOfInfluences == 4 && v % 3 == 0){
+			pIndices[3] = NR_OF_BONES + 40.0f;
+			pWeights[3] = 0.0f;
+		}
+		for(unsigned int i = 0; i < nrOfInfluences; ++i){
+			pWeights[i] /= totalWeight;
+			if(pWeights[i] > 0)
+				highestBone = std::max(highestBone, (unsigned int)pIndices[i]);
+		}
+
+		streams.SetInfluences(v, pIndices, pWeights);
+	}
+
+	TT_CHECK(streams.NrOfBones == highestBone + 1);
+
+	std::vector<DualQuaternion> palette(NR_OF_BONES);
+	for(auto& dq : palette)
+		dq = RandomTransform(random);
+
+	std::vector<Vector3> skinnedPositions, skinnedNormals;
+	TT_CHECK(SkinVertices(streams, palette, skinnedPositions, &skinnedNormals) );
+	TT_CHECK(skinnedPositions.size() == nrOfVertices && skinnedNormals.size() == nrOfVertices);
+
+	float maxPosError = 0, maxNormError = 0;
+	for(unsigned int v = 0; v < nrOfVertices && v < skinnedPositions.size(); ++v){
+		Vector3 pos, norm;
+		ReferenceSkin(blendIndices[v], blendWeights[v], palette, positions[v], normals[v], pos, norm);
+		maxPosError = std::max(maxPosError, GetDistance(skinnedPositions[v], pos) );
+		maxNormError = std::max(maxNormError, GetDistance(skinnedNormals[v], norm) );
+	}
+
+	TT_CHECK(maxPosError < 1e-4f);
+	TT_CHECK(maxNormError < 1e-4f);
+}
+
+TT_TEST(Skinning, GoblinMatchesReferenceSkinner)
+{
+	SourceMesh source;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), source);
+
+	unsigned int nrOfPartialVertices = 0;
+	for(unsigned int v = 0; v < source.GetNrOfVertices(); ++v)
+		nrOfPartialVertices += source.BlendIndices.Data[source.BlendIndices.Indices[v] ].w < 0;
+	TT_CHECK(nrOfPartialVertices > 0);
+
+	SkinningStreams streams;
+	MakeSkinningStreams(source, streams);
+	TT_CHECK(streams.NrOfBones > 0 && streams.NrOfBones <= source.Skeleton.size() );
+
+	std::mt19937 random(3);
+	std::vector<DualQuaternion> palette(source.Skeleton.size() );
+	for(auto& dq : palette)
+		dq = RandomTransform(random);
+
+	std::vector<Vector3> skinnedPositions, skinnedNormals;
+	TT_CHECK(SkinVertices(streams, palette, skinnedPositions, &skinnedNormals) );
+
+	float maxPosError = 0, maxNormError = 0;
+	for(unsigned int v = 0; v < skinnedPositions.size(); ++v){
+		const D3DXVECTOR3& sourcePos = source.Positions.Data[source.Positions.Indices[v] ];
+		const D3DXVECTOR3& sourceNorm = source.Normals.Data[source.Normals.Indices[v] ];
+		unsigned int blendData = source.BlendIndices.Indices[v];
+
+		Vector3 pos, norm;
+		ReferenceSkin(source.BlendIndices.Data[blendData], source.BlendWeights.Data[blendData], palette
+					 ,Vector3(sourcePos.x, sourcePos.y, sourcePos.z), Vector3(sourceNorm.x, sourceNorm.y, sourceNorm.z), pos, norm);
+		maxPosError = std::max(maxPosError, GetDistance(skinnedPositions[v], pos) / std::max(1.0f, pos.Length() ) );
+		maxNormError = std::max(maxNormError, GetDistance(skinnedNormals[v], norm) );
+	}
+
+	TT_CHECK(!skinnedPositions.empty() );
+	TT_CHECK(maxPosError < 1e-4f);
+	TT_CHECK(maxNormError < 1e-4f);
+}
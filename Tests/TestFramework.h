@@ -0,0 +1,42 @@
+#pragma once
+
+//Minimal test registry for the headless build. TT_TEST defines a test and registers it under its suite, TestMain.cpp runs
+//the suites named on the command line (all of them without arguments) and returns non-zero if any check failed.
+
+#include <vector>
+#include <cstdio>
+#include <cmath>
+
+struct TestCase
+{
+	const char* Suite;
+	const char* Name;
+	void (*Run)(void);
+};
+
+std::vector<TestCase>& GetTestCases(void);
+void ReportFailure(const char* file, int line, const char* message);
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* suite, const char* name, void (*run)(void));
+};
+
+#define TT_TEST(suite, name) \
+	static void suite##_##name(void); \
+	static TestRegistrar suite##_##name##_Registrar(#suite, #name, suite##_##name); \
+	static void suite##_##name(void)
+
+#define TT_CHECK(condition) \
+	do{ if(!(condition) ) ReportFailure(__FILE__, __LINE__, #condition); }while(false)
+
+//Relative to the magnitude of expected once it exceeds 1
+#define TT_CHECK_NEAR(actual, expected, tolerance) \
+	do{ if(!(fabs( (double)(actual) - (double)(expected) ) <= (tolerance) * (1.0 + fabs( (double)(expected) ) ) ) ) \
+		ReportFailure(__FILE__, __LINE__, #actual " is not near " #expected); }while(false)
+
+//Compares count floats starting at the given addresses, stops at the first mismatch
+#define TT_CHECK_NEAR_N(pActual, pExpected, count, tolerance) \
+	do{ for(unsigned int i_ = 0; i_ < (unsigned int)(count); ++i_) \
+		if(!(fabs( (double)(pActual)[i_] - (double)(pExpected)[i_] ) <= (tolerance) * (1.0 + fabs( (double)(pExpected)[i_] ) ) ) ){ \
+			ReportFailure(__FILE__, __LINE__, #pActual " is not near " #pExpected); break; } }while(false)
@@ -0,0 +1,63 @@
+#include "TestFramework.h"
+#include <cstring>
+
+namespace
+{
+	int g_NrOfFailures = 0;
+
+	bool IsSelected(const TestCase& test, int argc, char** argv)
+	{
+		if(argc < 2)
+			return true;
+
+		for(int i = 1; i < argc; ++i)
+			if(strcmp(argv[i], test.Suite) == 0)
+				return true;
+
+		return false;
+	}
+}
+
+std::vector<TestCase>& GetTestCases(void)
+{
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+void ReportFailure(const char* file, int line, const char* message)
+{
+	printf("  %s(%d): %s\n", file, line, message);
+	++g_NrOfFailures;
+}
+
+TestRegistrar::TestRegistrar(const char* suite, const char* name, void (*run)(void))
+{
+	TestCase test = {suite, name, run};
+	GetTestCases().push_back(test);
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int nrOfTests = 0, nrOfFailedTests = 0;
+	for(auto& test : GetTestCases() ){
+		if(!IsSelected(test, argc, argv) )
+			continue;
+
+		int failuresBefore = g_NrOfFailures;
+		try{
+			test.Run();
+		}
+		catch(std::exception& e){
+			ReportFailure(test.Suite, 0, e.what() );
+		}
+
+		bool bPassed = g_NrOfFailures == failuresBefore;
+		printf("[%s] %s.%s\n", bPassed ? "  OK  " : "FAILED", test.Suite, test.Name);
+		++nrOfTests;
+		if(!bPassed)
+			++nrOfFailedTests;
+	}
+
+	printf("%u tests, %u failed\n", nrOfTests, nrOfFailedTests);
+	return nrOfFailedTests == 0 && nrOfTests > 0 ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include "../../Graphics/SourceMesh.h"
+#include "../../Graphics/MeshCooker.h"
+#include "../../Helpers/MappedFileReader.h"
+#include <fstream>
+
+//Cooks a source .ttmesh with the engine's cooking code (see MeshCooker.h) into a cooked .ttmesh with a single stream holding
+//every attribute, as Model3D::Cook does without layouts, and prints what cooking did to the vertex cache behaviour:
+//
+//	TTengineCookMesh [--static] <source.ttmesh> <cooked.ttmesh>
+//
+//Cooked files hold no animation data. --static drops the skeleton, clips and skin weights of animated meshes instead of
+//refusing them. The cooked file is read back to check it loads. LODs are generated when it is loaded, as for any cooked
+//file without them.
+
+int main(int argc, char* argv[])
+{
+	bool bStatic = argc > 1 && strcmp(argv[1], "--static") == 0;
+	int firstFile = bStatic ? 2 : 1;
+	if(argc != firstFile + 2){
+		printf("Usage: %s [--static] <source.ttmesh> <cooked.ttmesh>\n", argv[0]);
+		return 1;
+	}
+
+	const char* sourceFile = argv[firstFile];
+	const char* cookedFile = argv[firstFile + 1];
+	try{
+		SourceMesh mesh;
+		ReadSourceMesh(sourceFile, mesh);
+
+		if(bStatic){
+			mesh.Skeleton.clear();
+			mesh.AnimClips.clear();
+			mesh.BlendIndices = SourceAttribute<D3DXVECTOR4>();
+			mesh.BlendWeights = SourceAttribute<D3DXVECTOR4>();
+		}
+
+		CookSource source;
+		if(!GatherCookSource(mesh, source) ){
+			printf("%s: has animation data, which cooked files can't hold. Use --static to drop it.\n", sourceFile);
+			return 1;
+		}
+
+		CookedMesh cooked;
+		CookReport report;
+		CookMesh(source, cooked, report);
+
+		vector<char> file;
+		WriteCookedMesh(cooked, file);
+		{
+			std::ofstream outFile(cookedFile, std::ios::binary);
+			outFile.write(file.data(), file.size() );
+			if(!outFile){
+				printf("%s: failed to write\n", cookedFile);
+				return 1;
+			}
+		}
+
+		MappedFileReader cookedReader(cookedFile);
+		CookedMesh loaded;
+		ReadCookedMesh(cookedReader, loaded);
+		if(loaded.NrOfVertices != cooked.NrOfVertices || loaded.Indices != cooked.Indices){
+			printf("%s: reads back different from what was cooked\n", cookedFile);
+			return 1;
+		}
+
+		printf("%s -> %s\n", sourceFile, cookedFile);
+		printf("  %u triangles, %u -> %u vertices, %u clusters, %u bytes\n", static_cast<unsigned int>(cooked.Indices.size() / 3)
+			  ,report.NrOfSourceVertices, report.NrOfVertices, report.NrOfClusters, static_cast<unsigned int>(file.size() ) );
+		printf("  ACMR source %.3f, cooked %.3f\n", report.SourceACMR, report.CookedACMR);
+	}
+	catch(const std::exception& e){
+		printf("%s: %s\n", sourceFile, e.what() );
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+#include "TestFramework.h"
+#include "../Graphics/VertexFormat.h"
+#include "MeshFixtures.h"
+#include <cstring>
+
+namespace
+{
+	//Encodes an attribute in its source format as the quantized format of the semantic and decodes it again
+	DXGI_FORMAT RoundTrip(InputLayoutSemantic semantic, DXGI_FORMAT shaderFormat, const float* pValue, float* pResult)
+	{
+		DXGI_FORMAT format = GetQuantizedFormat(semantic, shaderFormat);
+		char element[16];
+		ConvertVertexElement(semantic, GetSourceFormat(semantic), pValue, format, element);
+		DecodeVertexElement(format, element, pResult);
+		return format;
+	}
+
+	bool IsNaN(unsigned short half)
+	{
+		return (half >> 10 & 0x1F) == 0x1F && (half & 0x3FF) != 0;
+	}
+}
+
+TT_TEST(VertexFormat, HalfRoundTrip)
+{
+	for(unsigned int half = 0; half < 0x10000; ++half)
+		if(!IsNaN(half) )
+			TT_CHECK(FloatToHalf(HalfToFloat(half) ) == half);
+}
+
+TT_TEST(VertexFormat, HalfRoundsToNearest)
+{
+	//No neighbour of the chosen half is closer, over the whole normal and subnormal range
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> mantissa(-1.0f, 1.0f);
+	std::uniform_int_distribution<int> exponent(-24, 15);
+	for(unsigned int i = 0; i < 100000; ++i){
+		float value = ldexp(mantissa(random), exponent(random) );
+		unsigned short half = FloatToHalf(value);
+		float error = fabs(HalfToFloat(half) - value);
+		for(int step = -1; step <= 1; step += 2){
+			unsigned short neighbour = static_cast<unsigned short>(half + step);
+			if( (neighbour & 0x7FFF) < 0x7C00 && (neighbour ^ half) < 0x8000)
+				TT_CHECK(error <= fabs(HalfToFloat(neighbour) - value) );
+		}
+	}
+}
+
+TT_TEST(VertexFormat, QuantizedFormats)
+{
+	TT_CHECK(GetQuantizedFormat(InputLayoutSemantic::Position, DXGI_FORMAT_R32G32B32_FLOAT) == DXGI_FORMAT_R16G16B16A16_FLOAT);
+	TT_CHECK(GetQuantizedFormat(InputLayoutSemantic::TexCoord, DXGI_FORMAT_R32G32_FLOAT) == DXGI_FORMAT_R16G16_FLOAT);
+	TT_CHECK(GetQuantizedFormat(InputLayoutSemantic::Normal, DXGI_FORMAT_R32G32B32_FLOAT) == DXGI_FORMAT_R8G8B8A8_SNORM);
+	TT_CHECK(GetQuantizedFormat(InputLayoutSemantic::BlendWeights, DXGI_FORMAT_R32G32B32A32_FLOAT) == DXGI_FORMAT_R8G8B8A8_UNORM);
+	TT_CHECK(GetQuantizedFormat(InputLayoutSemantic::BlendIndices, DXGI_FORMAT_R32G32B32A32_UINT) == DXGI_FORMAT_R8G8B8A8_UINT);
+
+	//Float bone indices stay floats, the input assembler doesn't convert 8 bit integers to them
+	TT_CHECK(GetQuantizedFormat(InputLayoutSemantic::BlendIndices, DXGI_FORMAT_R32G32B32A32_FLOAT) == DXGI_FORMAT_R32G32B32A32_FLOAT);
+
+	//A skinned vertex of position, normal, uv, indices and weights goes from 64 to 24 bytes
+	TT_CHECK(GetFormatSize(DXGI_FORMAT_R32G32B32_FLOAT) * 2 + GetFormatSize(DXGI_FORMAT_R32G32_FLOAT)
+			+ GetFormatSize(DXGI_FORMAT_R32G32B32A32_UINT) + GetFormatSize(DXGI_FORMAT_R32G32B32A32_FLOAT) == 64);
+	TT_CHECK(GetFormatSize(DXGI_FORMAT_R16G16B16A16_FLOAT) + GetFormatSize(DXGI_FORMAT_R8G8B8A8_SNORM) + GetFormatSize(DXGI_FORMAT_R16G16_FLOAT)
+			+ GetFormatSize(DXGI_FORMAT_R8G8B8A8_UINT) + GetFormatSize(DXGI_FORMAT_R8G8B8A8_UNORM) == 24);
+}
+
+TT_TEST(VertexFormat, NormalizedFormatsClamp)
+{
+	const float color[4] = {1.5f, -0.5f, 0.5f, 1.0f};
+	float result[4];
+	RoundTrip(InputLayoutSemantic::Color, DXGI_FORMAT_R32G32B32A32_FLOAT, color, result);
+	TT_CHECK(result[0] == 1.0f && result[1] == 0.0f && result[3] == 1.0f);
+	TT_CHECK_NEAR(result[2], 0.5f, 1.0 / 255);
+
+	const float normal[4] = {2.0f, -2.0f, 0.0f, 0.0f};
+	RoundTrip(InputLayoutSemantic::Normal, DXGI_FORMAT_R32G32B32_FLOAT, normal, result);
+	TT_CHECK(result[0] == 1.0f && result[1] == -1.0f && result[2] == 0.0f);
+}
+
+TT_TEST(VertexFormat, GoblinQuantizedRoundTrip)
+{
+	SourceMesh mesh;
+	ReadSourceMesh(GetResourcePath("goblin.ttmesh"), mesh);
+
+	//Half precision positions are within half a step of 11 significant bits of the largest coordinate
+	float maxCoordinate = 0.0f;
+	for(auto& position : mesh.Positions.Data)
+		maxCoordinate = max(maxCoordinate, max(fabs(position.x), max(fabs(position.y), fabs(position.z) ) ) );
+
+	float value[4], result[4];
+	for(auto& position : mesh.Positions.Data){
+		D3DXVECTOR4 source(position.x, position.y, position.z, 0.0f);
+		RoundTrip(InputLayoutSemantic::Position, DXGI_FORMAT_R32G32B32_FLOAT, &source.x, result);
+		for(unsigned int i = 0; i < 3; ++i)
+			TT_CHECK(fabs(result[i] - (&source.x)[i]) <= maxCoordinate / 2048);
+		TT_CHECK(result[3] == 1.0f);
+	}
+
+	for(auto& normal : mesh.Normals.Data){
+		D3DXVECTOR4 source(normal.x, normal.y, normal.z, 0.0f);
+		RoundTrip(InputLayoutSemantic::Normal, DXGI_FORMAT_R32G32B32_FLOAT, &source.x, result);
+		float length = sqrt(result[0] * result[0] + result[1] * result[1] + result[2] * result[2]);
+		for(unsigned int i = 0; i < 3; ++i)
+			TT_CHECK(fabs(result[i] / length - (&source.x)[i]) < 0.02f);
+	}
+
+	for(auto& texCoord : mesh.TexCoords[0].Data){
+		D3DXVECTOR4 source(texCoord.x, texCoord.y, 0.0f, 0.0f);
+		RoundTrip(InputLayoutSemantic::TexCoord, DXGI_FORMAT_R32G32_FLOAT, &source.x, result);
+		TT_CHECK(fabs(result[0] - texCoord.x) <= 1.0f / 2048 && fabs(result[1] - texCoord.y) <= 1.0f / 2048);
+	}
+
+	//Weights are renormalized and still add up to exactly 255 steps, indices of every influence survive
+	for(unsigned int i = 0; i < mesh.BlendWeights.Data.size(); ++i){
+		const D3DXVECTOR4& weights = mesh.BlendWeights.Data[i];
+		float sum = weights.x + weights.y + weights.z + weights.w;
+		char element[4];
+		ConvertVertexElement(InputLayoutSemantic::BlendWeights, DXGI_FORMAT_R32G32B32A32_FLOAT, &weights.x, DXGI_FORMAT_R8G8B8A8_UNORM, element);
+		auto pSteps = reinterpret_cast<const unsigned char*>(element);
+		TT_CHECK(pSteps[0] + pSteps[1] + pSteps[2] + pSteps[3] == 255);
+		for(unsigned int j = 0; j < 4; ++j)
+			TT_CHECK(fabs( (&weights.x)[j] / sum - pSteps[j] / 255.0f) <= 1.0f / 255);
+
+		memcpy(value, &mesh.BlendIndices.Data[i].x, sizeof(value) );
+		RoundTrip(InputLayoutSemantic::BlendIndices, DXGI_FORMAT_R32G32B32A32_UINT, value, result);
+		for(unsigned int j = 0; j < 4; ++j)
+			if( (&weights.x)[j] > 0.0f)
+				TT_CHECK(result[j] == value[j]);
+	}
+}
@@ -0,0 +1,135 @@
+#include "TestFramework.h"
+#include "../Helpers/WorkerPool.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+namespace
+{
+	//Runs a loop on the pool and checks every index is visited exactly once, in chunks of at most grainSize
+	void CheckCoverage(WorkerPool& pool, unsigned int count, unsigned int grainSize)
+	{
+		std::vector<std::atomic<unsigned int> > visits(count);
+		for(auto& visit : visits)
+			visit = 0;
+
+		//A grain size of 0 is treated as 1
+		unsigned int chunkSize = grainSize == 0 ? 1 : grainSize;
+		std::atomic<bool> bChunksValid(true);
+		pool.ParallelFor(count, grainSize, [&](unsigned int begin, unsigned int end){
+			//A loop that isn't split arrives as one range, chunks start on a multiple of the grain size
+			bool bWholeRange = begin == 0 && end == count;
+			if(begin >= end || end > count || (!bWholeRange && (begin % chunkSize != 0 || end - begin > chunkSize) ) )
+				bChunksValid = false;
+
+			for(unsigned int i = begin; i < end && i < count; ++i)
+				++visits[i];
+		});
+
+		TT_CHECK(bChunksValid);
+		for(auto& visit : visits)
+			TT_CHECK(visit == 1);
+	}
+}
+
+TT_TEST(WorkerPool, ChunksCoverTheRangeOnce)
+{
+	WorkerPool pool(3);
+	TT_CHECK(pool.GetNrOfWorkers() == 3);
+
+	const unsigned int counts[] = {1, 3, 4, 7, 64, 1000, 1001};
+	const unsigned int grainSizes[] = {1, 4, 16, 5000};
+	for(auto count : counts)
+		for(auto grainSize : grainSizes)
+			CheckCoverage(pool, count, grainSize);
+
+	CheckCoverage(pool, 100, 0);
+
+	//An empty loop doesn't call the function
+	bool bCalled = false;
+	pool.ParallelFor(0, 4, [&](unsigned int, unsigned int){ bCalled = true; });
+	TT_CHECK(!bCalled);
+}
+
+TT_TEST(WorkerPool, NestedCallsRunOnTheCallingThread)
+{
+	WorkerPool pool(3);
+
+	const unsigned int outerCount = 64, innerCount = 50;
+	std::vector<std::atomic<unsigned int> > visits(outerCount * innerCount);
+	for(auto& visit : visits)
+		visit = 0;
+
+	std::atomic<bool> bSerial(true);
+	pool.ParallelFor(outerCount, 2, [&](unsigned int begin, unsigned int end){
+		for(unsigned int outer = begin; outer < end; ++outer){
+			//Waiting on the workers from one of them could deadlock, the inner loop runs in one go instead
+			std::thread::id caller = std::this_thread::get_id();
+			unsigned int nrOfCalls = 0;
+			pool.ParallelFor(innerCount, 4, [&](unsigned int innerBegin, unsigned int innerEnd){
+				++nrOfCalls;
+				if(std::this_thread::get_id() != caller)
+					bSerial = false;
+
+				for(unsigned int inner = innerBegin; inner < innerEnd; ++inner)
+					++visits[outer * innerCount + inner];
+			});
+
+			if(nrOfCalls != 1)
+				bSerial = false;
+		}
+	});
+
+	TT_CHECK(bSerial);
+	for(auto& visit : visits)
+		TT_CHECK(visit == 1);
+}
+
+TT_TEST(WorkerPool, ConcurrentDispatchesAllComplete)
+{
+	WorkerPool pool(3);
+
+	//Only one thread dispatches at a time, the other runs its loop itself
+	std::vector<std::thread> callers;
+	std::atomic<unsigned int> nrOfFailures(0);
+	for(unsigned int t = 0; t < 4; ++t)
+		callers.push_back(std::thread([&](){
+			for(unsigned int run = 0; run < 50; ++run){
+				std::vector<std::atomic<unsigned int> > visits(200);
+				for(auto& visit : visits)
+					visit = 0;
+
+				pool.ParallelFor(visits.size(), 8, [&](unsigned int begin, unsigned int end){
+					for(unsigned int i = begin; i < end; ++i)
+						++visits[i];
+				});
+
+				for(auto& visit : visits)
+					if(visit != 1)
+						++nrOfFailures;
+			}
+		}) );
+
+	for(auto& caller : callers)
+		caller.join();
+
+	TT_CHECK(nrOfFailures == 0);
+}
+
+TT_TEST(WorkerPool, CallerOnlyPoolRunsSerially)
+{
+	//No workers, the caller is the only thread and gets the whole loop at once
+	WorkerPool pool(0);
+	TT_CHECK(pool.GetNrOfWorkers() == 0);
+
+	std::thread::id caller = std::this_thread::get_id();
+	unsigned int nrOfCalls = 0;
+	pool.ParallelFor(1000, 4, [&](unsigned int begin, unsigned int end){
+		++nrOfCalls;
+		TT_CHECK(begin == 0 && end == 1000);
+		TT_CHECK(std::this_thread::get_id() == caller);
+	});
+	TT_CHECK(nrOfCalls == 1);
+
+	CheckCoverage(pool, 77, 3);
+}